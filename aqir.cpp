@@ -0,0 +1,463 @@
+#include "aqir.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// --- 文件中的定长记录，全部没有隐式填充 ---
+namespace {
+
+constexpr char AQIR_MAGIC[4] = {'A', 'Q', 'I', 'R'};
+constexpr uint32_t AQIR_BYTE_ORDER = 0x01020304; // 按本机字节序写入，读回不等说明字节序不同
+constexpr uint32_t AQIR_NO_TYPE = 0xFFFFFFFFu;
+
+struct Section {
+    uint64_t offset; // 相对文件开头，8 字节对齐
+    uint64_t count;  // 记录个数
+};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t quadrupleSize;
+    int32_t tempVarCount;
+    int32_t labelCount;
+    Section strings;         // StringEntry[]
+    Section stringData;      // char[]
+    Section quadruples;      // Quadruple[]
+    Section functions;       // AqirFunction[]
+    Section types;           // TypeRecord[]
+    Section fields;          // FieldRecord[]: 函数参数和结构体成员
+    Section typeNames;       // TypeNameRecord[]: 类型表
+    Section globalSymbols;   // SymbolRecord[]: 全局作用域
+    Section declaredSymbols; // SymbolRecord[]: 所有曾声明的符号
+};
+
+struct StringEntry {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct TypeRecord {
+    NameId name;
+    uint8_t kind;
+    uint8_t isDynamic;
+    uint16_t reserved;
+    int32_t size;
+    int32_t alignment;
+    int32_t arrayElementCount;
+    uint32_t elementType;
+    uint32_t returnType;
+    uint32_t firstField;     // 先是 parameterCount 个参数，再是 memberCount 个成员
+    uint32_t parameterCount;
+    uint32_t memberCount;
+};
+
+struct FieldRecord {
+    NameId name;
+    uint32_t type;
+    int32_t offset; // 结构体成员的偏移，参数不使用
+};
+
+struct TypeNameRecord {
+    NameId name;
+    uint32_t type;
+};
+
+struct SymbolRecord {
+    NameId name;
+    uint32_t type;
+    uint8_t category;
+    uint8_t isConst;
+    uint8_t isInitialized;
+    uint8_t reserved;
+    int32_t memoryOffset;
+    int32_t lineDeclared;
+    int32_t scopeLevel;
+};
+
+// 给类型图中的每个 TypeInfo 编号 (数组、函数类型不在类型表里，只能从符号出发收集)
+class TypeCollector {
+public:
+    uint32_t add(const shared_ptr<TypeInfo>& type) {
+        if (!type) return AQIR_NO_TYPE;
+        auto it = index.find(type.get());
+        if (it != index.end()) return it->second;
+
+        uint32_t id = static_cast<uint32_t>(order.size());
+        index[type.get()] = id;
+        order.push_back(type.get());
+        add(type->elementType);
+        add(type->returnType);
+        for (const auto& p : type->parameters) add(p.type);
+        for (const auto& m : type->structMembers) add(m.type);
+        return id;
+    }
+    uint32_t find(const shared_ptr<TypeInfo>& type) const {
+        return type ? index.at(type.get()) : AQIR_NO_TYPE;
+    }
+    const vector<const TypeInfo*>& types() const { return order; }
+
+private:
+    unordered_map<const TypeInfo*, uint32_t> index;
+    vector<const TypeInfo*> order;
+};
+
+template <typename T>
+Section appendSection(vector<char>& out, const T* items, size_t count) {
+    out.resize((out.size() + 7) & ~size_t(7), 0);
+    Section section{out.size(), count};
+    const char* bytes = reinterpret_cast<const char*>(items);
+    out.insert(out.end(), bytes, bytes + count * sizeof(T));
+    return section;
+}
+
+// 逐个字段拷贝，结构体里的填充字节保持为 0，同样的输入总是写出同样的文件
+void encodeOperand(char* dst, const Operand& o) {
+    memcpy(dst + offsetof(Operand, kind), &o.kind, sizeof(o.kind));
+    memcpy(dst + offsetof(Operand, name), &o.name, sizeof(o.name));
+    memcpy(dst + offsetof(Operand, intValue), &o.intValue, sizeof(o.intValue));
+}
+
+void encodeQuadruple(char* dst, const Quadruple& q) {
+    memcpy(dst + offsetof(Quadruple, op), &q.op, sizeof(q.op));
+    encodeOperand(dst + offsetof(Quadruple, arg1), q.arg1);
+    encodeOperand(dst + offsetof(Quadruple, arg2), q.arg2);
+    encodeOperand(dst + offsetof(Quadruple, res), q.res);
+}
+
+SymbolRecord encodeSymbol(const Symbol& sym, const TypeCollector& types) {
+    SymbolRecord r{};
+    r.name = sym.name;
+    r.type = types.find(sym.type);
+    r.category = static_cast<uint8_t>(sym.category);
+    r.isConst = sym.isConst;
+    r.isInitialized = sym.isInitialized;
+    r.memoryOffset = sym.memoryOffset;
+    r.lineDeclared = sym.lineDeclared;
+    r.scopeLevel = sym.scopeLevel;
+    return r;
+}
+
+// 按名字 id 排序，使输出与哈希表的遍历顺序无关
+template <typename Map>
+vector<typename Map::const_iterator> sortedByName(const Map& map) {
+    vector<typename Map::const_iterator> items;
+    for (auto it = map.begin(); it != map.end(); ++it) items.push_back(it);
+    sort(items.begin(), items.end(), [](const auto& a, const auto& b) { return a->first < b->first; });
+    return items;
+}
+
+bool reportAqirError(const string& path, const string& reason) {
+    cerr << "错误: 无法加载中间代码文件 " << path << ": " << reason << endl;
+    return false;
+}
+
+} // namespace
+
+bool writeAqir(const string& path, QuadrupleSpan quads, const SymbolTable& symbolTable) {
+    auto knownTypes = sortedByName(symbolTable.getKnownTypes());
+    auto globalSymbols = sortedByName(symbolTable.getGlobalScope());
+    auto declaredSymbols = sortedByName(symbolTable.getAllSymbols());
+
+    // 类型表和符号
+    TypeCollector types;
+    for (const auto& it : knownTypes) types.add(it->second);
+    for (const auto& it : globalSymbols) types.add(it->second.type);
+    for (const auto& it : declaredSymbols) types.add(it->second.type);
+
+    vector<TypeRecord> typeRecords;
+    vector<FieldRecord> fieldRecords;
+    for (const TypeInfo* type : types.types()) {
+        TypeRecord r{};
+        r.name = intern(type->name);
+        r.kind = static_cast<uint8_t>(type->kind);
+        r.isDynamic = type->isDynamic;
+        r.size = type->size;
+        r.alignment = type->alignment;
+        r.arrayElementCount = type->arrayElementCount;
+        r.elementType = types.find(type->elementType);
+        r.returnType = types.find(type->returnType);
+        r.firstField = static_cast<uint32_t>(fieldRecords.size());
+        r.parameterCount = static_cast<uint32_t>(type->parameters.size());
+        r.memberCount = static_cast<uint32_t>(type->structMembers.size());
+        for (const auto& p : type->parameters) fieldRecords.push_back({p.name, types.find(p.type), 0});
+        for (const auto& m : type->structMembers) fieldRecords.push_back({m.name, types.find(m.type), m.offset});
+        typeRecords.push_back(r);
+    }
+
+    vector<TypeNameRecord> typeNameRecords;
+    for (const auto& it : knownTypes) typeNameRecords.push_back({it->first, types.find(it->second)});
+    vector<SymbolRecord> globalRecords, declaredRecords;
+    for (const auto& it : globalSymbols) globalRecords.push_back(encodeSymbol(it->second, types));
+    for (const auto& it : declaredSymbols) declaredRecords.push_back(encodeSymbol(it->second, types));
+
+    // 函数边界
+    vector<AqirFunction> functions;
+    for (size_t i = 0; i < quads.size(); ++i) {
+        if (quads[i].op == Opcode::FUNC_BEGIN) {
+            functions.push_back({quads[i].arg1.name, static_cast<uint32_t>(i), static_cast<uint32_t>(quads.size())});
+        } else if (quads[i].op == Opcode::FUNC_END && !functions.empty()) {
+            functions.back().end = static_cast<uint32_t>(i + 1);
+        }
+    }
+
+    // 字符串池放在最后收集: 上面驻留的类型名也要包含进来
+    const StringInterner& pool = interner();
+    vector<StringEntry> stringEntries;
+    vector<char> stringData;
+    for (NameId id = 0; id < pool.size(); ++id) {
+        const string& s = pool.str(id);
+        stringEntries.push_back({static_cast<uint32_t>(stringData.size()), static_cast<uint32_t>(s.size())});
+        stringData.insert(stringData.end(), s.begin(), s.end());
+    }
+
+    // 组装文件
+    Header header{};
+    memcpy(header.magic, AQIR_MAGIC, sizeof(AQIR_MAGIC));
+    header.version = AQIR_VERSION;
+    header.byteOrder = AQIR_BYTE_ORDER;
+    header.quadrupleSize = sizeof(Quadruple);
+    header.tempVarCount = symbolTable.getTempVarCount();
+    header.labelCount = symbolTable.getLabelCount();
+
+    vector<char> out(sizeof(Header), 0);
+    header.strings = appendSection(out, stringEntries.data(), stringEntries.size());
+    header.stringData = appendSection(out, stringData.data(), stringData.size());
+
+    vector<char> quadBytes(quads.size() * sizeof(Quadruple), 0);
+    for (size_t i = 0; i < quads.size(); ++i) encodeQuadruple(&quadBytes[i * sizeof(Quadruple)], quads[i]);
+    header.quadruples = appendSection(out, quadBytes.data(), quadBytes.size());
+    header.quadruples.count = quads.size();
+
+    header.functions = appendSection(out, functions.data(), functions.size());
+    header.types = appendSection(out, typeRecords.data(), typeRecords.size());
+    header.fields = appendSection(out, fieldRecords.data(), fieldRecords.size());
+    header.typeNames = appendSection(out, typeNameRecords.data(), typeNameRecords.size());
+    header.globalSymbols = appendSection(out, globalRecords.data(), globalRecords.size());
+    header.declaredSymbols = appendSection(out, declaredRecords.data(), declaredRecords.size());
+    memcpy(out.data(), &header, sizeof(Header));
+
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file.is_open() || !file.write(out.data(), static_cast<streamsize>(out.size()))) {
+        cerr << "错误: 无法写入中间代码文件: " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+AqirFile::~AqirFile() {
+    close();
+}
+
+void AqirFile::close() {
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (data) munmap(const_cast<char*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+    quads = QuadrupleSpan();
+    remapped.clear();
+    funcs.clear();
+}
+
+// 取出一个段并检查它没有越界、满足对齐
+template <typename T>
+static const T* sectionData(const char* data, size_t size, const Section& s) {
+    if (s.offset > size || s.offset % alignof(T) != 0) return nullptr;
+    if (s.count > (size - s.offset) / sizeof(T)) return nullptr;
+    return reinterpret_cast<const T*>(data + s.offset);
+}
+
+bool AqirFile::open(const string& path, SymbolTable& symbolTable) {
+    close();
+
+    // 1. 只读映射整个文件
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return reportAqirError(path, "无法打开文件");
+    fileHandle = file;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) return reportAqirError(path, "无法获取文件大小");
+    if (static_cast<uint64_t>(fileSize.QuadPart) < sizeof(Header)) return reportAqirError(path, "文件过小");
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) return reportAqirError(path, "无法映射文件");
+    mappingHandle = mapping;
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) return reportAqirError(path, "无法映射文件");
+    data = static_cast<const char*>(view);
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return reportAqirError(path, "无法打开文件");
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(Header)) {
+        ::close(fd);
+        return reportAqirError(path, "文件过小");
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // 映射建立后即可关闭文件描述符
+    if (view == MAP_FAILED) return reportAqirError(path, "无法映射文件");
+    data = static_cast<const char*>(view);
+    size = static_cast<size_t>(st.st_size);
+#endif
+
+    // 2. 校验头部
+    Header header;
+    memcpy(&header, data, sizeof(Header));
+    if (memcmp(header.magic, AQIR_MAGIC, sizeof(AQIR_MAGIC)) != 0) return reportAqirError(path, "不是 .aqir 文件");
+    if (header.version != AQIR_VERSION) {
+        return reportAqirError(path, "版本 " + to_string(header.version) + " 与编译器支持的版本 " +
+            to_string(AQIR_VERSION) + " 不一致");
+    }
+    if (header.byteOrder != AQIR_BYTE_ORDER || header.quadrupleSize != sizeof(Quadruple)) {
+        return reportAqirError(path, "文件由字节序或四元式布局不同的编译器生成");
+    }
+
+    const auto* strings = sectionData<StringEntry>(data, size, header.strings);
+    const auto* stringData = sectionData<char>(data, size, header.stringData);
+    const auto* quadData = sectionData<Quadruple>(data, size, header.quadruples);
+    const auto* functionData = sectionData<AqirFunction>(data, size, header.functions);
+    const auto* typeData = sectionData<TypeRecord>(data, size, header.types);
+    const auto* fieldData = sectionData<FieldRecord>(data, size, header.fields);
+    const auto* typeNameData = sectionData<TypeNameRecord>(data, size, header.typeNames);
+    const auto* globalData = sectionData<SymbolRecord>(data, size, header.globalSymbols);
+    const auto* declaredData = sectionData<SymbolRecord>(data, size, header.declaredSymbols);
+    if (!strings || !stringData || !quadData || !functionData || !typeData || !fieldData ||
+        !typeNameData || !globalData || !declaredData) {
+        return reportAqirError(path, "段越界");
+    }
+
+    // 3. 字符串池装入驻留表。文件中的 id 与本进程一致时 (通常如此: 两边都是先建符号表再驻留其他名字)
+    //    四元式可以原地使用，否则需要换算 id
+    const size_t stringCount = header.strings.count;
+    vector<NameId> idMap(stringCount);
+    bool sameIds = true;
+    for (size_t i = 0; i < stringCount; ++i) {
+        if (strings[i].offset > header.stringData.count ||
+            strings[i].length > header.stringData.count - strings[i].offset) {
+            return reportAqirError(path, "字符串池损坏");
+        }
+        idMap[i] = intern(string_view(stringData + strings[i].offset, strings[i].length));
+        sameIds = sameIds && idMap[i] == i;
+    }
+    bool badName = false;
+    auto mapName = [&](NameId id) -> NameId {
+        if (id >= stringCount) { badName = true; return NAME_NONE; }
+        return idMap[id];
+    };
+
+    // 4. 四元式: 检查操作符和操作数种类都在范围内
+    const size_t quadCount = header.quadruples.count;
+    for (size_t i = 0; i < quadCount; ++i) {
+        const Quadruple& q = quadData[i];
+        if (q.op > Opcode::STORE_MEMBER) return reportAqirError(path, "未知的四元式操作符");
+        for (const Operand* o : {&q.arg1, &q.arg2, &q.res}) {
+            if (o->kind > OperandKind::CHAR || o->name >= stringCount) return reportAqirError(path, "四元式操作数损坏");
+        }
+    }
+    if (sameIds) {
+        quads = QuadrupleSpan(quadData, quadCount);
+    } else {
+        remapped.assign(quadData, quadData + quadCount);
+        for (auto& q : remapped) {
+            q.arg1.name = idMap[q.arg1.name];
+            q.arg2.name = idMap[q.arg2.name];
+            q.res.name = idMap[q.res.name];
+        }
+        quads = QuadrupleSpan(remapped);
+    }
+
+    for (size_t i = 0; i < header.functions.count; ++i) {
+        AqirFunction f = functionData[i];
+        if (f.begin > f.end || f.end > quadCount) return reportAqirError(path, "函数边界损坏");
+        f.name = mapName(f.name);
+        funcs.push_back(f);
+    }
+
+    // 5. 类型: 先建出全部对象再连接相互引用。基础类型沿用符号表里已有的实例
+    const size_t typeCount = header.types.count;
+    vector<shared_ptr<TypeInfo>> types(typeCount);
+    vector<bool> reused(typeCount, false);
+    for (size_t i = 0; i < typeCount; ++i) {
+        const TypeRecord& r = typeData[i];
+        if (r.kind > static_cast<uint8_t>(TypeKind::UNKNOWN)) return reportAqirError(path, "类型表损坏");
+        auto kind = static_cast<TypeKind>(r.kind);
+        NameId name = mapName(r.name);
+        auto existing = symbolTable.lookupType(name);
+        if ((kind == TypeKind::PRIMITIVE || kind == TypeKind::VOID_TYPE) && existing && existing->kind == kind) {
+            types[i] = existing;
+            reused[i] = true;
+            continue;
+        }
+        types[i] = make_shared<TypeInfo>(kind, nameOf(name), r.size, r.alignment);
+        types[i]->arrayElementCount = r.arrayElementCount;
+        types[i]->isDynamic = r.isDynamic != 0;
+    }
+    bool badType = false;
+    auto typeAt = [&](uint32_t index) -> shared_ptr<TypeInfo> {
+        if (index == AQIR_NO_TYPE) return nullptr;
+        if (index >= typeCount) { badType = true; return nullptr; }
+        return types[index];
+    };
+    for (size_t i = 0; i < typeCount; ++i) {
+        if (reused[i]) continue;
+        const TypeRecord& r = typeData[i];
+        if (r.firstField > header.fields.count ||
+            uint64_t(r.parameterCount) + r.memberCount > header.fields.count - r.firstField) {
+            return reportAqirError(path, "类型表损坏");
+        }
+        TypeInfo& type = *types[i];
+        type.elementType = typeAt(r.elementType);
+        type.returnType = typeAt(r.returnType);
+        const FieldRecord* field = fieldData + r.firstField;
+        for (uint32_t k = 0; k < r.parameterCount; ++k, ++field) {
+            type.parameters.push_back({mapName(field->name), typeAt(field->type)});
+        }
+        for (uint32_t k = 0; k < r.memberCount; ++k, ++field) {
+            type.structMembers.push_back({mapName(field->name), typeAt(field->type), field->offset});
+        }
+    }
+    for (size_t i = 0; i < header.typeNames.count; ++i) {
+        symbolTable.addType(mapName(typeNameData[i].name), typeAt(typeNameData[i].type));
+    }
+
+    // 6. 符号和计数器
+    auto restore = [&](const SymbolRecord& r, bool inGlobalScope) -> bool {
+        if (r.category > static_cast<uint8_t>(SymbolCategory::Function)) return false;
+        Symbol sym(mapName(r.name), static_cast<SymbolCategory>(r.category), typeAt(r.type),
+                   r.lineDeclared, r.isConst != 0, r.isInitialized != 0, r.memoryOffset);
+        sym.scopeLevel = r.scopeLevel;
+        symbolTable.restoreSymbol(sym, inGlobalScope, !inGlobalScope);
+        return true;
+    };
+    for (size_t i = 0; i < header.globalSymbols.count; ++i) {
+        if (!restore(globalData[i], true)) return reportAqirError(path, "符号表损坏");
+    }
+    for (size_t i = 0; i < header.declaredSymbols.count; ++i) {
+        if (!restore(declaredData[i], false)) return reportAqirError(path, "符号表损坏");
+    }
+    if (badName || badType) return reportAqirError(path, "名字或类型引用越界");
+    symbolTable.restoreCounters(header.tempVarCount, header.labelCount);
+    return true;
+}
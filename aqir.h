@@ -0,0 +1,62 @@
+#ifndef AQIR_H
+#define AQIR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "quadruple.h"
+#include "symbol_table.h"
+
+// .aqir: 四元式中间代码的二进制文件格式。
+// 文件由定长头部和若干按 8 字节对齐的段组成，段里直接存放定长记录:
+//   字符串池    驻留表中的全部字符串，下标就是写出时的 NameId
+//   四元式      Quadruple 数组，与内存中的布局逐字节相同，映射后无需解析即可交给优化器和代码生成器
+//   函数边界    每个函数 FUNC_BEGIN..FUNC_END 在四元式数组中的范围
+//   类型和符号  SymbolTable 的类型表、全局作用域、所有曾声明的符号以及临时变量/标签计数器
+// 头部记录版本号、字节序和 Quadruple 的大小，与当前编译器不一致的文件拒绝加载。
+
+constexpr uint32_t AQIR_VERSION = 1;
+
+// 一个函数在四元式数组中的范围 [begin, end)
+struct AqirFunction {
+    NameId name;
+    uint32_t begin;
+    uint32_t end;
+};
+
+// 把四元式序列和符号表写成 .aqir 文件，失败时输出错误信息并返回 false
+bool writeAqir(const std::string& path, QuadrupleSpan quads, const SymbolTable& symbolTable);
+
+// 映射进内存的 .aqir 文件，析构时解除映射
+class AqirFile {
+public:
+    AqirFile() = default;
+    ~AqirFile();
+    AqirFile(const AqirFile&) = delete;
+    AqirFile& operator=(const AqirFile&) = delete;
+
+    // 映射文件并校验; 字符串池装入驻留表，类型和符号恢复到 symbolTable (应是新建的符号表)。
+    // 失败时输出错误信息并返回 false
+    bool open(const std::string& path, SymbolTable& symbolTable);
+
+    // 本进程驻留表的 id 与文件一致时直接指向映射的内存，否则指向换算过 id 的副本
+    QuadrupleSpan quadruples() const { return quads; }
+    const std::vector<AqirFunction>& functions() const { return funcs; }
+
+private:
+    void close();
+
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+    QuadrupleSpan quads;
+    std::vector<Quadruple> remapped;
+    std::vector<AqirFunction> funcs;
+};
+
+#endif // AQIR_H
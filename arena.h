@@ -0,0 +1,111 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 区域(bump)分配器: 从大块内存里顺序切出对象，整块一起释放。
+// 不会调用对象的析构函数，所以只允许放平凡可析构的类型 (make 中有静态检查)，
+// 对象内部的字符串/数组也要放在同一个 Arena 里 (见 copyString / ArenaList)。
+class Arena {
+public:
+    explicit Arena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align) {
+        uintptr_t p = (reinterpret_cast<uintptr_t>(cur) + align - 1) & ~(uintptr_t)(align - 1);
+        if (cur == nullptr || p + size > reinterpret_cast<uintptr_t>(limit)) {
+            return allocateSlow(size, align);
+        }
+        cur = reinterpret_cast<char*>(p + size);
+        return reinterpret_cast<void*>(p);
+    }
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena 不调用析构函数，只能存放平凡可析构的类型");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // 未初始化的数组，只用于平凡类型
+    template <typename T>
+    T* allocateArray(size_t count) {
+        static_assert(std::is_trivial<T>::value, "allocateArray 只用于平凡类型");
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // 把字符串拷进 Arena，返回的视图和 Arena 同生命周期
+    std::string_view copyString(std::string_view s) {
+        if (s.empty()) return std::string_view();
+        char* p = static_cast<char*>(allocate(s.size(), 1));
+        std::memcpy(p, s.data(), s.size());
+        return std::string_view(p, s.size());
+    }
+
+    size_t bytesAllocated() const { return totalBytes; }
+
+private:
+    void* allocateSlow(size_t size, size_t align) {
+        // 超过块大小一半的对象单独占一块，避免浪费当前块的剩余空间
+        size_t need = size + align;
+        if (need > blockSize / 2) {
+            blocks.emplace_back(new char[need]);
+            totalBytes += need;
+            uintptr_t p = reinterpret_cast<uintptr_t>(blocks.back().get());
+            return reinterpret_cast<void*>((p + align - 1) & ~(uintptr_t)(align - 1));
+        }
+        blocks.emplace_back(new char[blockSize]);
+        totalBytes += blockSize;
+        cur = blocks.back().get();
+        limit = cur + blockSize;
+        return allocate(size, align);
+    }
+
+    size_t blockSize;
+    char* cur = nullptr;
+    char* limit = nullptr;
+    size_t totalBytes = 0;
+    std::vector<std::unique_ptr<char[]>> blocks;
+};
+
+// 元素放在 Arena 里的动态数组，本身平凡可析构，可以作为 Arena 中对象的成员。
+// 扩容时旧数组直接丢弃，随 Arena 一起释放。T 需是平凡类型 (通常是节点指针)
+template <typename T>
+class ArenaList {
+public:
+    void push_back(Arena& arena, T value) {
+        if (count == capacity) {
+            uint32_t newCapacity = capacity ? capacity * 2 : 4;
+            T* grown = arena.allocateArray<T>(newCapacity);
+            if (count) std::memcpy(grown, items, sizeof(T) * count);
+            items = grown;
+            capacity = newCapacity;
+        }
+        items[count++] = value;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    void clear() { count = 0; }
+    T& operator[](size_t i) { return items[i]; }
+    const T& operator[](size_t i) const { return items[i]; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+
+private:
+    T* items = nullptr;
+    uint32_t count = 0;
+    uint32_t capacity = 0;
+};
+
+#endif // ARENA_H
@@ -3,11 +3,10 @@
 #define AST_NODES_H
 
 #include <string>
-#include <vector>
-#include <memory>
-#include <iostream>
+#include <string_view>
 
 #include "token.h"
+#include "arena.h"
 
 class StatementListNode;
 class TypeNode;
@@ -47,282 +46,249 @@ public:
 
 public:
     ASTNode(NodeType type, int line) : nodeType(type), lineNumber(line) {}
-    virtual ~ASTNode() = default;
-    virtual void print(int indent = 0) const;
+    // 所有节点都分配在 Arena 中，随 Arena 整体释放，不逐个析构。
+    // 因此节点不能有虚析构函数，成员也只能是指针、string_view 和 ArenaList。
+    // 语法分析结束后由 flattenAST 转成 FlatAST (flat_ast.h)，打印和 IR 生成都在 FlatAST 上进行。
 };
 
 //初始化列表类
 class InitializerListNode : public ASTNode {
 public:
-    std::vector<std::unique_ptr<ASTNode>> elements;
+    ArenaList<ASTNode*> elements;
 
-    InitializerListNode(std::vector<std::unique_ptr<ASTNode>> elems, int line)
-        : ASTNode(NodeType::InitializerList, line), elements(std::move(elems)) {}
-
-    void print(int indent = 0) const override;
+    InitializerListNode(ArenaList<ASTNode*> elems, int line)
+        : ASTNode(NodeType::InitializerList, line), elements(elems) {}
 };
 
 //根结点类
 class ProgramNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> statementList;
-    ProgramNode(std::unique_ptr<ASTNode> stmtList, int line)
-        : ASTNode(NodeType::Program, line), statementList(std::move(stmtList)) {}
-    void print(int indent = 0) const override;
+    ASTNode* statementList;
+    ProgramNode(ASTNode* stmtList, int line)
+        : ASTNode(NodeType::Program, line), statementList(stmtList) {}
 };
 
 //语句块类，就是被大括号围起来的类
 class StatementListNode : public ASTNode {
 public:
-    std::vector<std::unique_ptr<ASTNode>> statements;
+    ArenaList<ASTNode*> statements;
     StatementListNode(int line) : ASTNode(NodeType::StatementList, line) {}
-    void addStatement(std::unique_ptr<ASTNode> stmt) {
+    void addStatement(Arena& arena, ASTNode* stmt) {
         if (stmt) {
-            statements.push_back(std::move(stmt));
+            statements.push_back(arena, stmt);
         }
     }
-    void print(int indent = 0) const override;
 };
 
 //基本数据类型的名字，比如int，float还有自己命名的结构体
 class TypeNode : public ASTNode {
 public:
-    std::string typeName;
-    TypeNode(const std::string& name, int line)
+    std::string_view typeName;
+    TypeNode(std::string_view name, int line)
         : ASTNode(NodeType::Type, line), typeName(name) {}
-    void print(int indent = 0) const override;
 };
 
 //数组类型存储
 class ArrayTypeNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> elementType;//数组类型
-    std::unique_ptr<ASTNode> sizeExpression;//大小，动态数组设为空
+    ASTNode* elementType;//数组类型
+    ASTNode* sizeExpression;//大小，动态数组设为空
 
-    ArrayTypeNode(std::unique_ptr<ASTNode> elemType, std::unique_ptr<ASTNode> sizeExpr, int line)
+    ArrayTypeNode(ASTNode* elemType, ASTNode* sizeExpr, int line)
         : ASTNode(NodeType::ArrayType, line),
-          elementType(std::move(elemType)), sizeExpression(std::move(sizeExpr)) {}
-
-    void print(int indent = 0) const override;
+          elementType(elemType), sizeExpression(sizeExpr) {}
 };
 
 //变量语句存储
 class DeclarationStatementNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> typeSpecifier;//类型，可以是typenode也可以是arraynode
-    std::string identifierName;//名字
-    std::unique_ptr<ASTNode> initialValue;//初值
-
-    DeclarationStatementNode(std::unique_ptr<ASTNode> typeSpec, const std::string& idName,
-                             std::unique_ptr<ASTNode> initVal, int line)
-        : ASTNode(NodeType::DeclarationStatement, line), typeSpecifier(std::move(typeSpec)),
-          identifierName(idName), initialValue(std::move(initVal)) {}
-    void print(int indent = 0) const override;
+    ASTNode* typeSpecifier;//类型，可以是typenode也可以是arraynode
+    std::string_view identifierName;//名字
+    ASTNode* initialValue;//初值
+
+    DeclarationStatementNode(ASTNode* typeSpec, std::string_view idName,
+                             ASTNode* initVal, int line)
+        : ASTNode(NodeType::DeclarationStatement, line), typeSpecifier(typeSpec),
+          identifierName(idName), initialValue(initVal) {}
 };
 
 class ArrayAccessNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> arrayExpr;
-    std::unique_ptr<ASTNode> indexExpr;
+    ASTNode* arrayExpr;
+    ASTNode* indexExpr;
 
-    ArrayAccessNode(std::unique_ptr<ASTNode> arrExpr, std::unique_ptr<ASTNode> idxExpr, int line)
+    ArrayAccessNode(ASTNode* arrExpr, ASTNode* idxExpr, int line)
         : ASTNode(NodeType::ArrayAccessExpression, line),
-          arrayExpr(std::move(arrExpr)), indexExpr(std::move(idxExpr)) {}
-
-    void print(int indent = 0) const override;
+          arrayExpr(arrExpr), indexExpr(idxExpr) {}
 };
 
 class StructiDefinitionNode : public ASTNode {
 public:
-    std::string structiName;
-    std::unique_ptr<StatementListNode> memberDeclarations;
-    StructiDefinitionNode(const std::string& name, std::unique_ptr<StatementListNode> members, int line)
+    std::string_view structiName;
+    StatementListNode* memberDeclarations;
+    StructiDefinitionNode(std::string_view name, StatementListNode* members, int line)
         : ASTNode(NodeType::StructiDefinitionStatement, line),
-          structiName(name), memberDeclarations(std::move(members)) {}
-    void print(int indent = 0) const override;
+          structiName(name), memberDeclarations(members) {}
 };
 
 //点操作符，成员访问
 class MemberAccessNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> structExpr;
-    std::string memberName;
-    MemberAccessNode(std::unique_ptr<ASTNode> sExpr, const std::string& mName, int line)
+    ASTNode* structExpr;
+    std::string_view memberName;
+    MemberAccessNode(ASTNode* sExpr, std::string_view mName, int line)
         : ASTNode(NodeType::MemberAccessExpression, line),
-          structExpr(std::move(sExpr)), memberName(mName) {}
-    void print(int indent = 0) const override;
+          structExpr(sExpr), memberName(mName) {}
 };
 
 //赋值语句
 class AssignmentStatementNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> leftHandSide;
-    std::string op;
-    std::unique_ptr<ASTNode> expression;
-
-    AssignmentStatementNode(std::unique_ptr<ASTNode> lhs, std::string oper, std::unique_ptr<ASTNode> expr, int line)
-        : ASTNode(NodeType::AssignmentStatement, line), leftHandSide(std::move(lhs)), op(std::move(oper)), expression(std::move(expr)) {}
-
-    AssignmentStatementNode(std::unique_ptr<ASTNode> lhs, std::unique_ptr<ASTNode> expr, int line)
-        : ASTNode(NodeType::AssignmentStatement, line), leftHandSide(std::move(lhs)), op("="), expression(std::move(expr)) {}
+    ASTNode* leftHandSide;
+    std::string_view op;
+    ASTNode* expression;
 
+    AssignmentStatementNode(ASTNode* lhs, std::string_view oper, ASTNode* expr, int line)
+        : ASTNode(NodeType::AssignmentStatement, line), leftHandSide(lhs), op(oper), expression(expr) {}
 
-    void print(int indent = 0) const override;
+    AssignmentStatementNode(ASTNode* lhs, ASTNode* expr, int line)
+        : ASTNode(NodeType::AssignmentStatement, line), leftHandSide(lhs), op("="), expression(expr) {}
 };
 
 class IfStatementNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> condition;
-    std::unique_ptr<ASTNode> thenBlock;
-    std::unique_ptr<ASTNode> elseBlock;
-    IfStatementNode(std::unique_ptr<ASTNode> cond, std::unique_ptr<ASTNode> thenB,
-                    std::unique_ptr<ASTNode> elseB, int line)
-        : ASTNode(NodeType::IfStatement, line), condition(std::move(cond)),
-          thenBlock(std::move(thenB)), elseBlock(std::move(elseB)) {}
-    void print(int indent = 0) const override;
+    ASTNode* condition;
+    ASTNode* thenBlock;
+    ASTNode* elseBlock;
+    IfStatementNode(ASTNode* cond, ASTNode* thenB,
+                    ASTNode* elseB, int line)
+        : ASTNode(NodeType::IfStatement, line), condition(cond),
+          thenBlock(thenB), elseBlock(elseB) {}
 };
 
 class WhileStatementNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> condition;
-    std::unique_ptr<ASTNode> loopBlock;
-    WhileStatementNode(std::unique_ptr<ASTNode> cond, std::unique_ptr<ASTNode> loopB, int line)
-        : ASTNode(NodeType::WhileStatement, line), condition(std::move(cond)), loopBlock(std::move(loopB)) {}
-    void print(int indent = 0) const override;
+    ASTNode* condition;
+    ASTNode* loopBlock;
+    WhileStatementNode(ASTNode* cond, ASTNode* loopB, int line)
+        : ASTNode(NodeType::WhileStatement, line), condition(cond), loopBlock(loopB) {}
 };
 
 class ForStatementNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> initialization;
-    std::unique_ptr<ASTNode> condition;
-    std::unique_ptr<ASTNode> increment;
-    std::unique_ptr<StatementListNode> body;
-    ForStatementNode(std::unique_ptr<ASTNode> init,
-                     std::unique_ptr<ASTNode> cond,
-                     std::unique_ptr<ASTNode> incr,
-                     std::unique_ptr<StatementListNode> b, int line)
+    ASTNode* initialization;
+    ASTNode* condition;
+    ASTNode* increment;
+    StatementListNode* body;
+    ForStatementNode(ASTNode* init,
+                     ASTNode* cond,
+                     ASTNode* incr,
+                     StatementListNode* b, int line)
         : ASTNode(NodeType::ForStatement, line),
-          initialization(std::move(init)),
-          condition(std::move(cond)),
-          increment(std::move(incr)),
-          body(std::move(b)) {}
-    void print(int indent = 0) const override;
+          initialization(init),
+          condition(cond),
+          increment(incr),
+          body(b) {}
 };
 
 class PrintStatementNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> expression;
-    PrintStatementNode(std::unique_ptr<ASTNode> expr, int line)
-        : ASTNode(NodeType::PrintStatement, line), expression(std::move(expr)) {}
-    void print(int indent = 0) const override;
+    ASTNode* expression;
+    PrintStatementNode(ASTNode* expr, int line)
+        : ASTNode(NodeType::PrintStatement, line), expression(expr) {}
 };
 
 class BinaryExpressionNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> left;
-    std::string op;
-    std::unique_ptr<ASTNode> right;
-    BinaryExpressionNode(std::unique_ptr<ASTNode> l, const std::string& oper, std::unique_ptr<ASTNode> r, int line)
-        : ASTNode(NodeType::BinaryExpression, line), left(std::move(l)), op(oper), right(std::move(r)) {}
-    void print(int indent = 0) const override;
+    ASTNode* left;
+    std::string_view op;
+    ASTNode* right;
+    BinaryExpressionNode(ASTNode* l, std::string_view oper, ASTNode* r, int line)
+        : ASTNode(NodeType::BinaryExpression, line), left(l), op(oper), right(r) {}
 };
 
 class UnaryExpressionNode : public ASTNode {
 public:
-    std::string op;
-    std::unique_ptr<ASTNode> operand;
-    UnaryExpressionNode(const std::string& oper, std::unique_ptr<ASTNode> opnd, int line)
-        : ASTNode(NodeType::UnaryExpression, line), op(oper), operand(std::move(opnd)) {}
-    void print(int indent = 0) const override;
+    std::string_view op;
+    ASTNode* operand;
+    UnaryExpressionNode(std::string_view oper, ASTNode* opnd, int line)
+        : ASTNode(NodeType::UnaryExpression, line), op(oper), operand(opnd) {}
 };
 
 class LiteralNode : public ASTNode {
 public:
-    std::string value;
+    std::string_view value;
     TokenType literalType;
 
-    LiteralNode(const std::string& val, TokenType type, int line)
+    LiteralNode(std::string_view val, TokenType type, int line)
         : ASTNode(NodeType::Literal, line), value(val), literalType(type) {}
-    void print(int indent = 0) const override;
 };
 
 
 class IdentifierNode : public ASTNode {
 public:
-    std::string name;
-    IdentifierNode(const std::string& idName, int line)
+    std::string_view name;
+    IdentifierNode(std::string_view idName, int line)
         : ASTNode(NodeType::Identifier, line), name(idName) {}
-    void print(int indent = 0) const override;
 };
 
 class FunctionDefinitionNode : public ASTNode {
 public:
-    std::string functionName;
-    std::unique_ptr<TypeNode> returnType;
-    std::unique_ptr<StatementListNode> parameters;
-    std::unique_ptr<StatementListNode> body;
-
-    FunctionDefinitionNode(std::string name, std::unique_ptr<TypeNode> retType,
-                             std::unique_ptr<StatementListNode> params, std::unique_ptr<StatementListNode> b, int line)
-        : ASTNode(NodeType::FunctionDefinition, line), functionName(std::move(name)),
-          returnType(std::move(retType)), parameters(std::move(params)), body(std::move(b)) {}
-
-    void print(int indent = 0) const override;
+    std::string_view functionName;
+    TypeNode* returnType;
+    StatementListNode* parameters;
+    StatementListNode* body;
+
+    FunctionDefinitionNode(std::string_view name, TypeNode* retType,
+                             StatementListNode* params, StatementListNode* b, int line)
+        : ASTNode(NodeType::FunctionDefinition, line), functionName(name),
+          returnType(retType), parameters(params), body(b) {}
 };
 
 class FunctionCallNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> functionExpr;
-    std::vector<std::unique_ptr<ASTNode>> arguments;
+    ASTNode* functionExpr;
+    ArenaList<ASTNode*> arguments;
 
-    FunctionCallNode(std::unique_ptr<ASTNode> func, std::vector<std::unique_ptr<ASTNode>> args, int line)
+    FunctionCallNode(ASTNode* func, ArenaList<ASTNode*> args, int line)
         : ASTNode(NodeType::FunctionCall, line),
-          functionExpr(std::move(func)), arguments(std::move(args)) {}
-
-    void print(int indent = 0) const override;
+          functionExpr(func), arguments(args) {}
 };
 
 class ReturnStatementNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> returnValue;
+    ASTNode* returnValue;
 
-    ReturnStatementNode(std::unique_ptr<ASTNode> retVal, int line)
-        : ASTNode(NodeType::ReturnStatement, line), returnValue(std::move(retVal)) {}
-
-    void print(int indent = 0) const override;
+    ReturnStatementNode(ASTNode* retVal, int line)
+        : ASTNode(NodeType::ReturnStatement, line), returnValue(retVal) {}
 };
 
 class BreakStatementNode : public ASTNode {
 public:
     BreakStatementNode(int line) : ASTNode(NodeType::BreakStatement, line) {}
-    void print(int indent = 0) const override;
 };
 
 class ContinueStatementNode : public ASTNode {
 public:
     ContinueStatementNode(int line) : ASTNode(NodeType::ContinueStatement, line) {}
-    void print(int indent = 0) const override;
 };
 
 class CaseStatementNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> value;
-    std::unique_ptr<StatementListNode> body;
-
-    CaseStatementNode(std::unique_ptr<ASTNode> val, std::unique_ptr<StatementListNode> b, int line)
-        : ASTNode(NodeType::CaseStatement, line), value(std::move(val)), body(std::move(b)) {}
+    ASTNode* value;
+    StatementListNode* body;
 
-    void print(int indent = 0) const override;
+    CaseStatementNode(ASTNode* val, StatementListNode* b, int line)
+        : ASTNode(NodeType::CaseStatement, line), value(val), body(b) {}
 };
 
 class SwitchStatementNode : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> expression;
-    std::vector<std::unique_ptr<CaseStatementNode>> cases;
+    ASTNode* expression;
+    ArenaList<CaseStatementNode*> cases;
 
-    SwitchStatementNode(std::unique_ptr<ASTNode> expr, std::vector<std::unique_ptr<CaseStatementNode>> caseList, int line)
-        : ASTNode(NodeType::SwitchStatement, line), expression(std::move(expr)), cases(std::move(caseList)) {}
-    void print(int indent = 0) const override;
+    SwitchStatementNode(ASTNode* expr, ArenaList<CaseStatementNode*> caseList, int line)
+        : ASTNode(NodeType::SwitchStatement, line), expression(expr), cases(caseList) {}
 };
 
 
@@ -0,0 +1,53 @@
+#ifndef BIT_VECTOR_H
+#define BIT_VECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 定长位向量，数据流分析里的集合运算按 64 位字整段进行。
+// 各运算都是对两个等长数组逐字的简单循环，编译器可以自动向量化
+class BitVector {
+public:
+    explicit BitVector(size_t bits = 0) : words((bits + 63) / 64, 0) {}
+
+    void set(size_t i) { words[i >> 6] |= uint64_t(1) << (i & 63); }
+    bool test(size_t i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+
+    // this |= other
+    void unite(const BitVector& other) {
+        const size_t n = words.size();
+        uint64_t* a = words.data();
+        const uint64_t* b = other.words.data();
+        for (size_t k = 0; k < n; ++k) a[k] |= b[k];
+    }
+
+    // this = gen | (in & ~kill)，返回是否有变化
+    bool assignTransfer(const BitVector& gen, const BitVector& in, const BitVector& kill) {
+        const size_t n = words.size();
+        uint64_t* a = words.data();
+        const uint64_t *g = gen.words.data(), *x = in.words.data(), *k = kill.words.data();
+        uint64_t diff = 0;
+        for (size_t w = 0; w < n; ++w) {
+            uint64_t v = g[w] | (x[w] & ~k[w]);
+            diff |= v ^ a[w];
+            a[w] = v;
+        }
+        return diff != 0;
+    }
+
+    // 按下标从小到大访问每个置位的位
+    template <typename F>
+    void forEach(F&& f) const {
+        for (size_t w = 0; w < words.size(); ++w) {
+            for (uint64_t bits = words[w]; bits; bits &= bits - 1) {
+                f(w * 64 + static_cast<size_t>(__builtin_ctzll(bits)));
+            }
+        }
+    }
+
+private:
+    std::vector<uint64_t> words;
+};
+
+#endif // BIT_VECTOR_H
@@ -0,0 +1,516 @@
+#include "bytecode.h"
+
+#include <climits>
+#include <cstdlib>
+#include <iomanip>
+
+#include "code_generator.h"
+
+using namespace std;
+
+namespace {
+
+constexpr int SCRATCH_COUNT = 3;                     // 每个函数的暂存寄存器个数
+constexpr size_t MAX_INDEX = BC_NO_REG - 1;          // 寄存器、常量和全局表的最大下标
+
+[[noreturn]] void lowerError(const string& message) {
+    cout.flush();
+    cerr << "字节码生成错误: " << message << endl;
+    exit(EXIT_FAILURE);
+}
+
+// 四元式操作符到字节码操作码: 同一族内两边的顺序一致 (ADD..MOD, LT..NE)
+BcOp familyOp(BcOp first, Opcode op, Opcode familyFirst) {
+    return static_cast<BcOp>(static_cast<int>(first) + static_cast<int>(op) - static_cast<int>(familyFirst));
+}
+
+bool isComparison(Opcode op) { return op >= Opcode::LT && op <= Opcode::NE; }
+bool isConstant(const Operand& o) { return !o.isVariable() && !o.isNone() && o.kind != OperandKind::LABEL; }
+
+// 交换比较的两个操作数后对应的比较
+Opcode mirrored(Opcode op) {
+    switch (op) {
+        case Opcode::LT: return Opcode::GT;
+        case Opcode::GT: return Opcode::LT;
+        case Opcode::LE: return Opcode::GE;
+        case Opcode::GE: return Opcode::LE;
+        default:         return op;
+    }
+}
+
+class Lowering {
+public:
+    Lowering(QuadrupleSpan quads, SymbolTable& st) : quadruples(quads), symbolTable(st) {}
+
+    BytecodeProgram run() {
+        layouts = computeFrameLayouts(quadruples, symbolTable);
+
+        // 统计每个变量被读取的次数，比较结果只被紧随其后的跳转读取时才能合并
+        for (const auto& q : quadruples) {
+            Operand uses[3];
+            int count = quadUses(q, uses);
+            for (int k = 0; k < count; ++k) ++useCounts[uses[k].name];
+        }
+
+        // 按所属函数分组，顶层代码 (包括 anchor 主块) 排在最前面
+        vector<vector<const Quadruple*>> bodies(1);
+        program.functions.push_back(BcFunction{NAME_NONE});
+        size_t current = 0;
+        for (const auto& q : quadruples) {
+            if (q.op == Opcode::FUNC_BEGIN) {
+                current = bodies.size();
+                program.functionIndex[q.arg1.name] = static_cast<uint32_t>(current);
+                program.functions.push_back(BcFunction{q.arg1.name});
+                bodies.emplace_back();
+                continue;
+            }
+            bodies[current].push_back(&q);
+            if (q.op == Opcode::FUNC_END) current = 0;
+        }
+
+        for (size_t f = 0; f < bodies.size(); ++f) lowerFunction(program.functions[f], bodies[f]);
+
+        for (const auto& [at, label] : jumpFixups) {
+            auto it = labelTargets.find(label);
+            if (it == labelTargets.end()) lowerError("跳转到未定义的标签 '" + nameOf(label) + "'");
+            program.code[at].target = static_cast<int32_t>(it->second);
+        }
+        return std::move(program);
+    }
+
+private:
+    QuadrupleSpan quadruples;
+    SymbolTable& symbolTable;
+    BytecodeProgram program;
+
+    unordered_map<NameId, FrameLayout> layouts;
+    unordered_map<NameId, int> useCounts;
+    unordered_map<NameId, uint16_t> globalIndex;
+    unordered_map<uint64_t, uint16_t> constantIndex; // (种类, 拼写) -> 常量表下标
+    unordered_map<NameId, uint32_t> labelTargets;
+    vector<pair<size_t, NameId>> jumpFixups;
+
+    // 当前函数的寄存器分配
+    unordered_map<NameId, uint16_t> registers;
+    uint16_t scratchBase = 0;
+
+    // 寄存器编号: 形参 (按 GET_PARAM 的逆序)，然后是栈帧布局里的局部变量，最后是布局之外遗漏的变量。
+    // 局部变量中可能先读后写的排在最前面，调用时只有它们需要清零
+    void assignRegisters(BcFunction& function, const vector<const Quadruple*>& body) {
+        registers.clear();
+        auto assign = [&](NameId name) {
+            if (registers.count(name)) return;
+            if (registers.size() >= MAX_INDEX - SCRATCH_COUNT) {
+                lowerError("函数 '" + nameOf(function.name) + "' 的寄存器超过上限");
+            }
+            registers.emplace(name, static_cast<uint16_t>(registers.size()));
+        };
+
+        // 实参从右往左压栈，形参逆序编号后调用时实参正好落在各自的寄存器里
+        vector<NameId> params;
+        for (const Quadruple* q : body) {
+            if (q->op == Opcode::GET_PARAM) params.push_back(q->arg1.name);
+        }
+        for (auto it = params.rbegin(); it != params.rend(); ++it) assign(*it);
+        function.numParams = static_cast<uint16_t>(registers.size());
+
+        vector<NameId> locals;
+        auto layout = layouts.find(function.name);
+        if (layout != layouts.end()) locals = layout->second.order;
+        for (const Quadruple* q : body) {
+            if (q->op == Opcode::FUNC_END) continue;
+            for (const Operand* o : {&q->arg1, &q->arg2, &q->res}) {
+                if (q->op == Opcode::CALL && o == &q->arg1) continue; // 函数名不是变量
+                if (o->isVariable() && globalOf(*o) < 0) locals.push_back(o->name);
+            }
+        }
+
+        // 顶层代码的寄存器段在开始执行时已经全部清零
+        if (function.name != NAME_NONE) {
+            vector<bool> live = liveAtEntry(body, locals);
+            vector<NameId> cleared, rest;
+            for (size_t k = 0; k < locals.size(); ++k) (live[k] ? cleared : rest).push_back(locals[k]);
+            for (NameId name : cleared) assign(name);
+            function.numCleared = static_cast<uint16_t>(registers.size() - function.numParams);
+            for (NameId name : rest) assign(name);
+        } else {
+            for (NameId name : locals) assign(name);
+        }
+
+        scratchBase = static_cast<uint16_t>(registers.size());
+        function.numRegisters = static_cast<uint16_t>(registers.size() + SCRATCH_COUNT);
+    }
+
+    // 逐条四元式做活跃变量分析，返回 locals 中每个变量在函数入口是否活跃 (即可能先读后写)
+    static vector<bool> liveAtEntry(const vector<const Quadruple*>& body, const vector<NameId>& locals) {
+        unordered_map<NameId, size_t> index;
+        for (NameId name : locals) index.emplace(name, index.size());
+        size_t n = body.size(), words = (index.size() + 63) / 64;
+        auto bit = [&](const Operand& o) -> size_t {
+            auto it = o.isVariable() ? index.find(o.name) : index.end();
+            return it == index.end() ? SIZE_MAX : it->second;
+        };
+
+        unordered_map<NameId, size_t> labels;
+        for (size_t i = 0; i < n; ++i) {
+            if (body[i]->op == Opcode::LABEL) labels.emplace(body[i]->arg1.name, i);
+        }
+
+        vector<uint64_t> liveIn((n + 1) * words, 0); // liveIn[n] 是函数出口，恒为空
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t i = n; i-- > 0;) {
+                const Quadruple& q = *body[i];
+                vector<uint64_t> in(words, 0);
+                auto merge = [&](size_t succ) {
+                    for (size_t w = 0; w < words; ++w) in[w] |= liveIn[succ * words + w];
+                };
+                switch (q.op) {
+                    case Opcode::RETURN: case Opcode::FUNC_END:
+                        break;
+                    case Opcode::JUMP:
+                    case Opcode::JUMPF:
+                    case Opcode::JUMPNZ: {
+                        auto target = labels.find(q.res.name);
+                        if (target != labels.end()) merge(target->second);
+                        if (q.op != Opcode::JUMP) merge(i + 1);
+                        break;
+                    }
+                    default:
+                        merge(i + 1);
+                        break;
+                }
+                size_t def = bit(quadDef(q));
+                if (def != SIZE_MAX) in[def / 64] &= ~(uint64_t{1} << (def % 64));
+                Operand uses[3];
+                int count = quadUses(q, uses);
+                for (int k = 0; k < count; ++k) {
+                    size_t use = bit(uses[k]);
+                    if (use != SIZE_MAX) in[use / 64] |= uint64_t{1} << (use % 64);
+                }
+                for (size_t w = 0; w < words; ++w) {
+                    if (liveIn[i * words + w] != in[w]) {
+                        liveIn[i * words + w] = in[w];
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        vector<bool> live(locals.size());
+        for (size_t k = 0; k < locals.size(); ++k) {
+            auto it = index.find(locals[k]);
+            live[k] = n > 0 && (liveIn[it->second / 64] >> (it->second % 64) & 1);
+        }
+        return live;
+    }
+
+    // 与解释器和代码生成器一致: 能在全局作用域查到的变量都是全局变量。返回全局表下标，不是时返回 -1
+    int globalOf(const Operand& o) {
+        auto it = globalIndex.find(o.name);
+        if (it != globalIndex.end()) return it->second;
+        const Symbol* sym = symbolTable.lookup(o.name);
+        if (!sym || sym->scopeLevel != 0 || sym->category != SymbolCategory::Variable) return -1;
+        if (program.globals.size() >= MAX_INDEX) lowerError("全局变量过多");
+        uint16_t index = static_cast<uint16_t>(program.globals.size());
+        program.globals.push_back(o.name);
+        globalIndex.emplace(o.name, index);
+        return index;
+    }
+
+    uint16_t constantOf(const Operand& o) {
+        uint64_t key = (static_cast<uint64_t>(o.kind) << 32) | o.name;
+        auto [it, inserted] = constantIndex.try_emplace(key, static_cast<uint16_t>(program.constants.size()));
+        if (inserted) {
+            if (program.constants.size() >= MAX_INDEX) lowerError("常量过多");
+            program.constants.push_back(constantValue(o));
+        }
+        return it->second;
+    }
+
+    void emit(BcOp op, uint16_t a = 0, uint16_t b = 0, uint16_t c = 0, int32_t target = 0, uint8_t flag = 0) {
+        BcInstr in;
+        in.op = op;
+        in.flag = flag;
+        in.a = a;
+        in.b = b;
+        in.c = c;
+        in.target = target;
+        program.code.push_back(in);
+    }
+
+    void emitJump(BcOp op, uint16_t a, uint16_t b, const Operand& label, uint8_t flag = 0) {
+        jumpFixups.emplace_back(program.code.size(), label.name);
+        emit(op, a, b, 0, 0, flag);
+    }
+
+    // 存放操作数值的寄存器: 局部变量直接用它的寄存器，全局变量和常量先载入第 k 个暂存寄存器
+    uint16_t read(const Operand& o, int k) {
+        uint16_t scratch = static_cast<uint16_t>(scratchBase + k);
+        if (o.isVariable()) {
+            int g = globalOf(o);
+            if (g < 0) return registers.at(o.name);
+            emit(BcOp::GETGLOBAL, scratch, static_cast<uint16_t>(g));
+            return scratch;
+        }
+        emit(BcOp::LOADK, scratch, constantOf(o));
+        return scratch;
+    }
+
+    // 结果要写入的寄存器: 局部变量直接写，全局变量先写进第 k 个暂存寄存器，再由 store 写回全局表
+    uint16_t dest(const Operand& o, int k) {
+        if (o.isVariable() && globalOf(o) < 0) return registers.at(o.name);
+        return static_cast<uint16_t>(scratchBase + k);
+    }
+
+    void store(const Operand& o, uint16_t reg) {
+        if (!o.isVariable()) return;
+        int g = globalOf(o);
+        if (g >= 0) emit(BcOp::SETGLOBAL, static_cast<uint16_t>(g), reg);
+    }
+
+    // 比较结果只被紧随其后的 JUMPF/JUMPNZ 读取时，合并成一条比较跳转
+    bool tryFuseCompare(const Quadruple& q, const Quadruple* next) {
+        if (!next || (next->op != Opcode::JUMPF && next->op != Opcode::JUMPNZ)) return false;
+        if (!q.res.isVariable() || next->arg1 != q.res || globalOf(q.res) >= 0) return false;
+        if (useCounts[q.res.name] != 1) return false;
+
+        uint8_t flag = next->op == Opcode::JUMPNZ ? 1 : 0;
+        if (isConstant(q.arg2) || isConstant(q.arg1)) {
+            bool swap = !isConstant(q.arg2); // 常量在左边时交换两边
+            Opcode cmp = swap ? mirrored(q.op) : q.op;
+            uint16_t a = read(swap ? q.arg2 : q.arg1, 0);
+            uint16_t k = constantOf(swap ? q.arg1 : q.arg2);
+            emitJump(familyOp(BcOp::JLTK, cmp, Opcode::LT), a, k, next->res, flag);
+        } else {
+            uint16_t a = read(q.arg1, 0);
+            uint16_t b = read(q.arg2, 1);
+            emitJump(familyOp(BcOp::JLT, q.op, Opcode::LT), a, b, next->res, flag);
+        }
+        return true;
+    }
+
+    void lowerFunction(BcFunction& function, const vector<const Quadruple*>& body) {
+        assignRegisters(function, body);
+        function.entry = static_cast<uint32_t>(program.code.size());
+
+        for (size_t i = 0; i < body.size(); ++i) {
+            const Quadruple& q = *body[i];
+            const Quadruple* next = i + 1 < body.size() ? body[i + 1] : nullptr;
+            switch (q.op) {
+                case Opcode::LABEL:
+                    labelTargets[q.arg1.name] = static_cast<uint32_t>(program.code.size());
+                    break;
+                case Opcode::GET_PARAM:
+                case Opcode::FUNC_BEGIN:
+                    break; // 形参在 CALL 时直接放进寄存器
+                case Opcode::FUNC_END:
+                    emit(BcOp::RETURN0);
+                    break;
+                case Opcode::ASSIGN: {
+                    if (q.res.isVariable() && globalOf(q.res) < 0) {
+                        uint16_t d = registers.at(q.res.name);
+                        if (q.arg1.isVariable() && globalOf(q.arg1) < 0) {
+                            emit(BcOp::MOVE, d, registers.at(q.arg1.name));
+                        } else if (q.arg1.isVariable()) {
+                            emit(BcOp::GETGLOBAL, d, static_cast<uint16_t>(globalOf(q.arg1)));
+                        } else {
+                            emit(BcOp::LOADK, d, constantOf(q.arg1));
+                        }
+                    } else {
+                        store(q.res, read(q.arg1, 0));
+                    }
+                    break;
+                }
+                case Opcode::ADD: case Opcode::SUB: case Opcode::MUL:
+                case Opcode::DIV: case Opcode::MOD: {
+                    Operand lhs = q.arg1, rhs = q.arg2;
+                    if (q.op == Opcode::MUL && isConstant(lhs) && !isConstant(rhs)) swap(lhs, rhs);
+                    bool constantRhs = q.op <= Opcode::MUL && isConstant(rhs) && !isConstant(lhs);
+                    uint16_t b = read(lhs, 1);
+                    uint16_t c = constantRhs ? constantOf(rhs) : read(rhs, 2);
+                    uint16_t a = dest(q.res, 0);
+                    emit(constantRhs ? familyOp(BcOp::ADDK, q.op, Opcode::ADD) : familyOp(BcOp::ADD, q.op, Opcode::ADD), a, b, c);
+                    store(q.res, a);
+                    break;
+                }
+                case Opcode::NEG:
+                case Opcode::NOT: {
+                    uint16_t b = read(q.arg1, 1);
+                    uint16_t a = dest(q.res, 0);
+                    emit(q.op == Opcode::NEG ? BcOp::NEG : BcOp::NOT, a, b);
+                    store(q.res, a);
+                    break;
+                }
+                case Opcode::LT: case Opcode::GT: case Opcode::LE:
+                case Opcode::GE: case Opcode::EQ: case Opcode::NE:
+                    if (tryFuseCompare(q, next)) {
+                        ++i; // 跳转已经合并
+                        break;
+                    }
+                    [[fallthrough]];
+                case Opcode::AND:
+                case Opcode::OR: {
+                    uint16_t b = read(q.arg1, 1);
+                    uint16_t c = read(q.arg2, 2);
+                    uint16_t a = dest(q.res, 0);
+                    BcOp op = isComparison(q.op) ? familyOp(BcOp::LT, q.op, Opcode::LT)
+                                                 : (q.op == Opcode::AND ? BcOp::AND : BcOp::OR);
+                    emit(op, a, b, c);
+                    store(q.res, a);
+                    break;
+                }
+                case Opcode::JUMP:
+                    emitJump(BcOp::JMP, 0, 0, q.res);
+                    break;
+                case Opcode::JUMPF:
+                case Opcode::JUMPNZ:
+                    emitJump(q.op == Opcode::JUMPF ? BcOp::JMPF : BcOp::JMPT, read(q.arg1, 0), 0, q.res);
+                    break;
+                case Opcode::PARAM:
+                    emit(BcOp::PARAM, read(q.arg1, 0));
+                    break;
+                case Opcode::CALL: {
+                    if (program.callSites.size() >= INT32_MAX) lowerError("调用点过多");
+                    int32_t site = static_cast<int32_t>(program.callSites.size());
+                    program.callSites.push_back(q.arg1.name);
+                    uint16_t a = q.res.isVariable() ? dest(q.res, 0) : BC_NO_REG;
+                    uint16_t argc = static_cast<uint16_t>(min<int64_t>(max<int64_t>(q.arg2.intValue, 0), MAX_INDEX));
+                    emit(BcOp::CALL, a, argc, 0, site);
+                    store(q.res, a);
+                    break;
+                }
+                case Opcode::RETURN:
+                    if (q.arg1.isNone()) emit(BcOp::RETURN0);
+                    else emit(BcOp::RETURN, read(q.arg1, 0));
+                    break;
+                case Opcode::PRINT:
+                    emit(BcOp::PRINT, read(q.arg1, 0));
+                    break;
+                case Opcode::DEC_ARRAY:
+                case Opcode::DEC_DYN_ARRAY: {
+                    uint16_t b = read(q.arg2, 1);
+                    uint16_t a = dest(q.arg1, 0);
+                    emit(BcOp::NEWARRAY, a, b);
+                    store(q.arg1, a);
+                    break;
+                }
+                // 结构体第一次访问成员时才分配存储，所以基址是全局变量时访问之后要写回
+                case Opcode::STORE_AT: {
+                    uint16_t base = read(q.arg2, 0);
+                    uint16_t index = read(q.res, 1);
+                    uint16_t src = read(q.arg1, 2);
+                    emit(BcOp::SETINDEX, base, index, src);
+                    store(q.arg2, base);
+                    break;
+                }
+                case Opcode::LOAD_AT: {
+                    uint16_t base = read(q.arg2, 1);
+                    uint16_t index = read(q.res, 2);
+                    uint16_t a = dest(q.arg1, 0);
+                    emit(BcOp::GETINDEX, a, base, index);
+                    store(q.arg2, base);
+                    store(q.arg1, a);
+                    break;
+                }
+                case Opcode::LOAD_MEMBER: {
+                    // 成员按 2 字节一个排布，换成成员下标
+                    uint16_t base = read(q.arg2, 1);
+                    uint16_t a = dest(q.arg1, 0);
+                    emit(BcOp::GETFIELD, a, base, static_cast<uint16_t>(q.res.intValue / 2));
+                    store(q.arg2, base);
+                    store(q.arg1, a);
+                    break;
+                }
+                case Opcode::STORE_MEMBER: {
+                    uint16_t src = read(q.arg1, 0);
+                    uint16_t base = read(q.arg2, 1);
+                    emit(BcOp::SETFIELD, src, base, static_cast<uint16_t>(q.res.intValue / 2));
+                    store(q.arg2, base);
+                    break;
+                }
+            }
+        }
+
+        // 顶层代码执行完停机，函数体末尾总有 FUNC_END 生成的返回
+        if (function.name == NAME_NONE) emit(BcOp::HALT);
+        else if (program.code.empty() || program.code.back().op != BcOp::RETURN0) emit(BcOp::RETURN0);
+    }
+};
+
+} // namespace
+
+const char* bcOpName(BcOp op) {
+    static const char* const names[] = {
+        "MOVE", "LOADK", "GETGLOBAL", "SETGLOBAL",
+        "ADD", "SUB", "MUL", "DIV", "MOD", "ADDK", "SUBK", "MULK", "NEG", "NOT",
+        "LT", "GT", "LE", "GE", "EQ", "NE", "AND", "OR",
+        "JMP", "JMPF", "JMPT",
+        "JLT", "JGT", "JLE", "JGE", "JEQ", "JNE",
+        "JLTK", "JGTK", "JLEK", "JGEK", "JEQK", "JNEK",
+        "PARAM", "CALL", "RETURN", "RETURN0", "PRINT",
+        "NEWARRAY", "GETINDEX", "SETINDEX", "GETFIELD", "SETFIELD", "HALT"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(BcOp::HALT) + 1, "名字表与 BcOp 不一致");
+    return names[static_cast<size_t>(op)];
+}
+
+BytecodeProgram lowerToBytecode(QuadrupleSpan quads, SymbolTable& st) {
+    return Lowering(quads, st).run();
+}
+
+void BytecodeProgram::dump(ostream& os) const {
+    os << "常量表:";
+    for (size_t k = 0; k < constants.size(); ++k) {
+        os << " K" << k << "=";
+        if (constants[k].type == ValueType::STRING) os << '"' << *constants[k].s << '"';
+        else writeValue(os, constants[k]);
+    }
+    os << "\n全局表:";
+    for (size_t g = 0; g < globals.size(); ++g) os << " G" << g << "=" << nameOf(globals[g]);
+    os << '\n';
+
+    auto reg = [](uint16_t r) { return r == BC_NO_REG ? string("_") : "r" + to_string(r); };
+    for (size_t f = 0; f < functions.size(); ++f) {
+        const BcFunction& fn = functions[f];
+        uint32_t end = f + 1 < functions.size() ? functions[f + 1].entry : static_cast<uint32_t>(code.size());
+        os << "\n函数 " << (fn.name == NAME_NONE ? string("<顶层>") : nameOf(fn.name))
+           << ": 参数 " << fn.numParams << " 个, 寄存器 " << fn.numRegisters << " 个, 调用时清零 "
+           << fn.numCleared << " 个\n";
+        for (uint32_t pc = fn.entry; pc < end; ++pc) {
+            const BcInstr& in = code[pc];
+            os << setw(6) << pc << "  ";
+            if (in.op == BcOp::RETURN0 || in.op == BcOp::HALT) {
+                os << bcOpName(in.op) << '\n';
+                continue;
+            }
+            os << left << setw(10) << bcOpName(in.op) << right;
+            switch (in.op) {
+                case BcOp::MOVE: case BcOp::NEG: case BcOp::NOT: case BcOp::NEWARRAY:
+                    os << reg(in.a) << ", " << reg(in.b); break;
+                case BcOp::LOADK:     os << reg(in.a) << ", K" << in.b; break;
+                case BcOp::GETGLOBAL: os << reg(in.a) << ", G" << in.b; break;
+                case BcOp::SETGLOBAL: os << "G" << in.a << ", " << reg(in.b); break;
+                case BcOp::ADDK: case BcOp::SUBK: case BcOp::MULK:
+                    os << reg(in.a) << ", " << reg(in.b) << ", K" << in.c; break;
+                case BcOp::GETFIELD: case BcOp::SETFIELD:
+                    os << reg(in.a) << ", " << reg(in.b) << ", #" << in.c; break;
+                case BcOp::JMP:       os << "@" << in.target; break;
+                case BcOp::JMPF: case BcOp::JMPT:
+                    os << reg(in.a) << ", @" << in.target; break;
+                case BcOp::JLT: case BcOp::JGT: case BcOp::JLE: case BcOp::JGE: case BcOp::JEQ: case BcOp::JNE:
+                    os << reg(in.a) << ", " << reg(in.b) << (in.flag ? ", 真 @" : ", 假 @") << in.target; break;
+                case BcOp::JLTK: case BcOp::JGTK: case BcOp::JLEK: case BcOp::JGEK: case BcOp::JEQK: case BcOp::JNEK:
+                    os << reg(in.a) << ", K" << in.b << (in.flag ? ", 真 @" : ", 假 @") << in.target; break;
+                case BcOp::PARAM: case BcOp::RETURN: case BcOp::PRINT:
+                    os << reg(in.a); break;
+                case BcOp::CALL:
+                    os << reg(in.a) << ", " << nameOf(callSites[in.target]) << ", " << in.b; break;
+                default:
+                    os << reg(in.a) << ", " << reg(in.b) << ", " << reg(in.c); break;
+            }
+            os << '\n';
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "quadruple.h"
+#include "runtime_value.h"
+#include "symbol_table.h"
+
+// 寄存器式字节码: 汇编后端之外的第二个后端，由 VirtualMachine (见 vm.h) 执行。
+// 每个函数 (函数定义之外的顶层代码也算一个) 有自己的一组虚拟寄存器，调用时整组分配在值栈上:
+//   0 .. 参数个数-1   形参，逆序排列 (最后一个形参是 0 号)，与实参从右往左压栈的顺序一致
+//   之后              局部变量和临时变量，按 computeFrameLayouts 算出的栈帧布局的分配顺序;
+//                     其中可能先读后写的 (活跃变量分析得出) 排在最前，调用时只清零这几个
+//   最后三个          暂存寄存器，存放从全局表或常量表取来的操作数
+// 全局变量用 GETGLOBAL/SETGLOBAL 存取，常量用 LOADK 载入；加减乘和比较跳转可以直接以常量为右操作数。
+// 比较之后紧跟条件跳转、且比较结果没有别处使用时，两条合并成一条比较跳转指令。
+
+enum class BcOp : uint8_t {
+    MOVE,                           // R[a] = R[b]
+    LOADK,                          // R[a] = K[b]
+    GETGLOBAL,                      // R[a] = G[b]
+    SETGLOBAL,                      // G[a] = R[b]
+    ADD, SUB, MUL, DIV, MOD,        // R[a] = R[b] op R[c]
+    ADDK, SUBK, MULK,               // R[a] = R[b] op K[c]
+    NEG, NOT,                       // R[a] = op R[b]
+    LT, GT, LE, GE, EQ, NE,         // R[a] = R[b] cmp R[c]
+    AND, OR,                        // R[a] = R[b] op R[c]
+    JMP,                            // 跳到 target
+    JMPF, JMPT,                     // R[a] 为假 / 为真时跳到 target
+    JLT, JGT, JLE, JGE, JEQ, JNE,   // (R[a] cmp R[b]) 等于 flag 时跳到 target
+    JLTK, JGTK, JLEK, JGEK, JEQK, JNEK, // (R[a] cmp K[b]) 等于 flag 时跳到 target
+    PARAM,                          // 压入实参 R[a]
+    CALL,                           // 按调用点 target 调用，b 个实参，返回值写入 R[a] (a 为 BC_NO_REG 时丢弃)
+    RETURN,                         // 返回 R[a]
+    RETURN0,                        // 返回，没有返回值
+    PRINT,                          // 输出 R[a]
+    NEWARRAY,                       // R[a] = 长度为 R[b] 的数组
+    GETINDEX,                       // R[a] = R[b][R[c]]
+    SETINDEX,                       // R[a][R[b]] = R[c]
+    GETFIELD,                       // R[a] = R[b] 的第 c 个成员
+    SETFIELD,                       // R[b] 的第 c 个成员 = R[a]
+    HALT
+};
+
+constexpr uint16_t BC_NO_REG = 0xFFFF;
+
+const char* bcOpName(BcOp op);
+
+// 定长 12 字节的指令
+struct BcInstr {
+    BcOp op = BcOp::HALT;
+    uint8_t flag = 0;         // 比较跳转: 比较结果等于 flag 时跳转
+    uint16_t a = 0, b = 0, c = 0;
+    int32_t target = 0;       // 跳转目标或调用点下标
+};
+
+static_assert(sizeof(BcInstr) == 12, "BcInstr 应保持 12 字节");
+
+struct BcFunction {
+    NameId name = NAME_NONE;   // 顶层代码为 NAME_NONE
+    uint32_t entry = 0;        // 第一条指令的下标
+    uint16_t numParams = 0;
+    uint16_t numCleared = 0;   // 紧跟形参之后、调用时需要清零的寄存器个数
+    uint16_t numRegisters = 0; // 含形参和暂存寄存器
+};
+
+struct BytecodeProgram {
+    std::vector<BcInstr> code;
+    std::vector<BcFunction> functions;                // functions[0] 是顶层代码
+    std::unordered_map<NameId, uint32_t> functionIndex;
+    std::vector<Value> constants;                     // 常量表
+    std::vector<NameId> globals;                      // 全局表每一项对应的变量名
+    std::vector<NameId> callSites;                    // 每个调用点的被调函数名，运行时才解析
+
+    // 反汇编输出
+    void dump(std::ostream& os) const;
+};
+
+// 把 (优化后的) 四元式翻译成字节码
+BytecodeProgram lowerToBytecode(QuadrupleSpan quads, SymbolTable& st);
+
+#endif // BYTECODE_H
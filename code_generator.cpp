@@ -1,14 +1,16 @@
 #include "code_generator.h"
+#include "thread_pool.h"
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
 #include <set>
+#include <optional>
 
 using namespace std;
 
 // 构造函数
-CodeGenerator::CodeGenerator(const std::vector<Quadruple>& quads, SymbolTable& st)
-    : symbolTable(st), quadruples(quads), string_literal_counter(0) {}
+CodeGenerator::CodeGenerator(QuadrupleSpan quads, SymbolTable& st, ThreadPool* threadPool)
+    : symbolTable(st), quadruples(quads), pool(threadPool), string_literal_counter(0) {}
 
 // 主生成函数，协调所有步骤
 string CodeGenerator::generate() {
@@ -27,73 +29,78 @@ string CodeGenerator::generate() {
 // 预处理四元式，为数据段和代码段的生成做准备
 void CodeGenerator::preprocess_data() {
     // 第一遍：收集所有字符串字面量
+    map<NameId, string> literals;
     for (const auto& q : quadruples) {
         // 检查四元式的每个操作数，字符串可能出现在 PRINT, =, + 等多种操作中
-        const string* ops[] = {&q.arg1, &q.arg2, &q.res};
-        for(const auto* op : ops) {
-            if (op && op->length() > 1 && op->front() == '"') {
-                // 如果是字符串字面量且未处理过
-                if (string_literals.find(*op) == string_literals.end()) {
-                    // 生成唯一标签(如LC0, LC1...)
-                    string label = "LC" + to_string(string_literal_counter++);
-                    string_literals[*op] = label;// 存储映射关系
-                }
+        const Operand* ops[] = {&q.arg1, &q.arg2, &q.res};
+        for(const Operand* op : ops) {
+            // 如果是字符串字面量且未处理过
+            if (op->kind == OperandKind::STRING && literals.find(op->name) == literals.end()) {
+                // 生成唯一标签(如LC0, LC1...)
+                string label = "LC" + to_string(string_literal_counter++);
+                literals[op->name] = label;// 存储映射关系
             }
         }
     }
+    string_literals = make_shared<const map<NameId, string>>(std::move(literals));
 
     // 第二遍：为每个函数计算栈帧布局和大小
-    string active_function_name;
-    for (const auto& q_func_start : quadruples) {
-        if (q_func_start.op == "FUNC_BEGIN") {
-            active_function_name = q_func_start.arg1;
-            auto& current_layout = function_frames_layout[active_function_name];
-            int current_local_offset = 0;
-
-            // 扫描函数体内的所有四元式，确定所有局部变量和临时变量
-            bool in_func_body = false;
-            for (const auto& q_inner : quadruples) {
-                if (q_inner.op == "FUNC_BEGIN" && q_inner.arg1 == active_function_name) {
-                    in_func_body = true;
-                }
-                if (!in_func_body) continue;
-                if (q_inner.op == "FUNC_END" && q_inner.arg1 == active_function_name) break;
-
-                // 检查所有操作数
-                const string* operands[] = {&q_inner.arg1, &q_inner.arg2, &q_inner.res};
-                for (const auto* op_ptr : operands) {
-                    const string& op_name = *op_ptr;
-                    // 跳过空操作数、临时变量、数字和字符串字面量
-                    if (op_name.empty() || op_name == "_" || isdigit(op_name[0]) || op_name.front() == '"' || op_name.front() == '\'') continue;
-
-                    // 查找符号
-                    const Symbol* sym = symbolTable.lookup(op_name);
-                    if(sym && sym->scopeLevel == 0) continue; // 全局变量，不在栈上
-
-                    // 检查是否是参数
-                    bool is_param = false;
-                    const Symbol* func_sym = symbolTable.lookup(active_function_name);
-                    if(func_sym) for(const auto& p : func_sym->type->parameters) if(p.name == op_name) is_param = true;
-
-                    // 如果不是参数，并且尚未分配，则在栈上为其分配空间
-                    if (!is_param && current_layout.find(op_name) == current_layout.end()) {
-                        int size_to_alloc = 2; // 默认为 WORD
-                        // 处理数组声明
-                         if ((q_inner.op == "DEC_ARRAY" || q_inner.op == "DEC_DYN_ARRAY") && q_inner.arg1 == op_name) {
-                            try {
-                                size_to_alloc = stoi(q_inner.arg2) * 2; // 静态数组
-                            } catch(...) { size_to_alloc = 2; } // 动态数组本身只存指针
-                         }
-                        current_local_offset += size_to_alloc;
-                        // 记录变量在栈帧中的偏移和大小
-                        current_layout[op_name] = {-current_local_offset, size_to_alloc};
-                    }
-                }
+    frame_layouts = make_shared<const unordered_map<NameId, FrameLayout>>(computeFrameLayouts(quadruples, symbolTable));
+}
+
+// 一遍扫描计算所有函数的栈帧布局
+unordered_map<NameId, FrameLayout> computeFrameLayouts(QuadrupleSpan quads, SymbolTable& st) {
+    unordered_map<NameId, FrameLayout> layouts;
+    NameId active_function_name = NAME_NONE;
+    FrameLayout* current_layout = &layouts[NAME_NONE];
+    const Symbol* func_sym = nullptr;
+
+    for (const auto& q : quads) {
+        if (q.op == Opcode::FUNC_BEGIN) {
+            active_function_name = q.arg1.name;
+            current_layout = &layouts[active_function_name];
+            func_sym = st.lookup(active_function_name);
+            continue;
+        }
+        if (q.op == Opcode::FUNC_END && q.arg1.name == active_function_name) {
+            active_function_name = NAME_NONE;
+            current_layout = &layouts[NAME_NONE];
+            func_sym = nullptr;
+            continue;
+        }
+
+        // 检查所有操作数
+        const Operand* operands[] = {&q.arg1, &q.arg2, &q.res};
+        for (const Operand* operand : operands) {
+            // 只有变量和临时变量需要栈空间，跳过空操作数、标签和各种字面量
+            if (!operand->isVariable()) continue;
+            NameId op_id = operand->name;
+            if (current_layout->slots.count(op_id)) continue;
+
+            // 查找符号
+            const Symbol* sym = st.lookup(op_id);
+            if (sym && sym->scopeLevel == 0) continue; // 全局变量，不在栈上
+
+            // 检查是否是参数
+            bool is_param = false;
+            if (func_sym) for (const auto& p : func_sym->type->parameters) if (p.name == op_id) is_param = true;
+            if (is_param) continue;
+
+            // 在栈上为其分配空间
+            int size_to_alloc = 2; // 默认为 WORD
+            // 处理数组声明
+            if ((q.op == Opcode::DEC_ARRAY || q.op == Opcode::DEC_DYN_ARRAY) && q.arg1.name == op_id) {
+                if (q.arg2.kind == OperandKind::INT) {
+                    size_to_alloc = static_cast<int>(q.arg2.intValue) * 2; // 静态数组
+                } // 否则是动态数组，本身只存指针
             }
-            // 记录函数的总局部变量大小
-            function_local_sizes[active_function_name] = current_local_offset;
+            current_layout->localSize += size_to_alloc;
+            // 记录变量在栈帧中的偏移和大小
+            current_layout->slots[op_id] = {-current_layout->localSize, size_to_alloc};
+            current_layout->order.push_back(op_id);
         }
     }
+    return layouts;
 }
 
 
@@ -109,8 +116,8 @@ void CodeGenerator::generateDataSegment() {
     assembly_code << "    concat_buffer db 256 dup(0)     ; 用于字符串拼接的结果" << endl;
 
     // 处理字符串字面量
-    for (const auto& pair : string_literals) {
-        string sanitized_str = pair.first.substr(1, pair.first.length() - 2);// 去掉引号
+    for (const auto& pair : *string_literals) {
+        const string& sanitized_str = nameOf(pair.first);// 词法分析时已去掉两侧引号
         // 处理转义字符，例如 `\n`
         string final_str;
         for(size_t i = 0; i < sanitized_str.length(); ++i) {
@@ -129,14 +136,18 @@ void CodeGenerator::generateDataSegment() {
         assembly_code << "    " << pair.second << " db \"" << final_str << "\", 0" << endl;
     }
 
-    // 为全局变量分配空间
-    const auto& symbols = symbolTable.getAllSymbols();
-    for (const auto& pair : symbols) {
+    // 为全局变量分配空间，按名字 id (即首次出现的顺序) 输出
+    vector<NameId> global_names;
+    for (const auto& pair : symbolTable.getAllSymbols()) {
         const auto& sym = pair.second;
         if (sym.category == SymbolCategory::Variable && sym.scopeLevel == 0) {
-             assembly_code << "    " << sym.name << " dw ?" << endl;// 定义未初始化的字(word)
+            global_names.push_back(sym.name);
         }
     }
+    sort(global_names.begin(), global_names.end());
+    for (NameId name : global_names) {
+        assembly_code << "    " << nameOf(name) << " dw ?" << endl;// 定义未初始化的字(word)
+    }
 }
 
 // 生成 .CODE 代码段
@@ -154,24 +165,73 @@ void CodeGenerator::generateCodeSegment() {
     emit("int 21h");
     assembly_code << "main ENDP" << endl;
 
-    // 为每个四元式生成代码
-    for (const auto& quad : quadruples) {
-        generateForQuad(quad);
+    // 为每个四元式生成代码。四元式按函数定义切成若干段，每个函数是一个任务，顶层代码的各段合成一个任务
+    // (它们共用全局的标签编号)。有线程池时各任务并行，每段用一个共享只读数据的生成器写进自己的缓冲，
+    // 函数里生成的标签按函数编号 (见 SymbolTable::FunctionNames)，最后按原顺序拼接，结果与线程调度无关
+    struct Piece {
+        size_t begin, end;
+        NameId function; // 顶层代码为 NAME_NONE
+        string text;
+    };
+    vector<Piece> pieces;
+    for (size_t i = 0; i < quadruples.size();) {
+        size_t end = i;
+        NameId function = NAME_NONE;
+        if (quadruples[i].op == Opcode::FUNC_BEGIN) {
+            function = quadruples[i].arg1.name;
+            while (end < quadruples.size() &&
+                   !(quadruples[end].op == Opcode::FUNC_END && quadruples[end].arg1.name == function)) ++end;
+            end = min(end + 1, quadruples.size());
+        } else {
+            while (end < quadruples.size() && quadruples[end].op != Opcode::FUNC_BEGIN) ++end;
+        }
+        pieces.push_back({i, end, function, ""});
+        i = end;
     }
+    vector<vector<size_t>> tasks(1); // 第 0 个任务是全部顶层代码
+    for (size_t k = 0; k < pieces.size(); ++k) {
+        if (pieces[k].function == NAME_NONE) tasks[0].push_back(k);
+        else tasks.push_back({k});
+    }
+    auto generate_task = [&](size_t t) {
+        for (size_t k : tasks[t]) {
+            Piece& piece = pieces[k];
+            optional<SymbolTable::FunctionNames> names;
+            if (piece.function != NAME_NONE) names.emplace(symbolTable, piece.function);
+            CodeGenerator part(quadruples, symbolTable);
+            part.frame_layouts = frame_layouts;
+            part.string_literals = string_literals;
+            for (size_t i = piece.begin; i < piece.end; ++i) part.generateForQuad(quadruples[i]);
+            piece.text = part.assembly_code.str();
+        }
+    };
+    if (pool && tasks.size() > 1) {
+        pool->parallelFor(tasks.size(), generate_task);
+    } else {
+        for (size_t t = 0; t < tasks.size(); ++t) generate_task(t);
+    }
+    for (const auto& piece : pieces) assembly_code << piece.text;
 
     assembly_code << "\nEND main" << endl;// 程序结束
 }
 
 
 //获取操作数的类型信息
-shared_ptr<TypeInfo> CodeGenerator::getOperandType(const string& operand) {
-    if (operand.empty() || operand == "_") return symbolTable.lookupType("void");
-    if (isdigit(operand[0]) || (operand.length() > 1 && operand[0] == '-')) return symbolTable.lookupType("int");
-    if (operand == "true" || operand == "false") return symbolTable.lookupType("bool");
-    if (operand.front() == '"') return symbolTable.lookupType("string");
+shared_ptr<TypeInfo> CodeGenerator::getOperandType(const Operand& operand) {
+    switch (operand.kind) {
+        case OperandKind::NONE:   return symbolTable.lookupType("void");
+        case OperandKind::INT:    return symbolTable.lookupType("int");
+        case OperandKind::FLOAT:  return symbolTable.lookupType("float");
+        case OperandKind::BOOL:   return symbolTable.lookupType("bool");
+        case OperandKind::STRING: return symbolTable.lookupType("string");
+        case OperandKind::CHAR:   return symbolTable.lookupType("char");
+        case OperandKind::LABEL:  return nullptr;
+        case OperandKind::TEMP:
+        case OperandKind::SYMBOL: break;
+    }
 
     // 查找符号表中的类型
-    const Symbol* sym = symbolTable.lookup(operand);
+    const Symbol* sym = symbolTable.lookup(operand.name);
     if (sym) return sym->type;
 
     return nullptr; // 未知类型
@@ -183,11 +243,13 @@ void CodeGenerator::generateForQuad(const Quadruple& q) {
     assembly_code << "\n    ; " << q.toString() << endl;
 
     // 根据操作类型分发处理
-    if (q.op == "=") {
+    switch (q.op) {
+    case Opcode::ASSIGN:
         // 赋值操作
         emit("mov ax, " + getOperandAddress(q.arg1));
         emit("mov " + getOperandAddress(q.res) + ", ax");
-    } else if (q.op == "+") {
+        break;
+    case Opcode::ADD: {
         // 进行类型派发，判断是整数加法还是字符串拼接
         auto type1 = getOperandType(q.arg1);
         auto type2 = getOperandType(q.arg2);
@@ -200,25 +262,34 @@ void CodeGenerator::generateForQuad(const Quadruple& q) {
             emit("add ax, " + getOperandAddress(q.arg2));
             emit("mov " + getOperandAddress(q.res) + ", ax");
         }
-    } else if (q.op == "-") {
+        break;
+    }
+    case Opcode::SUB:
         emit("mov ax, " + getOperandAddress(q.arg1));
         emit("sub ax, " + getOperandAddress(q.arg2));
         emit("mov " + getOperandAddress(q.res) + ", ax");
-    }
-    else if (q.op == "*") {
+        break;
+    case Opcode::NEG:
+        emit("mov ax, " + getOperandAddress(q.arg1));
+        emit("neg ax");
+        emit("mov " + getOperandAddress(q.res) + ", ax");
+        break;
+    case Opcode::MUL:
         emit("mov ax, " + getOperandAddress(q.arg1));
         emit("mov bx, " + getOperandAddress(q.arg2));
         emit("imul bx");
         emit("mov " + getOperandAddress(q.res) + ", ax");
-    } else if (q.op == "/") {
+        break;
+    case Opcode::DIV:
         emit("mov ax, " + getOperandAddress(q.arg1));
         emit("cwd", "将AX的符号扩展到DX");
         emit("mov bx, " + getOperandAddress(q.arg2));
         emit("idiv bx");
         emit("mov " + getOperandAddress(q.res) + ", ax");
-    } else if (q.op == "&&") {
-        string false_label = symbolTable.generateLabel();
-        string end_label = symbolTable.generateLabel();
+        break;
+    case Opcode::AND: {
+        const string& false_label = nameOf(symbolTable.generateLabel());
+        const string& end_label = nameOf(symbolTable.generateLabel());
         emit("mov ax, " + getOperandAddress(q.arg1));
         emit("cmp ax, 0");
         emit("je " + false_label);
@@ -230,45 +301,52 @@ void CodeGenerator::generateForQuad(const Quadruple& q) {
         assembly_code << false_label << ":" << endl;
         emit("mov " + getOperandAddress(q.res) + ", 0");
         assembly_code << end_label << ":" << endl;
-    } else if (q.op == "<" || q.op == ">" || q.op == "==" || q.op == "!=" || q.op == ">=" || q.op == "<=") {
+        break;
+    }
+    case Opcode::LT: case Opcode::GT: case Opcode::EQ:
+    case Opcode::NE: case Opcode::GE: case Opcode::LE:
         handleComparison(q);
-    } else if (q.op == "LABEL") {
-        assembly_code << q.arg1 << ":" << endl;
-    } else if (q.op == "JUMP") {
-        emit("jmp " + q.res);
-    } else if (q.op == "JUMPF") {
+        break;
+    case Opcode::LABEL:
+        assembly_code << q.arg1.str() << ":" << endl;
+        break;
+    case Opcode::JUMP:
+        emit("jmp " + q.res.str());
+        break;
+    case Opcode::JUMPF:
         emit("mov ax, " + getOperandAddress(q.arg1));
         emit("cmp ax, 0");
-        emit("je " + q.res);
-    }
-    else if (q.op == "FUNC_BEGIN") handleFunctionBegin(q);
-    else if (q.op == "FUNC_END")   handleFunctionEnd(q);
-    else if (q.op == "PARAM")      handleParam(q);
-    else if (q.op == "CALL")       handleCall(q);
-    else if (q.op == "RETURN")     handleReturn(q);
-    else if (q.op == "PRINT")      handlePrint(q);
-    else if (q.op == "DEC_ARRAY" || q.op == "DEC_DYN_ARRAY")  handleArrayDeclaration(q);
-    else if (q.op == "STORE_AT")   handleStoreAt(q);
-    else if (q.op == "LOAD_AT")    handleLoadAt(q);
-    else if (q.op == "GET_PARAM")  handleGetParam(q);
-    else if (q.op == "LOAD_MEMBER") {
+        emit("je " + q.res.str());
+        break;
+    case Opcode::FUNC_BEGIN:    handleFunctionBegin(q); break;
+    case Opcode::FUNC_END:      handleFunctionEnd(q); break;
+    case Opcode::PARAM:         handleParam(q); break;
+    case Opcode::CALL:          handleCall(q); break;
+    case Opcode::RETURN:        handleReturn(q); break;
+    case Opcode::PRINT:         handlePrint(q); break;
+    case Opcode::DEC_ARRAY:
+    case Opcode::DEC_DYN_ARRAY: handleArrayDeclaration(q); break;
+    case Opcode::STORE_AT:      handleStoreAt(q); break;
+    case Opcode::LOAD_AT:       handleLoadAt(q); break;
+    case Opcode::GET_PARAM:     handleGetParam(q); break;
+    case Opcode::LOAD_MEMBER:
         // 四元式: (LOAD_MEMBER, dest, base, offset)
         // dest = q.arg1, base = q.arg2, offset = q.res
         emit("lea si, " + getOperandAddress(q.arg2), "获取结构体基地址到 SI");
-        emit("add si, " + q.res, "加上成员偏移量");
+        emit("add si, " + getOperandAddress(q.res), "加上成员偏移量");
         emit("mov ax, [si]", "从计算出的地址加载成员的值到 AX");
         emit("mov " + getOperandAddress(q.arg1) + ", ax", "将值存入目标变量");
-    }
-    else if (q.op == "STORE_MEMBER") {
+        break;
+    case Opcode::STORE_MEMBER:
         // 四元式: (STORE_MEMBER, src, base, offset)
         // src = q.arg1, base = q.arg2, offset = q.res
         emit("lea si, " + getOperandAddress(q.arg2), "获取结构体基地址到 SI");
-        emit("add si, " + q.res, "加上成员偏移量");
+        emit("add si, " + getOperandAddress(q.res), "加上成员偏移量");
         emit("mov ax, " + getOperandAddress(q.arg1), "获取要存储的源值到 AX");
         emit("mov [si], ax", "将值存入计算出的内存地址");
-    }
-    else {
-        assembly_code << "    ; 未处理的操作: " << q.op << endl;
+        break;
+    default:
+        assembly_code << "    ; 未处理的操作: " << opcodeName(q.op) << endl;
     }
 }
 
@@ -326,17 +404,24 @@ void CodeGenerator::handleStringConcat(const Quadruple& q) {
 }
 
 // 获取操作数的有效地址字符串
-string CodeGenerator::getOperandAddress(const std::string& operand) {
+string CodeGenerator::getOperandAddress(const Operand& operand) {
     // 处理特殊操作数
-    if (operand.empty() || operand == "_") return "";
-    if (isdigit(operand[0]) || (operand.length() > 1 && operand[0] == '-')) return operand;// 立即数
-    if (operand == "true") return "1";
-    if (operand == "false") return "0";
-    if (string_literals.count(operand)) return "OFFSET " + string_literals.at(operand);// 字符串字面量地址
+    switch (operand.kind) {
+        case OperandKind::NONE:   return "";
+        case OperandKind::INT:
+        case OperandKind::FLOAT:  return operand.str(); // 立即数
+        case OperandKind::BOOL:
+        case OperandKind::CHAR:   return to_string(operand.intValue); // true/false 为 1/0，字符为其编码
+        case OperandKind::STRING: return "OFFSET " + string_literals->at(operand.name); // 字符串字面量地址
+        case OperandKind::LABEL:  return operand.str();
+        case OperandKind::TEMP:
+        case OperandKind::SYMBOL: break;
+    }
+    NameId operand_id = operand.name;
 
     // 局部变量或临时变量
-    if (!current_function.empty() && function_frames_layout.count(current_function) && function_frames_layout.at(current_function).count(operand)) {
-        return "WORD PTR [bp" + to_string(function_frames_layout.at(current_function).at(operand).offset) + "]";
+    if (current_function != NAME_NONE && frame_layouts->count(current_function) && frame_layouts->at(current_function).slots.count(operand_id)) {
+        return "WORD PTR [bp" + to_string(frame_layouts->at(current_function).slots.at(operand_id).offset) + "]";
     }
 
     // 函数参数
@@ -345,19 +430,19 @@ string CodeGenerator::getOperandAddress(const std::string& operand) {
         int param_offset = 4; // BP(2) + RET(2)
         // 反向查找参数
         for (int i = func_sym->type->parameters.size() - 1; i >= 0; --i) {
-            if (func_sym->type->parameters[i].name == operand) {
+            if (func_sym->type->parameters[i].name == operand_id) {
                 return "WORD PTR [bp + " + to_string(param_offset) + "]";
             }
             param_offset += 2; // WORD size每个参数占2字节
         }
     }
-    return "WORD PTR " + operand; // 全局变量
+    return "WORD PTR " + operand.str(); // 全局变量
 }
 
 // 处理函数开始
 void CodeGenerator::handleFunctionBegin(const Quadruple& q) {
-    current_function = q.arg1;
-    string proc_name = (q.arg1 == "main") ? "anchor_main" : q.arg1;
+    current_function = q.arg1.name;
+    string proc_name = (q.arg1.str() == "main") ? "anchor_main" : q.arg1.str();
     assembly_code << "\n" << proc_name << " PROC" << endl;
 
     // 标准函数序言
@@ -365,8 +450,8 @@ void CodeGenerator::handleFunctionBegin(const Quadruple& q) {
     emit("mov bp, sp", "设置新的基址指针");
 
     // 为局部变量分配栈空间
-    if (function_local_sizes.count(current_function)) {
-        int total_local_size = function_local_sizes.at(current_function);
+    if (frame_layouts->count(current_function)) {
+        int total_local_size = frame_layouts->at(current_function).localSize;
         if (total_local_size > 0) {
             emit("sub sp, " + to_string(total_local_size), "为局部变量分配栈空间");
         }
@@ -375,18 +460,18 @@ void CodeGenerator::handleFunctionBegin(const Quadruple& q) {
 
 // 处理函数结束
 void CodeGenerator::handleFunctionEnd(const Quadruple& q) {
-    string proc_name = (q.arg1 == "main") ? "anchor_main" : q.arg1;
+    string proc_name = (q.arg1.str() == "main") ? "anchor_main" : q.arg1.str();
     // 标准函数尾声
     emit("mov sp, bp", "释放局部变量空间");
     emit("pop bp", "恢复旧的基址指针");
     emit("ret", "返回");
     assembly_code << proc_name << " ENDP" << endl;
-    current_function = "";
+    current_function = NAME_NONE;
 }
 
 // 处理返回语句
 void CodeGenerator::handleReturn(const Quadruple& q) {
-    if (q.arg1 != "_") {
+    if (!q.arg1.isNone()) {
         emit("mov ax, " + getOperandAddress(q.arg1), "将返回值放入ax");
     }
     emit("mov sp, bp");
@@ -401,22 +486,19 @@ void CodeGenerator::handleParam(const Quadruple& q) {
 
 // 处理函数调用
 void CodeGenerator::handleCall(const Quadruple& q) {
-    string proc_name = (q.arg1 == "main") ? "anchor_main" : q.arg1;
+    string proc_name = (q.arg1.str() == "main") ? "anchor_main" : q.arg1.str();
     emit("call " + proc_name);
-    if (!q.arg2.empty() && q.arg2 != "0") {
-        int arg_count = stoi(q.arg2);
-        if (arg_count > 0) {
-            emit("add sp, " + to_string(arg_count * 2), "调用者清理参数占用的栈空间");
-        }
+    if (q.arg2.kind == OperandKind::INT && q.arg2.intValue > 0) {
+        emit("add sp, " + to_string(q.arg2.intValue * 2), "调用者清理参数占用的栈空间");
     }
-    if (q.res != "_") {
+    if (!q.res.isNone()) {
         emit("mov " + getOperandAddress(q.res) + ", ax", "保存返回值");
     }
 }
 
 // 处理打印语句
 void CodeGenerator::handlePrint(const Quadruple& q) {
-    string operand = q.arg1;
+    const Operand& operand = q.arg1;
     auto type = getOperandType(operand);
 
     if (type && (type->name == "string" || type->name == "string[]" || (type->kind == TypeKind::ARRAY && type->elementType->name == "string"))) {
@@ -433,16 +515,18 @@ void CodeGenerator::handlePrint(const Quadruple& q) {
 // 处理比较操作
 void CodeGenerator::handleComparison(const Quadruple& q) {
     string jump_instruction;
-    if (q.op == "<") jump_instruction = "jl";
-    else if (q.op == ">") jump_instruction = "jg";
-    else if (q.op == "==") jump_instruction = "je";
-    else if (q.op == "!=") jump_instruction = "jne";
-    else if (q.op == ">=") jump_instruction = "jge";
-    else if (q.op == "<=") jump_instruction = "jle";
-    else return;
+    switch (q.op) {
+        case Opcode::LT: jump_instruction = "jl"; break;
+        case Opcode::GT: jump_instruction = "jg"; break;
+        case Opcode::EQ: jump_instruction = "je"; break;
+        case Opcode::NE: jump_instruction = "jne"; break;
+        case Opcode::GE: jump_instruction = "jge"; break;
+        case Opcode::LE: jump_instruction = "jle"; break;
+        default: return;
+    }
 
-    string true_label = symbolTable.generateLabel();
-    string end_label = symbolTable.generateLabel();
+    const string& true_label = nameOf(symbolTable.generateLabel());
+    const string& end_label = nameOf(symbolTable.generateLabel());
 
     emit("mov ax, " + getOperandAddress(q.arg1));
     emit("cmp ax, " + getOperandAddress(q.arg2));
@@ -465,7 +549,7 @@ void CodeGenerator::handleStoreAt(const Quadruple& q) {
     emit("shl bx, 1", "index *= 2 (因为是WORD类型)");
 
     // 获取基地址到 si
-    const Symbol* base_sym = symbolTable.lookup(q.res);
+    const Symbol* base_sym = symbolTable.lookup(q.res.name);
     if (base_sym && base_sym->type->kind == TypeKind::ARRAY && base_sym->scopeLevel > 0) {
         emit("lea si, " + getOperandAddress(q.res), "获取局部数组基地址");
     } else {
@@ -484,7 +568,7 @@ void CodeGenerator::handleLoadAt(const Quadruple& q) {
     emit("mov bx, " + getOperandAddress(q.res), "将 index 放入 bx");
     emit("shl bx, 1", "index *= 2");
 
-    const Symbol* base_sym = symbolTable.lookup(q.arg2);
+    const Symbol* base_sym = symbolTable.lookup(q.arg2.name);
     // 修正：更准确地判断是取地址还是取值
     if (base_sym && base_sym->type->kind == TypeKind::ARRAY && base_sym->scopeLevel > 0) {
         emit("lea si, " + getOperandAddress(q.arg2), "获取局部数组基地址");
@@ -6,31 +6,47 @@
 #include <sstream>
 #include <unordered_map>
 #include <map>
+#include <memory>
 
 #include "quadruple.h"
 #include "symbol_table.h"
 
+class ThreadPool;
+
 // 描述栈上一个变量或参数的位置
 struct StackLocation {
     int offset; // 相对于 BP 的偏移量
     int size;   // 变量大小 (例如 dw 是 2)
 };
 
+// 一个函数的栈帧布局: 局部变量和临时变量按首次出现的顺序依次分配在 BP 之下。
+// 参数 (在 BP 之上，按参数序号寻址) 和全局变量不在其中
+struct FrameLayout {
+    std::unordered_map<NameId, StackLocation> slots;
+    std::vector<NameId> order; // 分配的先后顺序
+    int localSize = 0;         // 局部变量的总大小
+};
+
+// 按函数名计算每个函数的栈帧布局，函数定义之外的顶层代码记在 NAME_NONE 下。
+// 汇编后端和字节码后端 (见 bytecode.h) 共用这份布局
+std::unordered_map<NameId, FrameLayout> computeFrameLayouts(QuadrupleSpan quads, SymbolTable& st);
+
 class CodeGenerator {
 private:
-    const std::vector<Quadruple>& quadruples;
+    QuadrupleSpan quadruples;
     SymbolTable& symbolTable;
     std::stringstream assembly_code;
 
+    ThreadPool* pool = nullptr; // 为空时各函数依次生成
+
     // 状态管理
-    std::string current_function; // 当前正在生成的函数名
-    // 存储每个函数内所有局部变量和临时的位置映射
-    std::map<std::string, std::unordered_map<std::string, StackLocation>> function_frames_layout;
-    // 专门用于存储每个函数预计算好的局部变量总大小
-    std::map<std::string, int> function_local_sizes;
-
-    // 用于处理字符串字面量
-    std::map<std::string, std::string> string_literals;
+    NameId current_function = NAME_NONE; // 当前正在生成的函数名
+    // 以下两项由 preprocess_data 算好后只读，并行生成时各段的生成器共用同一份
+    // 每个函数内所有局部变量和临时变量的位置以及局部变量总大小
+    std::shared_ptr<const std::unordered_map<NameId, FrameLayout>> frame_layouts;
+
+    // 用于处理字符串字面量: 字面量 id -> 数据段标签，按出现顺序编号
+    std::shared_ptr<const std::map<NameId, std::string>> string_literals;
     int string_literal_counter = 0;
 
     // 代码生成阶段
@@ -40,8 +56,8 @@ private:
 
     // 指令生成辅助函数
     void generateForQuad(const Quadruple& q);                      // 为单个四元式生成代码
-    std::string getOperandAddress(const std::string& operand);     // 获取操作数的有效地址字符串
-    std::shared_ptr<TypeInfo> getOperandType(const std::string& operand); // 获取操作数的类型信息
+    std::string getOperandAddress(const Operand& operand);            // 获取操作数的有效地址字符串
+    std::shared_ptr<TypeInfo> getOperandType(const Operand& operand); // 获取操作数的类型信息
     void emit(const std::string& instruction, const std::string& comment = ""); // 发射单条汇编指令
 
     // 具体指令的处理函数
@@ -64,7 +80,8 @@ private:
 
 
 public:
-    CodeGenerator(const std::vector<Quadruple>& quads, SymbolTable& st);
+    // 给出线程池时，各函数的代码在池里并行生成
+    CodeGenerator(QuadrupleSpan quads, SymbolTable& st, ThreadPool* pool = nullptr);
     std::string generate(); // 生成汇编代码的公共接口
 };
 
@@ -0,0 +1,524 @@
+#include "flat_ast.h"
+#include "parser.h"
+#include <iostream>
+
+using namespace std;
+
+// --- 指针 AST -> FlatAST ---
+
+// 先序遍历指针 AST: 先放父节点并为它预留子节点槽位，再依次递归填入子节点下标，
+// 这样同一个节点的子节点下标在 childIds 中是连续的，生成 IR 时按下标顺序访问
+class FlatASTBuilder {
+public:
+    FlatAST build(const ProgramNode* program) {
+        emit(program);
+        return std::move(flat);
+    }
+
+private:
+    FlatAST flat;
+
+    NodeId addNode(const ASTNode* node, string_view text) {
+        FlatNode n{};
+        n.kind = static_cast<uint8_t>(node->nodeType);
+        n.line = node->lineNumber;
+        n.textOffset = static_cast<uint32_t>(flat.textPool.size());
+        n.textLength = static_cast<uint32_t>(text.size());
+        flat.textPool.append(text.data(), text.size());
+        flat.nodes.push_back(n);
+        return static_cast<NodeId>(flat.nodes.size() - 1);
+    }
+
+    // 固定子节点 fixed[0..fixedCount) 之后再接一个可变长列表 list
+    template <typename List>
+    void emitChildren(NodeId id, const ASTNode* const* fixed, uint32_t fixedCount, const List* list) {
+        uint32_t count = fixedCount + (list ? static_cast<uint32_t>(list->size()) : 0);
+        uint32_t first = static_cast<uint32_t>(flat.childIds.size());
+        flat.nodes[id].firstChild = first;
+        flat.nodes[id].childCount = count;
+        flat.childIds.resize(first + count, NO_NODE);
+        uint32_t slot = first;
+        for (uint32_t i = 0; i < fixedCount; ++i) {
+            NodeId c = emit(fixed[i]); // 递归会扩展 childIds，所以按下标回填
+            flat.childIds[slot++] = c;
+        }
+        if (list) {
+            for (const auto* elem : *list) {
+                NodeId c = emit(elem);
+                flat.childIds[slot++] = c;
+            }
+        }
+    }
+
+    void emitFixed(NodeId id, std::initializer_list<const ASTNode*> fixed) {
+        emitChildren<ArenaList<ASTNode*>>(id, fixed.begin(), static_cast<uint32_t>(fixed.size()), nullptr);
+    }
+
+    NodeId emit(const ASTNode* node) {
+        if (!node) return NO_NODE;
+        switch (node->nodeType) {
+            case NodeKind::Program: {
+                auto n = static_cast<const ProgramNode*>(node);
+                NodeId id = addNode(n, {});
+                emitFixed(id, {n->statementList});
+                return id;
+            }
+            case NodeKind::StatementList: {
+                auto n = static_cast<const StatementListNode*>(node);
+                NodeId id = addNode(n, {});
+                emitChildren(id, nullptr, 0, &n->statements);
+                return id;
+            }
+            case NodeKind::InitializerList: {
+                auto n = static_cast<const InitializerListNode*>(node);
+                NodeId id = addNode(n, {});
+                emitChildren(id, nullptr, 0, &n->elements);
+                return id;
+            }
+            case NodeKind::Type: {
+                auto n = static_cast<const TypeNode*>(node);
+                NodeId id = addNode(n, n->typeName);
+                emitFixed(id, {});
+                return id;
+            }
+            case NodeKind::ArrayType: {
+                auto n = static_cast<const ArrayTypeNode*>(node);
+                NodeId id = addNode(n, {});
+                emitFixed(id, {n->elementType, n->sizeExpression});
+                return id;
+            }
+            case NodeKind::DeclarationStatement: {
+                auto n = static_cast<const DeclarationStatementNode*>(node);
+                NodeId id = addNode(n, n->identifierName);
+                emitFixed(id, {n->typeSpecifier, n->initialValue});
+                return id;
+            }
+            case NodeKind::ArrayAccessExpression: {
+                auto n = static_cast<const ArrayAccessNode*>(node);
+                NodeId id = addNode(n, {});
+                emitFixed(id, {n->arrayExpr, n->indexExpr});
+                return id;
+            }
+            case NodeKind::StructiDefinitionStatement: {
+                auto n = static_cast<const StructiDefinitionNode*>(node);
+                NodeId id = addNode(n, n->structiName);
+                emitFixed(id, {n->memberDeclarations});
+                return id;
+            }
+            case NodeKind::MemberAccessExpression: {
+                auto n = static_cast<const MemberAccessNode*>(node);
+                NodeId id = addNode(n, n->memberName);
+                emitFixed(id, {n->structExpr});
+                return id;
+            }
+            case NodeKind::AssignmentStatement: {
+                auto n = static_cast<const AssignmentStatementNode*>(node);
+                NodeId id = addNode(n, n->op);
+                emitFixed(id, {n->leftHandSide, n->expression});
+                return id;
+            }
+            case NodeKind::IfStatement: {
+                auto n = static_cast<const IfStatementNode*>(node);
+                NodeId id = addNode(n, {});
+                emitFixed(id, {n->condition, n->thenBlock, n->elseBlock});
+                return id;
+            }
+            case NodeKind::WhileStatement: {
+                auto n = static_cast<const WhileStatementNode*>(node);
+                NodeId id = addNode(n, {});
+                emitFixed(id, {n->condition, n->loopBlock});
+                return id;
+            }
+            case NodeKind::ForStatement: {
+                auto n = static_cast<const ForStatementNode*>(node);
+                NodeId id = addNode(n, {});
+                emitFixed(id, {n->initialization, n->condition, n->increment, n->body});
+                return id;
+            }
+            case NodeKind::PrintStatement: {
+                auto n = static_cast<const PrintStatementNode*>(node);
+                NodeId id = addNode(n, {});
+                emitFixed(id, {n->expression});
+                return id;
+            }
+            case NodeKind::BinaryExpression: {
+                auto n = static_cast<const BinaryExpressionNode*>(node);
+                NodeId id = addNode(n, n->op);
+                emitFixed(id, {n->left, n->right});
+                return id;
+            }
+            case NodeKind::UnaryExpression: {
+                auto n = static_cast<const UnaryExpressionNode*>(node);
+                NodeId id = addNode(n, n->op);
+                emitFixed(id, {n->operand});
+                return id;
+            }
+            case NodeKind::Literal: {
+                auto n = static_cast<const LiteralNode*>(node);
+                NodeId id = addNode(n, n->value);
+                flat.nodes[id].literalType = static_cast<uint8_t>(n->literalType);
+                emitFixed(id, {});
+                return id;
+            }
+            case NodeKind::Identifier: {
+                auto n = static_cast<const IdentifierNode*>(node);
+                NodeId id = addNode(n, n->name);
+                emitFixed(id, {});
+                return id;
+            }
+            case NodeKind::FunctionDefinition: {
+                auto n = static_cast<const FunctionDefinitionNode*>(node);
+                NodeId id = addNode(n, n->functionName);
+                emitFixed(id, {n->returnType, n->parameters, n->body});
+                return id;
+            }
+            case NodeKind::FunctionCall: {
+                auto n = static_cast<const FunctionCallNode*>(node);
+                NodeId id = addNode(n, {});
+                const ASTNode* fixed[] = {n->functionExpr};
+                emitChildren(id, fixed, 1, &n->arguments);
+                return id;
+            }
+            case NodeKind::ReturnStatement: {
+                auto n = static_cast<const ReturnStatementNode*>(node);
+                NodeId id = addNode(n, {});
+                emitFixed(id, {n->returnValue});
+                return id;
+            }
+            case NodeKind::SwitchStatement: {
+                auto n = static_cast<const SwitchStatementNode*>(node);
+                NodeId id = addNode(n, {});
+                const ASTNode* fixed[] = {n->expression};
+                emitChildren(id, fixed, 1, &n->cases);
+                return id;
+            }
+            case NodeKind::CaseStatement: {
+                auto n = static_cast<const CaseStatementNode*>(node);
+                NodeId id = addNode(n, {});
+                emitFixed(id, {n->value, n->body});
+                return id;
+            }
+            case NodeKind::BreakStatement:
+            case NodeKind::ContinueStatement: {
+                NodeId id = addNode(node, {});
+                emitFixed(id, {});
+                return id;
+            }
+        }
+        NodeId id = addNode(node, {});
+        emitFixed(id, {});
+        return id;
+    }
+};
+
+FlatAST flattenAST(const ProgramNode* program) {
+    return FlatASTBuilder().build(program);
+}
+
+
+// --- 打印 ---
+
+// 辅助：打印指定数量的indent缩进空格（为了ast生成更加美观……好吧其实没有什么大用，但是写了就不想删了🤣）
+static void printIndent(int indent) {
+    for (int i = 0; i < indent; ++i) {
+        cout << "  ";
+    }
+}
+
+//下面是众多print实现：基本都是三个模式：1. 打印自身信息 2. 递归子节点 3. 处理空节点，如果空就跳过，避免崩溃
+class FlatASTPrinter : public FlatASTVisitor<FlatASTPrinter, void, int> {
+public:
+    using FlatASTVisitor::FlatASTVisitor;
+
+    void print(NodeId id, int indent) {
+        if (id != NO_NODE) visit(id, indent);
+    }
+
+    // 没有专门打印格式的节点
+    void visitNode(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "ASTNode (节点类型: " << static_cast<int>(ast.kind(id)) << ", 行号: " << ast.line(id) << ")" << endl;
+    }
+
+    void visitInitializerList(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "InitializerListNode (初始化列表, 行号: " << ast.line(id) << ", 元素数量: " << ast.childCount(id) << ")" << endl;
+        for (NodeId elem : ast.children(id)) {
+            print(elem, indent + 1);
+        }
+    }
+
+    //打印根结点
+    void visitProgram(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "ProgramNode (程序根节点, 行号: " << ast.line(id) << ")" << endl;
+        print(ast.child(id, PROGRAM_BODY), indent + 1);
+    }
+
+    void visitStatementList(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "StatementListNode (语句列表, 行号: " << ast.line(id) << ", 语句数量: " << ast.childCount(id) << ")" << endl;
+        for (NodeId stmt : ast.children(id)) {
+            print(stmt, indent + 1);
+        }
+    }
+
+    void visitDeclarationStatement(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "DeclarationStatementNode (声明语句, 标识符: " << ast.text(id) << ", 行号: " << ast.line(id) << ")" << endl;
+
+        printIndent(indent + 1);
+        cout << "类型说明符: " << endl;
+        print(ast.child(id, DECL_TYPE), indent + 2);
+
+        if (ast.child(id, DECL_INIT) != NO_NODE) {
+            printIndent(indent + 1);
+            cout << "初始化值: " << endl;
+            print(ast.child(id, DECL_INIT), indent + 2);
+        }
+    }
+
+    void visitAssignmentStatement(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "AssignmentStatementNode (赋值语句, 运算符: " << ast.text(id) << ", 行号: " << ast.line(id) << ")" << endl;
+
+        printIndent(indent + 1);
+        cout << "左值 (LHS): " << endl;
+        print(ast.child(id, ASSIGN_LHS), indent + 2);
+
+        printIndent(indent + 1);
+        cout << "赋值表达式 (RHS): " << endl;
+        print(ast.child(id, ASSIGN_RHS), indent + 2);
+    }
+
+    void visitIfStatement(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "IfStatementNode (If语句, 行号: " << ast.line(id) << ")" << endl;
+        printIndent(indent + 1); cout << "条件: " << endl;
+        print(ast.child(id, IF_COND), indent + 2);
+        printIndent(indent + 1); cout << "Then语句块: " << endl;
+        print(ast.child(id, IF_THEN), indent + 2);
+        if (ast.child(id, IF_ELSE) != NO_NODE) {
+            printIndent(indent + 1); cout << "Else语句块: " << endl;
+            print(ast.child(id, IF_ELSE), indent + 2);
+        }
+    }
+
+    void visitWhileStatement(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "WhileStatementNode (While语句, 行号: " << ast.line(id) << ")" << endl;
+        printIndent(indent + 1); cout << "循环条件: " << endl;
+        print(ast.child(id, WHILE_COND), indent + 2);
+        printIndent(indent + 1); cout << "循环体: " << endl;
+        print(ast.child(id, WHILE_BODY), indent + 2);
+    }
+
+    void visitForStatement(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "ForStatementNode (For语句, 行号: " << ast.line(id) << ")" << endl;
+        printIndent(indent + 1); cout << "初始化部分: " << endl;
+        printOrPlaceholder(ast.child(id, FOR_INIT), indent + 2, "<空>");
+        printIndent(indent + 1); cout << "条件部分: " << endl;
+        printOrPlaceholder(ast.child(id, FOR_COND), indent + 2, "<空 (默认为true)>");
+        printIndent(indent + 1); cout << "迭代表达式部分: " << endl;
+        printOrPlaceholder(ast.child(id, FOR_INCR), indent + 2, "<空>");
+        printIndent(indent + 1); cout << "循环体: " << endl;
+        print(ast.child(id, FOR_BODY), indent + 2);
+    }
+
+    void visitPrintStatement(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "PrintStatementNode (Print语句, 行号: " << ast.line(id) << ")" << endl;
+        printIndent(indent + 1); cout << "打印表达式: " << endl;
+        print(ast.child(id, PRINT_EXPR), indent + 2);
+    }
+
+    void visitType(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "TypeNode (类型节点): " << ast.text(id) << " (行号: " << ast.line(id) << ")" << endl;
+    }
+
+    void visitStructiDefinitionStatement(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "StructiDefinitionNode (Structi 定义, 名称: " << ast.text(id) << ", 行号: " << ast.line(id) << ")" << endl;
+
+        printIndent(indent + 1);
+        cout << "成员列表: " << endl;
+        print(ast.child(id, STRUCTI_MEMBERS), indent + 2);
+    }
+
+    void visitArrayType(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "ArrayTypeNode (数组类型, 行号: " << ast.line(id) << ")" << endl;
+
+        printIndent(indent + 1);
+        cout << "元素类型: " << endl;
+        print(ast.child(id, ARRAY_TYPE_ELEMENT), indent + 2);
+
+        if (ast.child(id, ARRAY_TYPE_SIZE) != NO_NODE) {
+            printIndent(indent + 1);
+            cout << "大小表达式: " << endl;
+            print(ast.child(id, ARRAY_TYPE_SIZE), indent + 2);
+        } else {
+            printIndent(indent + 1);
+            cout << "大小: 动态" << endl;
+        }
+    }
+
+    void visitMemberAccessExpression(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "MemberAccessNode (成员访问, 成员名: " << ast.text(id) << ", 行号: " << ast.line(id) << ")" << endl;
+
+        printIndent(indent + 1);
+        cout << "结构体表达式: " << endl;
+        print(ast.child(id, MEMBER_ACCESS_BASE), indent + 2);
+    }
+
+    void visitArrayAccessExpression(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "ArrayAccessNode (数组访问, 行号: " << ast.line(id) << ")" << endl;
+
+        printIndent(indent + 1);
+        cout << "数组表达式: " << endl;
+        print(ast.child(id, ARRAY_ACCESS_ARRAY), indent + 2);
+
+        printIndent(indent + 1);
+        cout << "索引表达式: " << endl;
+        print(ast.child(id, ARRAY_ACCESS_INDEX), indent + 2);
+    }
+
+    void visitBinaryExpression(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "BinaryExpressionNode (运算符: " << ast.text(id) << ", 行号: " << ast.line(id) << ")" << endl;
+        printIndent(indent + 1); cout << "左操作数: " << endl;
+        print(ast.child(id, BINARY_LEFT), indent + 2);
+        printIndent(indent + 1); cout << "右操作数: " << endl;
+        print(ast.child(id, BINARY_RIGHT), indent + 2);
+    }
+
+    void visitUnaryExpression(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "UnaryExpressionNode (运算符: " << ast.text(id) << ", 行号: " << ast.line(id) << ")" << endl;
+        printIndent(indent + 1); cout << "操作数: " << endl;
+        print(ast.child(id, UNARY_OPERAND), indent + 2);
+    }
+
+    void visitLiteral(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "LiteralNode (类型: " << tokenTypeToString(ast.literalType(id)) << "): \"" << ast.text(id) << "\" (行号: " << ast.line(id) << ")" << endl;
+    }
+
+    void visitIdentifier(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "IdentifierNode (标识符): \"" << ast.text(id) << "\" (行号: " << ast.line(id) << ")" << endl;
+    }
+
+    void visitFunctionDefinition(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "FunctionDefinitionNode (函数定义: " << ast.text(id) << ", 行号: " << ast.line(id) << ")" << endl;
+
+        printIndent(indent + 1);
+        cout << "返回类型: " << endl;
+        print(ast.child(id, FUNC_RETURN_TYPE), indent + 2);
+
+        printIndent(indent + 1);
+        cout << "参数列表: " << endl;
+        NodeId params = ast.child(id, FUNC_PARAMS);
+        if (params != NO_NODE && ast.childCount(params) > 0) {
+            print(params, indent + 2);
+        } else {
+            printIndent(indent + 2);
+            cout << "<无参数>" << endl;
+        }
+
+        printIndent(indent + 1);
+        cout << "函数体: " << endl;
+        print(ast.child(id, FUNC_BODY), indent + 2);
+    }
+
+    void visitFunctionCall(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "FunctionCallNode (函数调用, 行号: " << ast.line(id) << ")" << endl;
+
+        printIndent(indent + 1);
+        cout << "函数名表达式: " << endl;
+        print(ast.child(id, CALL_FUNCTION), indent + 2);
+
+        printIndent(indent + 1);
+        cout << "参数: " << endl;
+        NodeRange args = ast.children(id, CALL_FIRST_ARG);
+        if (!args.empty()) {
+            for (NodeId arg : args) {
+                print(arg, indent + 2);
+            }
+        } else {
+            printIndent(indent + 2);
+            cout << "<无参数>" << endl;
+        }
+    }
+
+    void visitReturnStatement(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "ReturnStatementNode (返回语句, 行号: " << ast.line(id) << ")" << endl;
+
+        if (ast.child(id, RETURN_VALUE) != NO_NODE) {
+            printIndent(indent + 1);
+            cout << "返回值表达式: " << endl;
+            print(ast.child(id, RETURN_VALUE), indent + 2);
+        } else {
+            printIndent(indent + 1);
+            cout << "<void 返回>" << endl;
+        }
+    }
+
+    void visitBreakStatement(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "BreakStatementNode (Break语句, 行号: " << ast.line(id) << ")" << endl;
+    }
+
+    void visitContinueStatement(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "ContinueStatementNode (Continue语句, 行号: " << ast.line(id) << ")" << endl;
+    }
+
+    void visitCaseStatement(NodeId id, int indent) {
+        printIndent(indent);
+        NodeId value = ast.child(id, CASE_VALUE);
+        if (value != NO_NODE) {
+            cout << "CaseStatementNode (行号: " << ast.line(id) << ")" << endl;
+            printIndent(indent + 1); cout << "匹配值: " << endl;
+            print(value, indent + 2);
+        } else {
+            cout << "DefaultStatementNode (行号: " << ast.line(id) << ")" << endl;
+        }
+        printIndent(indent + 1); cout << "执行体: " << endl;
+        print(ast.child(id, CASE_BODY), indent + 2);
+    }
+
+    void visitSwitchStatement(NodeId id, int indent) {
+        printIndent(indent);
+        cout << "SwitchStatementNode (Switch语句, 行号: " << ast.line(id) << ")" << endl;
+
+        printIndent(indent + 1); cout << "判断表达式: " << endl;
+        print(ast.child(id, SWITCH_EXPR), indent + 2);
+
+        printIndent(indent + 1); cout << "分支列表: " << endl;
+        for (NodeId caseId : ast.children(id, SWITCH_FIRST_CASE)) {
+            print(caseId, indent + 2);
+        }
+    }
+
+private:
+    void printOrPlaceholder(NodeId id, int indent, const char* placeholder) {
+        if (id != NO_NODE) {
+            print(id, indent);
+        } else {
+            printIndent(indent);
+            cout << placeholder << endl;
+        }
+    }
+};
+
+void FlatAST::print(NodeId id, int indent) const {
+    FlatASTPrinter(*this).print(id, indent);
+}
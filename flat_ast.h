@@ -0,0 +1,179 @@
+// flat_ast.h
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ast_nodes.h"
+#include "token.h"
+
+// 压平后的 AST: 所有节点按先序存放在一个连续数组里，用 32 位下标互相引用，
+// 子节点下标集中存放在另一个数组中，每个节点只记录自己子节点的区间。
+// 名字、运算符、字面量等文本拷贝进一个字符串池，因此不依赖解析时的 Arena 和源缓冲区。
+// 语法分析仍然构建指针形式的 AST (ast_nodes.h)，之后由 flattenAST 一次性转换。
+
+using NodeId = uint32_t;
+constexpr NodeId NO_NODE = 0xFFFFFFFFu; // 可选子节点不存在
+using NodeKind = ASTNode::NodeType;
+
+// 每个节点 24 字节
+struct FlatNode {
+    uint8_t kind;        // NodeKind
+    uint8_t literalType; // 仅字面量节点使用，TokenType
+    int32_t line;
+    uint32_t firstChild; // 子节点区间在 childIds 中的起点
+    uint32_t childCount;
+    uint32_t textOffset; // 文本在 textPool 中的位置
+    uint32_t textLength;
+};
+
+// 各类节点的子节点槽位 (child 的第二个参数)。可选子节点不存在时该槽位为 NO_NODE。
+// 语句列表和初始化列表的子节点就是全部语句/元素；函数调用的实参、switch 的分支
+// 从各自的 *_FIRST_* 槽位开始一直到末尾。带文本的节点见各行注释。
+enum FlatSlot : uint32_t {
+    PROGRAM_BODY = 0,
+    ARRAY_TYPE_ELEMENT = 0, ARRAY_TYPE_SIZE = 1,          // 大小为空表示动态数组
+    DECL_TYPE = 0, DECL_INIT = 1,                         // 文本: 变量名
+    ARRAY_ACCESS_ARRAY = 0, ARRAY_ACCESS_INDEX = 1,
+    STRUCTI_MEMBERS = 0,                                  // 文本: 结构体名
+    MEMBER_ACCESS_BASE = 0,                               // 文本: 成员名
+    ASSIGN_LHS = 0, ASSIGN_RHS = 1,                       // 文本: 运算符
+    IF_COND = 0, IF_THEN = 1, IF_ELSE = 2,
+    WHILE_COND = 0, WHILE_BODY = 1,
+    FOR_INIT = 0, FOR_COND = 1, FOR_INCR = 2, FOR_BODY = 3,
+    PRINT_EXPR = 0,
+    BINARY_LEFT = 0, BINARY_RIGHT = 1,                    // 文本: 运算符
+    UNARY_OPERAND = 0,                                    // 文本: 运算符
+    FUNC_RETURN_TYPE = 0, FUNC_PARAMS = 1, FUNC_BODY = 2, // 文本: 函数名
+    CALL_FUNCTION = 0, CALL_FIRST_ARG = 1,
+    RETURN_VALUE = 0,
+    SWITCH_EXPR = 0, SWITCH_FIRST_CASE = 1,
+    CASE_VALUE = 0, CASE_BODY = 1,                        // 值为空表示 default
+};
+// 其余带文本的节点: Type (类型名)、Literal (字面量值)、Identifier (标识符名)
+
+// 子节点下标区间，可直接用于范围 for
+struct NodeRange {
+    const NodeId* first;
+    const NodeId* last;
+    const NodeId* begin() const { return first; }
+    const NodeId* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+    NodeId operator[](size_t i) const { return first[i]; }
+};
+
+class FlatAST {
+public:
+    NodeId root() const { return nodes.empty() ? NO_NODE : 0; } // 先序存放，根节点总在最前
+    size_t size() const { return nodes.size(); }
+
+    NodeKind kind(NodeId id) const { return static_cast<NodeKind>(nodes[id].kind); }
+    int line(NodeId id) const { return nodes[id].line; }
+    TokenType literalType(NodeId id) const { return static_cast<TokenType>(nodes[id].literalType); }
+    std::string_view text(NodeId id) const {
+        return std::string_view(textPool.data() + nodes[id].textOffset, nodes[id].textLength);
+    }
+
+    uint32_t childCount(NodeId id) const { return nodes[id].childCount; }
+    NodeId child(NodeId id, uint32_t slot) const {
+        return slot < nodes[id].childCount ? childIds[nodes[id].firstChild + slot] : NO_NODE;
+    }
+    // 从第 first 个槽位开始的全部子节点
+    NodeRange children(NodeId id, uint32_t first = 0) const {
+        const NodeId* base = childIds.data() + nodes[id].firstChild;
+        uint32_t count = nodes[id].childCount;
+        return NodeRange{base + (first < count ? first : count), base + count};
+    }
+
+    // 以缩进形式打印 id 为根的子树，格式与原先 ASTNode::print 相同
+    void print(NodeId id, int indent = 0) const;
+
+private:
+    friend class FlatASTBuilder;
+    std::vector<FlatNode> nodes;
+    std::vector<NodeId> childIds;
+    std::string textPool;
+};
+
+// 把解析得到的指针 AST 转换为 FlatAST。转换后原 AST (及其 Arena) 可以立即释放
+FlatAST flattenAST(const ProgramNode* program);
+
+// 静态分派的访问者 (CRTP): Derived 实现需要的 visitXxx(NodeId, Args...)，
+// 没有实现的节点类型落到 visitNode。所有调用在编译期确定，不经过虚函数。
+template <typename Derived, typename R = void, typename... Args>
+class FlatASTVisitor {
+public:
+    explicit FlatASTVisitor(const FlatAST& tree) : ast(tree) {}
+
+    R visit(NodeId id, Args... args) {
+        Derived& self = static_cast<Derived&>(*this);
+        switch (ast.kind(id)) {
+            case NodeKind::Program:                    return self.visitProgram(id, args...);
+            case NodeKind::StatementList:              return self.visitStatementList(id, args...);
+            case NodeKind::DeclarationStatement:       return self.visitDeclarationStatement(id, args...);
+            case NodeKind::AssignmentStatement:        return self.visitAssignmentStatement(id, args...);
+            case NodeKind::IfStatement:                return self.visitIfStatement(id, args...);
+            case NodeKind::WhileStatement:             return self.visitWhileStatement(id, args...);
+            case NodeKind::ForStatement:               return self.visitForStatement(id, args...);
+            case NodeKind::StructiDefinitionStatement: return self.visitStructiDefinitionStatement(id, args...);
+            case NodeKind::MemberAccessExpression:     return self.visitMemberAccessExpression(id, args...);
+            case NodeKind::ArrayType:                  return self.visitArrayType(id, args...);
+            case NodeKind::ArrayAccessExpression:      return self.visitArrayAccessExpression(id, args...);
+            case NodeKind::PrintStatement:             return self.visitPrintStatement(id, args...);
+            case NodeKind::BinaryExpression:           return self.visitBinaryExpression(id, args...);
+            case NodeKind::UnaryExpression:            return self.visitUnaryExpression(id, args...);
+            case NodeKind::Literal:                    return self.visitLiteral(id, args...);
+            case NodeKind::Identifier:                 return self.visitIdentifier(id, args...);
+            case NodeKind::Type:                       return self.visitType(id, args...);
+            case NodeKind::FunctionDefinition:         return self.visitFunctionDefinition(id, args...);
+            case NodeKind::FunctionCall:               return self.visitFunctionCall(id, args...);
+            case NodeKind::ReturnStatement:            return self.visitReturnStatement(id, args...);
+            case NodeKind::SwitchStatement:            return self.visitSwitchStatement(id, args...);
+            case NodeKind::CaseStatement:              return self.visitCaseStatement(id, args...);
+            case NodeKind::BreakStatement:             return self.visitBreakStatement(id, args...);
+            case NodeKind::ContinueStatement:          return self.visitContinueStatement(id, args...);
+            case NodeKind::InitializerList:            return self.visitInitializerList(id, args...);
+        }
+        return self.visitNode(id, args...);
+    }
+
+    // 默认实现: 全部交给 visitNode
+    R visitProgram(NodeId id, Args... args)                    { return self().visitNode(id, args...); }
+    R visitStatementList(NodeId id, Args... args)              { return self().visitNode(id, args...); }
+    R visitDeclarationStatement(NodeId id, Args... args)       { return self().visitNode(id, args...); }
+    R visitAssignmentStatement(NodeId id, Args... args)        { return self().visitNode(id, args...); }
+    R visitIfStatement(NodeId id, Args... args)                { return self().visitNode(id, args...); }
+    R visitWhileStatement(NodeId id, Args... args)             { return self().visitNode(id, args...); }
+    R visitForStatement(NodeId id, Args... args)               { return self().visitNode(id, args...); }
+    R visitStructiDefinitionStatement(NodeId id, Args... args) { return self().visitNode(id, args...); }
+    R visitMemberAccessExpression(NodeId id, Args... args)     { return self().visitNode(id, args...); }
+    R visitArrayType(NodeId id, Args... args)                  { return self().visitNode(id, args...); }
+    R visitArrayAccessExpression(NodeId id, Args... args)      { return self().visitNode(id, args...); }
+    R visitPrintStatement(NodeId id, Args... args)             { return self().visitNode(id, args...); }
+    R visitBinaryExpression(NodeId id, Args... args)           { return self().visitNode(id, args...); }
+    R visitUnaryExpression(NodeId id, Args... args)            { return self().visitNode(id, args...); }
+    R visitLiteral(NodeId id, Args... args)                    { return self().visitNode(id, args...); }
+    R visitIdentifier(NodeId id, Args... args)                 { return self().visitNode(id, args...); }
+    R visitType(NodeId id, Args... args)                       { return self().visitNode(id, args...); }
+    R visitFunctionDefinition(NodeId id, Args... args)         { return self().visitNode(id, args...); }
+    R visitFunctionCall(NodeId id, Args... args)               { return self().visitNode(id, args...); }
+    R visitReturnStatement(NodeId id, Args... args)            { return self().visitNode(id, args...); }
+    R visitSwitchStatement(NodeId id, Args... args)            { return self().visitNode(id, args...); }
+    R visitCaseStatement(NodeId id, Args... args)              { return self().visitNode(id, args...); }
+    R visitBreakStatement(NodeId id, Args... args)             { return self().visitNode(id, args...); }
+    R visitContinueStatement(NodeId id, Args... args)          { return self().visitNode(id, args...); }
+    R visitInitializerList(NodeId id, Args... args)            { return self().visitNode(id, args...); }
+    R visitNode(NodeId, Args...)                               { return R(); }
+
+protected:
+    const FlatAST& ast;
+
+private:
+    Derived& self() { return static_cast<Derived&>(*this); }
+};
+
+#endif // FLAT_AST_H
@@ -0,0 +1,150 @@
+#include "inliner.h"
+#include <iostream>
+
+using namespace std;
+
+namespace {
+
+// 叶子函数体里允许出现的四元式: 标量运算、跳转、返回和输出
+bool inlinable(Opcode op) {
+    switch (op) {
+        case Opcode::FUNC_BEGIN: case Opcode::FUNC_END: case Opcode::GET_PARAM:
+        case Opcode::PARAM: case Opcode::CALL:
+        case Opcode::DEC_ARRAY: case Opcode::DEC_DYN_ARRAY: case Opcode::STORE_AT: case Opcode::LOAD_AT:
+        case Opcode::LOAD_MEMBER: case Opcode::STORE_MEMBER:
+            return false;
+        default:
+            return true;
+    }
+}
+
+} // namespace
+
+Inliner::Inliner(QuadrupleSpan quads, SymbolTable& st, const unordered_set<NameId>& g)
+    : input(quads), symbol_table(st), globals(g) {}
+
+void Inliner::collect_callees() {
+    for (size_t i = 0; i < input.size(); ++i) {
+        if (input[i].op != Opcode::FUNC_BEGIN) continue;
+        NameId name = input[i].arg1.name;
+        Callee f;
+        size_t k = i + 1;
+        bool ok = true;
+        for (; k < input.size() && input[k].op == Opcode::GET_PARAM; ++k) {
+            // 与全局变量同名的形参在各后端里就是那个全局变量，不内联
+            if (globals.count(input[k].arg1.name)) ok = false;
+            f.params.push_back(input[k].arg1.name);
+        }
+        f.body_begin = k;
+        for (; k < input.size() && input[k].op != Opcode::FUNC_END; ++k) {
+            if (!inlinable(input[k].op)) ok = false;
+        }
+        f.body_end = k;
+        i = k;
+        if (ok && f.body_end - f.body_begin <= MAX_INLINE_SIZE) callees.emplace(name, std::move(f));
+    }
+    for (size_t i = 0; i < input.size(); ++i) {
+        if (input[i].op != Opcode::CALL) continue;
+        auto it = callees.find(input[i].arg1.name);
+        if (it != callees.end()) ++it->second.call_sites;
+    }
+}
+
+// 代价是复制的四元式条数; 收益是省下的 PARAM/GET_PARAM (每个实参各一条) 和 CALL/RETURN/序言/尾声，
+// 常量实参能让函数体在内联后继续折叠，额外加分。只有一处调用的函数内联后不会让代码变多
+bool Inliner::worth_inlining(const Callee& f, const vector<Operand>& args) const {
+    size_t size = f.body_end - f.body_begin;
+    if (size > budget) return false;
+    if (size <= ALWAYS_INLINE_SIZE || f.call_sites == 1) return true;
+    size_t benefit = 2 * args.size() + 4;
+    for (const auto& a : args) {
+        if (!a.isVariable()) benefit += 4;
+    }
+    return size <= 3 * benefit;
+}
+
+void Inliner::expand(const Callee& f, const Quadruple& call, const vector<size_t>& param_at, vector<Quadruple>& out) {
+    unordered_map<NameId, Operand> variables, labels;
+    auto rename = [&](const Operand& o) -> Operand {
+        if (o.kind == OperandKind::LABEL) {
+            auto [it, inserted] = labels.try_emplace(o.name);
+            if (inserted) it->second = Operand::label(symbol_table.generateLabel());
+            return it->second;
+        }
+        if (!o.isVariable() || globals.count(o.name)) return o;
+        auto [it, inserted] = variables.try_emplace(o.name);
+        if (inserted) it->second = Operand::temp(symbol_table.generateTempVar());
+        return it->second;
+    };
+
+    // 实参从右往左压入: 最后一条 PARAM 是第一个实参
+    const size_t n = param_at.size();
+    for (size_t k = 0; k < n; ++k) {
+        Quadruple& param = out[param_at[n - 1 - k]];
+        param = Quadruple(Opcode::ASSIGN, param.arg1, Operand::none(), rename(Operand::symbol(f.params[k])));
+    }
+    // 有名字的局部变量在每次调用时都从 0 开始
+    for (size_t i = f.body_begin; i < f.body_end; ++i) {
+        for (const Operand* o : {&input[i].arg1, &input[i].arg2, &input[i].res}) {
+            if (o->kind != OperandKind::SYMBOL || globals.count(o->name) || variables.count(o->name)) continue;
+            out.emplace_back(Opcode::ASSIGN, Operand::intImm(0), Operand::none(), rename(*o));
+        }
+    }
+
+    Operand end = Operand::label(symbol_table.generateLabel());
+    for (size_t i = f.body_begin; i < f.body_end; ++i) {
+        const Quadruple& q = input[i];
+        if (q.op == Opcode::RETURN) {
+            if (!call.res.isNone() && !q.arg1.isNone()) {
+                out.emplace_back(Opcode::ASSIGN, rename(q.arg1), Operand::none(), call.res);
+            }
+            out.emplace_back(Opcode::JUMP, Operand::none(), Operand::none(), end);
+            continue;
+        }
+        out.emplace_back(q.op, rename(q.arg1), rename(q.arg2), rename(q.res));
+    }
+    Opcode last = f.body_end > f.body_begin ? input[f.body_end - 1].op : Opcode::LABEL;
+    if (!call.res.isNone() && last != Opcode::RETURN && last != Opcode::JUMP) {
+        out.emplace_back(Opcode::ASSIGN, Operand::intImm(0), Operand::none(), call.res);
+    }
+    out.emplace_back(Opcode::LABEL, end);
+}
+
+vector<Quadruple> Inliner::run() {
+    collect_callees();
+    budget = input.size() / 2 + 64;
+
+    vector<Quadruple> out;
+    out.reserve(input.size());
+    vector<size_t> pending; // 已输出、等待 CALL 的 PARAM 所在位置
+    size_t inlined = 0;
+    for (size_t i = 0; i < input.size(); ++i) {
+        const Quadruple& q = input[i];
+        if (q.op == Opcode::PARAM) pending.push_back(out.size());
+        if (q.op != Opcode::CALL) {
+            out.push_back(q);
+            continue;
+        }
+        size_t argc = static_cast<size_t>(q.arg2.intValue);
+        auto it = callees.find(q.arg1.name);
+        if (argc > pending.size()) {
+            out.push_back(q);
+            continue;
+        }
+        vector<size_t> param_at(pending.end() - argc, pending.end());
+        pending.resize(pending.size() - argc);
+        vector<Operand> args;
+        for (size_t at : param_at) args.push_back(out[at].arg1);
+        if (it == callees.end() || it->second.params.size() != argc || !worth_inlining(it->second, args)) {
+            out.push_back(q);
+            continue;
+        }
+        const Callee& f = it->second;
+        cout << "  [内联] " << q.toString() << " (" << f.body_end - f.body_begin << " 条四元式)" << endl;
+        budget -= f.body_end - f.body_begin;
+        expand(f, q, param_at, out);
+        ++inlined;
+    }
+    cout << "--- 内联了 " << inlined << " 处调用 ---" << endl;
+    return out;
+}
@@ -0,0 +1,46 @@
+#ifndef INLINER_H
+#define INLINER_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "quadruple.h"
+#include "symbol_table.h"
+
+// 函数内联: 把小的叶子函数的函数体复制到调用处，省掉 PARAM/CALL/GET_PARAM/RETURN 和后端
+// 为每次调用生成的压栈、序言、尾声与清理实参，常量实参也能在之后的全局优化中继续折叠。
+//
+// 只内联函数体里没有调用、数组和结构体操作的函数，因此不会递归展开，形参和局部变量也都是标量。
+// 复制时局部变量和临时变量换成新的临时变量 (有名字的局部变量先清零，与解释器给新栈帧清零一致)，
+// 标签换成新标签，全局变量保持原名。实参在原来 PARAM 的位置赋给对应的形参，保持实参的求值时机;
+// RETURN 变成给调用结果赋值并跳到展开的末尾，执行到函数末尾没有返回值时结果为 0。
+class Inliner {
+public:
+    Inliner(QuadrupleSpan quads, SymbolTable& st, const std::unordered_set<NameId>& globals);
+
+    // 返回内联后的四元式序列，被内联的函数定义保留
+    std::vector<Quadruple> run();
+
+private:
+    // 不论收益都内联的函数体大小，以及内联的上限 (都按四元式条数，不含 FUNC_BEGIN/GET_PARAM/FUNC_END)
+    static constexpr size_t ALWAYS_INLINE_SIZE = 8;
+    static constexpr size_t MAX_INLINE_SIZE = 40;
+
+    struct Callee {
+        size_t body_begin = 0, body_end = 0;  // 函数体在输入中的范围
+        std::vector<NameId> params;
+        size_t call_sites = 0;
+    };
+
+    QuadrupleSpan input;
+    SymbolTable& symbol_table;
+    const std::unordered_set<NameId>& globals;
+    std::unordered_map<NameId, Callee> callees;  // 可以内联的函数
+    size_t budget = 0;                           // 还能复制的四元式条数，防止代码膨胀
+
+    void collect_callees();
+    bool worth_inlining(const Callee& f, const std::vector<Operand>& args) const;
+    void expand(const Callee& f, const Quadruple& call, const std::vector<size_t>& param_at, std::vector<Quadruple>& out);
+};
+
+#endif // INLINER_H
@@ -0,0 +1,28 @@
+#include "interner.h"
+
+using namespace std;
+
+StringInterner::StringInterner() {
+    intern("_"); // NAME_NONE
+}
+
+NameId StringInterner::intern(string_view s) {
+    lock_guard<std::mutex> lock(mutex);
+    auto it = ids.find(s);
+    if (it != ids.end()) return it->second;
+
+    NameId id = static_cast<NameId>(count.load(memory_order_relaxed));
+    uint64_t v = uint64_t(id) + FIRST_SEGMENT;
+    unsigned k = 63 - __builtin_clzll(v) - FIRST_SEGMENT_BITS;
+    if (!segments[k]) segments[k] = make_unique<string[]>(FIRST_SEGMENT << k);
+    string& slot = segments[k][v - (FIRST_SEGMENT << k)];
+    slot = s;
+    ids.emplace(string_view(slot), id);
+    count.store(id + 1, memory_order_release);
+    return id;
+}
+
+StringInterner& interner() {
+    static StringInterner instance;
+    return instance;
+}
@@ -0,0 +1,49 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// 全局字符串驻留表: 标识符、临时变量(T0..Tn)、标签(L0..Ln)、字面量都只存一份，
+// 各阶段之间传递和比较的都是稠密的整数 id，只有输出时才换回字符串。
+using NameId = uint32_t;
+
+// intern 加锁，可以在多个线程里同时调用 (函数级并行优化和代码生成时会生成新的名字)。
+// 字符串按段存放，第 k 段能放 FIRST_SEGMENT << k 个，段一经分配就不再移动，
+// 所以 str 不用加锁: 拿到 id 时它所在的段和字符串都已经写好
+class StringInterner {
+public:
+    StringInterner();
+
+    NameId intern(std::string_view s);
+    const std::string& str(NameId id) const {
+        uint64_t v = uint64_t(id) + FIRST_SEGMENT;
+        unsigned k = 63 - __builtin_clzll(v) - FIRST_SEGMENT_BITS;
+        return segments[k][v - (FIRST_SEGMENT << k)];
+    }
+    size_t size() const { return count.load(std::memory_order_acquire); }
+
+private:
+    static constexpr unsigned FIRST_SEGMENT_BITS = 10;
+    static constexpr uint64_t FIRST_SEGMENT = uint64_t(1) << FIRST_SEGMENT_BITS;
+
+    std::unique_ptr<std::string[]> segments[64 - FIRST_SEGMENT_BITS];
+    std::atomic<size_t> count{0};
+    std::unordered_map<std::string_view, NameId> ids; // 指向段里的字符串
+    std::mutex mutex;                                 // 保护 ids、count 的递增和新段的分配
+};
+
+// 编译过程中唯一的驻留表
+StringInterner& interner();
+
+constexpr NameId NAME_NONE = 0; // "_"，构造时第一个驻留
+
+inline NameId intern(std::string_view s) { return interner().intern(s); }
+inline const std::string& nameOf(NameId id) { return interner().str(id); }
+
+#endif // INTERNER_H
@@ -6,76 +6,83 @@
 #include <memory>
 #include <map>
 
-#include "ast_nodes.h"
+#include "flat_ast.h"
 #include "symbol_table.h"
 #include "quadruple.h"
 
 // 表达式求值结果的结构体
 struct ExpressionResult {
-    std::string place;
+    Operand place; // 结果所在的变量/临时变量/常量
     std::shared_ptr<TypeInfo> type;
     bool isLValue;
 
-    ExpressionResult(std::string p = "", std::shared_ptr<TypeInfo> t = nullptr, bool lval = false)
-        : place(std::move(p)), type(std::move(t)), isLValue(lval) {}
+    ExpressionResult(Operand p = {}, std::shared_ptr<TypeInfo> t = nullptr, bool lval = false)
+        : place(p), type(std::move(t)), isLValue(lval) {}
 
     bool isValid() const {
         return type != nullptr && type->kind != TypeKind::UNKNOWN;
     }
 };
 
-class IRGenerator {
+class IRGenerator : private FlatASTVisitor<IRGenerator> {
 private:
+    friend class FlatASTVisitor<IRGenerator>; // 基类按节点类型静态分派到下面的 visitXxx
+    class ExpressionDispatcher;               // 表达式节点的分派，见 ir_generator.cpp
+
     std::vector<Quadruple> quadruples;
     SymbolTable& symbolTable;
-    std::unique_ptr<ASTNode> astRoot;
     std::shared_ptr<TypeInfo> currentFunctionReturnType;
-    std::vector<std::string> breakLabels;
-    std::vector<std::string> continueLabels;
+    std::vector<Operand> breakLabels;
+    std::vector<Operand> continueLabels;
 
     // 核心遍历方法
-    void generate(ASTNode* node);
-    ExpressionResult generateExpression(ASTNode* node, bool needsLValue = false);
+    void generate(NodeId node);
+    ExpressionResult generateExpression(NodeId node, bool needsLValue = false);
 
     // 辅助函数，用于从AST类型节点获取符号表类型信息
-    std::shared_ptr<TypeInfo> getTypeFromNode(ASTNode* typeNode);
+    std::shared_ptr<TypeInfo> getTypeFromNode(NodeId typeNode);
 
     // 语义分析辅助函数
     void reportSemanticError(int line, const std::string& message);
-    std::shared_ptr<TypeInfo> getExpressionType(ASTNode* node);
+    std::shared_ptr<TypeInfo> getExpressionType(NodeId node);
     bool checkAssignmentCompatibility(const std::shared_ptr<TypeInfo>& target, const std::shared_ptr<TypeInfo>& source, int line);
     std::shared_ptr<TypeInfo> checkOperationType(const std::shared_ptr<TypeInfo>& type1, const std::shared_ptr<TypeInfo>& type2, const std::string& op, int line);
 
-    // 各AST节点的生成函数
-    void generateStatementList(StatementListNode* node);
-
-    std::string recursivelyInitializeArray(const std::string& nameHint,const std::shared_ptr<TypeInfo>& type, InitializerListNode* initList);
-
-    void generateDeclarationStatement(DeclarationStatementNode* node);
-    void generateAssignmentStatement(AssignmentStatementNode* node);
-    void generateIfStatement(IfStatementNode* node);
-    void generateWhileStatement(WhileStatementNode* node);
-    void generateForStatement(ForStatementNode* node);
-    void generatePrintStatement(PrintStatementNode* node);
-    void generateStructiDefinition(StructiDefinitionNode* node);
-    void generateFunctionDefinition(FunctionDefinitionNode* node);
-    void generateReturnStatement(ReturnStatementNode* node);
-    void generateSwitchStatement(SwitchStatementNode* node);
-    void generateBreakStatement(BreakStatementNode* node);
-    void generateContinueStatement(ContinueStatementNode* node);
+    Operand recursivelyInitializeArray(Operand nameHint,const std::shared_ptr<TypeInfo>& type, NodeId initList);
+
+    // 各语句节点的生成函数 (由 visit 分派)
+    void visitProgram(NodeId node);
+    void visitStatementList(NodeId node);
+    void visitDeclarationStatement(NodeId node);
+    void visitAssignmentStatement(NodeId node);
+    void visitIfStatement(NodeId node);
+    void visitWhileStatement(NodeId node);
+    void visitForStatement(NodeId node);
+    void visitPrintStatement(NodeId node);
+    void visitStructiDefinitionStatement(NodeId node);
+    void visitFunctionDefinition(NodeId node);
+    void visitReturnStatement(NodeId node);
+    void visitSwitchStatement(NodeId node);
+    void visitBreakStatement(NodeId node);
+    void visitContinueStatement(NodeId node);
+    // 可以单独成句的表达式
+    void visitFunctionCall(NodeId node) { generateExpression(node); }
+    void visitBinaryExpression(NodeId node) { generateExpression(node); }
+    void visitUnaryExpression(NodeId node) { generateExpression(node); }
+    void visitNode(NodeId node); // 其余节点不能作为语句
 
 
     // 表达式的生成函数
-    ExpressionResult generateFunctionCall(FunctionCallNode* node);
-    ExpressionResult generateArrayAccess(ArrayAccessNode* node, bool needsLValue);
-    ExpressionResult generateBinaryExpression(BinaryExpressionNode* node);
-    ExpressionResult generateUnaryExpression(UnaryExpressionNode* node);
-    ExpressionResult generateIdentifier(IdentifierNode* node, bool needsLValue);
-    ExpressionResult generateLiteral(LiteralNode* node);
-    ExpressionResult generateMemberAccess(MemberAccessNode* node, bool needsLValue);
+    ExpressionResult generateFunctionCall(NodeId node);
+    ExpressionResult generateArrayAccess(NodeId node, bool needsLValue);
+    ExpressionResult generateBinaryExpression(NodeId node);
+    ExpressionResult generateUnaryExpression(NodeId node);
+    ExpressionResult generateIdentifier(NodeId node, bool needsLValue);
+    ExpressionResult generateLiteral(NodeId node);
+    ExpressionResult generateMemberAccess(NodeId node, bool needsLValue);
 
 public:
-    IRGenerator(std::unique_ptr<ASTNode> root, SymbolTable& st);
+    IRGenerator(const FlatAST& tree, SymbolTable& st);
     void generate();
     const std::vector<Quadruple>& getQuadruples() const { return quadruples; }
     void dumpQuadruples() const;
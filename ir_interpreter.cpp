@@ -0,0 +1,432 @@
+#include "ir_interpreter.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+using namespace std;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define IR_COMPUTED_GOTO 1
+#else
+#define IR_COMPUTED_GOTO 0
+#endif
+
+namespace {
+
+constexpr int32_t NO_SLOT = INT32_MIN;                  // 不存在的操作数
+constexpr size_t MAX_CALL_DEPTH = 100000;               // 超过这个深度视为无穷递归
+
+// 解释器的操作码: 前面与 Opcode 一一对应，末尾追加停机指令
+constexpr uint32_t op(Opcode o) { return static_cast<uint32_t>(o); }
+constexpr uint32_t OP_HALT = op(Opcode::STORE_MEMBER) + 1;
+
+} // namespace
+
+IRInterpreter::IRInterpreter(QuadrupleSpan quads, SymbolTable& st, ostream& output)
+    : quadruples(quads), symbolTable(st), out(output) {}
+
+// 变量按名字分到当前栈帧或静态区，常量按 (种类, 拼写) 去重后放进静态区
+int32_t IRInterpreter::slotOf(const Operand& operand, unordered_map<NameId, int32_t>& locals, int32_t& frameSize) {
+    switch (operand.kind) {
+        case OperandKind::NONE:
+        case OperandKind::LABEL:
+            return NO_SLOT;
+        case OperandKind::TEMP:
+        case OperandKind::SYMBOL: {
+            // 与代码生成器一致: 能在全局作用域查到的变量都是全局变量
+            const Symbol* sym = symbolTable.lookup(operand.name);
+            if (sym && sym->scopeLevel == 0 && sym->category == SymbolCategory::Variable) {
+                auto [it, inserted] = globalSlots.try_emplace(operand.name, static_cast<int32_t>(statics.size()));
+                if (inserted) statics.emplace_back();
+                return ~it->second;
+            }
+            auto [it, inserted] = locals.try_emplace(operand.name, frameSize);
+            if (inserted) ++frameSize;
+            return it->second;
+        }
+        default: {
+            uint64_t key = (static_cast<uint64_t>(operand.kind) << 32) | operand.name;
+            auto [it, inserted] = constantSlots.try_emplace(key, static_cast<int32_t>(statics.size()));
+            if (inserted) statics.push_back(constantValue(operand));
+            return ~it->second;
+        }
+    }
+}
+
+// 预解码: 第一遍确定每条四元式的指令下标、标签位置和函数表，第二遍生成指令
+void IRInterpreter::preprocess() {
+    code.clear();
+    functions.assign(1, Function{NAME_NONE});
+    statics.clear();
+    globalSlots.clear();
+    constantSlots.clear();
+
+    unordered_map<NameId, uint32_t> labelTargets;
+    unordered_map<NameId, int32_t> functionIndex;
+    vector<uint32_t> skipTargets(1, 0); // 顶层执行到 FUNC_BEGIN 时跳过整个函数体
+    uint32_t next = 0;
+    int32_t current = 0;
+    for (const auto& q : quadruples) {
+        switch (q.op) {
+            case Opcode::LABEL:
+                labelTargets[q.arg1.name] = next;
+                break;
+            case Opcode::GET_PARAM:
+                break;
+            case Opcode::FUNC_BEGIN:
+                current = static_cast<int32_t>(functions.size());
+                functionIndex[q.arg1.name] = current;
+                functions.push_back(Function{q.arg1.name, ++next});
+                skipTargets.push_back(0);
+                break;
+            case Opcode::FUNC_END:
+                skipTargets[current] = ++next;
+                current = 0;
+                break;
+            default:
+                ++next;
+                break;
+        }
+    }
+
+    vector<unordered_map<NameId, int32_t>> locals(functions.size());
+    auto slot = [&](const Operand& operand) {
+        return slotOf(operand, locals[current], functions[current].frameSize);
+    };
+    auto target = [&](const Operand& label) {
+        auto it = labelTargets.find(label.name);
+        if (it == labelTargets.end()) runtimeError("跳转到未定义的标签 '" + label.str() + "'");
+        return static_cast<int32_t>(it->second);
+    };
+
+    code.reserve(next + 1);
+    current = 0;
+    for (const auto& q : quadruples) {
+        Instr in{op(q.op), NO_SLOT, NO_SLOT, NO_SLOT};
+        switch (q.op) {
+            case Opcode::LABEL:
+                continue;
+            case Opcode::GET_PARAM:
+                // 形参在 CALL 时直接写入，这里只记录槽位
+                functions[current].paramSlots.push_back(slot(q.arg1));
+                continue;
+            case Opcode::FUNC_BEGIN:
+                current = functionIndex[q.arg1.name];
+                in.a = static_cast<int32_t>(skipTargets[current]);
+                break;
+            case Opcode::FUNC_END:
+                current = 0;
+                break;
+            case Opcode::JUMP:
+                in.a = target(q.res);
+                break;
+            case Opcode::JUMPF:
+            case Opcode::JUMPNZ:
+                in.a = slot(q.arg1);
+                in.b = target(q.res);
+                break;
+            case Opcode::CALL: {
+                auto it = functionIndex.find(q.arg1.name);
+                if (it == functionIndex.end()) runtimeError("调用了未定义的函数 '" + q.arg1.str() + "'");
+                in.a = it->second;
+                in.b = static_cast<int32_t>(q.arg2.intValue);
+                in.c = slot(q.res);
+                break;
+            }
+            case Opcode::LOAD_MEMBER:
+            case Opcode::STORE_MEMBER:
+                // 成员按 2 字节一个排布，换成成员下标
+                in.a = slot(q.arg1);
+                in.b = slot(q.arg2);
+                in.c = static_cast<int32_t>(q.res.intValue / 2);
+                break;
+            default:
+                in.a = slot(q.arg1);
+                in.b = slot(q.arg2);
+                in.c = slot(q.res);
+                break;
+        }
+        code.push_back(in);
+    }
+    code.push_back(Instr{OP_HALT, NO_SLOT, NO_SLOT, NO_SLOT});
+}
+
+void IRInterpreter::printValue(const Value& v) {
+    writeValue(out, v);
+    out << '\n';
+}
+
+uint64_t IRInterpreter::execute() {
+    preprocess();
+
+    stack.assign(max<size_t>(1024, functions[0].frameSize), Value{});
+    callStack.clear();
+    pendingArgs.clear();
+
+    const Instr* const program = code.data();
+    const Instr* ip = program;
+    Value* const st = statics.data(); // 预解码之后静态区不再增长
+    size_t base = 0;
+    int32_t frameSize = functions[0].frameSize;
+    Value* fp = stack.data();
+    Value result;
+    uint64_t executed = 0;
+
+#define SLOT(s) ((s) >= 0 ? fp[(s)] : st[~(s)])
+
+#if IR_COMPUTED_GOTO
+    // 顺序必须与 Opcode 一致
+    static const void* const dispatchTable[] = {
+        &&op_ASSIGN, &&op_ADD, &&op_SUB, &&op_MUL, &&op_DIV, &&op_MOD, &&op_NEG, &&op_NOT,
+        &&op_LT, &&op_GT, &&op_LE, &&op_GE, &&op_EQ, &&op_NE, &&op_AND, &&op_OR,
+        &&op_LABEL, &&op_JUMP, &&op_JUMPF, &&op_JUMPNZ, &&op_FUNC_BEGIN, &&op_FUNC_END,
+        &&op_GET_PARAM, &&op_PARAM, &&op_CALL, &&op_RETURN, &&op_PRINT, &&op_DEC_ARRAY,
+        &&op_DEC_DYN_ARRAY, &&op_STORE_AT, &&op_LOAD_AT, &&op_LOAD_MEMBER, &&op_STORE_MEMBER,
+        &&op_HALT
+    };
+    static_assert(sizeof(dispatchTable) / sizeof(dispatchTable[0]) == OP_HALT + 1, "分派表与 Opcode 不一致");
+#define DISPATCH() do { ++executed; goto *dispatchTable[ip->op]; } while (0)
+#define CASE(name) op_##name:
+    DISPATCH();
+#else
+#define DISPATCH() continue
+#define CASE(name) case op(Opcode::name):
+    for (;;) {
+    ++executed;
+    switch (ip->op) {
+#endif
+
+    CASE(ASSIGN) {
+        SLOT(ip->c) = SLOT(ip->a);
+        ++ip;
+        DISPATCH();
+    }
+
+    // 两个操作数都是整数时直接算，其余交给慢速路径
+#define ARITHMETIC(name, expr)                                                 \
+    CASE(name) {                                                               \
+        const Value& x = SLOT(ip->a);                                          \
+        const Value& y = SLOT(ip->b);                                          \
+        if (x.type == ValueType::INT && y.type == ValueType::INT) {            \
+            uint64_t a = static_cast<uint64_t>(x.i), b = static_cast<uint64_t>(y.i); \
+            result = makeInt(static_cast<int64_t>(expr));                      \
+        } else {                                                               \
+            result = performArithmetic(static_cast<Opcode>(ip->op), x, y, heap); \
+        }                                                                      \
+        SLOT(ip->c) = result;                                                  \
+        ++ip;                                                                  \
+        DISPATCH();                                                            \
+    }
+
+    ARITHMETIC(ADD, a + b)
+    ARITHMETIC(SUB, a - b)
+    ARITHMETIC(MUL, a * b)
+#undef ARITHMETIC
+
+    CASE(DIV)
+    CASE(MOD) {
+        SLOT(ip->c) = performArithmetic(static_cast<Opcode>(ip->op), SLOT(ip->a), SLOT(ip->b), heap);
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(NEG)
+    CASE(NOT) {
+        SLOT(ip->c) = performUnary(static_cast<Opcode>(ip->op), SLOT(ip->a));
+        ++ip;
+        DISPATCH();
+    }
+
+#define COMPARISON(name, cmp)                                                  \
+    CASE(name) {                                                               \
+        const Value& x = SLOT(ip->a);                                          \
+        const Value& y = SLOT(ip->b);                                          \
+        if (x.type == ValueType::INT && y.type == ValueType::INT) {            \
+            result = makeBool(x.i cmp y.i);                                    \
+        } else {                                                               \
+            result = performComparison(static_cast<Opcode>(ip->op), x, y);     \
+        }                                                                      \
+        SLOT(ip->c) = result;                                                  \
+        ++ip;                                                                  \
+        DISPATCH();                                                            \
+    }
+
+    COMPARISON(LT, <)
+    COMPARISON(GT, >)
+    COMPARISON(LE, <=)
+    COMPARISON(GE, >=)
+    COMPARISON(EQ, ==)
+    COMPARISON(NE, !=)
+#undef COMPARISON
+
+    CASE(AND) {
+        SLOT(ip->c) = makeBool(truth(SLOT(ip->a)) && truth(SLOT(ip->b)));
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(OR) {
+        SLOT(ip->c) = makeBool(truth(SLOT(ip->a)) || truth(SLOT(ip->b)));
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(JUMP) {
+        ip = program + ip->a;
+        DISPATCH();
+    }
+
+    CASE(JUMPF) {
+        ip = truth(SLOT(ip->a)) ? ip + 1 : program + ip->b;
+        DISPATCH();
+    }
+
+    CASE(JUMPNZ) {
+        ip = truth(SLOT(ip->a)) ? program + ip->b : ip + 1;
+        DISPATCH();
+    }
+
+    CASE(FUNC_BEGIN) {
+        // 顺序执行到函数定义时跳过函数体
+        ip = program + ip->a;
+        DISPATCH();
+    }
+
+    CASE(PARAM) {
+        pendingArgs.push_back(SLOT(ip->a));
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(CALL) {
+        const Function& callee = functions[ip->a];
+        if (callStack.size() >= MAX_CALL_DEPTH) runtimeError("调用栈溢出 (递归过深)");
+
+        size_t calleeBase = base + frameSize;
+        size_t needed = calleeBase + callee.frameSize;
+        if (needed > stack.size()) {
+            stack.resize(max(needed, stack.size() * 2));
+            fp = stack.data() + base;
+        }
+        Value* calleeFp = stack.data() + calleeBase;
+        fill(calleeFp, calleeFp + callee.frameSize, Value{});
+
+        // 实参从右往左压入，栈顶是第一个实参
+        size_t argc = min(static_cast<size_t>(ip->b), pendingArgs.size());
+        size_t top = pendingArgs.size();
+        for (size_t k = 0; k < argc && k < callee.paramSlots.size(); ++k) {
+            int32_t s = callee.paramSlots[k];
+            (s >= 0 ? calleeFp[s] : st[~s]) = pendingArgs[top - 1 - k];
+        }
+        pendingArgs.resize(top - argc);
+
+        callStack.push_back(CallFrame{ip + 1, base, frameSize, ip->c});
+        base = calleeBase;
+        frameSize = callee.frameSize;
+        fp = calleeFp;
+        ip = program + callee.entry;
+        DISPATCH();
+    }
+
+    CASE(RETURN) {
+        result = ip->a != NO_SLOT ? SLOT(ip->a) : Value{};
+        goto do_return;
+    }
+
+    CASE(FUNC_END) {
+        // 执行到函数末尾，没有返回值
+        result = Value{};
+    do_return:
+        if (callStack.empty()) goto halt; // 顶层代码里的 return 结束程序
+        {
+            CallFrame caller = callStack.back();
+            callStack.pop_back();
+            base = caller.base;
+            frameSize = caller.frameSize;
+            fp = stack.data() + base;
+            ip = caller.returnIp;
+            if (caller.resultSlot != NO_SLOT) SLOT(caller.resultSlot) = result;
+        }
+        DISPATCH();
+    }
+
+    CASE(PRINT) {
+        printValue(SLOT(ip->a));
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(DEC_ARRAY)
+    CASE(DEC_DYN_ARRAY) {
+        result.type = ValueType::OBJECT;
+        result.object = heap.newArray(SLOT(ip->b));
+        SLOT(ip->a) = result;
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(STORE_AT) {
+        vector<Value>& array = heap.objectOf(SLOT(ip->b));
+        const Value& index = SLOT(ip->c);
+        if (index.type == ValueType::FLOAT || index.i < 0 || static_cast<size_t>(index.i) >= array.size()) {
+            runtimeError("数组下标越界");
+        }
+        array[index.i] = SLOT(ip->a);
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(LOAD_AT) {
+        vector<Value>& array = heap.objectOf(SLOT(ip->b));
+        const Value& index = SLOT(ip->c);
+        if (index.type == ValueType::FLOAT || index.i < 0 || static_cast<size_t>(index.i) >= array.size()) {
+            runtimeError("数组下标越界");
+        }
+        result = array[index.i];
+        SLOT(ip->a) = result;
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(LOAD_MEMBER) {
+        vector<Value>& object = heap.objectOf(SLOT(ip->b));
+        if (static_cast<size_t>(ip->c) >= object.size()) object.resize(ip->c + 1);
+        result = object[ip->c];
+        SLOT(ip->a) = result;
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(STORE_MEMBER) {
+        vector<Value>& object = heap.objectOf(SLOT(ip->b));
+        if (static_cast<size_t>(ip->c) >= object.size()) object.resize(ip->c + 1);
+        object[ip->c] = SLOT(ip->a);
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(LABEL)
+    CASE(GET_PARAM) {
+        // 预解码时已经去掉，不会出现在指令数组里
+        runtimeError("无效的指令");
+    }
+
+#if IR_COMPUTED_GOTO
+    op_HALT:
+#else
+    case OP_HALT:
+        goto halt;
+    default:
+        runtimeError("无效的指令");
+    }
+    }
+#endif
+
+halt:
+#undef CASE
+#undef DISPATCH
+#undef SLOT
+    out.flush();
+    return executed;
+}
@@ -0,0 +1,72 @@
+#ifndef IR_INTERPRETER_H
+#define IR_INTERPRETER_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "quadruple.h"
+#include "runtime_value.h"
+#include "symbol_table.h"
+
+// 四元式解释器: 不经过汇编，直接执行优化后的四元式。
+// 执行前先把四元式预解码成紧凑的指令数组:
+//   标签         换成指令下标，LABEL 和 GET_PARAM 本身不占指令
+//   变量和常量   换成槽位编号: 非负数是当前栈帧里的槽位，负数 (~i) 是静态区里的第 i 项 (全局变量和常量)
+//   函数         换成函数表下标，CALL 时新开栈帧并直接把实参放进形参的槽位
+// 执行时在 GCC/Clang 下用 computed goto 分派，其他编译器退化为 switch。
+// 顶层代码 (函数定义之外的四元式，包括 anchor 主块) 是程序入口。
+
+class IRInterpreter {
+public:
+    IRInterpreter(QuadrupleSpan quads, SymbolTable& st, std::ostream& out = std::cout);
+
+    // 预解码并从顶层代码开始执行，返回执行的指令条数
+    uint64_t execute();
+
+private:
+    // 预解码后的指令，定长 16 字节
+    struct Instr {
+        uint32_t op;      // 解释器内部的操作码 (见 ir_interpreter.cpp)
+        int32_t a, b, c;  // 槽位编号、跳转目标、函数下标或立即数，含义随操作码而定
+    };
+
+    struct Function {
+        NameId name;
+        uint32_t entry = 0;              // 第一条指令的下标
+        int32_t frameSize = 0;           // 栈帧里的槽位数
+        std::vector<int32_t> paramSlots; // 按参数顺序排列的形参槽位
+    };
+
+    // 调用栈上的一项，记录返回后要恢复的状态
+    struct CallFrame {
+        const Instr* returnIp;
+        size_t base;        // 调用者栈帧在值栈中的起点
+        int32_t frameSize;  // 调用者栈帧的大小
+        int32_t resultSlot; // 返回值写到调用者的哪个槽位
+    };
+
+    QuadrupleSpan quadruples;
+    SymbolTable& symbolTable;
+    std::ostream& out;
+
+    std::vector<Instr> code;
+    std::vector<Function> functions;   // functions[0] 是顶层代码
+    std::vector<Value> statics;        // 全局变量和常量
+    std::unordered_map<NameId, int32_t> globalSlots;
+    std::unordered_map<uint64_t, int32_t> constantSlots; // (种类, 拼写) -> 静态区下标
+
+    std::vector<Value> stack;          // 所有栈帧的槽位连续存放
+    std::vector<CallFrame> callStack;
+    std::vector<Value> pendingArgs;    // PARAM 压入、CALL 取走的实参
+
+    RuntimeHeap heap;                  // 数组、结构体和运行时拼接出的字符串
+
+    void preprocess();
+    int32_t slotOf(const Operand& operand, std::unordered_map<NameId, int32_t>& locals, int32_t& frameSize);
+    void printValue(const Value& v);
+};
+
+#endif // IR_INTERPRETER_H
@@ -0,0 +1,164 @@
+#include "jit.h"
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "runtime_value.h"
+#include "x64_assembler.h"
+#include "x64_generator.h"
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define ANCHOR_JIT_SUPPORTED 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+// 一次执行中运行时分配的字符串和数组
+struct JitHeap {
+    deque<string> strings;
+    vector<unique_ptr<int64_t[]>> arrays;
+};
+
+thread_local JitHeap* activeHeap = nullptr;
+
+// 值的类型编码与 X64Generator::printCode 一致: 0 整数, 1 浮点, 2 布尔, 3 字符, 4 字符串,
+// 5 + k 为元素编码是 k 的数组
+void writeNative(ostream& os, int64_t value, int code) {
+    switch (code) {
+        case 0: os << value; break;
+        case 1: {
+            double d;
+            memcpy(&d, &value, sizeof d);
+            os << d;
+            break;
+        }
+        case 2: os << (value ? "true" : "false"); break;
+        case 3: os << static_cast<char>(value); break;
+        case 4: if (value) os << reinterpret_cast<const char*>(value); break;
+        default: {
+            const int64_t* array = reinterpret_cast<const int64_t*>(value);
+            os << '[';
+            for (int64_t k = 0; array && k < array[0]; ++k) {
+                if (k) os << ", ";
+                writeNative(os, array[k + 1], code - 5);
+            }
+            os << ']';
+            break;
+        }
+    }
+}
+
+void rtPrint(int64_t value, int code) {
+    writeNative(cout, value, code);
+    cout << '\n';
+}
+
+const char* rtConcat(int64_t left, int leftCode, int64_t right, int rightCode) {
+    stringstream ss;
+    writeNative(ss, left, leftCode);
+    writeNative(ss, right, rightCode);
+    activeHeap->strings.push_back(ss.str());
+    return activeHeap->strings.back().c_str();
+}
+
+int64_t* rtNewArray(int64_t count) {
+    if (count < 0) runtimeError("数组大小无效");
+    auto block = make_unique<int64_t[]>(static_cast<size_t>(count) + 1); // 清零
+    block[0] = count;
+    activeHeap->arrays.push_back(std::move(block));
+    return activeHeap->arrays.back().get();
+}
+
+int rtStrcmp(const char* a, const char* b) { return strcmp(a ? a : "", b ? b : ""); }
+
+// 错误入口是从生成代码里条件跳转过来的，栈不一定对齐
+#if defined(__GNUC__)
+#define JIT_ERROR_ENTRY [[noreturn]] __attribute__((force_align_arg_pointer)) void
+#else
+#define JIT_ERROR_ENTRY [[noreturn]] void
+#endif
+JIT_ERROR_ENTRY rtErrDiv() { runtimeError("除以零"); }
+JIT_ERROR_ENTRY rtErrIndex() { runtimeError("数组下标越界"); }
+JIT_ERROR_ENTRY rtErrSize() { runtimeError("数组大小无效"); }
+JIT_ERROR_ENTRY rtErrOverflow() { runtimeError("调用栈溢出 (递归过深)"); }
+
+} // namespace
+
+JitProgram::JitProgram(QuadrupleSpan quads, SymbolTable& st)
+    : quadruples(quads), symbolTable(st) {}
+
+JitProgram::~JitProgram() {
+#ifdef ANCHOR_JIT_SUPPORTED
+    if (memory) munmap(memory, mappedSize);
+#endif
+}
+
+bool JitProgram::compile(string& error) {
+#ifdef ANCHOR_JIT_SUPPORTED
+    X64Encoder encoder;
+    X64Generator generator(quadruples, symbolTable);
+    generator.generate(encoder);
+    const pair<const char*, const void*> externals[] = {
+        {"rt_print", reinterpret_cast<const void*>(&rtPrint)},
+        {"rt_concat", reinterpret_cast<const void*>(&rtConcat)},
+        {"rt_new_array", reinterpret_cast<const void*>(&rtNewArray)},
+        {"rt_strcmp", reinterpret_cast<const void*>(&rtStrcmp)},
+        {"rt_err_div", reinterpret_cast<const void*>(&rtErrDiv)},
+        {"rt_err_index", reinterpret_cast<const void*>(&rtErrIndex)},
+        {"rt_err_size", reinterpret_cast<const void*>(&rtErrSize)},
+        {"rt_err_overflow", reinterpret_cast<const void*>(&rtErrOverflow)},
+    };
+    for (const auto& [name, address] : externals) encoder.defineExternal(name, address);
+
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    vector<uint8_t> image;
+    size_t dataOffset = 0;
+    if (!encoder.link(pageSize, image, dataOffset, error)) return false;
+    if (!encoder.labelOffset("main", entry)) {
+        error = "找不到顶层代码的入口";
+        return false;
+    }
+
+    // 先可写地映射并复制进去，再把代码页改成只读可执行
+    size_t size = (image.size() + pageSize - 1) / pageSize * pageSize;
+    void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) {
+        error = "无法分配可执行内存";
+        return false;
+    }
+    memcpy(mapped, image.data(), image.size());
+    if (mprotect(mapped, dataOffset, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mapped, size);
+        error = "无法设置代码页为可执行";
+        return false;
+    }
+    if (memory) munmap(memory, mappedSize);
+    memory = mapped;
+    mappedSize = size;
+    codeBytes = encoder.codeSize();
+    return true;
+#else
+    (void)quadruples;
+    (void)symbolTable;
+    error = "JIT 只支持 x86-64 上的类 Unix 系统";
+    return false;
+#endif
+}
+
+void JitProgram::run() {
+    if (!memory) return;
+    JitHeap heap;
+    activeHeap = &heap;
+    auto topLevel = reinterpret_cast<int (*)()>(static_cast<uint8_t*>(memory) + entry);
+    topLevel();
+    cout.flush();
+    activeHeap = nullptr;
+}
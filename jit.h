@@ -0,0 +1,40 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "quadruple.h"
+#include "symbol_table.h"
+
+// JIT 执行: 与 X64Generator 生成汇编文本用的是同一套指令选择和寄存器分配，
+// 只是指令交给 X64Encoder 直接编码成机器码，链接后放进 mmap 的内存里在进程内执行，
+// 不需要经过 output.s 和外部汇编器。
+// 内存布局为 [代码 | 外部函数跳板 | 数据]，代码页映射为只读可执行，数据页 (字符串字面量、全局变量) 可读写。
+// 运行时 (输出、字符串拼接、数组分配、运行时错误) 是本模块里的 C++ 函数，输出写到 std::cout，
+// 与解释器的格式和错误信息一致。只支持 x86-64 上的类 Unix 系统 (System V 调用约定)。
+class JitProgram {
+public:
+    JitProgram(QuadrupleSpan quads, SymbolTable& st);
+    ~JitProgram();
+    JitProgram(const JitProgram&) = delete;
+    JitProgram& operator=(const JitProgram&) = delete;
+
+    // 生成并映射机器码，失败时 error 为原因
+    bool compile(std::string& error);
+    // 执行顶层代码，运行期间分配的字符串和数组在返回前释放
+    void run();
+
+    size_t codeSize() const { return codeBytes; }
+
+private:
+    QuadrupleSpan quadruples;
+    SymbolTable& symbolTable;
+    void* memory = nullptr; // 映射的内存
+    size_t mappedSize = 0;
+    size_t codeBytes = 0;   // 生成的指令字节数 (不含跳板和数据)
+    size_t entry = 0;       // 顶层代码在映射内存中的偏移
+};
+
+#endif // JIT_H
@@ -10,24 +10,147 @@
 #include "token.h"
 #include "symbol_table.h"
 #include "scanner.h"
+#include "parallel_lexer.h"
+#include "thread_pool.h"
+#include "arena.h"
 #include "ast_nodes.h"
+#include "flat_ast.h"
 #include "parser.h"
 #include "quadruple.h"
 #include "ir_generator.h"
 #include "optimizer.h"
 #include "code_generator.h"
+#include "ir_interpreter.h"
+#include "bytecode.h"
+#include "vm.h"
+#include "x64_generator.h"
+#include "jit.h"
+#include "aqir.h"
 #include "tinyfiledialogs.h"
 using namespace std;
 
 #define MY_SOURCE_NAME "test/test_ir_correct.anchor"
+#define MY_IR_NAME "output.aqir"
+
+// 中间代码优化和目标代码生成，四元式可以来自 IRGenerator，也可以直接来自映射的 .aqir 文件。
+// useVM 为真时改用字节码后端，生成寄存器式字节码并在虚拟机上执行；
+// useJit 为真时把 x86-64 机器码直接生成到内存里并在进程内执行；
+// useX64 为真时生成 x86-64 (System V) 的 GAS 汇编，否则生成 16 位 MASM 汇编；
+// interpret 为真时再用解释器直接执行优化后的四元式。
+// 优化和 MASM 汇编的生成按函数在线程池里并行进行
+static int runBackend(QuadrupleSpan quadruples, SymbolTable& symbolTable, ThreadPool& threadPool, bool interpret,
+                      bool useVM, bool useX64, bool useJit) {
+    // 5. 中间代码优化阶段
+    std::cout << "\n[阶段 4: 中间代码优化]" << std::endl;
+    Optimizer optimizer(quadruples, symbolTable, &threadPool);
+    std::vector<Quadruple> optimizedQuads = optimizer.optimize();
 
-int main(int argc, char* argv[]) {
-    initializeKeywordMap();
-    initializeOperatorMap();
+    std::cout << "--- 优化后的四元式 ---" << std::endl;
+    for (size_t i = 0; i < optimizedQuads.size(); ++i) {
+        cout << i << ":\t" << optimizedQuads[i].toString() << endl;
+    }
+    cout << "--- 四元式结束 ---" << endl;
+
+    if (useVM) {
+        std::cout << "\n[阶段 5: 字节码生成]" << std::endl;
+        BytecodeProgram bytecode = lowerToBytecode(optimizedQuads, symbolTable);
+        std::cout << "--- 生成的字节码 ---" << std::endl;
+        bytecode.dump(std::cout);
+        std::cout << "--- 字节码结束 ---" << std::endl;
+
+        std::cout << "\n[阶段 6: 虚拟机执行]" << std::endl;
+        VirtualMachine vm(bytecode);
+        uint64_t steps = vm.run();
+        std::cout << "--- 虚拟机执行结束, 共执行 " << steps << " 条指令 ---" << std::endl;
+    } else if (useJit) {
+        std::cout << "\n[阶段 5: JIT 编译 (x86-64)]" << std::endl;
+        JitProgram jit(optimizedQuads, symbolTable);
+        std::string error;
+        if (!jit.compile(error)) {
+            std::cerr << "JIT 编译失败: " << error << std::endl;
+            return 1;
+        }
+        std::cout << "生成了 " << jit.codeSize() << " 字节的机器码" << std::endl;
+
+        std::cout << "\n[阶段 6: JIT 执行]" << std::endl;
+        jit.run();
+        std::cout << "--- JIT 执行结束 ---" << std::endl;
+    } else {
+        // 目标代码生成阶段
+        std::cout << "\n[阶段 5: 目标代码生成" << (useX64 ? " (x86-64)" : "") << "]" << std::endl;
+        // 使用优化后的四元式序列！
+        std::string assemblyCode;
+        if (useX64) {
+            X64Generator x64Gen(optimizedQuads, symbolTable);
+            assemblyCode = x64Gen.generate();
+        } else {
+            CodeGenerator codeGen(optimizedQuads, symbolTable, &threadPool);
+            assemblyCode = codeGen.generate();
+        }
+
+        std::cout << "--- 生成的 x86 汇编代码 ---" << std::endl;
+        //std::cout << assemblyCode << std::endl;
+        std::cout << "--- 汇编代码结束 ---" << std::endl;
+
+        std::ofstream outFile("output.s");
+        if(outFile.is_open()){
+            outFile << assemblyCode;
+            outFile.close();
+            std::cout << "汇编代码已保存到 output.s 文件中。" << std::endl;
+            if (useX64) std::cout << "可用 gcc -o program output.s 汇编链接。" << std::endl;
+        }
+    }
+
+    if (interpret) {
+        std::cout << "\n[阶段 " << (useVM || useJit ? 7 : 6) << ": 解释执行]" << std::endl;
+        IRInterpreter interpreter(optimizedQuads, symbolTable);
+        uint64_t steps = interpreter.execute();
+        std::cout << "--- 解释执行结束, 共执行 " << steps << " 条指令 ---" << std::endl;
+    }
+
+    std::cout << "\nAnchor 编译器所有阶段执行完毕。" << std::endl;
+    return 0;
+}
 
+int main(int argc, char* argv[]) {
     std::cout << "Anchor 编译器 - 目标代码生成模式" << std::endl;
     std::cout << "======================================" << std::endl;
 
+    // 命令行参数: [文件.aqir] [--run] [--vm] [--x64] [--jit]
+    const char* irPath = nullptr;
+    bool interpret = false;
+    bool useVM = false;
+    bool useX64 = false;
+    bool useJit = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--run") {
+            interpret = true;
+        } else if (std::string(argv[i]) == "--vm") {
+            useVM = true;
+        } else if (std::string(argv[i]) == "--x64") {
+            useX64 = true;
+        } else if (std::string(argv[i]) == "--jit") {
+            useJit = true;
+        } else if (std::filesystem::path(argv[i]).extension() == ".aqir") {
+            irPath = argv[i];
+        }
+    }
+
+    // 大文件的词法分析、按函数的优化和代码生成共用这个线程池
+    ThreadPool threadPool;
+
+    // 命令行给出 .aqir 文件时跳过词法、语法和语义分析，直接从映射的中间代码继续
+    if (irPath) {
+        SymbolTable symbolTable;
+        AqirFile irFile;
+        if (!irFile.open(irPath, symbolTable)) {
+            return 1;
+        }
+        std::cout << "从 " << irPath << " 加载了 " << irFile.quadruples().size() << " 条四元式, "
+                  << irFile.functions().size() << " 个函数" << std::endl;
+        return runBackend(irFile.quadruples(), symbolTable, threadPool, interpret, useVM, useX64, useJit);
+    }
+
     // 1. 获取源文件
     std::string sourceFilename;
     // 提供交互式选择
@@ -71,72 +194,47 @@ int main(int argc, char* argv[]) {
     // 2. 词法分析
     std::cout << "\n[阶段 1.5: 词法分析测试]" << std::endl;
     std::cout << "--- 扫描到的 Tokens ---" << std::endl;
-    Scanner testScanner(sourceFilename);
-    int tokenCount = 0;
-    while (true) {
-        Token token = testScanner.getNextToken();
+    // 只扫描一遍: Token 数组既用于这里的输出，也直接交给语法分析器 (大文件分块并行扫描)
+    Scanner scanner(sourceFilename);
+    TokenArray tokens = tokenizeParallel(scanner, threadPool);
+    for (size_t i = 0; i < tokens.size(); ++i) {
         // 对输出进行格式化，使其更易读
-        std::cout << "Token #" << ++tokenCount << "\t"
-                  << "行: " << token.line << ",\t"
-                  << "类型: " << tokenTypeToString(token.type) << ",\t"
-                  << "词素: '" << token.lexeme << "'" << std::endl;
-        if (token.type == TokenType::END_OF_FILE) {
-            break;
-        }
+        std::cout << "Token #" << i + 1 << "\t"
+                  << "行: " << tokens.lines[i] << ",\t"
+                  << "类型: " << tokenTypeToString(tokens.types[i]) << ",\t"
+                  << "词素: '" << tokens.lexeme(i) << "'" << std::endl;
     }
     std::cout << "--- 词法分析测试结束 ---" << std::endl;
 
 
     // 3. 语法分析
-    Scanner mainScanner(sourceFilename);
+    // 解析出的指针 AST 分配在 astArena 中，压平成 FlatAST 后整块释放
     SymbolTable symbolTable;
-    Parser parser(mainScanner, symbolTable);
-    std::unique_ptr<ProgramNode> astRoot = parser.parse();
-
-    if (!astRoot) {
-        std::cerr << "语法分析失败, 终止编译。" << std::endl;
-        return 1;
+    FlatAST ast;
+    {
+        Arena astArena;
+        Parser parser(tokens, symbolTable, astArena);
+        ProgramNode* astRoot = parser.parse();
+
+        if (!astRoot) {
+            std::cerr << "语法分析失败, 终止编译。" << std::endl;
+            return 1;
+        }
+        ast = flattenAST(astRoot);
     }
     std::cout << "\n[阶段 2: 语法分析] - AST 生成成功" << std::endl;
-    astRoot->print(0);
+    ast.print(ast.root(), 0);
 
 
     // 4. 语义分析与IR生成
-    IRGenerator irGenerator(std::move(astRoot), symbolTable);
+    IRGenerator irGenerator(ast, symbolTable);
     irGenerator.generate();
     const auto& quadruples = irGenerator.getQuadruples();
     std::cout << "\n[阶段 3: 中间代码生成] - 原始四元式" << std::endl;
     irGenerator.dumpQuadruples();
-
-
-    // 5. 中间代码优化阶段
-    std::cout << "\n[阶段 4: 中间代码优化]" << std::endl;
-    Optimizer optimizer(quadruples, symbolTable);
-    std::vector<Quadruple> optimizedQuads = optimizer.optimize();
-
-    std::cout << "--- 优化后的四元式 ---" << std::endl;
-    for (size_t i = 0; i < optimizedQuads.size(); ++i) {
-        cout << i << ":\t" << optimizedQuads[i].toString() << endl;
-    }
-    cout << "--- 四元式结束 ---" << endl;
-
-    // 目标代码生成阶段
-    std::cout << "\n[阶段 5: 目标代码生成]" << std::endl;
-    // 使用优化后的四元式序列！
-    CodeGenerator codeGen(optimizedQuads, symbolTable);
-    std::string assemblyCode = codeGen.generate();
-
-    std::cout << "--- 生成的 x86 汇编代码 ---" << std::endl;
-    //std::cout << assemblyCode << std::endl;
-    std::cout << "--- 汇编代码结束 ---" << std::endl;
-
-    std::ofstream outFile("output.s");
-    if(outFile.is_open()){
-        outFile << assemblyCode;
-        outFile.close();
-        std::cout << "汇编代码已保存到 output.s 文件中。" << std::endl;
+    if (writeAqir(MY_IR_NAME, quadruples, symbolTable)) {
+        std::cout << "中间代码已保存到 " << MY_IR_NAME << " 文件中。" << std::endl;
     }
 
-    std::cout << "\nAnchor 编译器所有阶段执行完毕。" << std::endl;
-    return 0;
+    return runBackend(quadruples, symbolTable, threadPool, interpret, useVM, useX64, useJit);
 }
@@ -1,48 +1,58 @@
 #include "optimizer.h"
+#include "bit_vector.h"
+#include "inliner.h"
+#include "ssa.h"
+#include "thread_pool.h"
 #include <map>
 #include <iostream>
 #include <algorithm>
 #include <sstream>
+#include <optional>
 #include <functional>
 #include <set>
 #include <list>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace std;
 
-// 检查字符串是否是数字
-bool is_numeric(const std::string& s) {
-    if (s.empty() || s.front() == '"' || s.front() == '\'') return false;
-    char* end = nullptr;
-    strtod(s.c_str(), &end); //从字符串开头开始解析，知道遇到无法解析的数字，讲字符地址存放在end中
-    return end != s.c_str() && *end == '\0'; //当至少解析了一个字符或者只想末尾，则字符串被解析成数字
+namespace {
+
+// 操作数 (种类, 名字) 压成一个整数，作散列表的键
+uint64_t operand_key(const Operand& o) {
+    return (static_cast<uint64_t>(o.kind) << 32) | o.name;
 }
 
-// 判断一个变量名是否为临时变量
-bool is_temporary_var(const std::string& s) {
-    if (s.length() > 1 && s[0] == 'T') {
-        for (size_t i = 1; i < s.length(); ++i) {
-            if (!isdigit(s[i])) return false;
-        }
-        return true;
+// DAG 内部节点的散列键，一元运算的右子节点编号为 -1
+struct NodeKey {
+    Opcode op;
+    int left, right;
+    bool operator==(const NodeKey& other) const { return op == other.op && left == other.left && right == other.right; }
+};
+
+struct NodeKeyHash {
+    size_t operator()(const NodeKey& k) const {
+        uint64_t h = static_cast<uint64_t>(k.op);
+        h = h * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(k.left);
+        h = h * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(k.right);
+        return static_cast<size_t>(h ^ (h >> 29));
     }
-    return false;
-}
+};
 
-// 判断一个字符串是否为变量
-bool Optimizer::is_variable(const std::string& s) {
-    if (s.empty() || s == "_") return false;
-    return !is_numeric(s) && s.front() != '"' && s.front() != '\'';
-}
+} // namespace
 
 // 构造函数
-Optimizer::Optimizer(const std::vector<Quadruple>& quads, SymbolTable& st)
-    : input_quads(quads), symbol_table(st) {}
+Optimizer::Optimizer(QuadrupleSpan quads, SymbolTable& st, ThreadPool* threadPool)
+    : input_quads(quads), symbol_table(st), pool(threadPool), log(cout) {}
+
+Optimizer::Optimizer(QuadrupleSpan quads, SymbolTable& st, const unordered_set<NameId>& g, ostream& out)
+    : input_quads(quads), symbol_table(st), globals(g), log(out) {}
 
 // 主优化函数，协调所有步骤
 vector<Quadruple> Optimizer::optimize() {
     if (input_quads.empty()) return {};
 
-    // 步骤 1 & 2: 划分基本块、构建CFG和进行活跃变量分析
     const auto& all_symbols = symbol_table.getAllSymbols();//符号表中获取所有的符号
     for (const auto& [name, symbol] : all_symbols) {
         if (symbol.category == SymbolCategory::Variable && symbol.scopeLevel == 0) {
@@ -50,12 +60,87 @@ vector<Quadruple> Optimizer::optimize() {
         }
     }
 
+    // 先内联小的叶子函数，之后的全局优化和局部优化都在内联后的序列上进行
+    inlined_quads = Inliner(input_quads, symbol_table, globals).run();
+
+    // 之后各单元互不影响: 每个函数是一个单元，函数定义之外的顶层代码按原顺序接起来是一个单元
+    // (顶层代码顺序执行时本来就跳过函数体，接起来不改变语义)。有线程池时各单元并行优化，
+    // 函数单元用自己的临时变量和标签编号，日志先写进各自的缓冲；结果和日志都按单元在输入中首次出现的顺序拼接
+    vector<vector<Quadruple>> units;
+    vector<NameId> unit_function; // 单元所属的函数，顶层代码为 NAME_NONE
+    size_t top_level = SIZE_MAX;
+    for (size_t i = 0; i < inlined_quads.size(); ++i) {
+        if (inlined_quads[i].op == Opcode::FUNC_BEGIN) {
+            NameId function = inlined_quads[i].arg1.name;
+            units.emplace_back();
+            unit_function.push_back(function);
+            for (; i < inlined_quads.size(); ++i) {
+                units.back().push_back(inlined_quads[i]);
+                if (inlined_quads[i].op == Opcode::FUNC_END && inlined_quads[i].arg1.name == function) break;
+            }
+            continue;
+        }
+        if (top_level == SIZE_MAX) {
+            top_level = units.size();
+            units.emplace_back();
+            unit_function.push_back(NAME_NONE);
+        }
+        units[top_level].push_back(inlined_quads[i]);
+    }
+
+    vector<vector<Quadruple>> results(units.size());
+    vector<ostringstream> logs(units.size());
+    auto optimize_one = [&](size_t k) {
+        optional<SymbolTable::FunctionNames> names;
+        if (unit_function[k] != NAME_NONE) names.emplace(symbol_table, unit_function[k]);
+        Optimizer unit(units[k], symbol_table, globals, logs[k]);
+        results[k] = unit.optimize_unit();
+    };
+    if (pool && units.size() > 1) {
+        pool->parallelFor(units.size(), optimize_one);
+    } else {
+        for (size_t k = 0; k < units.size(); ++k) optimize_one(k);
+    }
+
+    optimized_quads.clear();
+    for (size_t k = 0; k < units.size(); ++k) {
+        log << logs[k].str();
+        optimized_quads.insert(optimized_quads.end(), results[k].begin(), results[k].end());
+    }
+    return optimized_quads;
+}
+
+// 优化一个单元 (一个函数，或全部顶层代码)
+vector<Quadruple> Optimizer::optimize_unit() {
     divide_into_basic_blocks();
-    cout << "--- 已将四元式划分为 " << basic_blocks.size() << " 个基本块 ---" << endl;
+    log << "--- 已将四元式划分为 " << basic_blocks.size() << " 个基本块 ---" << endl;
 
     build_cfg_and_compute_use_def();//构建控制流图，计算基本块的use和def集合
     run_liveness_analysis();//活跃变量分析
 
+    // 全局优化: 在 SSA 形式上先做稀疏条件常量传播，再反复做常量/复写传播、值编号、循环不变代码外提、
+    // 强度削弱和死代码删除直到不再变化，转换回来 (同时删除不可达的块) 后重新划分基本块
+    {
+        SsaForm ssa(basic_blocks, globals, symbol_table, log);
+        ssa.construct();
+        ssa.propagateConditionalConstants();
+        bool changed = true;
+        while (changed) {
+            changed = ssa.propagate();
+            changed = ssa.numberValues() || changed;
+            changed = ssa.hoistLoopInvariants() || changed;
+            changed = ssa.reduceStrength() || changed;
+            changed = ssa.eliminateDeadCode() || changed;
+        }
+        global_quads = ssa.destruct();
+    }
+    input_quads = global_quads;
+    basic_blocks.clear();
+    divide_into_basic_blocks();
+    build_cfg_and_compute_use_def();
+    run_liveness_analysis();
+    log << "--- 全局优化后重新划分为 " << basic_blocks.size() << " 个基本块 ---" << endl;
+
     // 步骤 3: 对每个基本块进行“原地”优化
     // 这个循环只负责调用优化，不产生最终列表
     for (auto& block : basic_blocks) {
@@ -68,18 +153,37 @@ vector<Quadruple> Optimizer::optimize() {
         assembled_quads.insert(assembled_quads.end(), block.quads.begin(), block.quads.end());
     }
 
-    // 步骤 5: 在组装好的、顺序正确的列表上进行死标签移除
-    set<string> used_labels;
+    // 步骤 5: 在组装好的、顺序正确的列表上移除跳到紧随其后的标签的 JUMP，再进行死标签移除
+    vector<Quadruple> jumps_removed;
+    for (size_t i = 0; i < assembled_quads.size(); ++i) {
+        const auto& q = assembled_quads[i];
+        if (q.op == Opcode::JUMP) {
+            size_t next = i + 1;
+            while (next < assembled_quads.size() && assembled_quads[next].op == Opcode::LABEL &&
+                   assembled_quads[next].arg1.name != q.res.name) ++next;
+            if (next < assembled_quads.size() && assembled_quads[next].op == Opcode::LABEL) {
+                log << "  [移除多余跳转] " << q.toString() << endl;
+                continue;
+            }
+        }
+        jumps_removed.push_back(q);
+    }
+    assembled_quads = std::move(jumps_removed);
+
+    unordered_set<NameId> used_labels;
     for(const auto& q : assembled_quads) {
-        if(q.op == "JUMP" || q.op == "JUMPF" || q.op == "JUMPNZ") {
-            used_labels.insert(q.res);
+        switch (q.op) {
+            case Opcode::JUMP: case Opcode::JUMPF: case Opcode::JUMPNZ:
+                used_labels.insert(q.res.name);
+                break;
+            default: break;
         }
     }
 
     optimized_quads.clear();
     for(const auto& q : assembled_quads) {
-        if(q.op == "LABEL" && used_labels.find(q.arg1) == used_labels.end()) {
-            cout << "  [移除未使用标签] " << q.arg1 << endl;
+        if(q.op == Opcode::LABEL && used_labels.find(q.arg1.name) == used_labels.end()) {
+            log << "  [移除未使用标签] " << q.arg1.str() << endl;
             continue;
         }
         optimized_quads.push_back(q);
@@ -88,30 +192,45 @@ vector<Quadruple> Optimizer::optimize() {
     return optimized_quads;
 }
 
+const vector<BasicBlock>& Optimizer::analyzeLiveness() {
+    basic_blocks.clear();
+    if (input_quads.empty()) return basic_blocks;
+
+    divide_into_basic_blocks();
+    build_cfg_and_compute_use_def();
+    run_liveness_analysis();
+    return basic_blocks;
+}
+
 // 1. 划分基本块
 void Optimizer::divide_into_basic_blocks() {
     set<size_t> leaders; //无符号长整型
     leaders.insert(0);
 
-    map<string, size_t> label_to_index;
+    unordered_map<NameId, size_t> label_to_index;
     for (size_t i = 0; i < input_quads.size(); ++i) {
-        if (input_quads[i].op == "LABEL") {
-            label_to_index[input_quads[i].arg1] = i;
+        if (input_quads[i].op == Opcode::LABEL) {
+            label_to_index[input_quads[i].arg1.name] = i;
         }
     }
 
     for (size_t i = 0; i < input_quads.size(); ++i) {
         const auto& q = input_quads[i];
-        string op = q.op;
-        if (op == "JUMP" || op == "JUMPF" || op == "RETURN" || op == "CALL" || op == "FUNC_END") {
-            if (op == "JUMP" || op == "JUMPF") {//如果是跳转指令，那就讲索引加入leaders集合
-                if (label_to_index.count(q.res)) {
-                    leaders.insert(label_to_index.at(q.res));
+        switch (q.op) {
+            case Opcode::FUNC_BEGIN: // 函数入口总是新基本块的开始
+                leaders.insert(i);
+                break;
+            case Opcode::JUMP: case Opcode::JUMPF: case Opcode::JUMPNZ://如果是跳转指令，那就讲索引加入leaders集合
+                if (label_to_index.count(q.res.name)) {
+                    leaders.insert(label_to_index.at(q.res.name));
                 }
-            }
-            if (i + 1 < input_quads.size()) {//如果接下来的指令也是入口，那就将索引加入leaders集合
-                leaders.insert(i + 1);
-            }
+                // fallthrough
+            case Opcode::RETURN: case Opcode::CALL: case Opcode::FUNC_END:
+                if (i + 1 < input_quads.size()) {//如果接下来的指令也是入口，那就将索引加入leaders集合
+                    leaders.insert(i + 1);
+                }
+                break;
+            default: break;
         }
     }
 
@@ -132,10 +251,19 @@ void Optimizer::divide_into_basic_blocks() {
 
 // 2. 构建CFG并计算use/def集：从后往前
 void Optimizer::build_cfg_and_compute_use_def() {
-    map<string, int> label_to_block_id; //label和id的映射表
+    unordered_map<NameId, int> label_to_block_id; //label和id的映射表
+    // 顺序执行时的下一个基本块: 顶层代码遇到函数定义会跳过整个函数体
+    auto fallthrough_block = [&](size_t i) {
+        size_t next = i + 1;
+        while (next < basic_blocks.size() && basic_blocks[next].quads.front().op == Opcode::FUNC_BEGIN) {
+            while (next < basic_blocks.size() && basic_blocks[next].quads.back().op != Opcode::FUNC_END) ++next;
+            ++next;
+        }
+        return next;
+    };
     for (size_t i = 0; i < basic_blocks.size(); ++i) {
-        if (!basic_blocks[i].quads.empty() && basic_blocks[i].quads[0].op == "LABEL") {
-            label_to_block_id[basic_blocks[i].quads[0].arg1] = basic_blocks[i].id;
+        if (!basic_blocks[i].quads.empty() && basic_blocks[i].quads[0].op == Opcode::LABEL) {
+            label_to_block_id[basic_blocks[i].quads[0].arg1.name] = basic_blocks[i].id;
         }
     }
 
@@ -143,326 +271,395 @@ void Optimizer::build_cfg_and_compute_use_def() {
         auto& block = basic_blocks[i];
         for (auto it = block.quads.rbegin(); it != block.quads.rend(); ++it) {
             const auto& q = *it;
-            if (is_variable(q.res)) {//如果指令结果是一个变量，证明指令定义了变量
-                block.use.erase(q.res);//如果指令存在，那就会被从use里抹掉
-                block.def.insert(q.res);//并且在def集增加
+            const Operand def = quadDef(q);
+            if (def.isVariable()) {//指令定义了变量
+                block.use.erase(def);//如果指令存在，那就会被从use里抹掉
+                block.def.insert(def);//并且在def集增加
             }
-            if (is_variable(q.arg1)) block.use.insert(q.arg1);//如果操作数是变量，就证明被use了
-            if (is_variable(q.arg2)) block.use.insert(q.arg2);//同理
+            Operand uses[3];
+            int use_count = quadUses(q, uses);
+            block.use.insert(uses, uses + use_count);//读取的变量被use了
         }
 
         if (block.quads.empty()) continue;
         const auto& last_quad = block.quads.back();
-        if (last_quad.op == "JUMP") {
-            if (label_to_block_id.count(last_quad.res)) { //跳转到唯一的后继
-                block.successors.push_back(label_to_block_id.at(last_quad.res));
-            }
-        } else if (last_quad.op == "JUMPF") {
-            if (label_to_block_id.count(last_quad.res)) {//要么跳转到目标的基本快
-                block.successors.push_back(label_to_block_id.at(last_quad.res));
-            }
-            if (i + 1 < basic_blocks.size()) {//要么顺序执行下一个
-                block.successors.push_back(basic_blocks[i+1].id);
-            }
-        } else if (last_quad.op != "RETURN" && last_quad.op != "FUNC_END") {
-            if (i + 1 < basic_blocks.size()) {
-                block.successors.push_back(basic_blocks[i+1].id);
-            }
+        switch (last_quad.op) {
+            case Opcode::JUMP:
+                if (label_to_block_id.count(last_quad.res.name)) { //跳转到唯一的后继
+                    block.successors.push_back(label_to_block_id.at(last_quad.res.name));
+                }
+                break;
+            case Opcode::JUMPF: case Opcode::JUMPNZ:
+                if (label_to_block_id.count(last_quad.res.name)) {//要么跳转到目标的基本快
+                    block.successors.push_back(label_to_block_id.at(last_quad.res.name));
+                }
+                if (size_t next = fallthrough_block(i); next < basic_blocks.size()) {//要么顺序执行下一个
+                    block.successors.push_back(basic_blocks[next].id);
+                }
+                break;
+            case Opcode::RETURN: case Opcode::FUNC_END:
+                break;
+            default:
+                if (size_t next = fallthrough_block(i); next < basic_blocks.size()) {
+                    block.successors.push_back(basic_blocks[next].id);
+                }
         }
     }
-    //通过后继successors来填充predecessors
-    for(size_t i = 0; i < basic_blocks.size(); ++i) {
-        for(int successor_id : basic_blocks[i].successors) {
-            for(auto& b : basic_blocks) {
-                if(b.id == successor_id) {
-                    b.predecessors.push_back(basic_blocks[i].id);
-                    break;
-                }
-            }
+    //通过后继successors来填充predecessors，块的 id 就是它在 basic_blocks 中的下标
+    for (const auto& block : basic_blocks) {
+        for (int successor_id : block.successors) {
+            basic_blocks[successor_id].predecessors.push_back(block.id);
         }
     }
 }
 
 // 3. 运行活跃变量分析
-void Optimizer::run_liveness_analysis() {//迭代到集合不变为止
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        for (int i = basic_blocks.size() - 1; i >= 0; --i) {
-            auto& block = basic_blocks[i];
-            set<string> new_out;
-            for (int succ_id : block.successors) {
-                 for(const auto& b : basic_blocks) {
-                    if (b.id == succ_id) { //一个块的出口活跃变量是后继入口活跃变量集合
-                         new_out.insert(b.live_in.begin(), b.live_in.end());
-                         break;
-                    }
-                 }
-            }
+// 变量编成稠密下标，集合用位向量表示。工作表按 CFG 的后序 (即反向 CFG 的逆后序) 初始化，
+// 块的入口集合变化时只把它的前驱重新放回工作表。集合只增不减，出口集合直接并上后继的入口集合即可
+void Optimizer::run_liveness_analysis() {
+    const size_t n = basic_blocks.size();
+    unordered_map<uint64_t, size_t> index; // (种类, 名字) -> 下标
+    vector<Operand> variables;
+    auto index_of = [&](const Operand& v) {
+        auto [it, inserted] = index.try_emplace(operand_key(v), variables.size());
+        if (inserted) variables.push_back(v);
+        return it->second;
+    };
+    for (const auto& block : basic_blocks) {
+        for (const auto& v : block.use) index_of(v);
+        for (const auto& v : block.def) index_of(v);
+    }
+    const size_t m = variables.size();
+    vector<BitVector> use(n, BitVector(m)), def(n, BitVector(m)), live_in(n, BitVector(m)), live_out(n, BitVector(m));
+    for (size_t b = 0; b < n; ++b) {
+        for (const auto& v : basic_blocks[b].use) use[b].set(index_of(v));
+        for (const auto& v : basic_blocks[b].def) def[b].set(index_of(v));
+    }
 
-            if(new_out != block.live_out){
-                block.live_out = new_out;
-                changed = true;
+    // 非递归的深度优先搜索求后序，每个块都作为一次起点，不可达的块也参与计算
+    vector<int> postorder;
+    postorder.reserve(n);
+    vector<char> visited(n, 0);
+    vector<pair<int, size_t>> stack;
+    for (size_t root = 0; root < n; ++root) {
+        if (visited[root]) continue;
+        visited[root] = 1;
+        stack.emplace_back(static_cast<int>(root), 0);
+        while (!stack.empty()) {
+            auto& [b, next] = stack.back();
+            const auto& successors = basic_blocks[b].successors;
+            if (next < successors.size()) {
+                int s = successors[next++];
+                if (!visited[s]) {
+                    visited[s] = 1;
+                    stack.emplace_back(s, 0);
+                }
+            } else {
+                postorder.push_back(b);
+                stack.pop_back();
             }
+        }
+    }
 
-            set<string> new_in = block.use;
-            set<string> out_minus_def = block.live_out;
-            for (const auto& var : block.def) {
-                out_minus_def.erase(var);
+    deque<int> worklist(postorder.begin(), postorder.end());
+    vector<char> queued(n, 1);
+    while (!worklist.empty()) {
+        int b = worklist.front();
+        worklist.pop_front();
+        queued[b] = 0;
+        for (int s : basic_blocks[b].successors) live_out[b].unite(live_in[s]);
+        if (!live_in[b].assignTransfer(use[b], live_out[b], def[b])) continue;
+        for (int p : basic_blocks[b].predecessors) {
+            if (!queued[p]) {
+                queued[p] = 1;
+                worklist.push_back(p);
             }
-            new_in.insert(out_minus_def.begin(), out_minus_def.end());
+        }
+    }
 
-            if (new_in != block.live_in) {
-                block.live_in = new_in;
-                changed = true;
-            }
+    // 写回各块的集合，供局部优化和后端使用
+    for (size_t b = 0; b < n; ++b) {
+        auto& block = basic_blocks[b];
+        block.live_in.clear();
+        block.live_out.clear();
+        live_in[b].forEach([&](size_t v) { block.live_in.insert(variables[v]); });
+        live_out[b].forEach([&](size_t v) { block.live_out.insert(variables[v]); });
+    }
+}
+
+// 常量折叠: 两个整数按整数运算 (除法向零取整)，否则按浮点运算。不能折叠 (如除以零) 时返回 false
+bool fold_constants(Opcode op, const Operand& a, const Operand& b, Operand& result) {
+    if (a.kind == OperandKind::INT && b.kind == OperandKind::INT) {
+        uint64_t x = static_cast<uint64_t>(a.intValue), y = static_cast<uint64_t>(b.intValue);
+        int64_t r = 0;
+        switch (op) {
+            case Opcode::ADD: r = static_cast<int64_t>(x + y); break;
+            case Opcode::SUB: r = static_cast<int64_t>(x - y); break;
+            case Opcode::MUL: r = static_cast<int64_t>(x * y); break;
+            case Opcode::DIV:
+                if (b.intValue == 0 || b.intValue == -1) return false;
+                r = a.intValue / b.intValue;
+                break;
+            case Opcode::MOD:
+                if (b.intValue == 0 || b.intValue == -1) return false;
+                r = a.intValue % b.intValue;
+                break;
+            default: return false;
         }
+        result = Operand::intImm(r);
+        return true;
+    }
+
+    double v1 = a.numericValue(), v2 = b.numericValue(), r = 0;
+    switch (op) {
+        case Opcode::ADD: r = v1 + v2; break;
+        case Opcode::SUB: r = v1 - v2; break;
+        case Opcode::MUL: r = v1 * v2; break;
+        case Opcode::DIV:
+            if (v2 == 0) return false;
+            r = v1 / v2;
+            break;
+        default: return false;
     }
+    stringstream ss; ss << r;//折叠结果的拼写
+    string spelling = ss.str();
+    // 浮点结果即使是整数值也保持浮点类型
+    if (spelling.find_first_of(".eEn") == string::npos) spelling += ".0";
+    result = Operand::number(spelling);
+    return true;
 }
 
 // 4. 对单个基本块进行DAG优化
+// 有副作用的指令 (跳转、调用、输出、数组和成员访问、写全局变量等) 把基本块切成若干段，
+// 每段里的纯计算建一个 DAG，在下一条副作用指令之前生成代码，副作用指令本身按原位置保留。
 void Optimizer::optimize_block(BasicBlock& block) {
-    cout << "\n--- 正在优化基本块 " << block.id << " (size=" << block.quads.size() << ") ---" << endl;
+    log << "\n--- 正在优化基本块 " << block.id << " (size=" << block.quads.size() << ") ---" << endl;
     if (block.quads.empty()) return;
 
-    map<string, DagNode*> var_to_node;
-    list<unique_ptr<DagNode>> all_nodes;
+    // 每条指令之前的活跃变量，由出口活跃变量倒推
+    vector<set<Operand>> live_before(block.quads.size() + 1);
+    live_before.back() = block.live_out;
+    for (size_t i = block.quads.size(); i-- > 0;) {
+        live_before[i] = live_before[i + 1];
+        const Operand def = quadDef(block.quads[i]);
+        if (def.isVariable()) live_before[i].erase(def);
+        Operand uses[3];
+        int use_count = quadUses(block.quads[i], uses);
+        live_before[i].insert(uses, uses + use_count);
+    }
+
+    unordered_map<NameId, DagNode*> var_to_node;
+    // 节点从整块共用的区域里分配，每段结束时整体清空。每条四元式最多新建三个节点 (两个叶子和一个内部节点或折叠出的常量)，
+    // 预留足够的容量后不会再分配，节点地址保持不变
+    vector<DagNode> nodes;
+    nodes.reserve(3 * block.quads.size());
+    // 散列表: 常量 -> 叶子，(操作符, 左子节点, 右子节点) -> 内部节点。可交换的运算按子节点编号排序后查找
+    unordered_map<uint64_t, DagNode*> constant_leaves;
+    unordered_map<NodeKey, DagNode*, NodeKeyHash> interior_nodes;
     int nodeIdCounter = 0;
+    vector<Quadruple> final_block_code;//存放新生成的优化代码
 
-    auto find_or_create_leaf = [&](const string& name) -> DagNode* {
+    auto find_or_create_leaf = [&](const Operand& name) -> DagNode* {
         // 如果是变量。
-        if (is_variable(name)) {
+        if (name.isVariable()) {
             // 如果这个变量已经在map中有关联的节点，直接返回该节点。
-            if (var_to_node.count(name)) return var_to_node[name];
-            // 如果是常量（数字或字符串字面量）。
+            auto it = var_to_node.find(name.name);
+            if (it != var_to_node.end()) return it->second;
+            // 如果是常量（数字或字符串字面量），查表看是否已有代表此常量的叶子节点。
         } else {
-            // 遍历所有已创建的节点，看是否已有代表此常量的叶子节点。
-            for (const auto& node : all_nodes) {
-                if (node->op == "leaf" && !node->labels.empty() && node->labels[0] == name) return node.get();
-            }
+            auto it = constant_leaves.find(operand_key(name));
+            if (it != constant_leaves.end()) return it->second;
         }
         // 如果找不到，创建一个新的叶子节点。
-        auto node = make_unique<DagNode>(nodeIdCounter++, "leaf");
+        DagNode* node = &nodes.emplace_back(nodeIdCounter++);
         // 将变量名或常量值作为它的第一个标签。
+        node->value = name;
         node->labels.push_back(name);
-        DagNode* ptr = node.get(); // 获取原始指针。
-        all_nodes.push_back(std::move(node)); // 将新节点存入列表中。
-        // 如果是变量，更新map，建立关联。
-        if (is_variable(name)) var_to_node[name] = ptr;
-        return ptr;
+        // 建立关联。
+        if (name.isVariable()) var_to_node[name.name] = node;
+        else constant_leaves[operand_key(name)] = node;
+        return node;
     };
 
-    for(const auto& live_var : block.live_in) find_or_create_leaf(live_var);
+    // 变量被重新赋值前，先从它原来所在节点的标签里移除
+    auto detach = [&](const Operand& var) {
+        auto it = var_to_node.find(var.name);
+        if (it == var_to_node.end()) return;
+        auto& labels = it->second->labels;
+        labels.erase(remove(labels.begin(), labels.end(), var), labels.end());
+    };
+
+    // 为当前段的 DAG 生成代码，live 是段结束处的活跃变量
+    auto flush_segment = [&](const set<Operand>& live) {
+        if (nodes.empty()) return;
+
+        // 第二步: 识别所有必需的节点，根节点是段末活跃变量所在的节点
+        set<DagNode*> needed_nodes;
+        list<DagNode*> worklist;
+        for (const auto& live_var : live) {
+            auto it = var_to_node.find(live_var.name);
+            if (it != var_to_node.end() && needed_nodes.insert(it->second).second) worklist.push_back(it->second);
+        }
+        // 反向追溯所有依赖的节点
+        while (!worklist.empty()) {
+            DagNode* node = worklist.front();
+            worklist.pop_front();
+            for (DagNode* child : {node->left, node->right}) {
+                if (child && needed_nodes.insert(child).second) worklist.push_back(child);
+            }
+        }
+
+        // 第三步: 确定每个内部节点写入哪个变量。节点按创建顺序生成，子节点总在父节点之前
+        const size_t SEGMENT_END = SIZE_MAX;
+        vector<DagNode*> order;
+        unordered_map<NameId, size_t> write_pos; // 变量在生成的代码中第几处被写入
+        for (DagNode& n : nodes) {
+            DagNode* node = &n;
+            if (node->is_leaf) continue;
+            if (!needed_nodes.count(node)) {
+                log << "  [死代码消除] " << Quadruple(node->op, node->left->value,
+                    node->right ? node->right->value : Operand::none(),
+                    node->labels.empty() ? Operand::none() : node->labels.front()).toString() << endl;
+                continue;
+            }
+            // 优先使用活跃的用户变量名，其次是活跃的临时变量，都没有时随便用一个当前仍指向本节点的名字
+            Operand primary_label = Operand::none();
+            int best_rank = 4;
+            for (const auto& label : node->labels) {
+                auto it = var_to_node.find(label.name);
+                if (!label.isVariable() || it == var_to_node.end() || it->second != node) continue;
+                bool is_temp = label.kind == OperandKind::TEMP;
+                int rank = live.count(label) ? (is_temp ? 1 : 0) : (is_temp ? 2 : 3);
+                if (rank < best_rank) {
+                    best_rank = rank;
+                    primary_label = label;
+                }
+            }
+            if (primary_label.isNone()) primary_label = Operand::temp(symbol_table.generateTempVar());
+            node->value = primary_label;
+            write_pos[primary_label.name] = order.size();
+            order.push_back(node);
+        }
+        // 段末还要补的赋值: 活跃变量的值不在它自己名下
+        vector<pair<Operand, DagNode*>> copies;
+        for (const auto& live_var : live) {
+            auto it = var_to_node.find(live_var.name);
+            if (it == var_to_node.end() || it->second->value == live_var) continue;
+            copies.emplace_back(live_var, it->second);
+            write_pos[live_var.name] = SEGMENT_END;
+        }
+
+        // 叶子代表变量在段入口处的值。若这个变量在生成的代码里先被覆盖、之后还要读旧值，先把旧值存进新的临时变量
+        unordered_map<DagNode*, size_t> last_read;
+        for (size_t pos = 0; pos < order.size(); ++pos) {
+            for (DagNode* child : {order[pos]->left, order[pos]->right}) {
+                if (child && child->is_leaf) last_read[child] = pos;
+            }
+        }
+        for (const auto& copy : copies) {
+            if (copy.second->is_leaf) last_read[copy.second] = SEGMENT_END;
+        }
+        for (DagNode& n : nodes) {
+            DagNode* node = &n;
+            if (!node->is_leaf || !node->value.isVariable() || !last_read.count(node)) continue;
+            auto written = write_pos.find(node->value.name);
+            if (written == write_pos.end()) continue;
+            if (last_read[node] > written->second || written->second == SEGMENT_END) {
+                Operand saved = Operand::temp(symbol_table.generateTempVar());
+                final_block_code.emplace_back(Opcode::ASSIGN, node->value, Operand::none(), saved);
+                log << "  [保存旧值] " << final_block_code.back().toString() << endl;
+                node->value = saved;
+            }
+        }
+
+        for (DagNode* node : order) {
+            final_block_code.emplace_back(node->op, node->left->value,
+                node->right ? node->right->value : Operand::none(), node->value);
+            log << "  [生成] " << final_block_code.back().toString() << endl;
+        }
+        for (const auto& copy : copies) {
+            final_block_code.emplace_back(Opcode::ASSIGN, copy.second->value, Operand::none(), copy.first);
+        }
+
+        var_to_node.clear();
+        constant_leaves.clear();
+        interior_nodes.clear();
+        nodes.clear();
+    };
 
     // 第一步: 构建DAG
-    vector<Quadruple> side_effect_quads;
-    for (const auto& q : block.quads) {
-        bool is_expr = (q.op == "+" || q.op == "-" || q.op == "*" || q.op == "/" || q.op == ">" || q.op == "<" || q.op == "==" || q.op == "!=" || q.op == "&&" || q.op == "||");
+    for (size_t i = 0; i < block.quads.size(); ++i) {
+        const auto& q = block.quads[i];
+        bool is_expr = false;
+        switch (q.op) {
+            case Opcode::ADD: case Opcode::SUB: case Opcode::MUL: case Opcode::DIV: case Opcode::MOD:
+            case Opcode::NEG: case Opcode::NOT:
+            case Opcode::LT: case Opcode::GT: case Opcode::LE: case Opcode::GE: case Opcode::EQ: case Opcode::NE:
+            case Opcode::AND: case Opcode::OR:
+                is_expr = true;
+                break;
+            default: break;
+        }
+        // 对全局变量的写入是一种副作用，必须保留，不能动弹
+        bool writes_global = q.res.isVariable() && globals.count(q.res.name);
 
-        if (is_expr) {
+        if (is_expr && !writes_global) {
             //为左右操作数查找或者创建dag节点
             DagNode* left = find_or_create_leaf(q.arg1);
-            DagNode* right = find_or_create_leaf(q.arg2);
+            DagNode* right = q.arg2.isNone() ? nullptr : find_or_create_leaf(q.arg2);
             //常量折叠直接算
-            if (is_numeric(left->labels.front()) && is_numeric(right->labels.front()) &&
-               (q.op == "+" || q.op == "-" || q.op == "*" || q.op == "/"))
-            {
-                 double v1 = stod(left->labels.front());//字符串转换成double类型
-                 double v2 = stod(right->labels.front());
-                 double res_v = 0;
-
-                 if (q.op == "+") res_v = v1 + v2;
-                 else if (q.op == "-") res_v = v1 - v2;
-                 else if (q.op == "*") res_v = v1 * v2;
-                 else if (q.op == "/" && v2 != 0) res_v = v1 / v2;
-                 else goto perform_cse; // 除以零或其他情况，跳转
-
-                 stringstream ss; ss << res_v;//变回字符串
-
-                 if (var_to_node.count(q.res)) {//移除旧的关联
-                    auto& labels = var_to_node[q.res]->labels;
-                    labels.erase(remove(labels.begin(), labels.end(), q.res), labels.end());
-                 }
-                 var_to_node[q.res] = find_or_create_leaf(ss.str());//new一个
-                 cout << "  [常量折叠] " << q.toString() << " -> " << ss.str() << endl;
-                 continue;
+            Operand folded;
+            if (right && left->is_leaf && right->is_leaf && left->value.isNumeric() && right->value.isNumeric() &&
+                fold_constants(q.op, left->value, right->value, folded)) {
+                detach(q.res);//移除旧的关联
+                DagNode* leaf = find_or_create_leaf(folded);
+                leaf->labels.push_back(q.res);
+                var_to_node[q.res.name] = leaf;
+                log << "  [常量折叠] " << q.toString() << " -> " << folded.str() << endl;
+                continue;
             }
 
-        perform_cse://公共子表达式消除
-            DagNode* existing_node = nullptr;
-            for(const auto& node_ptr : all_nodes) {
-                if(node_ptr->op != "leaf" && node_ptr->equals(q.op, left, right)) {//是否存在完全相同的计算node
-                    existing_node = node_ptr.get(); break;
-                }
-            }
-            if (var_to_node.count(q.res)) {//将目标变量从旧node移除
-                auto& labels = var_to_node[q.res]->labels;
-                labels.erase(remove(labels.begin(), labels.end(), q.res), labels.end());
-            }
+            //公共子表达式消除: 查表看是否存在完全相同的计算node
+            NodeKey key{q.op, left->id, right ? right->id : -1};
+            if (right && isCommutative(q.op) && key.right < key.left) swap(key.left, key.right);
+            auto [slot, inserted] = interior_nodes.try_emplace(key, nullptr);
+            DagNode* existing_node = inserted ? nullptr : slot->second;
+            detach(q.res);//将目标变量从旧node移除
 
             // 如果真有
             if (existing_node) {
-                cout << "  [CSE] " << q.toString() << endl;
+                log << "  [CSE] " << q.toString() << endl;
                 // 直接将当前指令的目标变量作为新标签添加到这个已存在节点上。
                 existing_node->labels.push_back(q.res);
                 // 更新map，将目标变量关联到这个节点。
-                var_to_node[q.res] = existing_node;
+                var_to_node[q.res.name] = existing_node;
                 // 如果没找着
             } else {
                 // 创建一个新的内部节点来代表这个计算。
-                auto new_node = make_unique<DagNode>(nodeIdCounter++, q.op);
+                DagNode* new_node = &nodes.emplace_back(nodeIdCounter++, q.op);
                 new_node->left = left; new_node->right = right;
                 new_node->labels.push_back(q.res);
                 // 更新map，将目标变量关联到这个新节点。
-                var_to_node[q.res] = new_node.get();
-                all_nodes.push_back(std::move(new_node));
+                var_to_node[q.res.name] = new_node;
+                slot->second = new_node;
             }
 
-        } else if (q.op == "=") {
-            // 对全局变量的赋值是一种副作用，必须保留，不能动弹
-            if (globals.count(q.res)) {
-                side_effect_quads.push_back(q);
-            }
-            // 无论如何，都需要更新DAG
-            if (var_to_node.count(q.res)) {
-                auto& labels = var_to_node[q.res]->labels;
-                labels.erase(remove(labels.begin(), labels.end(), q.res), labels.end());
-            }
+        } else if (q.op == Opcode::ASSIGN && !writes_global) {
             DagNode* arg1_node = find_or_create_leaf(q.arg1);
+            detach(q.res);
             arg1_node->labels.push_back(q.res);
-            var_to_node[q.res] = arg1_node;
+            var_to_node[q.res.name] = arg1_node;
 
         } else {
-            // 所有其他类型的指令，比如call jump等等，它们被视为有副作用，不能被优化掉，直接存起来。
-            side_effect_quads.push_back(q);
-            // 如果是函数调用，它可能会修改任何全局变量或通过指针修改内存。
-            // 为了安全起见，我们假设所有全局变量的值都可能已失效。
-            if (q.op == "CALL") {
-                // 如果调用有返回值，为返回值创建一个新的叶子节点，表示它的值是全新的。
-                if (is_variable(q.res)) var_to_node[q.res] = find_or_create_leaf(q.res);
-                // 同样，为所有全局变量创建新的叶子节点，表示它们的值可能已被修改。
-                for (const auto& g : globals) var_to_node[g] = find_or_create_leaf(g);
-            }
-        }
-    }
-
-    // 第二步: 识别所有必需的节点
-    set<DagNode*> needed_nodes;
-    list<DagNode*> worklist;
-
-    // 根节点：出口活跃变量 和 有副作用指令使用的变量
-    for (const auto& live_var : block.live_out) {
-        if (var_to_node.count(live_var)) { //还没标记为必须那就标记为必须
-            if(needed_nodes.find(var_to_node[live_var]) == needed_nodes.end()){
-                worklist.push_back(var_to_node[live_var]);
-                needed_nodes.insert(var_to_node[live_var]);
-            }
-        }
-    }
-    for (const auto& q : side_effect_quads) {//是副作用的话，节点也是必须的
-        if (is_variable(q.arg1) && var_to_node.count(q.arg1)) {
-            if(needed_nodes.find(var_to_node[q.arg1]) == needed_nodes.end()){
-                 worklist.push_back(var_to_node[q.arg1]);
-                 needed_nodes.insert(var_to_node[q.arg1]);
-            }
+            // 所有其他类型的指令，比如call jump等等，它们被视为有副作用，不能被优化掉。
+            // 先为它之前的计算生成代码，使它读到的变量都已就位，再原样保留这条指令。
+            flush_segment(live_before[i]);
+            final_block_code.push_back(q);
         }
-        if (is_variable(q.arg2) && var_to_node.count(q.arg2)) {
-             if(needed_nodes.find(var_to_node[q.arg2]) == needed_nodes.end()){
-                 worklist.push_back(var_to_node[q.arg2]);
-                 needed_nodes.insert(var_to_node[q.arg2]);
-            }
-        }
-        if (is_variable(q.res) && var_to_node.count(q.res)) {
-             if(needed_nodes.find(var_to_node[q.res]) == needed_nodes.end()){
-                 worklist.push_back(var_to_node[q.res]);
-                 needed_nodes.insert(var_to_node[q.res]);
-            }
-        }
-    }
-
-    // 反向追溯所有依赖的节点
-    while(!worklist.empty()){
-        DagNode* node = worklist.front();
-        worklist.pop_front();
-        if(node->left && needed_nodes.find(node->left) == needed_nodes.end()){ //当前节点的子节点也是必须的
-            needed_nodes.insert(node->left);
-            worklist.push_back(node->left);
-        }
-        if(node->right && needed_nodes.find(node->right) == needed_nodes.end()){
-            needed_nodes.insert(node->right);
-            worklist.push_back(node->right);
-        }
-    }
-
-    // 第三步: 从DAG生成代码
-    vector<Quadruple> final_block_code;//存放新生成的优化代码
-    set<int> generated_node_ids;
-    //用于便利dag并生成代码
-    function<void(DagNode*)> generate_code =
-        [&](DagNode* node) {
-        if (!node || generated_node_ids.count(node->id)) return;//空or处理过
-
-        if (needed_nodes.find(node) == needed_nodes.end()) { //非必须
-             if (node->op != "leaf") {
-                 cout << "  [死代码消除] " << Quadruple(node->op, node->left->labels.front(), node->right ? node->right->labels.front() : "_", node->labels.front()).toString() << endl;
-             }
-             return;
-        }
-        //后序遍历生成子节点代码
-        generate_code(node->left);
-        generate_code(node->right);
-
-        if (node->op == "leaf") {
-            generated_node_ids.insert(node->id);
-            return;
-        }
-
-        string primary_label = node->labels.front();
-        for(const auto& label : node->labels) {
-            if(!is_temporary_var(label)) {
-                primary_label = label; //优先使用用户定义名，而不是临时变量
-                break;
-            }
-        }
-
-        string arg1_val = node->left->labels.front();
-        string arg2_val = node->right ? node->right->labels.front() : "_";
-
-        final_block_code.emplace_back(node->op, arg1_val, arg2_val, primary_label);
-        cout << "  [生成] " << final_block_code.back().toString() << endl;
-        //更新dag，确保主标签在最前
-        var_to_node[primary_label] = node;
-        node->labels.insert(node->labels.begin(), primary_label);
-
-        generated_node_ids.insert(node->id);//标记已经处理的节点
-    };
-
-    for(const auto& node_ptr : all_nodes){
-        generate_code(node_ptr.get());//调用代码生成函数
-    }
-
-    // 为出口活跃变量生成最终赋值
-    for (const auto& live_var : block.live_out) {
-        if (!var_to_node.count(live_var)) continue;
-        // 如果是全局变量，它的赋值已经作为副作用处理，这里不再生成
-        if (globals.count(live_var)) continue;
-
-        string current_val = var_to_node[live_var]->labels.front();
-        if (live_var != current_val) {//名字不同的，需要再生成一条语句哦
-            final_block_code.emplace_back("=", current_val, "_", live_var);
-        }
-    }
-
-    // 添加有副作用的指令
-    for(auto& q : side_effect_quads){
-        // 在添加前，将其操作数更新为优化后的最新值（即其在DAG中对应节点的标签）。
-        if(is_variable(q.arg1) && var_to_node.count(q.arg1)) q.arg1 = var_to_node.at(q.arg1)->labels.front();
-        if(is_variable(q.arg2) && var_to_node.count(q.arg2)) q.arg2 = var_to_node.at(q.arg2)->labels.front();
     }
-    // 将更新后的副作用指令追加到代码末尾。
-    final_block_code.insert(final_block_code.end(), side_effect_quads.begin(), side_effect_quads.end());
+    flush_segment(block.live_out);
 
-    cout << "--- 优化后基本块 (size=" << final_block_code.size() << ") ---" << endl;
+    log << "--- 优化后基本块 (size=" << final_block_code.size() << ") ---" << endl;
     // 最后，用新生成的、优化过的代码，替换掉基本块中的旧代码。
     block.quads = final_block_code;
 }
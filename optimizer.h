@@ -5,33 +5,35 @@
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <ostream>
 #include <set>
+#include <unordered_set>
 #include "quadruple.h"
 #include "symbol_table.h"
 
+class ThreadPool;
+
 // DAG中的节点
 struct DagNode {
     int id;                                     // 节点的唯一ID
-    std::string op;                             // 节点的操作符 (如 "+", "leaf")
-    DagNode *left = nullptr, *right = nullptr;  // 指向左右子节点的指针
-    std::vector<std::string> labels;            // 附加到此节点的变量名/临时变量名列表
-
-    DagNode(int i, std::string o) : id(i), op(std::move(o)) {}
-
-    // 比较两个节点是否等价（操作符和子节点都相同）
-    bool equals(const std::string& other_op, DagNode* other_left, DagNode* other_right) const {
-        return op == other_op && left == other_left && right == other_right;
-    }
+    bool is_leaf;                               // 叶子节点: 块入口处的变量值或常量
+    Opcode op;                                  // 内部节点的操作符 (如 ADD)，叶子节点不使用
+    DagNode *left = nullptr, *right = nullptr;  // 指向左右子节点的指针，一元运算只有左子节点
+    std::vector<Operand> labels;                // 附加到此节点的变量/临时变量/常量列表
+    Operand value;                              // 生成代码时读取节点值的位置: 叶子是入口处的变量或常量，内部节点是写入的变量
+
+    explicit DagNode(int i) : id(i), is_leaf(true), op(Opcode::ASSIGN) {}
+    DagNode(int i, Opcode o) : id(i), is_leaf(false), op(o) {}
 };
 
 // 用于表示基本块及其数据流信息的结构
 struct BasicBlock {
     int id;
     std::vector<Quadruple> quads;
-    std::set<std::string> use;
-    std::set<std::string> def;
-    std::set<std::string> live_in;
-    std::set<std::string> live_out;
+    std::set<Operand> use;
+    std::set<Operand> def;
+    std::set<Operand> live_in;
+    std::set<Operand> live_out;
     std::vector<int> successors;
     std::vector<int> predecessors;
 
@@ -39,14 +41,27 @@ struct BasicBlock {
 };
 
 
+// 常量折叠: 两个整数按整数运算 (除法向零取整)，否则按浮点运算。不能折叠 (如除以零) 时返回 false
+bool fold_constants(Opcode op, const Operand& a, const Operand& b, Operand& result);
+
 // 优化器类
 class Optimizer {
 private:
-    const std::vector<Quadruple>& input_quads;
+    QuadrupleSpan input_quads;
     std::vector<Quadruple> optimized_quads;
+    std::vector<Quadruple> inlined_quads; // 内联 (见 inliner.h) 之后的序列
+    std::vector<Quadruple> global_quads;  // 全局优化 (见 ssa.h) 之后的序列，局部优化在它上面进行
     SymbolTable& symbol_table;
     std::vector<BasicBlock> basic_blocks; // 存储所有基本块
-    std::set<std::string> globals;
+    std::unordered_set<NameId> globals;
+    ThreadPool* pool = nullptr;           // 为空时各单元依次优化
+    std::ostream& log;                    // 优化过程的日志
+
+    // 优化一个函数或全部顶层代码时使用的构造函数，globals 由整体的优化器给出
+    Optimizer(QuadrupleSpan quads, SymbolTable& st, const std::unordered_set<NameId>& globals, std::ostream& log);
+
+    // 对一个单元做全局优化、局部优化，整理跳转和标签
+    std::vector<Quadruple> optimize_unit();
 
     // 1. 将四元式序列划分为基本块
     void divide_into_basic_blocks();
@@ -60,15 +75,16 @@ private:
     // 4. 对单个基本块进行DAG优化
     void optimize_block(BasicBlock& block);
 
-    // 辅助函数：判断字符串是否为变量
-    bool is_variable(const std::string& s);
-
-
 public:
-    Optimizer(const std::vector<Quadruple>& quads, SymbolTable& st);
+    // 给出线程池时，内联之后各函数在池里并行优化
+    Optimizer(QuadrupleSpan quads, SymbolTable& st, ThreadPool* pool = nullptr);
 
     // 执行优化的主函数
     std::vector<Quadruple> optimize();
+
+    // 只划分基本块并做活跃变量分析，不改写四元式。
+    // 各块按顺序首尾相接即为输入序列，后端据此计算活跃区间、分配寄存器
+    const std::vector<BasicBlock>& analyzeLiveness();
 };
 
 #endif // OPTIMIZER_H
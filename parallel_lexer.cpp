@@ -0,0 +1,184 @@
+#include "parallel_lexer.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 每块至少这么多字节，小于两块的文件直接顺序扫描 (编译时可用 -DANCHOR_PARALLEL_LEX_MIN_CHUNK=n 调整)
+#ifndef ANCHOR_PARALLEL_LEX_MIN_CHUNK
+#define ANCHOR_PARALLEL_LEX_MIN_CHUNK (256 * 1024)
+#endif
+
+// 分块边界上可能处于的词法状态。分块总是紧跟在换行符之后开始，行注释不会跨块，
+// 所以只有这四种: 普通代码、字符串内部、多行注释内部、字符字面量还差一个字符
+// (形如 '\n 的字符字面量把换行符当作字符本身，结束引号落在下一块)。
+enum class LexState { Normal, String, BlockComment, CharLiteral };
+constexpr size_t LEX_STATE_COUNT = 4;
+
+// 从某个入口状态扫过一块得到的结果
+struct StateRun {
+    LexState exit = LexState::Normal; // 块末尾的状态
+    const char* firstCut = nullptr;   // 块内第一个处于普通状态的行首，可以在这里安全切开
+};
+
+// 只识别会跨行的结构的简化状态机，规则与 Scanner 保持一致:
+// 字符串到下一个 '"' 结束(没有转义)；字符字面量总是吃掉引号后的两个字符；
+// "/*" 之后从下一个字符开始找 "*/"。其余 Token 都不含换行符、引号或注释起始符。
+static StateRun runStateMachine(const char* p, const char* end, LexState entry) {
+    StateRun run;
+    LexState state = entry;
+    int charPending = (entry == LexState::CharLiteral) ? 1 : 0;
+    while (p < end) {
+        switch (state) {
+            case LexState::Normal: {
+                char c = *p++;
+                if (c == '\n') {
+                    if (!run.firstCut) run.firstCut = p;
+                } else if (c == '"') {
+                    state = LexState::String;
+                } else if (c == '\'') {
+                    state = LexState::CharLiteral;
+                    charPending = 2;
+                } else if (c == '/' && p < end && *p == '/') { // 行注释: 停在换行符上，交给普通状态处理
+                    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+                    p = nl ? nl : end;
+                } else if (c == '/' && p < end && *p == '*') {
+                    ++p;
+                    state = LexState::BlockComment;
+                }
+                break;
+            }
+            case LexState::String: {
+                const char* close = static_cast<const char*>(std::memchr(p, '"', end - p));
+                if (close) {
+                    p = close + 1;
+                    state = LexState::Normal;
+                } else {
+                    p = end;
+                }
+                break;
+            }
+            case LexState::BlockComment: {
+                const char* star = static_cast<const char*>(std::memchr(p, '*', end - p));
+                while (star && star + 1 < end && star[1] != '/') {
+                    star = static_cast<const char*>(std::memchr(star + 1, '*', end - star - 1));
+                }
+                if (star && star + 1 < end) {
+                    p = star + 2;
+                    state = LexState::Normal;
+                } else {
+                    p = end;
+                }
+                break;
+            }
+            case LexState::CharLiteral: {
+                int n = static_cast<int>(std::min<ptrdiff_t>(charPending, end - p));
+                p += n;
+                charPending -= n;
+                if (charPending == 0) state = LexState::Normal;
+                break;
+            }
+        }
+    }
+    run.exit = state;
+    return run;
+}
+
+TokenArray tokenizeParallel(Scanner& scanner, ThreadPool& pool) {
+    std::string_view text = scanner.source();
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+
+    size_t chunkCount = std::min<size_t>(static_cast<size_t>(pool.size()) * 4,
+                                         text.size() / ANCHOR_PARALLEL_LEX_MIN_CHUNK);
+    if (chunkCount <= 1) {
+        return scanner.tokenizeAll();
+    }
+
+    // 1. 按字节均分，每个切分点推到其后第一个换行符之后
+    std::vector<const char*> starts{begin};
+    for (size_t i = 1; i < chunkCount; ++i) {
+        const char* p = std::max(begin + text.size() * i / chunkCount, starts.back());
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!nl || nl + 1 >= end) break;
+        if (nl + 1 > starts.back()) starts.push_back(nl + 1);
+    }
+    const size_t n = starts.size();
+    if (n <= 1) {
+        return scanner.tokenizeAll();
+    }
+    auto chunkEnd = [&](size_t i) { return i + 1 < n ? starts[i + 1] : end; };
+
+    // 2. 推测: 不知道每块开头处于什么状态，就从每种可能的入口状态各扫一遍
+    std::vector<StateRun> runs(n * LEX_STATE_COUNT);
+    pool.parallelFor(n * LEX_STATE_COUNT, [&](size_t job) {
+        size_t i = job / LEX_STATE_COUNT;
+        LexState entry = static_cast<LexState>(job % LEX_STATE_COUNT);
+        if (i == 0 && entry != LexState::Normal) return; // 文件开头一定是普通状态
+        runs[job] = runStateMachine(starts[i], chunkEnd(i), entry);
+    });
+
+    // 3. 从文件开头依次串起真实状态。入口不是普通状态的块，把开头到第一个安全切分点
+    //    之间的内容并给前一块；整块都找不到切分点时整块并入前一块
+    std::vector<const char*> cuts{begin};
+    LexState state = LexState::Normal;
+    for (size_t i = 0; i < n; ++i) {
+        const StateRun& run = runs[i * LEX_STATE_COUNT + static_cast<size_t>(state)];
+        if (i > 0) {
+            const char* cut = (state == LexState::Normal) ? starts[i] : run.firstCut;
+            if (cut && cut < chunkEnd(i)) cuts.push_back(cut);
+        }
+        state = run.exit;
+    }
+    const size_t pieces = cuts.size();
+    auto pieceEnd = [&](size_t i) { return i + 1 < pieces ? cuts[i + 1] : end; };
+
+    // 4. 每块第一行的行号 = 1 + 之前各块的换行符总数
+    std::vector<int> firstLine(pieces, 1);
+    std::vector<int> newlines(pieces, 0);
+    pool.parallelFor(pieces, [&](size_t i) {
+        newlines[i] = static_cast<int>(std::count(cuts[i], pieceEnd(i), '\n'));
+    });
+    for (size_t i = 1; i < pieces; ++i) {
+        firstLine[i] = firstLine[i - 1] + newlines[i - 1];
+    }
+
+    // 5. 各块独立扫描，词法错误先写进各自的缓冲区
+    std::vector<TokenArray> parts(pieces);
+    std::vector<std::ostringstream> errors(pieces);
+    pool.parallelFor(pieces, [&](size_t i) {
+        Scanner chunk(std::string_view(cuts[i], pieceEnd(i) - cuts[i]), firstLine[i], errors[i]);
+        parts[i] = chunk.tokenizeAll();
+    });
+
+    // 6. 拼接: 除最后一块外去掉各块的 END_OF_FILE，偏移量换算回整个缓冲区
+    std::vector<size_t> base(pieces + 1, 0);
+    for (size_t i = 0; i < pieces; ++i) {
+        base[i + 1] = base[i] + parts[i].size() - (i + 1 < pieces ? 1 : 0);
+    }
+    TokenArray tokens;
+    tokens.source = begin;
+    tokens.types.resize(base[pieces]);
+    tokens.offsets.resize(base[pieces]);
+    tokens.lengths.resize(base[pieces]);
+    tokens.lines.resize(base[pieces]);
+    pool.parallelFor(pieces, [&](size_t i) {
+        const TokenArray& part = parts[i];
+        const size_t count = base[i + 1] - base[i];
+        const uint32_t delta = static_cast<uint32_t>(cuts[i] - begin);
+        std::copy_n(part.types.begin(), count, tokens.types.begin() + base[i]);
+        std::copy_n(part.lengths.begin(), count, tokens.lengths.begin() + base[i]);
+        std::copy_n(part.lines.begin(), count, tokens.lines.begin() + base[i]);
+        for (size_t j = 0; j < count; ++j) {
+            tokens.offsets[base[i] + j] = part.types[j] == TokenType::END_OF_FILE ? 0 : part.offsets[j] + delta;
+        }
+    });
+
+    // 7. 按块的顺序输出词法错误，与顺序扫描的输出一致
+    for (const auto& err : errors) {
+        std::cerr << err.str();
+    }
+    return tokens;
+}
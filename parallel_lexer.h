@@ -0,0 +1,13 @@
+#ifndef PARALLEL_LEXER_H
+#define PARALLEL_LEXER_H
+
+#include "scanner.h"
+#include "thread_pool.h"
+#include "token.h"
+
+// 并行词法分析: 把 scanner 持有的源缓冲区按行切成若干块，在线程池上分别扫描后拼接。
+// 结果(Token 序列、行号以及词法错误的输出顺序)与 scanner.tokenizeAll() 完全相同。
+// 文件较小时直接退回顺序扫描。scanner 必须还没有读取过任何 Token。
+TokenArray tokenizeParallel(Scanner& scanner, ThreadPool& pool);
+
+#endif // PARALLEL_LEXER_H
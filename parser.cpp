@@ -3,9 +3,9 @@
 using namespace std;
 
 //part one～
-//初始化解析器，传入当前处理scanner
-Parser::Parser(Scanner& s, SymbolTable& st)//用s来遍历，用st来检测
-    : scanner(s), symbolTable(st), currentToken(scanner.getNextToken()) {
+//初始化解析器，传入扫描好的整份Token数组
+Parser::Parser(const TokenArray& t, SymbolTable& st, Arena& a)//按下标遍历t，用st来检测，节点放进a
+    : tokens(t), position(0), currentToken(tokens.at(0)), symbolTable(st), arena(a) {
     operatorPrecedence[TokenType::ASSIGN] = 1;
     operatorPrecedence[TokenType::PLUS_ASSIGN] = 1;
     operatorPrecedence[TokenType::MINUS_ASSIGN] = 1;
@@ -113,13 +113,16 @@ string tokenTypeToString(TokenType type) {
 
 //辅助函数：
 //跳转到下一个语法单元
-void Parser::advance() { currentToken = scanner.getNextToken(); }
+void Parser::advance() {
+    if (position + 1 < tokens.size()) ++position; // 停在最后的 END_OF_FILE 上
+    currentToken = tokens.at(position);
+}
 //检查语法单元是否是期待款
 void Parser::match(TokenType expectedType) {
     if (currentToken.type == expectedType) {
         advance();
     } else {
-        reportError("期望的Token是 " + tokenTypeToString(expectedType) + ", 但实际得到的是 " + tokenTypeToString(currentToken.type) + " (词素: \"" + currentToken.lexeme + "\")");
+        reportError("期望的Token是 " + tokenTypeToString(expectedType) + ", 但实际得到的是 " + tokenTypeToString(currentToken.type) + " (词素: \"" + string(currentToken.lexeme) + "\")");
     }
 }
 //报错并直接终止程序（其实不太合适，但是暂时先这样吧）
@@ -127,9 +130,10 @@ void Parser::reportError(const string& message) {
     cerr << "语法错误 在行 " << currentToken.line << ": " << message << endl;
     exit(EXIT_FAILURE);
 }
-//预读k个词法单元
-const Token& Parser::peek(int k) {
-    return scanner.peekToken(k);
+//预读第k个词法单元的类型，越过末尾时返回 END_OF_FILE
+TokenType Parser::peekType(int k) const {
+    size_t index = std::min(position + k, tokens.size() - 1);
+    return tokens.types[index];
 }
 //get到算符优先级
 int Parser::getPrecedence(TokenType opType) {
@@ -153,15 +157,15 @@ bool Parser::isAssignmentOperator(TokenType type) const {
 
 //part two～
 //开始解析程序，直到文件结束，返回指向ast语法树的根节点指针
-unique_ptr<ProgramNode> Parser::parse() {
+ProgramNode* Parser::parse() {
     int line = currentToken.line;
-    auto stmts = make_unique<StatementListNode>(line);//存储顶层语句
+    auto stmts = arena.make<StatementListNode>(line);//存储顶层语句
 
     //循环处理anchor和文件结尾之外的字符（全局变量，函数，结构体）
     while (currentToken.type != TokenType::KW_ANCHOR && currentToken.type != TokenType::END_OF_FILE) {
         auto stmt = parseStatement(); //解析单挑语句
         if (stmt) {
-            stmts->addStatement(std::move(stmt)); //将语句节点添加到列表中，必须要用move，不然报错…………
+            stmts->addStatement(arena, stmt); //将语句节点添加到列表中
         }
     }
 
@@ -170,41 +174,41 @@ unique_ptr<ProgramNode> Parser::parse() {
         auto mainBlock = parseBlockStatement();
 
         if (mainBlock) {
-             auto* mainStmts = static_cast<StatementListNode*>(mainBlock.get());
+             auto* mainStmts = static_cast<StatementListNode*>(mainBlock);
              for (auto& stmt : mainStmts->statements) {
-                stmts->addStatement(std::move(stmt));
+                stmts->addStatement(arena, stmt);
              }
              mainStmts->statements.clear();//清空原来的列表
         }
     }
 
     match(TokenType::END_OF_FILE);
-    return make_unique<ProgramNode>(std::move(stmts), line);//返回根节点，其子节点是敖汉所有语句的列表stmts
+    return arena.make<ProgramNode>(stmts, line);//返回根节点，其子节点是敖汉所有语句的列表stmts
 }
 //解析语句列表（一系列语句）
-unique_ptr<StatementListNode> Parser::parseStatementList() {
+StatementListNode* Parser::parseStatementList() {
     int line = currentToken.line;
-    auto stmtList = make_unique<StatementListNode>(line);
+    auto stmtList = arena.make<StatementListNode>(line);
     while (currentToken.type != TokenType::RBRACE &&
            currentToken.type != TokenType::KW_CASE &&
            currentToken.type != TokenType::KW_DEFAULT &&
            currentToken.type != TokenType::END_OF_FILE) {//如果尚未结束
         auto stmt = parseStatement();
         if (stmt) {
-            stmtList->addStatement(std::move(stmt));
+            stmtList->addStatement(arena, stmt);
         }
     }
     return stmtList;
 }
 //解析由大括号包围的代码块
-unique_ptr<ASTNode> Parser::parseBlockStatement() {
+ASTNode* Parser::parseBlockStatement() {
     match(TokenType::LBRACE);
     auto block = parseStatementList();
     match(TokenType::RBRACE);
     return block;
 }
 //解析单条语句
-unique_ptr<ASTNode> Parser::parseStatement() {
+ASTNode* Parser::parseStatement() {
     switch (currentToken.type) {
         case TokenType::KW_IF: return parseIfStatement();
         case TokenType::KW_WHILE: return parseWhileStatement();
@@ -238,17 +242,17 @@ unique_ptr<ASTNode> Parser::parseStatement() {
         default:
             if (isTypeKeyword(currentToken.type) ||
                (currentToken.type == TokenType::IDENTIFIER &&
-               (peek(1).type == TokenType::IDENTIFIER || peek(1).type == TokenType::LBRACKET)))
+               (peekType(1) == TokenType::IDENTIFIER || peekType(1) == TokenType::LBRACKET)))
             {
                  int lookahead_count = 1; //向前看多远，用来判断是函数定义还是变量声明
-                 while(peek(lookahead_count).type == TokenType::LBRACKET){
+                 while(peekType(lookahead_count) == TokenType::LBRACKET){
                     lookahead_count++;
-                    if(peek(lookahead_count).type != TokenType::RBRACKET){
-                        while(peek(lookahead_count).type != TokenType::RBRACKET  && peek(lookahead_count).type != TokenType::END_OF_FILE ) lookahead_count++;
+                    if(peekType(lookahead_count) != TokenType::RBRACKET){
+                        while(peekType(lookahead_count) != TokenType::RBRACKET  && peekType(lookahead_count) != TokenType::END_OF_FILE ) lookahead_count++;
                     }
-                    if(peek(lookahead_count).type == TokenType::RBRACKET) lookahead_count++; else break;
+                    if(peekType(lookahead_count) == TokenType::RBRACKET) lookahead_count++; else break;
                  }
-                 if (peek(lookahead_count + 1).type == TokenType::LPAREN) {
+                 if (peekType(lookahead_count + 1) == TokenType::LPAREN) {
                     return parseFunctionDefinition(); //如果是括号，那么就是函数定义
                  } else {
                     auto decl = parseDeclarationStatement(); //否则就是一个变量声明
@@ -263,15 +267,15 @@ unique_ptr<ASTNode> Parser::parseStatement() {
     }
 }
 //解析初始化列表{}
-unique_ptr<ASTNode> Parser::parseInitializerList() {
+ASTNode* Parser::parseInitializerList() {
     int line = currentToken.line;
     match(TokenType::LBRACE);
 
-    vector<unique_ptr<ASTNode>> elements;
+    ArenaList<ASTNode*> elements;
     if (currentToken.type != TokenType::RBRACE) {
         while (true) {
             // 在这里，每个元素都可以是另一个表达式，其中可能包含另一个初始化列表
-            elements.push_back(parseExpression());
+            elements.push_back(arena, parseExpression());
             if (currentToken.type == TokenType::COMMA) {//如果下一个是，
                 advance();
                 if (currentToken.type == TokenType::RBRACE) { // 允许尾随逗号，即允许{1,2,}
@@ -284,15 +288,15 @@ unique_ptr<ASTNode> Parser::parseInitializerList() {
     }
 
     match(TokenType::RBRACE);
-    return make_unique<InitializerListNode>(std::move(elements), line);
+    return arena.make<InitializerListNode>(elements, line);
 }
 //解析一个变量声明语句 int a;/int function(){}/int a[]/int a=1
-unique_ptr<DeclarationStatementNode> Parser::parseDeclarationStatement(bool isParam) {
+DeclarationStatementNode* Parser::parseDeclarationStatement(bool isParam) {
     int line = currentToken.line;
 
     auto typeNode = parseTypeSpecifier();
 
-    string idName = currentToken.lexeme;
+    string_view idName = arena.copyString(currentToken.lexeme); // 名字拷进 Arena，AST 不依赖源缓冲区
     match(TokenType::IDENTIFIER);
 
     while (currentToken.type == TokenType::LBRACKET) {
@@ -302,20 +306,20 @@ unique_ptr<DeclarationStatementNode> Parser::parseDeclarationStatement(bool isPa
         int arrayLine = currentToken.line;
         match(TokenType::LBRACKET);
 
-        unique_ptr<ASTNode> sizeExpr = nullptr;
+        ASTNode* sizeExpr = nullptr;
         if (currentToken.type != TokenType::RBRACKET) { //如果不空，
             sizeExpr = parseExpression();
         } else { //如果空，必须初始化
-            if (peek(1).type != TokenType::ASSIGN || peek(2).type != TokenType::LBRACE) {
+            if (peekType(1) != TokenType::ASSIGN || peekType(2) != TokenType::LBRACE) {
                 reportError("C 风格的空括号 `[]` 数组声明必须带有初始化列表。");
             }
         }
 
         match(TokenType::RBRACKET);
-        typeNode = make_unique<ArrayTypeNode>(std::move(typeNode), std::move(sizeExpr), arrayLine);
+        typeNode = arena.make<ArrayTypeNode>(typeNode, sizeExpr, arrayLine);
     }
 
-    unique_ptr<ASTNode> initialValue = nullptr;
+    ASTNode* initialValue = nullptr;
     if (currentToken.type == TokenType::ASSIGN) { //等号
         if(isParam) reportError("函数参数不允许有默认值。");
         advance();
@@ -326,46 +330,46 @@ unique_ptr<DeclarationStatementNode> Parser::parseDeclarationStatement(bool isPa
         }
     }
 
-    return make_unique<DeclarationStatementNode>(std::move(typeNode), idName, std::move(initialValue), line);
+    return arena.make<DeclarationStatementNode>(typeNode, idName, initialValue, line);
 }
 //解析类型说明符，比如数组/结构体
-unique_ptr<ASTNode> Parser::parseTypeSpecifier() {
+ASTNode* Parser::parseTypeSpecifier() {
     int line = currentToken.line;
-    unique_ptr<ASTNode> type;
+    ASTNode* type = nullptr;
 
     if (isTypeKeyword(currentToken.type) || currentToken.type == TokenType::IDENTIFIER) {
-        type = make_unique<TypeNode>(currentToken.lexeme, line);
+        type = arena.make<TypeNode>(arena.copyString(currentToken.lexeme), line);
         advance();
     } else {
         reportError("期望一个类型名，但得到 " + tokenTypeToString(currentToken.type));
         return nullptr;
     }
 
-    while (currentToken.type == TokenType::LBRACKET && peek(1).type == TokenType::RBRACKET) {
+    while (currentToken.type == TokenType::LBRACKET && peekType(1) == TokenType::RBRACKET) {
         int arrayLine = currentToken.line;
         match(TokenType::LBRACKET);
         match(TokenType::RBRACKET);
 
-        type = make_unique<ArrayTypeNode>(std::move(type), nullptr, arrayLine);
+        type = arena.make<ArrayTypeNode>(type, nullptr, arrayLine);
     }
 
     return type;
 }
 //解析函数定义
-unique_ptr<FunctionDefinitionNode> Parser::parseFunctionDefinition() {
+FunctionDefinitionNode* Parser::parseFunctionDefinition() {
     int line = currentToken.line;
     auto returnType = parseTypeSpecifier();
     if (returnType->nodeType != ASTNode::NodeType::Type) {
         reportError("函数定义中的返回类型必须是基础类型。");
     }
 
-    string funcName = currentToken.lexeme;
+    string_view funcName = arena.copyString(currentToken.lexeme);
     match(TokenType::IDENTIFIER);
     match(TokenType::LPAREN);
-    auto params = make_unique<StatementListNode>(currentToken.line);
+    auto params = arena.make<StatementListNode>(currentToken.line);
     if (currentToken.type != TokenType::RPAREN) {
         while (true) {
-            params->addStatement(parseDeclarationStatement(true));
+            params->addStatement(arena, parseDeclarationStatement(true));
             if (currentToken.type == TokenType::COMMA) {
                 advance();
             } else {
@@ -375,103 +379,103 @@ unique_ptr<FunctionDefinitionNode> Parser::parseFunctionDefinition() {
     }
     match(TokenType::RPAREN);
     auto body = parseBlockStatement();
-    auto bodyStmtList = unique_ptr<StatementListNode>(static_cast<StatementListNode*>(body.release()));
+    auto bodyStmtList = static_cast<StatementListNode*>(body);
 
-    auto returnTypeNode = unique_ptr<TypeNode>(static_cast<TypeNode*>(returnType.release()));
+    auto returnTypeNode = static_cast<TypeNode*>(returnType);
 
-    return make_unique<FunctionDefinitionNode>(funcName, std::move(returnTypeNode), std::move(params), std::move(bodyStmtList), line);
+    return arena.make<FunctionDefinitionNode>(funcName, returnTypeNode, params, bodyStmtList, line);
 }
 //解析return语句
-unique_ptr<ReturnStatementNode> Parser::parseReturnStatement() {
+ReturnStatementNode* Parser::parseReturnStatement() {
     int line = currentToken.line;
     match(TokenType::KW_RETURN);
-    unique_ptr<ASTNode> returnValue = nullptr;
+    ASTNode* returnValue = nullptr;
     if (currentToken.type != TokenType::SEMICOLON) {
         returnValue = parseExpression();
     }
-    return make_unique<ReturnStatementNode>(std::move(returnValue), line);
+    return arena.make<ReturnStatementNode>(returnValue, line);
 }
 //ifelse
-unique_ptr<IfStatementNode> Parser::parseIfStatement() {
+IfStatementNode* Parser::parseIfStatement() {
     int line = currentToken.line;
     match(TokenType::KW_IF);
     match(TokenType::LPAREN);
     auto condition = parseExpression();
     match(TokenType::RPAREN);
     auto thenBlock = parseStatement();
-    unique_ptr<ASTNode> elseBlock = nullptr;
+    ASTNode* elseBlock = nullptr;
     if (currentToken.type == TokenType::KW_ELSE) {
         advance();
         elseBlock = parseStatement();
     }
-    return make_unique<IfStatementNode>(std::move(condition), std::move(thenBlock), std::move(elseBlock), line);
+    return arena.make<IfStatementNode>(condition, thenBlock, elseBlock, line);
 }
 //while
-unique_ptr<WhileStatementNode> Parser::parseWhileStatement() {
+WhileStatementNode* Parser::parseWhileStatement() {
     int line = currentToken.line;
     match(TokenType::KW_WHILE);
     match(TokenType::LPAREN);
     auto condition = parseExpression();
     match(TokenType::RPAREN);
     auto loopBlock = parseStatement();
-    return make_unique<WhileStatementNode>(std::move(condition), std::move(loopBlock), line);
+    return arena.make<WhileStatementNode>(condition, loopBlock, line);
 }
 //for
-unique_ptr<ForStatementNode> Parser::parseForStatement() {
+ForStatementNode* Parser::parseForStatement() {
     int line = currentToken.line;
     match(TokenType::KW_FOR);
     match(TokenType::LPAREN);
-    unique_ptr<ASTNode> initialization = nullptr;
+    ASTNode* initialization = nullptr;
     if (currentToken.type != TokenType::SEMICOLON) {
-        if (isTypeKeyword(currentToken.type) || (currentToken.type == TokenType::IDENTIFIER && (peek(1).type == TokenType::IDENTIFIER || peek(1).type == TokenType::LBRACKET))) {
+        if (isTypeKeyword(currentToken.type) || (currentToken.type == TokenType::IDENTIFIER && (peekType(1) == TokenType::IDENTIFIER || peekType(1) == TokenType::LBRACKET))) {
             initialization = parseDeclarationStatement();
         } else {
             initialization = parseExpression();
         }
     }
     match(TokenType::SEMICOLON);
-    unique_ptr<ASTNode> condition = nullptr;
+    ASTNode* condition = nullptr;
     if (currentToken.type != TokenType::SEMICOLON) {
         condition = parseExpression();
     }
     match(TokenType::SEMICOLON);
-    unique_ptr<ASTNode> increment = nullptr;
+    ASTNode* increment = nullptr;
     if (currentToken.type != TokenType::RPAREN) {
         increment = parseExpression();
     }
     match(TokenType::RPAREN);
     auto body = parseStatement();
-    auto bodyStmtList = unique_ptr<StatementListNode>(static_cast<StatementListNode*>(body.release()));
-    return make_unique<ForStatementNode>(std::move(initialization), std::move(condition), std::move(increment), std::move(bodyStmtList), line);
+    auto bodyStmtList = static_cast<StatementListNode*>(body);
+    return arena.make<ForStatementNode>(initialization, condition, increment, bodyStmtList, line);
 }
 //print
-unique_ptr<PrintStatementNode> Parser::parsePrintStatement() {
+PrintStatementNode* Parser::parsePrintStatement() {
     int line = currentToken.line;
     match(TokenType::KW_PRINT);
     match(TokenType::LPAREN);
     auto expr = parseExpression();
     match(TokenType::RPAREN);
-    return make_unique<PrintStatementNode>(std::move(expr), line);
+    return arena.make<PrintStatementNode>(expr, line);
 }
 //结构体定义
-unique_ptr<StructiDefinitionNode> Parser::parseStructiDefinitionStatement() {
+StructiDefinitionNode* Parser::parseStructiDefinitionStatement() {
     int line = currentToken.line;
     match(TokenType::KW_STRUCTI);
-    string structiName = currentToken.lexeme;
+    string_view structiName = arena.copyString(currentToken.lexeme);
     match(TokenType::IDENTIFIER);
     match(TokenType::LBRACE);
-    auto members = make_unique<StatementListNode>(currentToken.line);
+    auto members = arena.make<StatementListNode>(currentToken.line);
     while (currentToken.type != TokenType::RBRACE) {
         auto memberDecl = parseDeclarationStatement(false);
         match(TokenType::SEMICOLON);
-        members->addStatement(std::move(memberDecl));
+        members->addStatement(arena, memberDecl);
     }
     match(TokenType::RBRACE);
     match(TokenType::SEMICOLON);
-    return make_unique<StructiDefinitionNode>(structiName, std::move(members), line);
+    return arena.make<StructiDefinitionNode>(structiName, members, line);
 }
 //switch
-unique_ptr<SwitchStatementNode> Parser::parseSwitchStatement() {
+SwitchStatementNode* Parser::parseSwitchStatement() {
     int line = currentToken.line;
     match(TokenType::KW_SWITCH);
     match(TokenType::LPAREN);
@@ -479,10 +483,10 @@ unique_ptr<SwitchStatementNode> Parser::parseSwitchStatement() {
     match(TokenType::RPAREN);
     match(TokenType::LBRACE);
 
-    vector<unique_ptr<CaseStatementNode>> cases;
+    ArenaList<CaseStatementNode*> cases;
     while(currentToken.type == TokenType::KW_CASE || currentToken.type == TokenType::KW_DEFAULT) {
         int caseLine = currentToken.line;
-        unique_ptr<ASTNode> value = nullptr;
+        ASTNode* value = nullptr;
 
         if (currentToken.type == TokenType::KW_CASE) {
             advance();
@@ -493,32 +497,32 @@ unique_ptr<SwitchStatementNode> Parser::parseSwitchStatement() {
         match(TokenType::COLON);
 
         auto body = parseStatementList();
-        cases.push_back(make_unique<CaseStatementNode>(std::move(value), std::move(body), caseLine));
+        cases.push_back(arena, arena.make<CaseStatementNode>(value, body, caseLine));
     }
 
     match(TokenType::RBRACE);
-    return make_unique<SwitchStatementNode>(std::move(expr), std::move(cases), line);
+    return arena.make<SwitchStatementNode>(expr, cases, line);
 }
 //break
-unique_ptr<BreakStatementNode> Parser::parseBreakStatement() {
+BreakStatementNode* Parser::parseBreakStatement() {
     int line = currentToken.line;
     match(TokenType::KW_BREAK);
-    return make_unique<BreakStatementNode>(line);
+    return arena.make<BreakStatementNode>(line);
 }
 //continue
-unique_ptr<ContinueStatementNode> Parser::parseContinueStatement() {
+ContinueStatementNode* Parser::parseContinueStatement() {
     int line = currentToken.line;
     match(TokenType::KW_CONTINUE);
-    return make_unique<ContinueStatementNode>(line);
+    return arena.make<ContinueStatementNode>(line);
 }
 
 //算法：算符优先
 //解析表达式入口，调用优先级较低的赋值运算开始
-unique_ptr<ASTNode> Parser::parseExpression() {
+ASTNode* Parser::parseExpression() {
     return parseAssignmentExpression();
 }
 //解析赋值表达式=
-unique_ptr<ASTNode> Parser::parseAssignmentExpression() {
+ASTNode* Parser::parseAssignmentExpression() {
     //首先，尝试解析一个更高优先级的表达式作为作操作数，然后解析大于等于2优先级的其他运算
     auto lhs = parseBinaryExpressionRHS(2, parseUnaryExpression());
 
@@ -526,13 +530,13 @@ unique_ptr<ASTNode> Parser::parseAssignmentExpression() {
         Token opToken = currentToken;
         advance();
         auto rhs = parseAssignmentExpression();
-        return make_unique<AssignmentStatementNode>(std::move(lhs), opToken.lexeme, std::move(rhs), opToken.line);
+        return arena.make<AssignmentStatementNode>(lhs, arena.copyString(opToken.lexeme), rhs, opToken.line);
     }
 
     return lhs;
 }
 //解析二元表达式（递归处理，算符优先）
-unique_ptr<ASTNode> Parser::parseBinaryExpressionRHS(int exprPrec, unique_ptr<ASTNode> lhs) {
+ASTNode* Parser::parseBinaryExpressionRHS(int exprPrec, ASTNode* lhs) {
     while (true) {
         int tokPrec = getPrecedence(currentToken.type);
         if (tokPrec < exprPrec) {//如果优先级达不到要求
@@ -544,32 +548,32 @@ unique_ptr<ASTNode> Parser::parseBinaryExpressionRHS(int exprPrec, unique_ptr<AS
         int nextPrec = getPrecedence(currentToken.type);
 
         if (tokPrec < nextPrec) {
-            rhs = parseBinaryExpressionRHS(tokPrec + 1, std::move(rhs));
+            rhs = parseBinaryExpressionRHS(tokPrec + 1, rhs);
         }
-        lhs = make_unique<BinaryExpressionNode>(std::move(lhs), opToken.lexeme, std::move(rhs), opToken.line);
+        lhs = arena.make<BinaryExpressionNode>(lhs, arena.copyString(opToken.lexeme), rhs, opToken.line);
     }
 }
 //解析一元表达式：取非，相反数
-unique_ptr<ASTNode> Parser::parseUnaryExpression() {
+ASTNode* Parser::parseUnaryExpression() {
     if (currentToken.type == TokenType::NOT || currentToken.type == TokenType::MINUS || currentToken.type == TokenType::INC || currentToken.type == TokenType::DEC) {
         Token opToken = currentToken;
         advance();
         auto operand = parseUnaryExpression();
-        return make_unique<UnaryExpressionNode>(opToken.lexeme, std::move(operand), opToken.line);
+        return arena.make<UnaryExpressionNode>(arena.copyString(opToken.lexeme), operand, opToken.line);
     }
     return parseFactor();
 }
 //解析因子：包含函数调用，数组访问，成员访问等后缀操作
-unique_ptr<ASTNode> Parser::parseFactor() {
+ASTNode* Parser::parseFactor() {
     auto node = parsePrimaryExpression();
     while (true) {
         if (currentToken.type == TokenType::LPAREN) {
             int line = currentToken.line;
             advance();
-            vector<unique_ptr<ASTNode>> args;
+            ArenaList<ASTNode*> args;
             if (currentToken.type != TokenType::RPAREN) {
                 while (true) {
-                    args.push_back(parseExpression());
+                    args.push_back(arena, parseExpression());
                     if (currentToken.type == TokenType::COMMA) {
                         advance();
                     } else {
@@ -578,19 +582,19 @@ unique_ptr<ASTNode> Parser::parseFactor() {
                 }
             }
             match(TokenType::RPAREN);
-            node = make_unique<FunctionCallNode>(std::move(node), std::move(args), line);
+            node = arena.make<FunctionCallNode>(node, args, line);
         } else if (currentToken.type == TokenType::LBRACKET) {
             int line = currentToken.line;
             advance();
             auto indexExpr = parseExpression();
             match(TokenType::RBRACKET);
-            node = make_unique<ArrayAccessNode>(std::move(node), std::move(indexExpr), line);
+            node = arena.make<ArrayAccessNode>(node, indexExpr, line);
         } else if (currentToken.type == TokenType::DOT) {
             int line = currentToken.line;
             advance();
-            string memberName = currentToken.lexeme;
+            string_view memberName = arena.copyString(currentToken.lexeme);
             match(TokenType::IDENTIFIER);
-            node = make_unique<MemberAccessNode>(std::move(node), memberName, line);
+            node = arena.make<MemberAccessNode>(node, memberName, line);
         } else {
             break;
         }
@@ -598,12 +602,12 @@ unique_ptr<ASTNode> Parser::parseFactor() {
     return node;
 }
 //解析基本表达式单元：标识符，常量，括号等等
-unique_ptr<ASTNode> Parser::parsePrimaryExpression() {
+ASTNode* Parser::parsePrimaryExpression() {
     int line = currentToken.line;
-    unique_ptr<ASTNode> node;
+    ASTNode* node = nullptr;
     switch (currentToken.type) {
         case TokenType::IDENTIFIER:
-            node = make_unique<IdentifierNode>(currentToken.lexeme, line);
+            node = arena.make<IdentifierNode>(arena.copyString(currentToken.lexeme), line);
         advance();
         break;
         case TokenType::INT_LITERAL:
@@ -612,7 +616,7 @@ unique_ptr<ASTNode> Parser::parsePrimaryExpression() {
         case TokenType::STRING_LITERAL:
         case TokenType::KW_TRUE:
         case TokenType::KW_FALSE:
-            node = make_unique<LiteralNode>(currentToken.lexeme, currentToken.type, line);
+            node = arena.make<LiteralNode>(arena.copyString(currentToken.lexeme), currentToken.type, line);
         advance();
         break;
         case TokenType::LPAREN:
@@ -8,55 +8,56 @@
 #include <unordered_map>
 #include <algorithm>
 
-#include "scanner.h"
 #include "token.h"
 #include "ast_nodes.h"
 #include "symbol_table.h"
 
 class Parser {
 private:
-    Scanner& scanner;
+    const TokenArray& tokens; // Scanner::tokenizeAll() 的结果
+    size_t position;          // currentToken 在 tokens 中的下标
     Token currentToken;
     SymbolTable& symbolTable;
+    Arena& arena;             // 所有 AST 节点都分配在这里，由调用者(编译单元)持有
 
     void advance();
     void match(TokenType expectedType);
     void reportError(const std::string& message);
-    const Token& peek(int k = 1);
+    TokenType peekType(int k = 1) const;
     std::unordered_map<TokenType, int> operatorPrecedence;//哈希表，存放操作符的优先级
 
     int getPrecedence(TokenType opType);
     bool isTypeKeyword(TokenType type) const;
     bool isAssignmentOperator(TokenType type) const;
 
-    std::unique_ptr<StatementListNode> parseStatementList();
-    std::unique_ptr<ASTNode> parseStatement();
-    std::unique_ptr<ASTNode> parseBlockStatement();
-    std::unique_ptr<DeclarationStatementNode> parseDeclarationStatement(bool isParam = false);
+    StatementListNode* parseStatementList();
+    ASTNode* parseStatement();
+    ASTNode* parseBlockStatement();
+    DeclarationStatementNode* parseDeclarationStatement(bool isParam = false);
 
-    std::unique_ptr<ASTNode> parseTypeSpecifier();
-    std::unique_ptr<IfStatementNode> parseIfStatement();
-    std::unique_ptr<WhileStatementNode> parseWhileStatement();
-    std::unique_ptr<ForStatementNode> parseForStatement();
-    std::unique_ptr<StructiDefinitionNode> parseStructiDefinitionStatement();
-    std::unique_ptr<PrintStatementNode> parsePrintStatement();
-    std::unique_ptr<FunctionDefinitionNode> parseFunctionDefinition();
-    std::unique_ptr<ReturnStatementNode> parseReturnStatement();
-    std::unique_ptr<SwitchStatementNode> parseSwitchStatement();
-    std::unique_ptr<BreakStatementNode> parseBreakStatement();
-    std::unique_ptr<ContinueStatementNode> parseContinueStatement();
+    ASTNode* parseTypeSpecifier();
+    IfStatementNode* parseIfStatement();
+    WhileStatementNode* parseWhileStatement();
+    ForStatementNode* parseForStatement();
+    StructiDefinitionNode* parseStructiDefinitionStatement();
+    PrintStatementNode* parsePrintStatement();
+    FunctionDefinitionNode* parseFunctionDefinition();
+    ReturnStatementNode* parseReturnStatement();
+    SwitchStatementNode* parseSwitchStatement();
+    BreakStatementNode* parseBreakStatement();
+    ContinueStatementNode* parseContinueStatement();
 
-    std::unique_ptr<ASTNode> parseExpression();
-    std::unique_ptr<ASTNode> parseAssignmentExpression();
-    std::unique_ptr<ASTNode> parseBinaryExpressionRHS(int exprPrec, std::unique_ptr<ASTNode> lhs);
-    std::unique_ptr<ASTNode> parseUnaryExpression();
-    std::unique_ptr<ASTNode> parseFactor();
-    std::unique_ptr<ASTNode> parsePrimaryExpression();
-    std::unique_ptr<ASTNode> parseInitializerList();
+    ASTNode* parseExpression();
+    ASTNode* parseAssignmentExpression();
+    ASTNode* parseBinaryExpressionRHS(int exprPrec, ASTNode* lhs);
+    ASTNode* parseUnaryExpression();
+    ASTNode* parseFactor();
+    ASTNode* parsePrimaryExpression();
+    ASTNode* parseInitializerList();
 
 public:
-    Parser(Scanner& s, SymbolTable& st);
-    std::unique_ptr<ProgramNode> parse();
+    Parser(const TokenArray& t, SymbolTable& st, Arena& a);
+    ProgramNode* parse();
 };
 
 std::string tokenTypeToString(TokenType type);
@@ -0,0 +1,215 @@
+#include "pass_manager.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+double now_ms() {
+    return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* conversion_name(IrForm from, IrForm to) {
+    if (to == IrForm::BLOCKS) return "cfg";
+    if (to == IrForm::SSA) return "to-ssa";
+    return from == IrForm::SSA ? "from-ssa" : "assemble";
+}
+
+void write_json_string(ostream& out, const string& s) {
+    out << '"';
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (c < 0x20) out << "\\u" << hex << setw(4) << setfill('0') << int(c) << dec << setfill(' ');
+        else out << c;
+    }
+    out << '"';
+}
+
+} // namespace
+
+const vector<pair<string, string>>& knownPasses() {
+    static const vector<pair<string, string>> passes = {
+        {"inline", "内联小的叶子函数 (对整个程序，只能是第一步)"},
+        {"sccp", "稀疏条件常量传播，删除条件已知的跳转和不可达块"},
+        {"propagate", "全局常量传播和复写传播"},
+        {"gvn", "全局值编号"},
+        {"licm", "循环不变代码外提"},
+        {"strength", "归纳变量的强度削弱"},
+        {"dce", "全局死代码删除"},
+        {"dag", "基本块内基于 DAG 的常量折叠、公共子表达式消除和死代码消除"},
+        {"jumps", "移除跳到下一条的跳转和未使用的标签"},
+    };
+    return passes;
+}
+
+string PassPipeline::preset(int level) {
+    switch (level) {
+        case 0: return "";
+        case 1: return "sccp,(propagate,dce)*,dag,jumps";
+        default: return "inline,sccp,(propagate,gvn,licm,strength,dce)*,dag,jumps";
+    }
+}
+
+bool PassPipeline::parse(const string& spec, PassPipeline& pipeline, string& error) {
+    pipeline.steps.clear();
+    string text;
+    for (char c : spec) {
+        if (!isspace(static_cast<unsigned char>(c))) text += c;
+    }
+    auto known = [](const string& name) {
+        const auto& passes = knownPasses();
+        return any_of(passes.begin(), passes.end(), [&](const auto& p) { return p.first == name; });
+    };
+
+    size_t i = 0;
+    while (i < text.size()) {
+        Step step;
+        bool group = text[i] == '(';
+        if (group) ++i;
+        while (true) {
+            size_t end = i;
+            while (end < text.size() && text[end] != ',' && text[end] != '(' && text[end] != ')' && text[end] != '*') ++end;
+            string name = text.substr(i, end - i);
+            if (name.empty()) {
+                error = "第 " + to_string(i + 1) + " 个字符处缺少遍名";
+                return false;
+            }
+            if (!known(name)) {
+                error = "未知的优化遍: " + name;
+                return false;
+            }
+            if (name == "inline" && (group || !pipeline.steps.empty())) {
+                error = "inline 只能作为流水线的第一步";
+                return false;
+            }
+            step.passes.push_back(name);
+            i = end;
+            if (!group || i >= text.size() || text[i] != ',') break;
+            ++i;
+        }
+        if (group) {
+            if (i + 1 >= text.size() || text[i] != ')' || text[i + 1] != '*') {
+                error = "括号括起的一组遍需要以 \")*\" 结尾";
+                return false;
+            }
+            i += 2;
+            step.repeat = true;
+        }
+        pipeline.steps.push_back(std::move(step));
+        if (i < text.size()) {
+            if (text[i] != ',') {
+                error = string("第 ") + to_string(i + 1) + " 个字符处应为 ','";
+                return false;
+            }
+            ++i;
+            if (i == text.size()) {
+                error = "流水线以 ',' 结尾";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+string PassPipeline::str() const {
+    string s;
+    for (const auto& step : steps) {
+        if (!s.empty()) s += ',';
+        if (step.repeat) s += '(';
+        for (size_t k = 0; k < step.passes.size(); ++k) {
+            if (k) s += ',';
+            s += step.passes[k];
+        }
+        if (step.repeat) s += ")*";
+    }
+    return s;
+}
+
+PassManager::PassManager(string unitName, IrForm initial, Hooks h, vector<PassRecord>& out)
+    : unit(std::move(unitName)), current(initial), hooks(std::move(h)), records(out) {}
+
+void PassManager::add(const string& name, IrForm form, IrForm result, Run run) {
+    passes[name] = Pass{form, result, std::move(run)};
+}
+
+void PassManager::run(const PassPipeline& pipeline) {
+    for (const auto& step : pipeline.steps) {
+        if (!step.repeat) {
+            run_pass(step.passes.front(), 0);
+            continue;
+        }
+        for (int round = 1;; ++round) {
+            size_t rewrites = 0;
+            for (const auto& name : step.passes) rewrites += run_pass(name, round);
+            if (rewrites == 0) break;
+        }
+    }
+}
+
+// 只在相邻的形式之间转换: 四元式 <-> 基本块 -> SSA -> 四元式
+void PassManager::require(IrForm form) {
+    while (current != form) {
+        IrForm next;
+        if (current == IrForm::QUADS) next = IrForm::BLOCKS;
+        else if (current == IrForm::BLOCKS) next = form == IrForm::SSA ? IrForm::SSA : IrForm::QUADS;
+        else next = IrForm::QUADS;
+        IrForm from = current;
+        measure(conversion_name(from, next), 0, [&] {
+            hooks.convert(from, next);
+            return size_t(0);
+        });
+        current = next;
+    }
+}
+
+size_t PassManager::run_pass(const string& name, int round) {
+    auto it = passes.find(name);
+    if (it == passes.end()) throw logic_error("优化遍 " + name + " 不能在单元 " + unit + " 上运行");
+    const Pass& pass = it->second;
+    require(pass.form);
+    size_t rewrites = measure(name, round, pass.run);
+    current = pass.result;
+    return rewrites;
+}
+
+size_t PassManager::measure(const string& name, int round, const Run& body) {
+    PassRecord record;
+    record.unit = unit;
+    record.pass = name;
+    record.round = round;
+    record.quads_before = hooks.quad_count();
+    record.blocks_before = hooks.block_count();
+    double start = now_ms();
+    record.rewrites = body();
+    record.time_ms = now_ms() - start;
+    record.quads_after = hooks.quad_count();
+    record.blocks_after = hooks.block_count();
+    records.push_back(std::move(record));
+    return records.back().rewrites;
+}
+
+void writePassStatsJson(ostream& out, const string& pipeline, double total_ms, const vector<PassRecord>& records) {
+    ostringstream json;
+    json << fixed << setprecision(3);
+    json << "{\n  \"pipeline\": ";
+    write_json_string(json, pipeline);
+    json << ",\n  \"total_ms\": " << total_ms << ",\n  \"passes\": [";
+    for (size_t i = 0; i < records.size(); ++i) {
+        const PassRecord& r = records[i];
+        json << (i ? ",\n    {" : "\n    {") << "\"unit\": ";
+        write_json_string(json, r.unit);
+        json << ", \"pass\": ";
+        write_json_string(json, r.pass);
+        json << ", \"round\": " << r.round << ", \"time_ms\": " << r.time_ms
+             << ", \"quads_before\": " << r.quads_before << ", \"quads_after\": " << r.quads_after
+             << ", \"blocks_before\": " << r.blocks_before << ", \"blocks_after\": " << r.blocks_after
+             << ", \"rewrites\": " << r.rewrites << "}";
+    }
+    json << (records.empty() ? "]\n}\n" : "\n  ]\n}\n");
+    out << json.str();
+}
@@ -0,0 +1,90 @@
+#ifndef PASS_MANAGER_H
+#define PASS_MANAGER_H
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 优化遍运行时中间代码的形式: 四元式序列、划分好并做过活跃变量分析的基本块、SSA 形式
+enum class IrForm { QUADS, BLOCKS, SSA };
+
+// 流水线: 按顺序执行的若干步，每步是一个遍，或是括号括起、以 * 结尾的一组遍，
+// 后者反复执行直到一整轮没有任何改写。例如 "sccp,(propagate,dce)*,dag,jumps"
+struct PassPipeline {
+    struct Step {
+        std::vector<std::string> passes;
+        bool repeat = false;
+    };
+    std::vector<Step> steps;
+
+    // -O0/-O1/-O2 对应的流水线
+    static std::string preset(int level);
+    // 解析失败时返回 false，error 给出原因
+    static bool parse(const std::string& spec, PassPipeline& pipeline, std::string& error);
+
+    bool empty() const { return steps.empty(); }
+    std::string str() const;
+};
+
+// 一个遍 (或形式之间的一次转换) 执行一次的统计
+struct PassRecord {
+    std::string unit;   // 函数名; 顶层代码为 "<top>"，对整个程序运行的遍为 "<program>"
+    std::string pass;   // 遍名; 形式转换为 "cfg"、"to-ssa"、"from-ssa"、"assemble"
+    int round = 0;      // 在重复组里是第几轮，从 1 开始; 不在重复组里为 0
+    double time_ms = 0;
+    size_t quads_before = 0, quads_after = 0;
+    size_t blocks_before = 0, blocks_after = 0;
+    size_t rewrites = 0;
+};
+
+// 在一个优化单元上按流水线执行已注册的遍，并记录每个遍的耗时、前后的四元式数和基本块数以及改写次数。
+// 遍只声明自己需要的形式，形式之间的转换由使用者通过 convert 提供，管理器在需要时调用并同样计时记录
+class PassManager {
+public:
+    // 返回改写的次数
+    using Run = std::function<size_t()>;
+
+    struct Hooks {
+        std::function<void(IrForm from, IrForm to)> convert;
+        std::function<size_t()> quad_count;
+        std::function<size_t()> block_count;
+    };
+
+    PassManager(std::string unit, IrForm initial, Hooks hooks, std::vector<PassRecord>& records);
+
+    // result 是遍结束后中间代码的形式 (如 DAG 优化改写了块内代码，活跃信息失效，结束时已拼回四元式)
+    void add(const std::string& name, IrForm form, IrForm result, Run run);
+
+    void run(const PassPipeline& pipeline);
+
+    // 转换到给定形式 (已经是时什么也不做)
+    void require(IrForm form);
+
+private:
+    struct Pass {
+        IrForm form, result;
+        Run run;
+    };
+
+    std::string unit;
+    IrForm current;
+    Hooks hooks;
+    std::vector<PassRecord>& records;
+    std::unordered_map<std::string, Pass> passes;
+
+    size_t run_pass(const std::string& name, int round);
+    // 执行 body 并记录一条统计，返回 body 报告的改写次数
+    size_t measure(const std::string& name, int round, const Run& body);
+};
+
+// 可以出现在流水线里的遍名及说明，按典型的执行顺序排列
+const std::vector<std::pair<std::string, std::string>>& knownPasses();
+
+// 把统计写成 JSON: {"pipeline": ..., "total_ms": ..., "passes": [{...}, ...]}
+void writePassStatsJson(std::ostream& out, const std::string& pipeline, double total_ms,
+                        const std::vector<PassRecord>& records);
+
+#endif // PASS_MANAGER_H
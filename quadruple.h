@@ -2,22 +2,250 @@
 #ifndef QUADRUPLE_H
 #define QUADRUPLE_H
 
+#include <cstdint>
+#include <cstdlib>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "interner.h"
+
+// 四元式的操作符。各阶段都按这个枚举 switch，不再比较字符串
+enum class Opcode : uint8_t {
+    ASSIGN,         // (=, src, _, dest)
+    ADD, SUB, MUL, DIV, MOD,
+    NEG,            // 一元取负 (-, src, _, dest)
+    NOT,            // 逻辑非 (!, src, _, dest)
+    LT, GT, LE, GE, EQ, NE,
+    AND, OR,
+    LABEL,          // (LABEL, label, _, _)
+    JUMP,           // (JUMP, _, _, label)
+    JUMPF,          // (JUMPF, cond, _, label)
+    JUMPNZ,         // (JUMPNZ, cond, _, label)
+    FUNC_BEGIN,     // (FUNC_BEGIN, func, _, _)
+    FUNC_END,       // (FUNC_END, func, _, _)
+    GET_PARAM,      // (GET_PARAM, param, _, _)
+    PARAM,          // (PARAM, arg, _, _)
+    CALL,           // (CALL, func, argCount, dest)
+    RETURN,         // (RETURN, value, _, _)
+    PRINT,          // (PRINT, value, _, _)
+    DEC_ARRAY,      // (DEC_ARRAY, array, size, elemSize)
+    DEC_DYN_ARRAY,  // (DEC_DYN_ARRAY, array, size, elemSize)
+    STORE_AT,       // (STORE_AT, src, base, index)
+    LOAD_AT,        // (LOAD_AT, dest, base, index)
+    LOAD_MEMBER,    // (LOAD_MEMBER, dest, base, offset)
+    STORE_MEMBER    // (STORE_MEMBER, src, base, offset)
+};
+
+// 调试输出用的操作符名，和原先四元式里的字符串保持一致
+inline const char* opcodeName(Opcode op) {
+    switch (op) {
+        case Opcode::ASSIGN:        return "=";
+        case Opcode::ADD:           return "+";
+        case Opcode::SUB:           return "-";
+        case Opcode::MUL:           return "*";
+        case Opcode::DIV:           return "/";
+        case Opcode::MOD:           return "%";
+        case Opcode::NEG:           return "-";
+        case Opcode::NOT:           return "!";
+        case Opcode::LT:            return "<";
+        case Opcode::GT:            return ">";
+        case Opcode::LE:            return "<=";
+        case Opcode::GE:            return ">=";
+        case Opcode::EQ:            return "==";
+        case Opcode::NE:            return "!=";
+        case Opcode::AND:           return "&&";
+        case Opcode::OR:            return "||";
+        case Opcode::LABEL:         return "LABEL";
+        case Opcode::JUMP:          return "JUMP";
+        case Opcode::JUMPF:         return "JUMPF";
+        case Opcode::JUMPNZ:        return "JUMPNZ";
+        case Opcode::FUNC_BEGIN:    return "FUNC_BEGIN";
+        case Opcode::FUNC_END:      return "FUNC_END";
+        case Opcode::GET_PARAM:     return "GET_PARAM";
+        case Opcode::PARAM:         return "PARAM";
+        case Opcode::CALL:          return "CALL";
+        case Opcode::RETURN:        return "RETURN";
+        case Opcode::PRINT:         return "PRINT";
+        case Opcode::DEC_ARRAY:     return "DEC_ARRAY";
+        case Opcode::DEC_DYN_ARRAY: return "DEC_DYN_ARRAY";
+        case Opcode::STORE_AT:      return "STORE_AT";
+        case Opcode::LOAD_AT:       return "LOAD_AT";
+        case Opcode::LOAD_MEMBER:   return "LOAD_MEMBER";
+        case Opcode::STORE_MEMBER:  return "STORE_MEMBER";
+    }
+    return "?";
+}
+
+// 操作数的种类，由 IR 生成器在产生操作数时确定，后续阶段直接读取
+enum class OperandKind : uint8_t {
+    NONE,    // 不存在的操作数 ("_")
+    TEMP,    // 临时变量 T0, T1, ...
+    SYMBOL,  // 符号表中的名字: 变量、参数、函数名
+    LABEL,   // 跳转标签 L0, L1, ...
+    INT,     // 整数立即数
+    FLOAT,   // 浮点立即数
+    BOOL,    // true / false
+    STRING,  // 字符串字面量 (拼写不含引号)
+    CHAR     // 字符字面量 (拼写为字符本身)
+};
+
+// 带标签的操作数: 种类 + 拼写在驻留表中的 id + 立即数的值。
+// 定长、可按位拷贝，相等比较只看种类和拼写。
+struct Operand {
+    OperandKind kind = OperandKind::NONE;
+    NameId name = NAME_NONE; // 拼写，用于输出和按名字查符号表
+    union {
+        int64_t intValue = 0; // INT / BOOL / CHAR
+        double floatValue;    // FLOAT
+    };
+
+    static Operand none() { return {}; }
+    static Operand temp(NameId id) { return make(OperandKind::TEMP, id); }
+    static Operand symbol(NameId id) { return make(OperandKind::SYMBOL, id); }
+    static Operand label(NameId id) { return make(OperandKind::LABEL, id); }
+    static Operand stringLit(NameId id) { return make(OperandKind::STRING, id); }
+
+    static Operand intImm(int64_t v) {
+        Operand o = make(OperandKind::INT, intern(std::to_string(v)));
+        o.intValue = v;
+        return o;
+    }
+    static Operand boolImm(bool v) {
+        Operand o = make(OperandKind::BOOL, intern(v ? "true" : "false"));
+        o.intValue = v ? 1 : 0;
+        return o;
+    }
+    static Operand charLit(NameId id) {
+        Operand o = make(OperandKind::CHAR, id);
+        const std::string& s = nameOf(id);
+        o.intValue = s.empty() ? 0 : static_cast<unsigned char>(s[0]);
+        return o;
+    }
+    // 数字字面量或常量折叠的结果: 能完整解析为整数的是 INT，否则是 FLOAT
+    static Operand number(std::string_view spelling) {
+        Operand o = make(OperandKind::INT, intern(spelling));
+        const char* s = nameOf(o.name).c_str();
+        char* end = nullptr;
+        long long iv = std::strtoll(s, &end, 10);
+        if (end != s && *end == '\0') {
+            o.intValue = iv;
+        } else {
+            o.kind = OperandKind::FLOAT;
+            o.floatValue = std::strtod(s, nullptr);
+        }
+        return o;
+    }
+
+    bool isNone() const { return kind == OperandKind::NONE; }
+    bool isVariable() const { return kind == OperandKind::TEMP || kind == OperandKind::SYMBOL; }
+    bool isNumeric() const { return kind == OperandKind::INT || kind == OperandKind::FLOAT; }
+    double numericValue() const { return kind == OperandKind::FLOAT ? floatValue : static_cast<double>(intValue); }
+    const std::string& str() const { return nameOf(name); }
+
+    bool operator==(const Operand& other) const { return kind == other.kind && name == other.name; }
+    bool operator!=(const Operand& other) const { return !(*this == other); }
+    // 先按拼写 id 排序，使集合的遍历顺序与名字首次出现的顺序一致
+    bool operator<(const Operand& other) const {
+        return name != other.name ? name < other.name : kind < other.kind;
+    }
+
+private:
+    static Operand make(OperandKind k, NameId id) {
+        Operand o;
+        o.kind = k;
+        o.name = id;
+        return o;
+    }
+};
+
+static_assert(std::is_trivially_copyable<Operand>::value, "Operand 必须可按位拷贝");
+static_assert(sizeof(Operand) == 16, "Operand 应保持 16 字节");
 
 // 四元式结构体：(Operator, Operand1, Operand2, Result)
+// 不存在的操作数为 Operand::none()，打印为 "_"
 struct Quadruple {
-    std::string op;    // 操作符 (例如 "+", "=", "JUMPF", "PRINT")
-    std::string arg1;  // 操作数1
-    std::string arg2;  // 操作数2
-    std::string res;   // 结果或目标标签
+    Opcode op;     // 操作符
+    Operand arg1;  // 操作数1
+    Operand arg2;  // 操作数2
+    Operand res;   // 结果或目标标签
 
-    Quadruple(const std::string& oper, const std::string& a1, const std::string& a2, const std::string& r)
+    Quadruple(Opcode oper, Operand a1 = {}, Operand a2 = {}, Operand r = {})
         : op(oper), arg1(a1), arg2(a2), res(r) {}
 
     // 用于调试打印四元式
     std::string toString() const {
-        return "(" + op + ", " + arg1 + ", " + arg2 + ", " + res + ")";
+        return std::string("(") + opcodeName(op) + ", " + arg1.str() + ", " + arg2.str() + ", " + res.str() + ")";
     }
 };
 
+static_assert(std::is_trivially_copyable<Quadruple>::value, "Quadruple 必须可按位拷贝");
+
+// 四元式写入的变量，没有时为 NONE。
+// 各字段的读写随操作符而定 (例如 LOAD_AT 写 arg1，STORE_AT 的 res 是下标)，数据流分析一律按这里判断
+inline Operand quadDef(const Quadruple& q) {
+    switch (q.op) {
+        case Opcode::GET_PARAM: case Opcode::LOAD_AT: case Opcode::LOAD_MEMBER:
+        case Opcode::DEC_ARRAY: case Opcode::DEC_DYN_ARRAY:
+            return q.arg1.isVariable() ? q.arg1 : Operand::none();
+        case Opcode::LABEL: case Opcode::JUMP: case Opcode::JUMPF: case Opcode::JUMPNZ:
+        case Opcode::FUNC_BEGIN: case Opcode::FUNC_END: case Opcode::PARAM: case Opcode::RETURN:
+        case Opcode::PRINT: case Opcode::STORE_AT: case Opcode::STORE_MEMBER:
+            return Operand::none();
+        default:
+            return q.res.isVariable() ? q.res : Operand::none();
+    }
+}
+
+// 四元式读取的变量 (函数名、标签和字面量不算)，写入 uses 并返回个数
+inline int quadUses(const Quadruple& q, Operand (&uses)[3]) {
+    int count = 0;
+    auto add = [&](const Operand& o) { if (o.isVariable()) uses[count++] = o; };
+    switch (q.op) {
+        case Opcode::LABEL: case Opcode::JUMP: case Opcode::FUNC_BEGIN: case Opcode::FUNC_END:
+        case Opcode::GET_PARAM: case Opcode::CALL:
+            break;
+        case Opcode::DEC_ARRAY: case Opcode::DEC_DYN_ARRAY: case Opcode::LOAD_MEMBER:
+            add(q.arg2);
+            break;
+        case Opcode::LOAD_AT:
+            add(q.arg2);
+            add(q.res);
+            break;
+        case Opcode::STORE_AT:
+            add(q.arg1);
+            add(q.arg2);
+            add(q.res);
+            break;
+        default:
+            add(q.arg1);
+            add(q.arg2);
+            break;
+    }
+    return count;
+}
+
+// 交换操作数不改变结果的运算。ADD 可能是字符串拼接，不算
+inline bool isCommutative(Opcode op) {
+    return op == Opcode::MUL || op == Opcode::EQ || op == Opcode::NE || op == Opcode::AND || op == Opcode::OR;
+}
+
+// 四元式序列的只读视图: 既可以指向 std::vector，也可以直接指向映射进内存的 .aqir 文件 (见 aqir.h)
+class QuadrupleSpan {
+public:
+    QuadrupleSpan() = default;
+    QuadrupleSpan(const Quadruple* data, size_t size) : first(data), count(size) {}
+    QuadrupleSpan(const std::vector<Quadruple>& quads) : first(quads.data()), count(quads.size()) {}
+
+    const Quadruple* begin() const { return first; }
+    const Quadruple* end() const { return first + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const Quadruple& operator[](size_t i) const { return first[i]; }
+
+private:
+    const Quadruple* first = nullptr;
+    size_t count = 0;
+};
+
 #endif // QUADRUPLE_H
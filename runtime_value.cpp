@@ -0,0 +1,155 @@
+#include "runtime_value.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+bool isNumberLike(ValueType t) { return t != ValueType::STRING && t != ValueType::OBJECT; }
+double asDouble(const Value& v) { return v.type == ValueType::FLOAT ? v.f : static_cast<double>(v.i); }
+
+} // namespace
+
+Value constantValue(const Operand& operand) {
+    Value v;
+    switch (operand.kind) {
+        case OperandKind::FLOAT:  v.type = ValueType::FLOAT; v.f = operand.floatValue; break;
+        case OperandKind::BOOL:   v.type = ValueType::BOOL; v.i = operand.intValue; break;
+        case OperandKind::CHAR:   v.type = ValueType::CHAR; v.i = operand.intValue; break;
+        case OperandKind::STRING: v.type = ValueType::STRING; v.s = &operand.str(); break;
+        default:                  v.i = operand.intValue; break;
+    }
+    return v;
+}
+
+void writeValue(ostream& os, const Value& v) {
+    switch (v.type) {
+        case ValueType::INT:    os << v.i; break;
+        case ValueType::FLOAT:  os << v.f; break;
+        case ValueType::BOOL:   os << (v.i ? "true" : "false"); break;
+        case ValueType::CHAR:   os << static_cast<char>(v.i); break;
+        case ValueType::STRING: os << *v.s; break;
+        case ValueType::OBJECT:
+            os << '[';
+            for (size_t k = 0; k < v.object->size(); ++k) {
+                if (k) os << ", ";
+                writeValue(os, (*v.object)[k]);
+            }
+            os << ']';
+            break;
+    }
+}
+
+void runtimeError(const string& message) {
+    cout.flush();
+    cerr << "运行时错误: " << message << endl;
+    exit(EXIT_FAILURE);
+}
+
+vector<Value>* RuntimeHeap::newArray(const Value& count) {
+    if (count.type == ValueType::FLOAT || !isNumberLike(count.type) || count.i < 0) {
+        runtimeError("数组大小无效");
+    }
+    objects.emplace_back(static_cast<size_t>(count.i));
+    return &objects.back();
+}
+
+vector<Value>& RuntimeHeap::objectOf(Value& slot) {
+    if (slot.type != ValueType::OBJECT) {
+        objects.emplace_back();
+        slot.type = ValueType::OBJECT;
+        slot.object = &objects.back();
+    }
+    return *slot.object;
+}
+
+const string* RuntimeHeap::newString(string s) {
+    strings.push_back(std::move(s));
+    return &strings.back();
+}
+
+Value performArithmetic(Opcode op, const Value& x, const Value& y, RuntimeHeap& heap) {
+    if (op == Opcode::ADD && (x.type == ValueType::STRING || y.type == ValueType::STRING)) {
+        ostringstream ss;
+        writeValue(ss, x);
+        writeValue(ss, y);
+        Value v;
+        v.type = ValueType::STRING;
+        v.s = heap.newString(ss.str());
+        return v;
+    }
+    if (!isNumberLike(x.type) || !isNumberLike(y.type)) runtimeError("运算的操作数类型不支持");
+
+    if (x.type == ValueType::FLOAT || y.type == ValueType::FLOAT) {
+        double a = asDouble(x), b = asDouble(y);
+        switch (op) {
+            case Opcode::ADD: return makeFloat(a + b);
+            case Opcode::SUB: return makeFloat(a - b);
+            case Opcode::MUL: return makeFloat(a * b);
+            case Opcode::DIV:
+                if (b == 0) runtimeError("除以零");
+                return makeFloat(a / b);
+            case Opcode::MOD:
+                if (b == 0) runtimeError("除以零");
+                return makeFloat(fmod(a, b));
+            default: break;
+        }
+    } else {
+        // 按无符号数运算，溢出时回绕而不是未定义行为
+        uint64_t a = static_cast<uint64_t>(x.i), b = static_cast<uint64_t>(y.i);
+        switch (op) {
+            case Opcode::ADD: return makeInt(static_cast<int64_t>(a + b));
+            case Opcode::SUB: return makeInt(static_cast<int64_t>(a - b));
+            case Opcode::MUL: return makeInt(static_cast<int64_t>(a * b));
+            case Opcode::DIV:
+                if (y.i == 0) runtimeError("除以零");
+                return makeInt(y.i == -1 ? static_cast<int64_t>(0 - a) : x.i / y.i);
+            case Opcode::MOD:
+                if (y.i == 0) runtimeError("除以零");
+                return makeInt(y.i == -1 ? 0 : x.i % y.i);
+            default: break;
+        }
+    }
+    runtimeError(string("无法执行运算 ") + opcodeName(op));
+}
+
+Value performComparison(Opcode op, const Value& x, const Value& y) {
+    int order = 0; // x < y 为 -1，相等为 0，x > y 为 1
+    if (x.type == ValueType::STRING && y.type == ValueType::STRING) {
+        int c = x.s->compare(*y.s);
+        order = (c > 0) - (c < 0);
+    } else if (isNumberLike(x.type) && isNumberLike(y.type)) {
+        if (x.type == ValueType::FLOAT || y.type == ValueType::FLOAT) {
+            double a = asDouble(x), b = asDouble(y);
+            order = (a > b) - (a < b);
+        } else {
+            order = (x.i > y.i) - (x.i < y.i);
+        }
+    } else if (x.type == ValueType::OBJECT && y.type == ValueType::OBJECT &&
+               (op == Opcode::EQ || op == Opcode::NE)) {
+        order = x.object == y.object ? 0 : 1;
+    } else {
+        runtimeError("比较的操作数类型不支持");
+    }
+
+    switch (op) {
+        case Opcode::LT: return makeBool(order < 0);
+        case Opcode::GT: return makeBool(order > 0);
+        case Opcode::LE: return makeBool(order <= 0);
+        case Opcode::GE: return makeBool(order >= 0);
+        case Opcode::EQ: return makeBool(order == 0);
+        case Opcode::NE: return makeBool(order != 0);
+        default: break;
+    }
+    runtimeError(string("无法执行比较 ") + opcodeName(op));
+}
+
+Value performUnary(Opcode op, const Value& x) {
+    if (!isNumberLike(x.type)) runtimeError("一元运算的操作数类型不支持");
+    if (op == Opcode::NOT) return makeBool(!truth(x));
+    if (x.type == ValueType::FLOAT) return makeFloat(-x.f);
+    return makeInt(static_cast<int64_t>(0 - static_cast<uint64_t>(x.i)));
+}
@@ -0,0 +1,67 @@
+#ifndef RUNTIME_VALUE_H
+#define RUNTIME_VALUE_H
+
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "quadruple.h"
+
+// 四元式解释器和字节码虚拟机共用的运行时值、堆和慢速路径运算。
+// 两个执行器都只在操作数都是整数时走自己的快速路径，其余情况调用这里的函数，保证语义一致。
+
+// 运行时的值: 类型标签 + 8 字节的值
+enum class ValueType : uint8_t {
+    INT,     // 整数按 64 位运算
+    FLOAT,
+    BOOL,
+    CHAR,
+    STRING,  // 指向驻留表或运行时堆里的字符串
+    OBJECT   // 数组或结构体，成员按下标存放
+};
+
+struct Value {
+    ValueType type = ValueType::INT;
+    union {
+        int64_t i = 0;                    // INT / BOOL / CHAR
+        double f;                         // FLOAT
+        const std::string* s;             // STRING
+        std::vector<Value>* object;       // OBJECT
+    };
+};
+
+inline Value makeInt(int64_t i) { Value v; v.i = i; return v; }
+inline Value makeBool(bool b) { Value v; v.type = ValueType::BOOL; v.i = b ? 1 : 0; return v; }
+inline Value makeFloat(double f) { Value v; v.type = ValueType::FLOAT; v.f = f; return v; }
+inline bool truth(const Value& v) { return v.type == ValueType::FLOAT ? v.f != 0 : v.i != 0; }
+
+// 立即数和字符串字面量对应的值
+Value constantValue(const Operand& operand);
+
+// PRINT 的输出格式: 布尔值为 true/false，数组按 [a, b] 输出
+void writeValue(std::ostream& os, const Value& v);
+
+// 输出运行时错误并终止程序
+[[noreturn]] void runtimeError(const std::string& message);
+
+// 运行时分配的数组、结构体和拼接出的字符串，随一次执行一起释放
+class RuntimeHeap {
+public:
+    std::vector<Value>* newArray(const Value& count);
+    // 结构体变量第一次访问成员时才分配存储
+    std::vector<Value>& objectOf(Value& slot);
+    const std::string* newString(std::string s);
+
+private:
+    std::deque<std::vector<Value>> objects;
+    std::deque<std::string> strings;
+};
+
+// 慢速路径: 浮点运算、字符串拼接以及各种错误检查
+Value performArithmetic(Opcode op, const Value& x, const Value& y, RuntimeHeap& heap);
+Value performComparison(Opcode op, const Value& x, const Value& y);
+Value performUnary(Opcode op, const Value& x);
+
+#endif // RUNTIME_VALUE_H
@@ -1,72 +1,232 @@
 #include "scanner.h"
 #include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+// --- 字符类批量扫描 ---
+// 空白、块注释和标识符字符一次检查一个向量宽度(AVX2: 32 字节, SSE2: 16 字节)，
+// 不足一个向量的尾部以及没有 SSE2 的平台逐字节处理。
+// 定义 ANCHOR_SCANNER_NO_SIMD 可以强制使用逐字节版本。
+#if !defined(ANCHOR_SCANNER_NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define SCANNER_SIMD_WIDTH 32
+using SimdVec = __m256i;
+static inline SimdVec simdLoad(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+static inline SimdVec simdSplat(char c) { return _mm256_set1_epi8(c); }
+static inline SimdVec simdEq(SimdVec v, char c) { return _mm256_cmpeq_epi8(v, simdSplat(c)); }
+static inline SimdVec simdOr(SimdVec a, SimdVec b) { return _mm256_or_si256(a, b); }
+static inline SimdVec simdSub(SimdVec a, SimdVec b) { return _mm256_sub_epi8(a, b); }
+static inline SimdVec simdXor(SimdVec a, SimdVec b) { return _mm256_xor_si256(a, b); }
+static inline SimdVec simdGt(SimdVec a, SimdVec b) { return _mm256_cmpgt_epi8(a, b); }
+static inline uint32_t simdMask(SimdVec v) { return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+#elif !defined(ANCHOR_SCANNER_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define SCANNER_SIMD_WIDTH 16
+using SimdVec = __m128i;
+static inline SimdVec simdLoad(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+static inline SimdVec simdSplat(char c) { return _mm_set1_epi8(c); }
+static inline SimdVec simdEq(SimdVec v, char c) { return _mm_cmpeq_epi8(v, simdSplat(c)); }
+static inline SimdVec simdOr(SimdVec a, SimdVec b) { return _mm_or_si128(a, b); }
+static inline SimdVec simdSub(SimdVec a, SimdVec b) { return _mm_sub_epi8(a, b); }
+static inline SimdVec simdXor(SimdVec a, SimdVec b) { return _mm_xor_si128(a, b); }
+static inline SimdVec simdGt(SimdVec a, SimdVec b) { return _mm_cmpgt_epi8(a, b); }
+static inline uint32_t simdMask(SimdVec v) { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+#endif
+
+#ifdef SCANNER_SIMD_WIDTH
+// movemask 结果中有效位全为1的掩码
+static constexpr uint32_t SIMD_FULL_MASK = (SCANNER_SIMD_WIDTH == 32) ? 0xFFFFFFFFu : 0xFFFFu;
+
+// 每个字节判断 lo <= c < lo + n (按无符号比较): 先减去 lo，再翻转符号位转成有符号比较
+static inline SimdVec simdInRange(SimdVec v, char lo, int n) {
+    SimdVec biased = simdXor(simdSub(v, simdSplat(lo)), simdSplat(static_cast<char>(0x80)));
+    return simdGt(simdSplat(static_cast<char>(n - 128)), biased);
+}
+
+// 低于第 k 位的掩码 (k < 32)
+static inline uint32_t lowBits(int k) { return (1u << k) - 1; }
+#endif
+
+// 跳过一段空白字符，返回第一个非空白字符的位置，newlines 累加其中的换行数
+static const char* skipWhitespaceRun(const char* p, const char* end, int& newlines) {
+#ifdef SCANNER_SIMD_WIDTH
+    while (end - p >= SCANNER_SIMD_WIDTH) {
+        SimdVec v = simdLoad(p);
+        uint32_t nl = simdMask(simdEq(v, '\n'));
+        uint32_t ws = nl | simdMask(simdOr(simdOr(simdEq(v, ' '), simdEq(v, '\t')), simdEq(v, '\r')));
+        uint32_t stop = ~ws & SIMD_FULL_MASK;
+        if (stop) {
+            int k = __builtin_ctz(stop);
+            newlines += __builtin_popcount(nl & lowBits(k));
+            return p + k;
+        }
+        newlines += __builtin_popcount(nl);
+        p += SCANNER_SIMD_WIDTH;
+    }
+#endif
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+        if (*p == '\n') newlines++;
+        ++p;
+    }
+    return p;
+}
+
+// 在块注释正文中查找结束的 "*/"，返回 '*' 的位置 (找不到返回 end)，newlines 累加跳过的换行数
+static const char* findBlockCommentEnd(const char* p, const char* end, int& newlines) {
+#ifdef SCANNER_SIMD_WIDTH
+    // 多读一个字节以判断跨越向量边界的 "*/"，因此要求 p + WIDTH < end
+    while (end - p > SCANNER_SIMD_WIDTH) {
+        SimdVec v = simdLoad(p);
+        uint32_t close = simdMask(simdEq(v, '*')) & simdMask(simdEq(simdLoad(p + 1), '/'));
+        uint32_t nl = simdMask(simdEq(v, '\n'));
+        if (close) {
+            int k = __builtin_ctz(close);
+            newlines += __builtin_popcount(nl & lowBits(k));
+            return p + k;
+        }
+        newlines += __builtin_popcount(nl);
+        p += SCANNER_SIMD_WIDTH;
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == '*' && p + 1 < end && p[1] == '/') return p;
+        if (*p == '\n') newlines++;
+    }
+    return end;
+}
+
+// 跳过标识符字符 [A-Za-z0-9_]，返回第一个非标识符字符的位置
+static const char* skipIdentifierChars(const char* p, const char* end) {
+#ifdef SCANNER_SIMD_WIDTH
+    while (end - p >= SCANNER_SIMD_WIDTH) {
+        SimdVec v = simdLoad(p);
+        SimdVec lower = simdOr(v, simdSplat(0x20)); // 'A'-'Z' 映射到 'a'-'z'，其余字符不会因此落入字母区间
+        SimdVec ok = simdOr(simdOr(simdInRange(lower, 'a', 26), simdInRange(v, '0', 10)), simdEq(v, '_'));
+        uint32_t stop = ~simdMask(ok) & SIMD_FULL_MASK;
+        if (stop) return p + __builtin_ctz(stop);
+        p += SCANNER_SIMD_WIDTH;
+    }
+#endif
+    while (p < end && ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') || (*p >= '0' && *p <= '9') || *p == '_')) {
+        ++p;
+    }
+    return p;
+}
 
 // --- 构造与析构 ---
 Scanner::Scanner(const std::string& filename)
-    : currentLine(1), currentChar('\0'), currentColumn(0) {
-    sourceFile.open(filename);
+    : begin(nullptr), cur(nullptr), end(nullptr), currentLine(1), errorStream(&std::cerr),
+      lookaheadRing(LOOKAHEAD_CAPACITY), lookaheadHead(0), lookaheadCount(0) {
+    std::ifstream sourceFile(filename, std::ios::binary);
     if (!sourceFile.is_open()) {
         std::cerr << "错误: 无法打开源文件: " << filename << std::endl;
         exit(EXIT_FAILURE);
     }
-    getNextCharInternal(); // 读取第一个字符以初始化
-}
-
-Scanner::~Scanner() {
-    if (sourceFile.is_open()) {
-        sourceFile.close();
+    // 一次性把整个文件读入连续缓冲区
+    sourceFile.seekg(0, std::ios::end);
+    std::streamoff fileSize = sourceFile.tellg();
+    sourceFile.seekg(0, std::ios::beg);
+    if (fileSize > 0) {
+        sourceBuffer.resize(static_cast<size_t>(fileSize));
+        sourceFile.read(&sourceBuffer[0], fileSize);
+        sourceBuffer.resize(static_cast<size_t>(sourceFile.gcount()));
     }
+
+    begin = sourceBuffer.data();
+    cur = begin;
+    end = begin + sourceBuffer.size();
 }
 
+Scanner::Scanner(std::string_view text, int firstLine, std::ostream& errorOut)
+    : begin(text.data()), cur(text.data()), end(text.data() + text.size()), currentLine(firstLine),
+      errorStream(&errorOut), lookaheadRing(LOOKAHEAD_CAPACITY), lookaheadHead(0), lookaheadCount(0) {}
+
 // 核心公共接口
 // 获取下一个Token (优先从缓冲区读取)
 Token Scanner::getNextToken() {
-    ensureLookahead(1); // 确保缓冲区中至少有一个Token
-    Token token = lookaheadBuffer.front();
-    lookaheadBuffer.pop_front();
+    if (lookaheadCount == 0) {
+        return fetchNextToken(); // 没有预读过的Token时直接扫描，不经过缓冲区
+    }
+    Token token = std::move(lookaheadRing[lookaheadHead]);
+    lookaheadHead = (lookaheadHead + 1) & (lookaheadRing.size() - 1);
+    lookaheadCount--;
     return token;
 }
 
 // 预读第k个Token
 const Token& Scanner::peekToken(int k) {
     ensureLookahead(k); // 确保缓冲区中至少有k个Token
-    return lookaheadBuffer[k - 1];
+    return lookaheadRing[(lookaheadHead + k - 1) & (lookaheadRing.size() - 1)];
+}
+
+// 批量扫描全部Token，已经预读进缓冲区的Token也会按顺序收进来
+TokenArray Scanner::tokenizeAll() {
+    TokenArray tokens;
+    tokens.source = begin;
+    tokens.reserve(static_cast<size_t>(end - begin) / 4 + 1); // 粗略估计: 平均每4个字节一个Token
+    while (true) {
+        Token token = getNextToken();
+        tokens.push_back(token);
+        if (token.type == TokenType::END_OF_FILE) break;
+    }
+    return tokens;
 }
 
 // 内部实现
 
 // 确保缓冲区中至少有k个Token
 void Scanner::ensureLookahead(int k) {
-    while (lookaheadBuffer.size() < k) {
-        lookaheadBuffer.push_back(fetchNextToken());
+    if (static_cast<size_t>(k) > lookaheadRing.size()) {
+        growLookahead(k);
+    }
+    const size_t mask = lookaheadRing.size() - 1;
+    while (lookaheadCount < static_cast<size_t>(k)) {
+        lookaheadRing[(lookaheadHead + lookaheadCount) & mask] = fetchNextToken();
+        lookaheadCount++;
     }
 }
 
+// 扩容环形缓冲区，并把已缓存的Token按顺序搬到新缓冲区开头
+void Scanner::growLookahead(size_t minCapacity) {
+    size_t capacity = lookaheadRing.size();
+    while (capacity < minCapacity) capacity *= 2;
+    std::vector<Token> grown(capacity);
+    const size_t mask = lookaheadRing.size() - 1;
+    for (size_t i = 0; i < lookaheadCount; ++i) {
+        grown[i] = std::move(lookaheadRing[(lookaheadHead + i) & mask]);
+    }
+    lookaheadRing.swap(grown);
+    lookaheadHead = 0;
+}
+
 // 真正从源文件扫描并构建下一个Token的函数
 Token Scanner::fetchNextToken() {
     while (true) {
         skipWhitespace();
-        if (currentChar == '/' && (sourceFile.peek() == '/' || sourceFile.peek() == '*')) {
+        if (!atEnd() && *cur == '/' && (peekChar() == '/' || peekChar() == '*')) {
             skipComment();
         } else {
             break;
         }
     }
 
-    if (currentChar == EOF) {
+    if (atEnd()) {
         return Token(TokenType::END_OF_FILE, "EOF", currentLine);
     }
 
-    if (isAlpha(currentChar)) {
+    const char c = *cur;
+    if (isAlpha(c)) {
         return processIdentifierOrKeyword();
     }
-    if (isDigit(currentChar) || (currentChar == '.' && isDigit(sourceFile.peek()))) {
+    if (isDigit(c) || (c == '.' && isDigit(peekChar()))) {
         return processNumber();
     }
-    if (currentChar == '\'') {
+    if (c == '\'') {
         return processCharLiteral();
     }
-    if (currentChar == '"') {
+    if (c == '"') {
         return processStringLiteral();
     }
 
@@ -75,46 +235,30 @@ Token Scanner::fetchNextToken() {
 
 
 // --- 字符处理和跳过逻辑 ---
-char Scanner::getNextCharInternal() {
-    if (sourceFile.get(currentChar)) {
-        if (currentChar == '\n') {
-            currentLine++;
-            currentColumn = 0;
-        } else {
-            currentColumn++;
-        }
-    } else {
-        currentChar = EOF;
-    }
-    return currentChar;
-}
-
 bool Scanner::isWhitespace(char c) const {
     return c == ' ' || c == '\t' || c == '\n' || c == '\r';
 }
 
 void Scanner::skipWhitespace() {
-    while (currentChar != EOF && isWhitespace(currentChar)) {
-        getNextCharInternal();
-    }
+    int newlines = 0;
+    cur = skipWhitespaceRun(cur, end, newlines);
+    currentLine += newlines;
 }
 
 void Scanner::skipComment() {
-    if (currentChar == '/') {
-        if (sourceFile.peek() == '/') { // 单行注释
-            while (currentChar != EOF && currentChar != '\n') {
-                getNextCharInternal();
-            }
-        } else if (sourceFile.peek() == '*') { // 多行注释
-            getNextCharInternal(); // 消耗 '/'
-            getNextCharInternal(); // 消耗 '*'
-            while (currentChar != EOF && !(currentChar == '*' && sourceFile.peek() == '/')) {
-                getNextCharInternal();
-            }
-            if (currentChar != EOF) {
-                getNextCharInternal(); // 消耗 '*'
-                getNextCharInternal(); // 消耗 '/'
-            }
+    if (atEnd() || *cur != '/') return;
+    if (peekChar() == '/') { // 单行注释: 直接找到行尾(memchr 本身已向量化)，换行符留给 skipWhitespace 处理
+        const char* nl = static_cast<const char*>(std::memchr(cur, '\n', end - cur));
+        cur = nl ? nl : end;
+    } else if (peekChar() == '*') { // 多行注释
+        advance(); // 消耗 '/'
+        advance(); // 消耗 '*'
+        int newlines = 0;
+        cur = findBlockCommentEnd(cur, end, newlines);
+        currentLine += newlines;
+        if (!atEnd()) {
+            advance(); // 消耗 '*'
+            advance(); // 消耗 '/'
         }
     }
 }
@@ -126,118 +270,105 @@ bool Scanner::isAlpha(char c) const { return (c >= 'a' && c <= 'z') || (c >= 'A'
 bool Scanner::isAlphaNumeric(char c) const { return isAlpha(c) || isDigit(c); }
 
 Token Scanner::processIdentifierOrKeyword() {
-    std::string lexeme_str;
     int startLine = currentLine;
-    while (currentChar != EOF && isAlphaNumeric(currentChar)) {
-        lexeme_str += currentChar;
-        getNextCharInternal();
-    }
-    if (keywordMap.count(lexeme_str)) {
-        return Token(keywordMap.at(lexeme_str), lexeme_str, startLine);
-    }
-    return Token(TokenType::IDENTIFIER, lexeme_str, startLine);
+    const char* start = cur;
+    cur = skipIdentifierChars(cur, end); // 标识符中不会出现换行符，直接移动指针
+    std::string_view lexeme(start, cur - start); // 直接引用缓冲区，不分配内存
+    return Token(lookupKeyword(lexeme), lexeme, startLine);
 }
 
 Token Scanner::processNumber() {
-    std::string lexeme_str;
     int startLine = currentLine;
+    const char* start = cur;
     bool isFloat = false;
 
     // 解析整数部分
-    while (currentChar != EOF && isDigit(currentChar)) {
-        lexeme_str += currentChar;
-        getNextCharInternal();
-    }
+    while (!atEnd() && isDigit(*cur)) ++cur;
 
     // 解析小数部分
-    if (currentChar == '.') {
+    if (!atEnd() && *cur == '.') {
         isFloat = true;
-        lexeme_str += currentChar;
-        getNextCharInternal();
-        while (currentChar != EOF && isDigit(currentChar)) {
-            lexeme_str += currentChar;
-            getNextCharInternal();
-        }
+        ++cur;
+        while (!atEnd() && isDigit(*cur)) ++cur;
     }
 
     // 解析科学计数法部分
-    if (currentChar == 'e' || currentChar == 'E') {
+    if (!atEnd() && (*cur == 'e' || *cur == 'E')) {
         isFloat = true; // 包含科学计数法的数总是浮点数
-        lexeme_str += currentChar;
-        getNextCharInternal();
+        ++cur;
 
         // 处理可选的 '+' 或 '-'
-        if (currentChar == '+' || currentChar == '-') {
-            lexeme_str += currentChar;
-            getNextCharInternal();
-        }
+        if (!atEnd() && (*cur == '+' || *cur == '-')) ++cur;
 
         // 解析指数部分的数字
-        if (!isDigit(currentChar)) {
+        if (atEnd() || !isDigit(*cur)) {
             reportError("科学计数法中缺少指数部分");
         }
-        while (currentChar != EOF && isDigit(currentChar)) {
-            lexeme_str += currentChar;
-            getNextCharInternal();
-        }
+        while (!atEnd() && isDigit(*cur)) ++cur;
     }
 
+
+    std::string_view lexeme(start, cur - start);
     if (isFloat) {
-        return Token(TokenType::FLOAT_LITERAL, lexeme_str, startLine);
+        return Token(TokenType::FLOAT_LITERAL, lexeme, startLine);
     }
-    return Token(TokenType::INT_LITERAL, lexeme_str, startLine);
+    return Token(TokenType::INT_LITERAL, lexeme, startLine);
 }
-
 Token Scanner::processCharLiteral() {
     int startLine = currentLine;
-    getNextCharInternal(); // 消耗起始 '
-    char val = currentChar;
-    getNextCharInternal(); // 消耗字符本身
-    if (currentChar != '\'') {
+    advance(); // 消耗起始 '
+    std::string_view val(cur, atEnd() ? 0 : 1); // 字符本身在缓冲区中的位置
+    advance(); // 消耗字符本身
+    if (atEnd() || *cur != '\'') {
         reportError("字符字面量未闭合");
     }
-    getNextCharInternal(); // 消耗结束 '
-    return Token(TokenType::CHAR_LITERAL, std::string(1, val), startLine);
+    advance(); // 消耗结束 '
+    return Token(TokenType::CHAR_LITERAL, val, startLine);
 }
 
 Token Scanner::processStringLiteral() {
-    std::string lexeme_str;
     int startLine = currentLine;
-    getNextCharInternal(); // 消耗起始 "
-    while (currentChar != EOF && currentChar != '"') {
-        lexeme_str += currentChar;
-        getNextCharInternal();
-    }
-    if (currentChar != '"') {
+    advance(); // 消耗起始 "
+    // 直接在缓冲区中查找结束引号，字符串内部的换行符一次性计入行号
+    const char* start = cur;
+    const char* close = static_cast<const char*>(std::memchr(cur, '"', end - cur));
+    cur = close ? close : end;
+    currentLine += static_cast<int>(std::count(start, cur, '\n'));
+    std::string_view lexeme(start, cur - start); // 不含两侧引号
+    if (atEnd()) {
         reportError("字符串字面量未闭合");
     }
-    getNextCharInternal(); // 消耗结束 "
-    return Token(TokenType::STRING_LITERAL, lexeme_str, startLine);
+    advance(); // 消耗结束 "
+    return Token(TokenType::STRING_LITERAL, lexeme, startLine);
 }
 
 Token Scanner::processOperatorOrDelimiter() {
     int startLine = currentLine;
-    std::string op(1, currentChar);
-    // 尝试匹配双字符操作符
-    if (sourceFile.peek() != EOF) {
-        std::string two_char_op = op + (char)sourceFile.peek();
-        if (operatorMap.count(two_char_op)) {
-            getNextCharInternal();
-            getNextCharInternal();
-            return Token(operatorMap.at(two_char_op), two_char_op, startLine);
-        }
-    }
-    // 匹配单字符操作符
-    if (operatorMap.count(op)) {
-        getNextCharInternal();
-        return Token(operatorMap.at(op), op, startLine);
+    // 先尝试双字符操作符，再匹配单字符 (直接读取下一个字节，不再调用 stream peek)
+    int length = 0;
+    TokenType type = lookupOperator(*cur, peekChar(), length);
+    if (type != TokenType::UNKNOWN) {
+        std::string_view op(cur, length);
+        cur += length;
+        return Token(type, op, startLine);
     }
 
-    reportError("未识别的符号: " + op);
-    getNextCharInternal();
+    std::string_view op(cur, 1);
+    reportError("未识别的符号: " + std::string(op));
+    advance();
     return Token(TokenType::UNKNOWN, op, startLine);
 }
 
 void Scanner::reportError(const std::string& message) const {
-    std::cerr << "词法错误 [行: " << currentLine << ", 列: " << currentColumn << "]: " << message << std::endl;
+    // 行号与列号按需计算: 当前字符本身是换行符时按下一行第 0 列报告 (与逐字符读取时一致)
+    int line = currentLine;
+    int column = 0;
+    if (!atEnd() && *cur == '\n') {
+        line++;
+    } else {
+        const char* lineStart = cur;
+        while (lineStart > begin && lineStart[-1] != '\n') --lineStart;
+        column = static_cast<int>(cur - lineStart) + (atEnd() ? 0 : 1);
+    }
+    *errorStream << "词法错误 [行: " << line << ", 列: " << column << "]: " << message << std::endl;
 }
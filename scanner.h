@@ -2,26 +2,44 @@
 #define SCANNER_H
 
 #include <string>
-#include <fstream>
+#include <string_view>
 #include <vector>
-#include <deque> // 使用 deque 作为缓冲区，便于在前端增删
+#include <iosfwd>
 #include "token.h"
 
 class Scanner {
 private:
-    std::ifstream sourceFile;
-    char currentChar;
+    // 整个源文件一次性读入的连续缓冲区，之后只用裸指针遍历，不再逐字符调用 ifstream::get
+    std::string sourceBuffer;
+    const char* begin; // 缓冲区起始
+    const char* cur;   // 当前字符 (cur == end 表示文件结束)
+    const char* end;   // 缓冲区末尾 (不含)
     int currentLine;
-    int currentColumn;
+    std::ostream* errorStream; // 词法错误输出位置，默认 std::cerr
 
-    // 使用双端队列作为预读缓冲区
-    std::deque<Token> lookaheadBuffer;
+    // 预读环形缓冲区: 容量固定为2的幂，按下标取模定位，不再为每个Token分配和拷贝。
+    // 语法分析器平时最多预读2个Token，只有扫描 "int a[表达式]" 这类声明时才会预读更远，
+    // 那时才按2倍扩容。
+    static constexpr size_t LOOKAHEAD_CAPACITY = 8;
+    std::vector<Token> lookaheadRing;
+    size_t lookaheadHead;  // 最早缓存的Token所在下标
+    size_t lookaheadCount; // 已缓存的Token数量
 
     // 核心词法分析逻辑 (现在是私有的)
     Token fetchNextToken();
 
     // 内部辅助函数
-    char getNextCharInternal();
+    // 前进一个字符，越过换行符时行号加一
+    void advance() {
+        if (cur < end) {
+            if (*cur == '\n') currentLine++;
+            ++cur;
+        }
+    }
+    // 预读当前字符之后第 n 个字符，越界返回 '\0'，纯指针读取
+    char peekChar(int n = 1) const { return (end - cur > n) ? cur[n] : '\0'; }
+    bool atEnd() const { return cur >= end; }
+
     bool isWhitespace(char c) const;
     bool isDigit(char c) const;
     bool isAlpha(char c) const;
@@ -36,14 +54,23 @@ private:
 
     // 填充缓冲区的方法
     void ensureLookahead(int k);
+    void growLookahead(size_t minCapacity);
 
 public:
     Scanner(const std::string& filename);
-    ~Scanner();
+    // 扫描别人持有的一段文本(不拷贝)，firstLine 为这段文本第一行的行号，错误写入 errorOut。
+    // 并行词法分析用它扫描各个分块，text 必须从某一行的行首开始，否则报错的列号不对
+    Scanner(std::string_view text, int firstLine, std::ostream& errorOut);
+    Scanner(const Scanner&) = delete;            // 指针指向自身持有的缓冲区，禁止拷贝
+    Scanner& operator=(const Scanner&) = delete;
 
     // 公共接口
     Token getNextToken(); // 从缓冲区获取或直接扫描新Token
     const Token& peekToken(int k = 1); // 预读第k个Token
+    // 批量模式: 一次扫描完剩余的全部Token(以 END_OF_FILE 结尾)，返回的数组引用本对象的缓冲区
+    TokenArray tokenizeAll();
+
+    std::string_view source() const { return std::string_view(begin, end - begin); }
 
     void reportError(const std::string& message) const;
     int getCurrentLine() const { return currentLine; }
@@ -0,0 +1,1212 @@
+#include "ssa.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <set>
+#include <tuple>
+#include "runtime_value.h"
+
+using namespace std;
+
+namespace {
+
+// 四元式中被读取的变量所在的字段，与 quadUses 一致
+int use_slots(Quadruple& q, Operand* (&slots)[3]) {
+    int count = 0;
+    auto add = [&](Operand& o) { if (o.isVariable()) slots[count++] = &o; };
+    switch (q.op) {
+        case Opcode::LABEL: case Opcode::JUMP: case Opcode::FUNC_BEGIN: case Opcode::FUNC_END:
+        case Opcode::GET_PARAM: case Opcode::CALL:
+            break;
+        case Opcode::DEC_ARRAY: case Opcode::DEC_DYN_ARRAY: case Opcode::LOAD_MEMBER:
+            add(q.arg2);
+            break;
+        case Opcode::LOAD_AT:
+            add(q.arg2);
+            add(q.res);
+            break;
+        case Opcode::STORE_AT:
+            add(q.arg1);
+            add(q.arg2);
+            add(q.res);
+            break;
+        default:
+            add(q.arg1);
+            add(q.arg2);
+            break;
+    }
+    return count;
+}
+
+// 四元式写入的变量所在的字段，与 quadDef 一致
+Operand* def_slot(Quadruple& q) {
+    switch (q.op) {
+        case Opcode::GET_PARAM: case Opcode::LOAD_AT: case Opcode::LOAD_MEMBER:
+        case Opcode::DEC_ARRAY: case Opcode::DEC_DYN_ARRAY:
+            return q.arg1.isVariable() ? &q.arg1 : nullptr;
+        case Opcode::LABEL: case Opcode::JUMP: case Opcode::JUMPF: case Opcode::JUMPNZ:
+        case Opcode::FUNC_BEGIN: case Opcode::FUNC_END: case Opcode::PARAM: case Opcode::RETURN:
+        case Opcode::PRINT: case Opcode::STORE_AT: case Opcode::STORE_MEMBER:
+            return nullptr;
+        default:
+            return q.res.isVariable() ? &q.res : nullptr;
+    }
+}
+
+// 可以做值编号的纯运算
+bool is_pure(Opcode op) {
+    switch (op) {
+        case Opcode::ADD: case Opcode::SUB: case Opcode::MUL: case Opcode::DIV: case Opcode::MOD:
+        case Opcode::NEG: case Opcode::NOT:
+        case Opcode::LT: case Opcode::GT: case Opcode::LE: case Opcode::GE: case Opcode::EQ: case Opcode::NE:
+        case Opcode::AND: case Opcode::OR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool is_constant(const Operand& o) { return !o.isNone() && !o.isVariable() && o.kind != OperandKind::LABEL; }
+
+bool is_number_like(const Operand& o) {
+    return o.isNumeric() || o.kind == OperandKind::BOOL || o.kind == OperandKind::CHAR;
+}
+
+// 按解释器的语义 (见 runtime_value.h) 计算常量运算。操作数不是数值、会出运行时错误 (除以零)
+// 或结果无法写成字面量时返回 false，留给运行时处理
+bool evaluate(Opcode op, const Operand& a, const Operand& b, Operand& result) {
+    if (!is_number_like(a) || (!b.isNone() && !is_number_like(b))) return false;
+    Value x = constantValue(a), y = constantValue(b), v;
+    switch (op) {
+        case Opcode::NEG: case Opcode::NOT:
+            v = performUnary(op, x);
+            break;
+        case Opcode::AND: v = makeBool(truth(x) && truth(y)); break;
+        case Opcode::OR:  v = makeBool(truth(x) || truth(y)); break;
+        case Opcode::LT: case Opcode::GT: case Opcode::LE: case Opcode::GE: case Opcode::EQ: case Opcode::NE:
+            v = performComparison(op, x, y);
+            break;
+        case Opcode::ADD: case Opcode::SUB: case Opcode::MUL: case Opcode::DIV: case Opcode::MOD: {
+            if ((op == Opcode::DIV || op == Opcode::MOD) && !truth(y)) return false;
+            RuntimeHeap heap;
+            v = performArithmetic(op, x, y, heap);
+            break;
+        }
+        default: return false;
+    }
+    switch (v.type) {
+        case ValueType::INT:  result = Operand::intImm(v.i); return true;
+        case ValueType::BOOL: result = Operand::boolImm(v.i != 0); return true;
+        case ValueType::FLOAT: {
+            if (!std::isfinite(v.f)) return false;
+            // 能精确读回的最短拼写，整数值也保持浮点类型
+            char spelling[32];
+            for (int precision = 15; precision <= 17; ++precision) {
+                snprintf(spelling, sizeof spelling, "%.*g", precision, v.f);
+                if (strtod(spelling, nullptr) == v.f) break;
+            }
+            string text = spelling;
+            if (text.find_first_of(".eEn") == string::npos) text += ".0";
+            result = Operand::number(text);
+            return true;
+        }
+        default: return false;
+    }
+}
+
+// 条件跳转读到的常量的真假，字符串等不确定时返回 false
+bool known_truth(const Operand& c, bool& value) {
+    if (!is_number_like(c)) return false;
+    value = truth(constantValue(c));
+    return true;
+}
+
+} // namespace
+
+SsaForm::SsaForm(vector<BasicBlock>& bbs, const unordered_set<NameId>& globals, SymbolTable& st, ostream& out)
+    : blocks(bbs), pinned(globals), symbol_table(st), log(out) {}
+
+bool SsaForm::is_ssa(const Operand& o) const {
+    return o.isVariable() && (renamable.count(o.name) || origin.count(o.name));
+}
+
+NameId SsaForm::origin_of(NameId name) const {
+    auto it = origin.find(name);
+    return it == origin.end() ? name : it->second;
+}
+
+Operand SsaForm::resolve(Operand o) const {
+    while (o.isVariable()) {
+        auto it = replacement.find(o.name);
+        if (it == replacement.end()) break;
+        o = it->second;
+    }
+    return o;
+}
+
+void SsaForm::resolve_uses(int b) {
+    for (auto& phi : phis[b]) {
+        for (auto& arg : phi.args) arg = resolve(arg);
+    }
+    for (auto& q : blocks[b].quads) {
+        Operand* slots[3];
+        int count = use_slots(q, slots);
+        for (int k = 0; k < count; ++k) *slots[k] = resolve(*slots[k]);
+    }
+}
+
+// 定义已被传播掉的四元式退出 SSA 时会删掉，不计在内
+size_t SsaForm::quadCount() const {
+    size_t count = 0;
+    for (int b : order) {
+        for (const auto& q : blocks[b].quads) {
+            const Operand def = quadDef(q);
+            if (!def.isVariable() || !replacement.count(def.name)) ++count;
+        }
+    }
+    return count;
+}
+
+void SsaForm::replace(const Operand& dest, const Operand& value, const char* tag) {
+    replacement[dest.name] = value;
+    log << "  [" << tag << "] " << dest.str() << " -> " << value.str() << endl;
+}
+
+// ---------------------------------------------------------------- 构造
+
+void SsaForm::construct() {
+    const int n = static_cast<int>(blocks.size());
+    idom.assign(n, -1);
+    dom_children.assign(n, {});
+    frontier.assign(n, {});
+    dom_pre.assign(n, -1);
+    dom_post.assign(n, -1);
+    phis.assign(n, {});
+
+    for (const auto& block : blocks) {
+        if (!block.quads.empty() && block.quads[0].op == Opcode::LABEL) label_block[block.quads[0].arg1.name] = block.id;
+        // 数组和结构体变量只按引用使用，不重命名
+        for (const auto& q : block.quads) {
+            switch (q.op) {
+                case Opcode::DEC_ARRAY: case Opcode::DEC_DYN_ARRAY:
+                    pinned.insert(q.arg1.name);
+                    break;
+                case Opcode::LOAD_AT: case Opcode::STORE_AT: case Opcode::LOAD_MEMBER: case Opcode::STORE_MEMBER:
+                    pinned.insert(q.arg2.name);
+                    break;
+                default: break;
+            }
+        }
+    }
+
+    // 区域入口: 各函数的 FUNC_BEGIN 块，以及跳过所有函数体之后的第一个顶层块。
+    // 入口块本身是循环头 (有前驱) 的区域不做变换
+    entries.clear();
+    for (int i = 0; i < n; ++i) {
+        if (blocks[i].quads.front().op == Opcode::FUNC_BEGIN) entries.push_back(i);
+    }
+    int top = 0;
+    while (top < n && blocks[top].quads.front().op == Opcode::FUNC_BEGIN) {
+        while (top < n && blocks[top].quads.back().op != Opcode::FUNC_END) ++top;
+        ++top;
+    }
+    if (top < n) entries.push_back(top);
+    roots = entries;
+    entries.erase(remove_if(entries.begin(), entries.end(), [&](int e) { return !blocks[e].predecessors.empty(); }),
+                  entries.end());
+
+    for (int entry : entries) compute_dominators(entry);
+
+    // 参与重命名的变量: 可达代码中出现的、没有被钉住的变量
+    for (int b = 0; b < n; ++b) {
+        if (idom[b] < 0) continue;
+        for (const auto& q : blocks[b].quads) {
+            Operand uses[3];
+            int count = quadUses(q, uses);
+            uses[count++] = quadDef(q);
+            for (int k = 0; k < count; ++k) {
+                const Operand& v = uses[k];
+                if (!v.isVariable() || pinned.count(v.name)) continue;
+                if (renamable.insert(v.name).second) variables.push_back(v);
+            }
+        }
+    }
+
+    place_phis();
+    for (int entry : entries) rename(entry);
+    log << "--- SSA: " << entries.size() << " 个区域, " << order.size() << " 个可达基本块, 插入 "
+         << phis_inserted << " 个 phi ---" << endl;
+}
+
+// Cooper-Harvey-Kennedy: 按逆后序迭代求直接支配者，再求支配边界
+void SsaForm::compute_dominators(int entry) {
+    vector<int> postorder;
+    vector<char> visited(blocks.size(), 0);
+    vector<pair<int, size_t>> stack{{entry, 0}};
+    visited[entry] = 1;
+    while (!stack.empty()) {
+        auto& [b, next] = stack.back();
+        if (next < blocks[b].successors.size()) {
+            int s = blocks[b].successors[next++];
+            if (!visited[s]) {
+                visited[s] = 1;
+                stack.push_back({s, 0});
+            }
+        } else {
+            postorder.push_back(b);
+            stack.pop_back();
+        }
+    }
+    vector<int> rpo_number(blocks.size(), -1);
+    for (size_t k = 0; k < postorder.size(); ++k) rpo_number[postorder[k]] = static_cast<int>(postorder.size() - 1 - k);
+
+    auto intersect = [&](int a, int b) {
+        while (a != b) {
+            while (rpo_number[a] > rpo_number[b]) a = idom[a];
+            while (rpo_number[b] > rpo_number[a]) b = idom[b];
+        }
+        return a;
+    };
+    idom[entry] = entry;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto it = postorder.rbegin(); it != postorder.rend(); ++it) {
+            int b = *it;
+            if (b == entry) continue;
+            int new_idom = -1;
+            for (int p : blocks[b].predecessors) {
+                if (idom[p] < 0) continue;
+                new_idom = new_idom < 0 ? p : intersect(p, new_idom);
+            }
+            if (new_idom != idom[b]) {
+                idom[b] = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    for (int b : postorder) {
+        if (b != entry) dom_children[idom[b]].push_back(b);
+        if (blocks[b].predecessors.size() < 2) continue;
+        for (int p : blocks[b].predecessors) {
+            if (idom[p] < 0) continue;
+            for (int runner = p; runner != idom[b]; runner = idom[runner]) {
+                auto& df = frontier[runner];
+                if (find(df.begin(), df.end(), b) == df.end()) df.push_back(b);
+            }
+        }
+    }
+    // 子节点按块的原顺序排列，使版本编号与代码顺序一致
+    for (int b : postorder) sort(dom_children[b].begin(), dom_children[b].end());
+}
+
+// 在定义所在块的迭代支配边界上插入 phi，只插在变量入口活跃的块
+void SsaForm::place_phis() {
+    unordered_map<NameId, vector<int>> def_blocks;
+    for (int b = 0; b < static_cast<int>(blocks.size()); ++b) {
+        if (idom[b] < 0) continue;
+        for (const auto& q : blocks[b].quads) {
+            Operand def = quadDef(q);
+            if (q.op == Opcode::GET_PARAM || !def.isVariable() || !renamable.count(def.name)) continue;
+            auto& list = def_blocks[def.name];
+            if (list.empty() || list.back() != b) list.push_back(b);
+        }
+    }
+
+    for (const Operand& var : variables) {
+        auto found = def_blocks.find(var.name);
+        if (found == def_blocks.end()) continue;
+        vector<int> worklist = found->second;
+        unordered_set<int> in_worklist(worklist.begin(), worklist.end());
+        unordered_set<int> placed;
+        while (!worklist.empty()) {
+            int b = worklist.back();
+            worklist.pop_back();
+            for (int d : frontier[b]) {
+                if (placed.count(d) || !blocks[d].live_in.count(var)) continue;
+                placed.insert(d);
+                phis[d].push_back({var, var, vector<Operand>(blocks[d].predecessors.size())});
+                ++phis_inserted;
+                if (in_worklist.insert(d).second) worklist.push_back(d);
+            }
+        }
+    }
+}
+
+// 沿支配树先序给每个定义一个新版本，把读取换成当前版本，并填写后继块 phi 的参数
+void SsaForm::rename(int entry) {
+    unordered_map<NameId, vector<NameId>> current;
+    vector<NameId> pushed;
+    auto top = [&](const Operand& var) {
+        Operand v = var;
+        auto it = current.find(var.name);
+        if (it != current.end() && !it->second.empty()) v.name = it->second.back();
+        return v;
+    };
+    auto new_version = [&](const Operand& var) {
+        auto& list = versions[var.name];
+        Operand v = var;
+        v.name = intern(nameOf(var.name) + "." + to_string(list.size() + 1));
+        list.push_back(v.name);
+        origin[v.name] = var.name;
+        current[var.name].push_back(v.name);
+        pushed.push_back(var.name);
+        return v;
+    };
+
+    vector<pair<int, size_t>> stack{{entry, SIZE_MAX}};
+    while (!stack.empty()) {
+        auto [b, mark] = stack.back();
+        stack.pop_back();
+        if (mark != SIZE_MAX) { // 离开 b: 撤销它压入的版本
+            while (pushed.size() > mark) {
+                current[pushed.back()].pop_back();
+                pushed.pop_back();
+            }
+            dom_post[b] = dom_clock++;
+            continue;
+        }
+        dom_pre[b] = dom_clock++;
+        order.push_back(b);
+        stack.push_back({b, pushed.size()});
+
+        for (auto& phi : phis[b]) phi.dest = new_version(phi.var);
+        for (auto& q : blocks[b].quads) {
+            Operand* slots[3];
+            int count = use_slots(q, slots);
+            for (int k = 0; k < count; ++k) {
+                if (renamable.count(slots[k]->name)) *slots[k] = top(*slots[k]);
+            }
+            // 参数的值就是第 0 个版本
+            Operand* def = def_slot(q);
+            if (def && q.op != Opcode::GET_PARAM && renamable.count(def->name)) *def = new_version(*def);
+        }
+        for (int s : blocks[b].successors) {
+            const auto& preds = blocks[s].predecessors;
+            for (auto& phi : phis[s]) {
+                for (size_t j = 0; j < preds.size(); ++j) {
+                    if (preds[j] == b) phi.args[j] = top(phi.var);
+                }
+            }
+        }
+        for (auto it = dom_children[b].rbegin(); it != dom_children[b].rend(); ++it) stack.push_back({*it, SIZE_MAX});
+    }
+}
+
+// ---------------------------------------------------------------- 优化
+
+size_t SsaForm::propagate() {
+    size_t rewrites = 0;
+    for (int b : order) {
+        resolve_uses(b);
+        // 除自身外只有一个不同参数的 phi 就是那个值
+        for (auto& phi : phis[b]) {
+            if (replacement.count(phi.dest.name)) continue;
+            Operand unique = Operand::none();
+            bool single = true;
+            for (const auto& arg : phi.args) {
+                if (arg.isNone() || arg == phi.dest) continue;
+                if (unique.isNone()) unique = arg;
+                else if (arg != unique) single = false;
+            }
+            if (single && !unique.isNone()) {
+                replace(phi.dest, unique, is_constant(unique) ? "常量传播" : "复写传播");
+                ++rewrites;
+            }
+        }
+        for (auto& q : blocks[b].quads) {
+            Operand* def = def_slot(q);
+            if (!def || !is_ssa(*def) || replacement.count(def->name)) continue;
+            if (q.op == Opcode::ASSIGN) {
+                Operand src = resolve(q.arg1);
+                if (is_constant(src) || is_ssa(src)) {
+                    replace(*def, src, is_constant(src) ? "常量传播" : "复写传播");
+                    ++rewrites;
+                }
+            } else if (q.arg1.isNumeric() && q.arg2.isNumeric()) {
+                Operand folded;
+                if (fold_constants(q.op, q.arg1, q.arg2, folded)) {
+                    log << "  [常量折叠] " << q.toString() << " -> " << folded.str() << endl;
+                    replace(*def, folded, "常量传播");
+                    ++rewrites;
+                }
+            }
+        }
+    }
+    return rewrites;
+}
+
+size_t SsaForm::numberValues() {
+    using Key = tuple<Opcode, OperandKind, NameId, OperandKind, NameId>;
+    map<Key, vector<pair<Operand, int>>> table; // 计算 -> 已有的值及其所在块
+    size_t rewrites = 0;
+    for (int b : order) {
+        resolve_uses(b);
+        // 同一块里参数完全相同的 phi
+        for (size_t i = 0; i < phis[b].size(); ++i) {
+            const auto& phi = phis[b][i];
+            if (replacement.count(phi.dest.name)) continue;
+            for (size_t k = 0; k < i; ++k) {
+                const auto& other = phis[b][k];
+                if (replacement.count(other.dest.name) || other.args != phi.args) continue;
+                replace(phi.dest, other.dest, "GVN");
+                ++rewrites;
+                break;
+            }
+        }
+        for (auto& q : blocks[b].quads) {
+            Operand* def = def_slot(q);
+            if (!is_pure(q.op) || !def || !is_ssa(*def) || replacement.count(def->name)) continue;
+            Operand a = q.arg1, c = q.arg2;
+            bool operands_known = (is_constant(a) || is_ssa(a)) && (c.isNone() || is_constant(c) || is_ssa(c));
+            if (!operands_known) continue;
+            if (isCommutative(q.op) && c < a) swap(a, c);
+            auto& candidates = table[Key(q.op, a.kind, a.name, c.kind, c.name)];
+            const Operand* existing = nullptr;
+            for (const auto& [value, where] : candidates) {
+                if (!replacement.count(value.name) && dominates(where, b)) {
+                    existing = &value;
+                    break;
+                }
+            }
+            if (existing) {
+                log << "  [GVN] " << q.toString() << endl;
+                replace(*def, *existing, "GVN");
+                ++rewrites;
+            } else {
+                candidates.emplace_back(*def, b);
+            }
+        }
+    }
+    return rewrites;
+}
+
+// 标记-清除: 有副作用的四元式 (输出、调用、跳转、数组和结构体访问、写入不参与重命名的变量……) 读取的版本是活的，
+// 活的版本的定义读取的版本也是活的。剩下的纯运算、复写和 phi 都可以删除。
+// 除法和取模可能除以零，只有除数是非零常量时才算纯运算
+size_t SsaForm::eliminateDeadCode() {
+    auto removable = [&](Quadruple& q) {
+        Operand* def = def_slot(q);
+        if (!def || !is_ssa(*def) || (q.op != Opcode::ASSIGN && !is_pure(q.op))) return false;
+        if (q.op == Opcode::DIV || q.op == Opcode::MOD) {
+            bool divisor;
+            return known_truth(q.arg2, divisor) && divisor;
+        }
+        return true;
+    };
+
+    unordered_map<NameId, pair<int, int>> definition; // 版本 -> (块, 四元式下标)，phi 的下标记为 -1 - k
+    vector<NameId> work;
+    unordered_set<NameId> live;
+    auto mark = [&](const Operand& o) {
+        if (is_ssa(o) && live.insert(o.name).second) work.push_back(o.name);
+    };
+    for (int b : order) {
+        resolve_uses(b);
+        for (size_t k = 0; k < phis[b].size(); ++k) {
+            if (!replacement.count(phis[b][k].dest.name)) definition[phis[b][k].dest.name] = {b, -1 - static_cast<int>(k)};
+        }
+        auto& quads = blocks[b].quads;
+        for (size_t i = 0; i < quads.size(); ++i) {
+            Operand* def = def_slot(quads[i]);
+            if (def && replacement.count(def->name)) continue; // 退出 SSA 时会删掉
+            if (removable(quads[i])) {
+                definition[def->name] = {b, static_cast<int>(i)};
+                continue;
+            }
+            Operand* slots[3];
+            int count = use_slots(quads[i], slots);
+            for (int k = 0; k < count; ++k) mark(*slots[k]);
+        }
+    }
+    while (!work.empty()) {
+        NameId name = work.back();
+        work.pop_back();
+        auto it = definition.find(name);
+        if (it == definition.end()) continue;
+        auto [b, i] = it->second;
+        if (i < 0) {
+            for (const auto& arg : phis[b][-1 - i].args) mark(arg);
+        } else {
+            Operand* slots[3];
+            int count = use_slots(blocks[b].quads[i], slots);
+            for (int k = 0; k < count; ++k) mark(*slots[k]);
+        }
+    }
+
+    size_t removed = 0;
+    for (int b : order) {
+        auto& quads = blocks[b].quads;
+        quads.erase(remove_if(quads.begin(), quads.end(), [&](Quadruple& q) {
+            Operand* def = def_slot(q);
+            if (!def || replacement.count(def->name) || !removable(q) || live.count(def->name)) return false;
+            log << "  [死代码删除] " << q.toString() << endl;
+            ++removed;
+            return true;
+        }), quads.end());
+        auto& list = phis[b];
+        list.erase(remove_if(list.begin(), list.end(), [&](const PhiNode& phi) {
+            if (replacement.count(phi.dest.name) || live.count(phi.dest.name)) return false;
+            ++removed;
+            return true;
+        }), list.end());
+    }
+    return removed;
+}
+
+// Wegman-Zadeck 的稀疏条件常量传播: 每个版本的格值从 "未知" 只降不升，经过 "常量" 到 "不是常量";
+// 只有可执行的边才参与 phi 的合并，条件已知的跳转只让一条出边可执行。
+// 求解后常量版本换成常量，条件已知的跳转改成 JUMP 或删掉，删除不可执行的块并从 CFG 中去掉死边
+size_t SsaForm::propagateConditionalConstants() {
+    const int n = static_cast<int>(blocks.size());
+    for (int b : order) resolve_uses(b);
+
+    enum class Lattice { TOP, CONSTANT, BOTTOM };
+    unordered_map<NameId, Operand> constant; // 格值为常量的版本
+    unordered_set<NameId> varying;           // 格值为 "不是常量" 的版本，其余版本为 "未知"
+    auto value_of = [&](const Operand& o, Operand& c) {
+        if (is_constant(o)) {
+            c = o;
+            return Lattice::CONSTANT;
+        }
+        // 第 0 个版本 (参数、入口处的值) 和不参与重命名的变量都不是常量
+        if (!o.isVariable() || !origin.count(o.name) || varying.count(o.name)) return Lattice::BOTTOM;
+        auto it = constant.find(o.name);
+        if (it == constant.end()) return Lattice::TOP;
+        c = it->second;
+        return Lattice::CONSTANT;
+    };
+
+    vector<NameId> ssa_work;
+    auto lower = [&](NameId v, Lattice lattice, const Operand& c) {
+        if (lattice == Lattice::TOP || varying.count(v)) return;
+        auto it = constant.find(v);
+        if (lattice == Lattice::CONSTANT && it == constant.end()) {
+            constant[v] = c;
+        } else if (lattice == Lattice::BOTTOM || it->second != c) {
+            if (it != constant.end()) constant.erase(it);
+            varying.insert(v);
+        } else {
+            return;
+        }
+        ssa_work.push_back(v);
+    };
+
+    // 每个版本被读取的位置: (块, 指令下标)，phi 的下标记为 -1 - k
+    unordered_map<NameId, vector<pair<int, int>>> users;
+    for (int b : order) {
+        for (size_t k = 0; k < phis[b].size(); ++k) {
+            for (const auto& arg : phis[b][k].args) {
+                if (arg.isVariable()) users[arg.name].emplace_back(b, -1 - static_cast<int>(k));
+            }
+        }
+        for (size_t i = 0; i < blocks[b].quads.size(); ++i) {
+            Operand uses[3];
+            int count = quadUses(blocks[b].quads[i], uses);
+            for (int k = 0; k < count; ++k) users[uses[k].name].emplace_back(b, static_cast<int>(i));
+        }
+    }
+
+    vector<char> executable(n, 0);
+    set<pair<int, int>> executable_edges;
+    vector<pair<int, int>> flow_work;
+    auto reach = [&](int p, int s) {
+        if (executable_edges.insert({p, s}).second) flow_work.emplace_back(p, s);
+    };
+    // 条件跳转的后继: successors[0] 是跳转目标，之后是顺序执行的下一块
+    auto visit_edges = [&](int b) {
+        const auto& succ = blocks[b].successors;
+        const auto& quads = blocks[b].quads;
+        bool conditional = !quads.empty() && (quads.back().op == Opcode::JUMPF || quads.back().op == Opcode::JUMPNZ);
+        if (conditional && label_block.count(quads.back().res.name)) {
+            const Quadruple& last = quads.back();
+            Operand c;
+            Lattice lattice = value_of(last.arg1, c);
+            if (lattice == Lattice::TOP) return;
+            bool truth_value;
+            if (lattice == Lattice::CONSTANT && known_truth(c, truth_value)) {
+                bool taken = last.op == Opcode::JUMPF ? !truth_value : truth_value;
+                if (taken) reach(b, succ[0]);
+                else if (succ.size() > 1) reach(b, succ[1]);
+                return;
+            }
+        }
+        for (int s : succ) reach(b, s);
+    };
+    auto visit_phi = [&](int b, const PhiNode& phi) {
+        const auto& preds = blocks[b].predecessors;
+        Lattice merged = Lattice::TOP;
+        Operand value;
+        for (size_t j = 0; j < preds.size() && merged != Lattice::BOTTOM; ++j) {
+            if (!executable_edges.count({preds[j], b})) continue;
+            Operand c;
+            Lattice lattice = value_of(phi.args[j], c);
+            if (lattice == Lattice::TOP) continue;
+            if (lattice == Lattice::BOTTOM || (merged == Lattice::CONSTANT && c != value)) {
+                merged = Lattice::BOTTOM;
+            } else {
+                merged = Lattice::CONSTANT;
+                value = c;
+            }
+        }
+        lower(phi.dest.name, merged, value);
+    };
+    auto visit_quad = [&](int b, size_t i) {
+        const Quadruple& q = blocks[b].quads[i];
+        Operand def = quadDef(q);
+        if (def.isVariable() && origin.count(def.name)) {
+            Operand a, c, folded;
+            if (q.op == Opcode::ASSIGN) {
+                Lattice lattice = value_of(q.arg1, a);
+                lower(def.name, lattice, a);
+            } else if (is_pure(q.op)) {
+                Lattice left = value_of(q.arg1, a);
+                Lattice right = q.arg2.isNone() ? Lattice::CONSTANT : value_of(q.arg2, c);
+                if (left == Lattice::BOTTOM || right == Lattice::BOTTOM) {
+                    lower(def.name, Lattice::BOTTOM, a);
+                } else if (left == Lattice::CONSTANT && right == Lattice::CONSTANT) {
+                    bool ok = evaluate(q.op, a, q.arg2.isNone() ? Operand::none() : c, folded);
+                    lower(def.name, ok ? Lattice::CONSTANT : Lattice::BOTTOM, folded);
+                }
+            } else {
+                lower(def.name, Lattice::BOTTOM, a);
+            }
+        }
+        if (i + 1 == blocks[b].quads.size()) visit_edges(b);
+    };
+
+    for (int entry : entries) flow_work.emplace_back(-1, entry);
+    while (!flow_work.empty() || !ssa_work.empty()) {
+        while (!flow_work.empty()) {
+            int s = flow_work.back().second;
+            flow_work.pop_back();
+            if (executable[s]) {
+                for (const auto& phi : phis[s]) visit_phi(s, phi);
+                continue;
+            }
+            executable[s] = 1;
+            for (const auto& phi : phis[s]) visit_phi(s, phi);
+            for (size_t i = 0; i < blocks[s].quads.size(); ++i) visit_quad(s, i);
+            if (blocks[s].quads.empty()) visit_edges(s);
+        }
+        while (!ssa_work.empty()) {
+            NameId v = ssa_work.back();
+            ssa_work.pop_back();
+            auto it = users.find(v);
+            if (it == users.end()) continue;
+            for (auto [b, i] : it->second) {
+                if (!executable[b]) continue;
+                if (i < 0) visit_phi(b, phis[b][-1 - i]);
+                else visit_quad(b, static_cast<size_t>(i));
+            }
+        }
+    }
+
+    // 改写: 常量版本换成常量，条件已知的跳转改成 JUMP 或删掉，不可执行的块只保留 FUNC_END
+    size_t constants = 0, branches = 0, removed = 0;
+    for (int b : order) {
+        auto& quads = blocks[b].quads;
+        if (!executable[b]) {
+            // 标签留着: 原本就不可达的代码可能还跳到这里，没用的标签最后会被移除
+            log << "  [SCCP 删除不可达块] 块 " << b << endl;
+            quads.erase(remove_if(quads.begin(), quads.end(), [](const Quadruple& q) {
+                return q.op != Opcode::FUNC_END && q.op != Opcode::LABEL;
+            }), quads.end());
+            phis[b].clear();
+            blocks[b].successors.clear();
+            idom[b] = -1;
+            ++removed;
+            continue;
+        }
+        for (const auto& phi : phis[b]) {
+            if (auto it = constant.find(phi.dest.name); it != constant.end()) {
+                replace(phi.dest, it->second, "SCCP");
+                ++constants;
+            }
+        }
+        for (auto& q : quads) {
+            Operand def = quadDef(q);
+            if (!def.isVariable()) continue;
+            if (auto it = constant.find(def.name); it != constant.end() && !replacement.count(def.name)) {
+                replace(def, it->second, "SCCP");
+                ++constants;
+            }
+        }
+        auto& succ = blocks[b].successors;
+        if (quads.empty()) continue;
+        Quadruple& last = quads.back();
+        Operand c;
+        bool truth_value;
+        if ((last.op == Opcode::JUMPF || last.op == Opcode::JUMPNZ) && label_block.count(last.res.name) &&
+            value_of(last.arg1, c) == Lattice::CONSTANT && known_truth(c, truth_value)) {
+            bool taken = last.op == Opcode::JUMPF ? !truth_value : truth_value;
+            log << "  [SCCP 条件跳转] " << last.toString() << (taken ? " -> 总是跳转" : " -> 从不跳转") << endl;
+            ++branches;
+            if (taken) {
+                last = Quadruple(Opcode::JUMP, Operand::none(), Operand::none(), last.res);
+                succ = {succ[0]};
+            } else {
+                quads.pop_back();
+                succ = succ.size() > 1 ? vector<int>{succ[1]} : vector<int>{};
+            }
+        } else {
+            succ.erase(remove_if(succ.begin(), succ.end(), [&](int s) { return !executable_edges.count({b, s}); }),
+                       succ.end());
+        }
+    }
+    order.erase(remove_if(order.begin(), order.end(), [&](int b) { return !executable[b]; }), order.end());
+
+    // 按新的后继重建前驱，phi 的参数跟着前驱移动 (同一前驱出现两次时两个参数相同)
+    vector<vector<int>> old_preds(n);
+    for (auto& block : blocks) old_preds[block.id] = std::move(block.predecessors);
+    for (auto& block : blocks) block.predecessors.clear();
+    for (const auto& block : blocks) {
+        for (int s : block.successors) blocks[s].predecessors.push_back(block.id);
+    }
+    for (int b : order) {
+        const auto& preds = blocks[b].predecessors;
+        for (auto& phi : phis[b]) {
+            vector<Operand> args(preds.size());
+            for (size_t j = 0; j < preds.size(); ++j) {
+                auto at = find(old_preds[b].begin(), old_preds[b].end(), preds[j]);
+                if (at != old_preds[b].end()) args[j] = phi.args[at - old_preds[b].begin()];
+            }
+            phi.args = std::move(args);
+        }
+    }
+
+    log << "--- SCCP: " << constants << " 个常量, " << branches << " 个条件跳转, 删除 " << removed
+         << " 个不可达块 ---" << endl;
+    return constants + branches + removed;
+}
+
+// ---------------------------------------------------------------- 循环
+
+vector<SsaForm::Loop> SsaForm::find_loops() const {
+    map<int, Loop> by_header;
+    for (int b : order) {
+        for (int h : blocks[b].successors) {
+            if (idom[h] < 0 || !dominates(h, b)) continue;
+            Loop& loop = by_header[h];
+            loop.header = h;
+            if (find(loop.latches.begin(), loop.latches.end(), b) == loop.latches.end()) loop.latches.push_back(b);
+            // 从回边的源逆着前驱走，到循环头为止
+            loop.body.insert(h);
+            vector<int> work{b};
+            while (!work.empty()) {
+                int x = work.back();
+                work.pop_back();
+                if (!loop.body.insert(x).second) continue;
+                for (int p : blocks[x].predecessors) {
+                    if (idom[p] >= 0) work.push_back(p);
+                }
+            }
+        }
+    }
+    vector<Loop> loops;
+    for (auto& [h, loop] : by_header) {
+        int outside = -1, count = 0;
+        for (int p : blocks[h].predecessors) {
+            if (!loop.body.count(p)) {
+                outside = p;
+                ++count;
+            }
+        }
+        if (count == 1 && blocks[outside].successors.size() == 1) {
+            const auto& quads = blocks[outside].quads;
+            bool conditional = !quads.empty() && (quads.back().op == Opcode::JUMPF || quads.back().op == Opcode::JUMPNZ);
+            if (!conditional) loop.preheader = outside;
+        }
+        loops.push_back(std::move(loop));
+    }
+    // 内层循环在前，外提到内层前置块的代码还能继续提到外层
+    stable_sort(loops.begin(), loops.end(), [](const Loop& a, const Loop& b) { return a.body.size() < b.body.size(); });
+    return loops;
+}
+
+// 每个 (未被传播掉的) 版本的定义所在块。没有定义的是第 0 个版本，即进入区域时的值
+unordered_map<NameId, int> SsaForm::def_blocks() const {
+    unordered_map<NameId, int> where;
+    for (int b : order) {
+        for (const auto& phi : phis[b]) where[phi.dest.name] = b;
+        for (const auto& q : blocks[b].quads) {
+            Operand def = quadDef(q);
+            if (is_ssa(def)) where[def.name] = b;
+        }
+    }
+    return where;
+}
+
+size_t SsaForm::hoistLoopInvariants() {
+    size_t rewrites = 0;
+    for (const Loop& loop : find_loops()) {
+        if (loop.preheader < 0) continue;
+        auto where = def_blocks();
+        auto invariant = [&](const Operand& o) {
+            if (o.isNone() || is_constant(o)) return true;
+            if (!is_ssa(o)) return false;
+            auto it = where.find(o.name);
+            return it == where.end() || !loop.body.count(it->second);
+        };
+        vector<Quadruple> hoisted;
+        // 按支配树先序访问，被外提的定义总在读取它的运算之前
+        for (int b : order) {
+            if (!loop.body.count(b)) continue;
+            resolve_uses(b);
+            auto& quads = blocks[b].quads;
+            for (size_t i = 0; i < quads.size();) {
+                Quadruple& q = quads[i];
+                Operand* def = def_slot(q);
+                bool movable = is_pure(q.op) && def && is_ssa(*def) && !replacement.count(def->name) &&
+                               invariant(q.arg1) && invariant(q.arg2);
+                // 循环可能一次也不执行，外提的运算不能引入除以零
+                if (movable && (q.op == Opcode::DIV || q.op == Opcode::MOD)) {
+                    bool divisor;
+                    movable = known_truth(q.arg2, divisor) && divisor;
+                }
+                if (!movable) {
+                    ++i;
+                    continue;
+                }
+                log << "  [循环不变量外提] " << q.toString() << " -> 块 " << loop.preheader << endl;
+                where[def->name] = loop.preheader;
+                hoisted.push_back(q);
+                quads.erase(quads.begin() + i);
+            }
+        }
+        if (hoisted.empty()) continue;
+        // 放在前置块的跳转之前; 顺序执行进入循环时放在末尾
+        auto& quads = blocks[loop.preheader].quads;
+        auto at = !quads.empty() && quads.back().op == Opcode::JUMP ? quads.end() - 1 : quads.end();
+        quads.insert(at, hoisted.begin(), hoisted.end());
+        rewrites += hoisted.size();
+    }
+    return rewrites;
+}
+
+size_t SsaForm::reduceStrength() {
+    size_t rewrites = 0;
+    for (const Loop& loop : find_loops()) {
+        // 只处理有前置块、只有一条回边的循环: 循环头的 phi 恰好一个参数是初值，一个是上一轮的值
+        const int h = loop.header;
+        const auto& preds = blocks[h].predecessors;
+        if (loop.preheader < 0 || loop.latches.size() != 1 || preds.size() != 2) continue;
+        const size_t entry = preds[0] == loop.preheader ? 0 : 1, back = 1 - entry;
+        if (preds[entry] != loop.preheader || preds[back] != loop.latches[0]) continue;
+
+        unordered_map<NameId, pair<int, size_t>> site; // 循环里的定义 -> (块, 下标)
+        for (int b : order) {
+            if (!loop.body.count(b)) continue;
+            resolve_uses(b);
+            auto& quads = blocks[b].quads;
+            for (size_t i = 0; i < quads.size(); ++i) {
+                if (Operand* d = def_slot(quads[i]); d && is_ssa(*d) && !replacement.count(d->name)) site[d->name] = {b, i};
+            }
+        }
+
+        // 基本归纳变量: i = phi(整数常量, i + 整数常量)
+        struct Induction { Operand init, step; int block; size_t at; };
+        unordered_map<NameId, Induction> basic;
+        for (const auto& phi : phis[h]) {
+            if (replacement.count(phi.dest.name)) continue;
+            Operand init = resolve(phi.args[entry]), next = resolve(phi.args[back]);
+            if (init.kind != OperandKind::INT || !is_ssa(next)) continue;
+            auto it = site.find(next.name);
+            if (it == site.end()) continue;
+            const Quadruple& q = blocks[it->second.first].quads[it->second.second];
+            Operand step;
+            if (q.op == Opcode::ADD && q.arg1 == phi.dest && q.arg2.kind == OperandKind::INT) step = q.arg2;
+            else if (q.op == Opcode::ADD && q.arg2 == phi.dest && q.arg1.kind == OperandKind::INT) step = q.arg1;
+            else if (q.op == Opcode::SUB && q.arg1 == phi.dest && q.arg2.kind == OperandKind::INT) step = Operand::intImm(static_cast<int64_t>(0 - static_cast<uint64_t>(q.arg2.intValue)));
+            else continue;
+            basic[phi.dest.name] = {init, step, it->second.first, it->second.second};
+        }
+        if (basic.empty()) continue;
+
+        // i * k 换成新的归纳变量 j = phi(初值 * k, j + 步长 * k)，同一个 (i, k) 共用一个 j。
+        // 整数乘法按 2^64 回绕，逐轮累加的结果与每轮相乘完全相同
+        map<pair<NameId, int64_t>, Operand> derived;
+        vector<tuple<int, size_t, Quadruple>> increments;
+        for (int b : order) {
+            if (!loop.body.count(b)) continue;
+            for (auto& q : blocks[b].quads) {
+                Operand* def = def_slot(q);
+                if (q.op != Opcode::MUL || !def || !is_ssa(*def) || replacement.count(def->name)) continue;
+                Operand iv = q.arg1, k = q.arg2;
+                if (!iv.isVariable() || !basic.count(iv.name)) swap(iv, k);
+                auto found = basic.find(iv.name);
+                if (!iv.isVariable() || found == basic.end() || k.kind != OperandKind::INT) continue;
+                const Induction& ind = found->second;
+                Operand& j = derived[{iv.name, k.intValue}];
+                if (j.isNone()) {
+                    Operand start, stride;
+                    if (!evaluate(Opcode::MUL, ind.init, k, start) || !evaluate(Opcode::MUL, ind.step, k, stride)) continue;
+                    j = Operand::temp(symbol_table.generateTempVar());
+                    Operand next = Operand::temp(symbol_table.generateTempVar());
+                    renamable.insert(j.name);
+                    renamable.insert(next.name);
+                    PhiNode phi{j, j, vector<Operand>(2)};
+                    phi.args[entry] = start;
+                    phi.args[back] = next;
+                    phis[h].push_back(std::move(phi));
+                    ++phis_inserted;
+                    increments.emplace_back(ind.block, ind.at, Quadruple(Opcode::ADD, j, stride, next));
+                }
+                log << "  [强度削弱] " << q.toString() << " -> " << j.str() << endl;
+                q = Quadruple(Opcode::ASSIGN, j, Operand::none(), *def);
+                ++rewrites;
+            }
+        }
+        // 新归纳变量的累加紧跟在原归纳变量的累加之后，从后往前插入以免下标失效
+        sort(increments.begin(), increments.end(), [](const auto& a, const auto& b) {
+            return tie(get<0>(a), get<1>(a)) > tie(get<0>(b), get<1>(b));
+        });
+        for (auto& [b, at, inc] : increments) {
+            auto& quads = blocks[b].quads;
+            quads.insert(quads.begin() + at + 1, inc);
+        }
+    }
+    return rewrites;
+}
+
+// ---------------------------------------------------------------- 退出 SSA
+
+// 把一组并行复写 (dest <- src) 排成顺序的赋值: 先做目标不再被其他复写读取的，成环时借一个临时变量
+void SsaForm::emit_copies(vector<pair<Operand, Operand>> copies, vector<Quadruple>& out) {
+    while (!copies.empty()) {
+        auto ready = find_if(copies.begin(), copies.end(), [&](const auto& c) {
+            return none_of(copies.begin(), copies.end(), [&](const auto& other) { return other.second == c.first; });
+        });
+        if (ready != copies.end()) {
+            out.emplace_back(Opcode::ASSIGN, ready->second, Operand::none(), ready->first);
+            copies.erase(ready);
+            continue;
+        }
+        Operand saved = Operand::temp(symbol_table.generateTempVar());
+        Operand blocked = copies.front().first;
+        out.emplace_back(Opcode::ASSIGN, blocked, Operand::none(), saved);
+        for (auto& c : copies) {
+            if (c.second == blocked) c.second = saved;
+        }
+    }
+}
+
+vector<Quadruple> SsaForm::destruct() {
+    const int n = static_cast<int>(blocks.size());
+
+    // 0. 从所有区域入口都走不到的块 (无条件跳转、RETURN 之后的代码) 只留下函数边界
+    vector<bool> reachable(n, false);
+    vector<int> work(roots.begin(), roots.end());
+    while (!work.empty()) {
+        int b = work.back();
+        work.pop_back();
+        if (reachable[b]) continue;
+        reachable[b] = true;
+        for (int s : blocks[b].successors) work.push_back(s);
+    }
+    for (int b = 0; b < n; ++b) {
+        if (reachable[b]) continue;
+        auto& quads = blocks[b].quads;
+        size_t before = quads.size();
+        quads.erase(remove_if(quads.begin(), quads.end(), [](const Quadruple& q) {
+            return q.op != Opcode::FUNC_BEGIN && q.op != Opcode::FUNC_END;
+        }), quads.end());
+        if (quads.size() != before) log << "  [删除不可达块] 块 " << b << endl;
+    }
+
+    // 1. 删掉被传播掉的定义，剩下的读取换成最终的值
+    for (int b : order) {
+        resolve_uses(b);
+        auto& quads = blocks[b].quads;
+        quads.erase(remove_if(quads.begin(), quads.end(), [&](Quadruple& q) {
+            Operand* def = def_slot(q);
+            return def && replacement.count(def->name);
+        }), quads.end());
+        auto& list = phis[b];
+        list.erase(remove_if(list.begin(), list.end(), [&](const PhiNode& phi) {
+            return replacement.count(phi.dest.name) > 0;
+        }), list.end());
+    }
+
+    // 2. SSA 上的活跃变量分析 (只看版本变量)。phi 的参数在对应前驱的出口活跃
+    vector<set<NameId>> use(n), def(n), live_in(n), live_out(n);
+    for (int b : order) {
+        for (const auto& phi : phis[b]) def[b].insert(phi.dest.name);
+        for (auto& q : blocks[b].quads) {
+            Operand* slots[3];
+            int count = use_slots(q, slots);
+            for (int k = 0; k < count; ++k) {
+                if (is_ssa(*slots[k]) && !def[b].count(slots[k]->name)) use[b].insert(slots[k]->name);
+            }
+            if (Operand* d = def_slot(q); d && is_ssa(*d)) def[b].insert(d->name);
+        }
+    }
+    auto phi_uses = [&](int p, int s, set<NameId>& into) {
+        const auto& preds = blocks[s].predecessors;
+        for (const auto& phi : phis[s]) {
+            for (size_t j = 0; j < preds.size(); ++j) {
+                if (preds[j] == p && is_ssa(phi.args[j])) into.insert(phi.args[j].name);
+            }
+        }
+    };
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            int b = *it;
+            set<NameId> out;
+            for (int s : blocks[b].successors) {
+                out.insert(live_in[s].begin(), live_in[s].end());
+                phi_uses(b, s, out);
+            }
+            set<NameId> in = use[b];
+            for (NameId v : out) {
+                if (!def[b].count(v)) in.insert(v);
+            }
+            if (out != live_out[b] || in != live_in[b]) {
+                live_out[b] = std::move(out);
+                live_in[b] = std::move(in);
+                changed = true;
+            }
+        }
+    }
+
+    // 3. 同一变量的两个版本, 一个在另一个定义处活跃, 就不能共用原名
+    set<pair<NameId, NameId>> interfere;
+    auto conflict = [&](NameId d, const set<NameId>& live) {
+        NameId o = origin_of(d);
+        for (NameId w : live) {
+            if (w != d && origin_of(w) == o) {
+                interfere.insert({d, w});
+                interfere.insert({w, d});
+            }
+        }
+    };
+    for (int b : order) {
+        set<NameId> live = live_out[b];
+        auto& quads = blocks[b].quads;
+        for (auto it = quads.rbegin(); it != quads.rend(); ++it) {
+            if (Operand* d = def_slot(*it); d && is_ssa(*d)) {
+                conflict(d->name, live);
+                live.erase(d->name);
+            }
+            Operand* slots[3];
+            int count = use_slots(*it, slots);
+            for (int k = 0; k < count; ++k) {
+                if (is_ssa(*slots[k])) live.insert(slots[k]->name);
+            }
+        }
+        for (const auto& phi : phis[b]) live.insert(phi.dest.name);
+        for (const auto& phi : phis[b]) conflict(phi.dest.name, live);
+    }
+
+    // 4. 每个变量的版本依次尝试合并回原名 (第 0 个版本总是原名)，冲突的换成新的临时变量
+    unordered_map<NameId, Operand> final_name;
+    for (const Operand& var : variables) {
+        vector<NameId> group{var.name};
+        auto found = versions.find(var.name);
+        if (found == versions.end()) continue;
+        for (NameId v : found->second) {
+            if (replacement.count(v)) continue;
+            bool free = none_of(group.begin(), group.end(), [&](NameId g) { return interfere.count({v, g}) > 0; });
+            if (free) {
+                group.push_back(v);
+                final_name[v] = var;
+            } else {
+                final_name[v] = Operand::temp(symbol_table.generateTempVar());
+                log << "  [SSA 版本冲突] " << nameOf(v) << " -> " << final_name[v].str() << endl;
+            }
+        }
+    }
+    auto rename_back = [&](Operand& o) {
+        if (!o.isVariable()) return;
+        auto it = final_name.find(o.name);
+        if (it != final_name.end()) o = it->second;
+    };
+    for (int b : order) {
+        for (auto& q : blocks[b].quads) {
+            Operand* slots[3];
+            int count = use_slots(q, slots);
+            for (int k = 0; k < count; ++k) rename_back(*slots[k]);
+            if (Operand* d = def_slot(q)) rename_back(*d);
+        }
+        for (auto& phi : phis[b]) {
+            rename_back(phi.dest);
+            for (auto& arg : phi.args) rename_back(arg);
+        }
+    }
+
+    // 5. phi 变成前驱边上的并行复写。无条件跳转的复写放在跳转之前，顺序执行的边放在块末尾
+    //    (条件跳转之后即只在不跳转时执行)，条件跳转的跳转边拆出新块: LABEL 新标签; 复写; JUMP 原目标
+    enum class Place { BEFORE_JUMP, AT_END, SPLIT };
+    map<pair<int, Place>, vector<pair<Operand, Operand>>> edge_copies;    // (前驱, 位置) -> 复写
+    map<int, vector<pair<Operand, vector<pair<Operand, Operand>>>>> split_blocks; // 目标块 -> 拆出的块
+    unordered_map<int, Operand> skip_jump;    // 顺序执行到拆出块之前的前驱要跳过它们
+    auto terminator = [&](int p) { return blocks[p].quads.empty() ? Opcode::LABEL : blocks[p].quads.back().op; };
+    for (int s : order) {
+        if (phis[s].empty()) continue;
+        const auto& preds = blocks[s].predecessors;
+        map<int, vector<pair<Operand, Operand>>> split_copies;
+        vector<int> falls; // 顺序执行到 s 的前驱
+        for (size_t j = 0; j < preds.size(); ++j) {
+            int p = preds[j];
+            if (idom[p] < 0) continue;
+            // 同一前驱可能两次出现 (条件跳转的两个目标相同): 第 k 次对应它后继列表中 s 的第 k 次出现
+            size_t occurrence = count(preds.begin(), preds.begin() + j, p), index = 0;
+            const auto& succ = blocks[p].successors;
+            for (size_t seen = 0; index < succ.size(); ++index) {
+                if (succ[index] == s && seen++ == occurrence) break;
+            }
+            Opcode term = terminator(p);
+            bool conditional = term == Opcode::JUMPF || term == Opcode::JUMPNZ;
+            bool jump_edge = (term == Opcode::JUMP || conditional) && index == 0 &&
+                             label_block.count(blocks[p].quads.back().res.name);
+            Place place = !jump_edge ? Place::AT_END : conditional ? Place::SPLIT : Place::BEFORE_JUMP;
+            if (place == Place::AT_END) falls.push_back(p);
+            vector<pair<Operand, Operand>> copies;
+            for (const auto& phi : phis[s]) {
+                if (phi.dest != phi.args[j]) copies.emplace_back(phi.dest, phi.args[j]);
+            }
+            if (copies.empty()) continue;
+            auto& into = place == Place::SPLIT ? split_copies[p] : edge_copies[{p, place}];
+            into.insert(into.end(), copies.begin(), copies.end());
+        }
+        for (auto& [p, copies] : split_copies) {
+            Operand label = Operand::label(symbol_table.generateLabel());
+            blocks[p].quads.back().res = label;
+            split_blocks[s].emplace_back(label, std::move(copies));
+        }
+        if (!split_copies.empty()) {
+            for (int p : falls) skip_jump[p] = blocks[s].quads.front().arg1;
+        }
+    }
+
+    vector<Quadruple> result;
+    for (int b = 0; b < n; ++b) {
+        if (auto it = split_blocks.find(b); it != split_blocks.end()) {
+            auto& list = it->second;
+            for (size_t k = 0; k < list.size(); ++k) {
+                result.emplace_back(Opcode::LABEL, list[k].first);
+                emit_copies(list[k].second, result);
+                if (k + 1 < list.size()) {
+                    result.emplace_back(Opcode::JUMP, Operand::none(), Operand::none(), blocks[b].quads.front().arg1);
+                }
+            }
+        }
+        const auto& quads = blocks[b].quads;
+        auto before = edge_copies.find({b, Place::BEFORE_JUMP});
+        auto at_end = edge_copies.find({b, Place::AT_END});
+        size_t body = before != edge_copies.end() ? quads.size() - 1 : quads.size();
+        result.insert(result.end(), quads.begin(), quads.begin() + body);
+        if (before != edge_copies.end()) emit_copies(before->second, result);
+        result.insert(result.end(), quads.begin() + body, quads.end());
+        if (at_end != edge_copies.end()) emit_copies(at_end->second, result);
+        if (auto skip = skip_jump.find(b); skip != skip_jump.end()) {
+            result.emplace_back(Opcode::JUMP, Operand::none(), Operand::none(), skip->second);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,105 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include <ostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "optimizer.h"
+
+// 基本块入口处的 phi: dest = phi(args...)
+struct PhiNode {
+    Operand var;                // 原变量
+    Operand dest;               // 新版本
+    std::vector<Operand> args;  // 与所在块的 predecessors 一一对应，来自不可达前驱的为 NONE
+};
+
+// 跨基本块的全局优化: 在 Optimizer 划分好的基本块和 CFG 上构造 SSA 形式，
+// 做稀疏条件常量传播 (SCCP)、全局常量传播、复写传播、值编号 (GVN)、循环优化和死代码删除，
+// 再转换回普通的四元式序列，从任何区域入口都走不到的块在这时删除。
+//
+// 每个函数体和顶层代码各自是一个区域，按 Cooper-Harvey-Kennedy 的迭代算法求支配树，
+// 按支配边界插入 phi (只插在变量入口活跃的块，即剪枝的 SSA)，沿支配树先序重命名。
+// 变量的第 0 个版本就是原来的名字 (参数和未赋值就读取的值)，之后的版本驻留为 "x.1"、"x.2"……
+// 全局变量、数组和结构体变量不参与重命名: 前者可能被调用修改，后两者是引用且结构体在
+// 第一次访问成员时才分配。
+//
+// 退出 SSA 时，互不干涉的版本合并回原名，其余换成新的临时变量;
+// phi 变成前驱末尾的并行复写，条件跳转的跳转边上需要复写时拆出一个新块。
+class SsaForm {
+public:
+    SsaForm(std::vector<BasicBlock>& blocks, const std::unordered_set<NameId>& globals, SymbolTable& st, std::ostream& log);
+
+    // 支配树、支配边界、插入 phi、重命名。blocks 需已建好 CFG 并做过活跃变量分析
+    void construct();
+    // 以下各遍返回改写的次数，为 0 即没有改动
+    // 稀疏条件常量传播 (SCCP): 跨块传播常量，消去条件已知的跳转并删除因此不可达的块。
+    // 改写次数为变成常量的版本、消去的条件跳转和删除的块数之和
+    size_t propagateConditionalConstants();
+    // 全局常量传播和复写传播 (顺带折叠常量运算)，返回被传播掉的版本数
+    size_t propagate();
+    // 全局值编号: 被支配的等价计算换成已有的值，返回替换的个数
+    size_t numberValues();
+    // 循环不变代码外提: 自然循环里操作数都在循环外定义的纯运算移到前置块，返回外提的四元式数
+    size_t hoistLoopInvariants();
+    // 归纳变量的强度削弱: 循环里的 i * k (i 每轮加常数，k 为常数) 换成每轮累加的新归纳变量，返回替换的乘法数
+    size_t reduceStrength();
+    // 全局死代码删除: 结果最终没有被有副作用的四元式用到的纯运算、复写和 phi 删除，返回删除的个数
+    size_t eliminateDeadCode();
+    // 转换回普通的四元式序列，块按原顺序排列
+    std::vector<Quadruple> destruct();
+
+    size_t phiCount() const { return phis_inserted; }
+    // 可达块的个数和其中四元式的条数 (不含 phi)
+    size_t blockCount() const { return order.size(); }
+    size_t quadCount() const;
+
+private:
+    std::vector<BasicBlock>& blocks;
+    std::unordered_set<NameId> pinned;   // 不参与重命名的变量
+    SymbolTable& symbol_table;
+    std::ostream& log;
+
+    std::unordered_map<NameId, int> label_block;     // 标签 -> 所在块
+    std::vector<int> idom;                            // 直接支配者，-1 为不可达
+    std::vector<std::vector<int>> dom_children;
+    std::vector<std::vector<int>> frontier;           // 支配边界
+    std::vector<int> dom_pre, dom_post;               // 支配树上的先序/后序编号，用于判断支配关系
+    int dom_clock = 0;
+    std::vector<int> entries;                         // 各区域的入口块
+    std::vector<int> roots;                           // 同上，包括入口有前驱、不做变换的区域
+    std::vector<int> order;                           // 所有可达块，按支配树先序
+    std::vector<std::vector<PhiNode>> phis;
+    size_t phis_inserted = 0;
+
+    std::unordered_set<NameId> renamable;                      // 参与重命名的原变量
+    std::vector<Operand> variables;                            // 同上，按首次出现的顺序
+    std::unordered_map<NameId, NameId> origin;                 // 版本 -> 原变量
+    std::unordered_map<NameId, std::vector<NameId>> versions;  // 原变量 -> 各版本，按创建顺序
+    std::unordered_map<NameId, Operand> replacement;           // 被传播掉的版本 -> 代替它的值
+
+    // 自然循环: 回边 latch -> header 中 header 支配 latch，循环体是不经过 header 能到达 latch 的块。
+    // 同一循环头的多条回边合成一个循环
+    struct Loop {
+        int header = -1;
+        std::vector<int> latches;
+        std::unordered_set<int> body;
+        int preheader = -1;   // 唯一的循环外前驱且只通向循环头时是它，否则为 -1
+    };
+
+    void compute_dominators(int entry);
+    void place_phis();
+    void rename(int entry);
+
+    bool is_ssa(const Operand& o) const;
+    NameId origin_of(NameId name) const;
+    bool dominates(int a, int b) const { return dom_pre[a] <= dom_pre[b] && dom_post[b] <= dom_post[a]; }
+    Operand resolve(Operand o) const;
+    void resolve_uses(int block);
+    void replace(const Operand& dest, const Operand& value, const char* tag);
+    std::vector<Loop> find_loops() const;
+    std::unordered_map<NameId, int> def_blocks() const;
+    void emit_copies(std::vector<std::pair<Operand, Operand>> copies, std::vector<Quadruple>& out);
+};
+
+#endif // SSA_H
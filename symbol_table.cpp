@@ -12,16 +12,16 @@ SymbolTable::SymbolTable() : currentOffset(0), tempVarCounter(0), labelCounter(0
 // 初始化基础类型并添加到类型系统中
 void SymbolTable::initializePrimitiveTypes() {
     // name, size, alignment
-    knownTypes["int"] = make_shared<TypeInfo>(TypeKind::PRIMITIVE, "int", 4, 4);
-    knownTypes["float"] = make_shared<TypeInfo>(TypeKind::PRIMITIVE, "float", 8, 8);
-    knownTypes["char"] = make_shared<TypeInfo>(TypeKind::PRIMITIVE, "char", 1, 1);
-    knownTypes["bool"] = make_shared<TypeInfo>(TypeKind::PRIMITIVE, "bool", 1, 1);
-    knownTypes["string"] = make_shared<TypeInfo>(TypeKind::PRIMITIVE, "string", 8, 8); // 假设字符串是指针大小
-    knownTypes["void"] = make_shared<TypeInfo>(TypeKind::VOID_TYPE, "void", 0, 0);
+    knownTypes[intern("int")] = make_shared<TypeInfo>(TypeKind::PRIMITIVE, "int", 4, 4);
+    knownTypes[intern("float")] = make_shared<TypeInfo>(TypeKind::PRIMITIVE, "float", 8, 8);
+    knownTypes[intern("char")] = make_shared<TypeInfo>(TypeKind::PRIMITIVE, "char", 1, 1);
+    knownTypes[intern("bool")] = make_shared<TypeInfo>(TypeKind::PRIMITIVE, "bool", 1, 1);
+    knownTypes[intern("string")] = make_shared<TypeInfo>(TypeKind::PRIMITIVE, "string", 8, 8); // 假设字符串是指针大小
+    knownTypes[intern("void")] = make_shared<TypeInfo>(TypeKind::VOID_TYPE, "void", 0, 0);
 }
 
 void SymbolTable::enterScope() {
-    scopes.push_back(unordered_map<string, Symbol>());
+    scopes.push_back(unordered_map<NameId, Symbol>());
 }
 
 void SymbolTable::exitScope() {
@@ -40,7 +40,7 @@ bool SymbolTable::insert(Symbol symbol) {
     auto& currentScopeMap = scopes.back();
 
     if (currentScopeMap.count(symbol.name)) {
-        cerr << "[语义错误] 标识符 '" << symbol.name
+        cerr << "[语义错误] 标识符 '" << nameOf(symbol.name)
              << "' 在当前作用域中重复声明 (行 " << symbol.lineDeclared << ")" << endl;
         return false;
     }
@@ -61,7 +61,7 @@ bool SymbolTable::insert(Symbol symbol) {
 }
 
 // 在作用域中查找符号
-Symbol* SymbolTable::lookup(const string& name, bool currentScopeOnly) {
+Symbol* SymbolTable::lookup(NameId name, bool currentScopeOnly) {
     if (currentScopeOnly) {
         if (!scopes.empty()) {
             auto& current = scopes.back();
@@ -82,7 +82,7 @@ Symbol* SymbolTable::lookup(const string& name, bool currentScopeOnly) {
 }
 
 // 查找所有曾经声明过的符号
-const Symbol* SymbolTable::lookupEverDeclared(const std::string& name) const {
+const Symbol* SymbolTable::lookupEverDeclared(NameId name) const {
     auto it = allSymbolsEverDeclared.find(name);
     if (it != allSymbolsEverDeclared.end()) {
         return &it->second;
@@ -91,7 +91,7 @@ const Symbol* SymbolTable::lookupEverDeclared(const std::string& name) const {
 }
 
 // 查找一个已知的类型
-std::shared_ptr<TypeInfo> SymbolTable::lookupType(const std::string& typeName) {
+std::shared_ptr<TypeInfo> SymbolTable::lookupType(NameId typeName) {
     auto it = knownTypes.find(typeName);
     if (it != knownTypes.end()) {
         return it->second;
@@ -100,7 +100,7 @@ std::shared_ptr<TypeInfo> SymbolTable::lookupType(const std::string& typeName) {
 }
 
 // 添加新的用户定义类型
-void SymbolTable::addType(const std::string& typeName, std::shared_ptr<TypeInfo> typeInfo) {
+void SymbolTable::addType(NameId typeName, std::shared_ptr<TypeInfo> typeInfo) {
     if (knownTypes.count(typeName)) {
         // 错误处理：类型重定义
         return;
@@ -115,7 +115,7 @@ void SymbolTable::dumpCurrentScope() const {
         const auto& current = scopes.back();
         for (const auto& pair : current) {
             const Symbol& sym = pair.second;
-            cout << "  " << sym.name << " (类型: " << (sym.type ? sym.type->name : "null")
+            cout << "  " << nameOf(sym.name) << " (类型: " << (sym.type ? sym.type->name : "null")
                  << ", 类别: " << static_cast<int>(sym.category)
                  << ", 层级: " << sym.scopeLevel // 打印层级
                  << ", 行号: " << sym.lineDeclared << ")" << endl;
@@ -135,7 +135,7 @@ void SymbolTable::dumpAll() const {
         }
         for (const auto& pair : scopeMap) {
             const Symbol& sym = pair.second;
-             cout << "  " << sym.name << " (类型: " << (sym.type ? sym.type->name : "null")
+             cout << "  " << nameOf(sym.name) << " (类型: " << (sym.type ? sym.type->name : "null")
                  << ", 类别: " << static_cast<int>(sym.category)
                  << ", 层级: " << sym.scopeLevel // 打印层级
                  << ", 行号: " << sym.lineDeclared << ")" << endl;
@@ -149,7 +149,7 @@ void SymbolTable::dumpAll() const {
     }
     for (const auto& pair : allSymbolsEverDeclared) {
         const Symbol& sym = pair.second;
-        cout << "  " << sym.name << " (类型: " << (sym.type ? sym.type->name : "null")
+        cout << "  " << nameOf(sym.name) << " (类型: " << (sym.type ? sym.type->name : "null")
              << ", 类别: " << static_cast<int>(sym.category)
              << ", 层级: " << sym.scopeLevel // 打印层级
              << ", 行号: " << sym.lineDeclared << ")" << endl;
@@ -157,14 +157,45 @@ void SymbolTable::dumpAll() const {
     cout << "--- 所有曾声明的符号结束 ---" << endl;
 }
 
-std::string SymbolTable::generateTempVar() {
-    return "T" + to_string(tempVarCounter++);
+namespace {
+thread_local SymbolTable::FunctionNames* activeFunctionNames = nullptr; // 本线程当前的 FunctionNames
 }
 
-std::string SymbolTable::generateLabel() {
-    return "L" + to_string(labelCounter++);
+SymbolTable::FunctionNames::FunctionNames(SymbolTable& t, NameId function)
+    : table(t), counters([&]() -> NameCounters& {
+          lock_guard<mutex> lock(t.functionCountersMutex);
+          return t.functionCounters[function];
+      }()),
+      suffix("_" + nameOf(function)), previous(activeFunctionNames) {
+    activeFunctionNames = this;
 }
 
-const std::unordered_map<std::string, Symbol>& SymbolTable::getAllSymbols() const {
+SymbolTable::FunctionNames::~FunctionNames() {
+    activeFunctionNames = previous;
+}
+
+NameId SymbolTable::generateTempVar() {
+    FunctionNames* names = activeFunctionNames;
+    if (names && &names->table == this) return intern("T" + to_string(names->counters.temps++) + names->suffix);
+    return intern("T" + to_string(tempVarCounter++));
+}
+
+NameId SymbolTable::generateLabel() {
+    FunctionNames* names = activeFunctionNames;
+    if (names && &names->table == this) return intern("L" + to_string(names->counters.labels++) + names->suffix);
+    return intern("L" + to_string(labelCounter++));
+}
+
+const std::unordered_map<NameId, Symbol>& SymbolTable::getAllSymbols() const {
     return allSymbolsEverDeclared;
 }
+
+void SymbolTable::restoreSymbol(const Symbol& symbol, bool inGlobalScope, bool everDeclared) {
+    if (inGlobalScope) scopes.front()[symbol.name] = symbol;
+    if (everDeclared) allSymbolsEverDeclared[symbol.name] = symbol;
+}
+
+void SymbolTable::restoreCounters(int temps, int labels) {
+    tempVarCounter = temps;
+    labelCounter = labels;
+}
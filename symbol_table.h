@@ -6,21 +6,24 @@
 #include <unordered_map>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <utility>
 
+#include "interner.h"
+
 //类型系统
 // 前向声明，以支持指针和递归类型定义
 struct TypeInfo;
 
 // 用于函数参数的结构体
 struct ParameterInfo {
-    std::string name;
+    NameId name;
     std::shared_ptr<TypeInfo> type;
 };
 
 //用于描述结构题的成员的结构体（我的附庸的附庸不是我的附庸，bushi）
 struct StructMemberInfo {
-    std::string name;
+    NameId name;
     std::shared_ptr<TypeInfo> type;
     int offset;
 };
@@ -72,7 +75,7 @@ enum class SymbolCategory {
 
 // 符号表中的条目
 struct Symbol {
-    std::string name;
+    NameId name;
     SymbolCategory category;
     std::shared_ptr<TypeInfo> type; // 使用 TypeInfo 代替 std::string
     bool isConst;
@@ -81,49 +84,88 @@ struct Symbol {
     int lineDeclared;
     int scopeLevel;
 
-    Symbol() : isConst(false), isInitialized(false), memoryOffset(-1), lineDeclared(-1), scopeLevel(-1) {}
+    Symbol() : name(NAME_NONE), isConst(false), isInitialized(false), memoryOffset(-1), lineDeclared(-1), scopeLevel(-1) {}
 
-    Symbol(std::string n, SymbolCategory cat, std::shared_ptr<TypeInfo> t,
+    Symbol(NameId n, SymbolCategory cat, std::shared_ptr<TypeInfo> t,
            int line, bool cst = false, bool init = false, int offset = -1)
-        : name(std::move(n)), category(cat), type(std::move(t)), isConst(cst),
+        : name(n), category(cat), type(std::move(t)), isConst(cst),
           isInitialized(init), memoryOffset(offset), lineDeclared(line), scopeLevel(-1) {}
 };
 
-// 符号表类
+// 符号表类，所有表都以驻留后的名字 id 为键。
+// 语义分析结束后只读取 (lookup、lookupType 等)，可以在多个线程里同时查询；生成名字见 FunctionNames
 class SymbolTable {
 private:
-    std::vector<std::unordered_map<std::string, Symbol>> scopes;
+    std::vector<std::unordered_map<NameId, Symbol>> scopes;
     int currentOffset = 0;
     int tempVarCounter = 0;
     int labelCounter = 0;
 
-    std::unordered_map<std::string, std::shared_ptr<TypeInfo>> knownTypes;
+    std::unordered_map<NameId, std::shared_ptr<TypeInfo>> knownTypes;
+
+    std::unordered_map<NameId, Symbol> allSymbolsEverDeclared;
 
-    std::unordered_map<std::string, Symbol> allSymbolsEverDeclared;
+    // 各函数自己的临时变量和标签计数器 (见 FunctionNames)
+    struct NameCounters {
+        int temps = 0;
+        int labels = 0;
+    };
+    std::unordered_map<NameId, NameCounters> functionCounters;
+    std::mutex functionCountersMutex;
 
     void initializePrimitiveTypes();
 
 public:
     SymbolTable();
 
+    // 并行处理各个函数时，处理函数 function 的任务先在自己的线程上建一个 FunctionNames。
+    // 在它的生存期内，这个线程调用 generateTempVar/generateLabel 得到带函数名后缀的名字 (如 T3_fib、L0_fib)，
+    // 计数器按函数各存一份，先优化、后生成代码时接着编号。这样各函数的名字互不冲突，也不随线程调度而变。
+    // 顶层代码不建 FunctionNames，使用共享的计数器，同一时刻只能有一个线程这样做
+    class FunctionNames {
+    public:
+        FunctionNames(SymbolTable& table, NameId function);
+        ~FunctionNames();
+        FunctionNames(const FunctionNames&) = delete;
+        FunctionNames& operator=(const FunctionNames&) = delete;
+
+    private:
+        friend class SymbolTable;
+        SymbolTable& table;
+        NameCounters& counters;
+        std::string suffix;
+        FunctionNames* previous;
+    };
+
     void enterScope();
     void exitScope();
 
     bool insert(Symbol symbol);
 
-    Symbol* lookup(const std::string& name, bool currentScopeOnly = false);
-    const Symbol* lookupEverDeclared(const std::string& name) const;
+    Symbol* lookup(NameId name, bool currentScopeOnly = false);
+    const Symbol* lookupEverDeclared(NameId name) const;
 
-    std::shared_ptr<TypeInfo> lookupType(const std::string& typeName);
-    void addType(const std::string& typeName, std::shared_ptr<TypeInfo> typeInfo);
+    std::shared_ptr<TypeInfo> lookupType(NameId typeName);
+    std::shared_ptr<TypeInfo> lookupType(std::string_view typeName) { return lookupType(intern(typeName)); }
+    void addType(NameId typeName, std::shared_ptr<TypeInfo> typeInfo);
 
     void dumpCurrentScope() const;
     void dumpAll() const;
 
-    std::string generateTempVar();
-    std::string generateLabel();
+    NameId generateTempVar();
+    NameId generateLabel();
+
+    const std::unordered_map<NameId, Symbol> &getAllSymbols() const;
 
-    const std::unordered_map<std::string, Symbol> &getAllSymbols() const;
+    // 以下供 .aqir 文件的读写使用 (见 aqir.h)
+    const std::unordered_map<NameId, Symbol>& getGlobalScope() const { return scopes.front(); }
+    const std::unordered_map<NameId, std::shared_ptr<TypeInfo>>& getKnownTypes() const { return knownTypes; }
+    int getTempVarCount() const { return tempVarCounter; }
+    int getLabelCount() const { return labelCounter; }
+    // 按原样恢复一个符号 (保留其 scopeLevel)，可分别放入全局作用域和曾声明符号表
+    void restoreSymbol(const Symbol& symbol, bool inGlobalScope, bool everDeclared);
+    // 恢复临时变量和标签计数器，保证之后生成的名字不与已有的重复
+    void restoreCounters(int temps, int labels);
 };
 
 #endif // SYMBOL_TABLE_H
@@ -0,0 +1,92 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// 固定大小的线程池: 启动时创建好工作线程，任务按提交顺序取出执行。
+// 注意不要在池内的任务里再调用同一个池的 parallelFor 并等待，线程全部阻塞时会死锁。
+class ThreadPool {
+public:
+    // threadCount 为 0 时使用硬件线程数
+    explicit ThreadPool(unsigned threadCount = 0) {
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        workers.reserve(threadCount);
+        for (unsigned i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // 提交一个任务，通过返回的 future 取得结果或任务抛出的异常
+    template <typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<F>> {
+        using Result = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace([packaged] { (*packaged)(); });
+        }
+        wakeup.notify_one();
+        return result;
+    }
+
+    // 对 [0, count) 的每个下标调用 body(i)，全部完成后才返回；任务中的异常在这里重新抛出
+    template <typename F>
+    void parallelFor(size_t count, F&& body) {
+        std::vector<std::future<void>> pending;
+        pending.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            pending.push_back(submit([&body, i] { body(i); }));
+        }
+        for (auto& f : pending) f.wait(); // 先等全部结束，body 的引用才能安全失效
+        for (auto& f : pending) f.get();
+    }
+
+private:
+    void workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeup.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stopping = false;
+};
+
+#endif // THREAD_POOL_H
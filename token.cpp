@@ -1,106 +1,182 @@
 #include "token.h"
 
-// 定义Anchor语言的关键字映射表
-std::unordered_map<std::string, TokenType> keywordMap;
-// 定义Anchor语言的运算符/界符映射表
-std::unordered_map<std::string, TokenType> operatorMap;
-
-// 初始化Anchor语言的关键字
-void initializeKeywordMap() {
-    // 清空以防重复初始化 (虽然通常只调用一次)
-    keywordMap.clear();
+// Anchor语言的关键字列表 (词素 -> TokenType)
+struct KeywordEntry {
+    std::string_view text;
+    TokenType type;
+};
 
+static constexpr KeywordEntry keywordList[] = {
     // 程序结构
-    keywordMap["anchor"] = TokenType::KW_ANCHOR;
-    keywordMap["main"] = TokenType::KW_MAIN;
+    {"anchor", TokenType::KW_ANCHOR},
+    {"main", TokenType::KW_MAIN},
 
     // 类型
-    keywordMap["int"] = TokenType::KW_INT;
-    keywordMap["float"] = TokenType::KW_FLOAT;
-    keywordMap["char"] = TokenType::KW_CHAR;
-    keywordMap["bool"] = TokenType::KW_BOOL;
-    keywordMap["string"] = TokenType::KW_STRING;
-    keywordMap["void"] = TokenType::KW_VOID;
-    keywordMap["const"] = TokenType::KW_CONST;
-    keywordMap["auto"] = TokenType::KW_AUTO;
+    {"int", TokenType::KW_INT},
+    {"float", TokenType::KW_FLOAT},
+    {"char", TokenType::KW_CHAR},
+    {"bool", TokenType::KW_BOOL},
+    {"string", TokenType::KW_STRING},
+    {"void", TokenType::KW_VOID},
+    {"const", TokenType::KW_CONST},
+    {"auto", TokenType::KW_AUTO},
 
     // 控制结构
-    keywordMap["if"] = TokenType::KW_IF;
-    keywordMap["else"] = TokenType::KW_ELSE;
-    keywordMap["while"] = TokenType::KW_WHILE;
-    keywordMap["for"] = TokenType::KW_FOR;
-    keywordMap["return"] = TokenType::KW_RETURN; // 确保 'return' 关键字被识别
-    keywordMap["break"] = TokenType::KW_BREAK;
-    keywordMap["continue"] = TokenType::KW_CONTINUE;
-    keywordMap["switch"] = TokenType::KW_SWITCH;
-    keywordMap["case"] = TokenType::KW_CASE;
-    keywordMap["default"] = TokenType::KW_DEFAULT;
+    {"if", TokenType::KW_IF},
+    {"else", TokenType::KW_ELSE},
+    {"while", TokenType::KW_WHILE},
+    {"for", TokenType::KW_FOR},
+    {"return", TokenType::KW_RETURN}, // 确保 'return' 关键字被识别
+    {"break", TokenType::KW_BREAK},
+    {"continue", TokenType::KW_CONTINUE},
+    {"switch", TokenType::KW_SWITCH},
+    {"case", TokenType::KW_CASE},
+    {"default", TokenType::KW_DEFAULT},
 
     // 内存
-    keywordMap["new"] = TokenType::KW_NEW;
-    keywordMap["delete"] = TokenType::KW_DELETE;
-    keywordMap["sizeof"] = TokenType::KW_SIZEOF;
+    {"new", TokenType::KW_NEW},
+    {"delete", TokenType::KW_DELETE},
+    {"sizeof", TokenType::KW_SIZEOF},
 
     // 布尔字面量
-    keywordMap["true"] = TokenType::KW_TRUE;
-    keywordMap["false"] = TokenType::KW_FALSE;
+    {"true", TokenType::KW_TRUE},
+    {"false", TokenType::KW_FALSE},
 
     // 结构体等
-    keywordMap["structi"] = TokenType::KW_STRUCTI;
-    keywordMap["union"] = TokenType::KW_UNION;
-    keywordMap["enum"] = TokenType::KW_ENUM;
+    {"structi", TokenType::KW_STRUCTI},
+    {"union", TokenType::KW_UNION},
+    {"enum", TokenType::KW_ENUM},
 
     // IO
-    keywordMap["print"] = TokenType::KW_PRINT;
-    keywordMap["input"] = TokenType::KW_INPUT;
+    {"print", TokenType::KW_PRINT},
+    {"input", TokenType::KW_INPUT},
+};
+
+constexpr size_t KEYWORD_COUNT = sizeof(keywordList) / sizeof(keywordList[0]);
+constexpr size_t KEYWORD_TABLE_SIZE = 128; // 必须是2的幂
+
+// 关键字长度范围，查找时先用长度过滤掉大部分标识符
+constexpr size_t keywordLengthBound(bool wantMax) {
+    size_t result = wantMax ? 0 : ~size_t(0);
+    for (const auto& kw : keywordList) {
+        if (wantMax ? kw.text.size() > result : kw.text.size() < result) result = kw.text.size();
+    }
+    return result;
+}
+constexpr size_t KEYWORD_MIN_LEN = keywordLengthBound(false);
+constexpr size_t KEYWORD_MAX_LEN = keywordLengthBound(true);
+static_assert(KEYWORD_MIN_LEN >= 2, "keywordHash 需要读取第二个字符");
+
+// 只看长度、前两个字符和最后一个字符，seed 在编译期搜索得到
+constexpr size_t keywordHash(std::string_view s, unsigned seed) {
+    unsigned h = static_cast<unsigned>(s.size());
+    h = h * seed + static_cast<unsigned char>(s[0]);
+    h = h * seed + static_cast<unsigned char>(s[1]);
+    h = h * seed + static_cast<unsigned char>(s[s.size() - 1]);
+    return (h ^ (h >> 9)) & (KEYWORD_TABLE_SIZE - 1);
+}
+
+// 判断某个 seed 能否让所有关键字落在互不相同的槽位上
+constexpr bool isPerfectSeed(unsigned seed) {
+    bool used[KEYWORD_TABLE_SIZE] = {};
+    for (const auto& kw : keywordList) {
+        size_t slot = keywordHash(kw.text, seed);
+        if (used[slot]) return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr unsigned findPerfectSeed() {
+    for (unsigned seed = 1; seed < 10000; ++seed) {
+        if (isPerfectSeed(seed)) return seed;
+    }
+    return 0;
 }
 
-// 初始化Anchor语言的运算符和界符
-void initializeOperatorMap() {
-    // 清空以防重复初始化
-    operatorMap.clear();
-
-    // 赋值
-    operatorMap["="] = TokenType::ASSIGN;
-    operatorMap["+="] = TokenType::PLUS_ASSIGN;
-    operatorMap["-="] = TokenType::MINUS_ASSIGN;
-    operatorMap["*="] = TokenType::STAR_ASSIGN;
-    operatorMap["/="] = TokenType::SLASH_ASSIGN;
-    operatorMap["%="] = TokenType::MOD_ASSIGN;
-
-    // 算术
-    operatorMap["+"] = TokenType::PLUS;
-    operatorMap["-"] = TokenType::MINUS;
-    operatorMap["*"] = TokenType::STAR;
-    operatorMap["/"] = TokenType::SLASH;
-    operatorMap["%"] = TokenType::MOD;
-
-    // 比较
-    operatorMap["=="] = TokenType::EQ;
-    operatorMap["!="] = TokenType::NEQ;
-    operatorMap["<"] = TokenType::LT;
-    operatorMap[">"] = TokenType::GT;
-    operatorMap["<="] = TokenType::LE;
-    operatorMap[">="] = TokenType::GE;
-
-    // 逻辑
-    operatorMap["&&"] = TokenType::AND;
-    operatorMap["||"] = TokenType::OR;
-    operatorMap["!"] = TokenType::NOT;
-
-    // 自增/自减
-    operatorMap["++"] = TokenType::INC;
-    operatorMap["--"] = TokenType::DEC;
-
-    // 界符
-    operatorMap[";"] = TokenType::SEMICOLON;
-    operatorMap[","] = TokenType::COMMA;
-    operatorMap[":"] = TokenType::COLON;
-    operatorMap["("] = TokenType::LPAREN;
-    operatorMap[")"] = TokenType::RPAREN;
-    operatorMap["{"] = TokenType::LBRACE;
-    operatorMap["}"] = TokenType::RBRACE;
-    operatorMap["["] = TokenType::LBRACKET;
-    operatorMap["]"]=TokenType::RBRACKET;
-    operatorMap["."] = TokenType::DOT;
-}
\ No newline at end of file
+constexpr unsigned KEYWORD_SEED = findPerfectSeed();
+static_assert(KEYWORD_SEED != 0, "找不到关键字的完美哈希种子，请调整 keywordHash 或表大小");
+
+// 槽位 -> keywordList 下标，-1 表示空槽
+struct KeywordTable {
+    signed char slots[KEYWORD_TABLE_SIZE];
+};
+
+constexpr KeywordTable buildKeywordTable() {
+    KeywordTable table{};
+    for (size_t i = 0; i < KEYWORD_TABLE_SIZE; ++i) table.slots[i] = -1;
+    for (size_t i = 0; i < KEYWORD_COUNT; ++i) {
+        table.slots[keywordHash(keywordList[i].text, KEYWORD_SEED)] = static_cast<signed char>(i);
+    }
+    return table;
+}
+
+static constexpr KeywordTable keywordTable = buildKeywordTable();
+
+// 关键字查找: 一次哈希 + 一次字符串比较
+TokenType lookupKeyword(std::string_view word) {
+    if (word.size() < KEYWORD_MIN_LEN || word.size() > KEYWORD_MAX_LEN) {
+        return TokenType::IDENTIFIER;
+    }
+    int index = keywordTable.slots[keywordHash(word, KEYWORD_SEED)];
+    if (index >= 0 && keywordList[index].text == word) {
+        return keywordList[index].type;
+    }
+    return TokenType::IDENTIFIER;
+}
+
+// 运算符和界符查找
+TokenType lookupOperator(char first, char second, int& length) {
+    // 双字符运算符
+    length = 2;
+    switch (first) {
+        case '=': if (second == '=') return TokenType::EQ; break;
+        case '!': if (second == '=') return TokenType::NEQ; break;
+        case '<': if (second == '=') return TokenType::LE; break;
+        case '>': if (second == '=') return TokenType::GE; break;
+        case '+':
+            if (second == '=') return TokenType::PLUS_ASSIGN;
+            if (second == '+') return TokenType::INC;
+            break;
+        case '-':
+            if (second == '=') return TokenType::MINUS_ASSIGN;
+            if (second == '-') return TokenType::DEC;
+            break;
+        case '*': if (second == '=') return TokenType::STAR_ASSIGN; break;
+        case '/': if (second == '=') return TokenType::SLASH_ASSIGN; break;
+        case '%': if (second == '=') return TokenType::MOD_ASSIGN; break;
+        case '&': if (second == '&') return TokenType::AND; break;
+        case '|': if (second == '|') return TokenType::OR; break;
+        default: break;
+    }
+
+    // 单字符运算符和界符
+    length = 1;
+    switch (first) {
+        // 赋值和算术
+        case '=': return TokenType::ASSIGN;
+        case '+': return TokenType::PLUS;
+        case '-': return TokenType::MINUS;
+        case '*': return TokenType::STAR;
+        case '/': return TokenType::SLASH;
+        case '%': return TokenType::MOD;
+        // 比较和逻辑
+        case '<': return TokenType::LT;
+        case '>': return TokenType::GT;
+        case '!': return TokenType::NOT;
+        // 界符
+        case ';': return TokenType::SEMICOLON;
+        case ',': return TokenType::COMMA;
+        case ':': return TokenType::COLON;
+        case '(': return TokenType::LPAREN;
+        case ')': return TokenType::RPAREN;
+        case '{': return TokenType::LBRACE;
+        case '}': return TokenType::RBRACE;
+        case '[': return TokenType::LBRACKET;
+        case ']': return TokenType::RBRACKET;
+        case '.': return TokenType::DOT;
+        default: break;
+    }
+    length = 0;
+    return TokenType::UNKNOWN;
+}
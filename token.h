@@ -2,7 +2,9 @@
 #define TOKEN_H
 
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
+#include <cstdint>
 
 // 定义Token的类型枚举
 enum class TokenType {
@@ -118,26 +120,63 @@ enum class TokenType {
 };
 
 // Token结构体定义, 用于表示词法分析器识别出的一个词法单元
+// 词素不再自己持有字符串，而是指向 Scanner 持有的源文件缓冲区，
+// 因此 Token 只在产生它的 Scanner 存活期间有效；需要长期保存文本的地方(如AST)自行拷贝。
 struct Token {
-    TokenType type;     // Token的类型 (来自TokenType枚举)
-    std::string lexeme; // Token的词素 (原始文本值)
-    int line;           // Token在源代码中的起始行号
+    TokenType type;          // Token的类型 (来自TokenType枚举)
+    std::string_view lexeme; // Token的词素 (指向源缓冲区的原始文本)
+    int line;                // Token在源代码中的起始行号
 
     // 构造函数
-    Token(TokenType t, const std::string& lex, int ln)
+    Token(TokenType t, std::string_view lex, int ln)
         : type(t), lexeme(lex), line(ln) {}
 
     // 默认构造函数, 初始化为一个无效/未知Token
     Token() : type(TokenType::UNKNOWN), lexeme(""), line(0) {}
 };
 
-// 外部声明Anchor语言的关键字映射表 (词素 -> TokenType)
-extern std::unordered_map<std::string, TokenType> keywordMap;
-// 初始化Anchor语言关键字映射表的函数声明
-void initializeKeywordMap();
+// 整个文件一次性扫描得到的Token序列，按字段分别存成数组 (类型/偏移/长度/行号)。
+// 语法分析器按下标读取，预读只是一次数组访问；词素仍然指向 Scanner 的源缓冲区，
+// 因此 TokenArray 不能比产生它的 Scanner 活得更久。
+struct TokenArray {
+    const char* source = nullptr;  // 源缓冲区起始地址
+    std::vector<TokenType> types;
+    std::vector<uint32_t> offsets; // 词素在缓冲区中的偏移
+    std::vector<uint32_t> lengths; // 词素长度
+    std::vector<int> lines;        // 起始行号
+
+    size_t size() const { return types.size(); }
+
+    void reserve(size_t n) {
+        types.reserve(n);
+        offsets.reserve(n);
+        lengths.reserve(n);
+        lines.reserve(n);
+    }
+
+    void push_back(const Token& token) {
+        types.push_back(token.type);
+        // EOF 的词素 "EOF" 不在缓冲区里，只记类型，取词素时再特殊处理
+        bool inBuffer = token.type != TokenType::END_OF_FILE;
+        offsets.push_back(inBuffer ? static_cast<uint32_t>(token.lexeme.data() - source) : 0);
+        lengths.push_back(inBuffer ? static_cast<uint32_t>(token.lexeme.size()) : 0);
+        lines.push_back(token.line);
+    }
+
+    std::string_view lexeme(size_t i) const {
+        if (types[i] == TokenType::END_OF_FILE) return "EOF";
+        return std::string_view(source + offsets[i], lengths[i]);
+    }
+
+    Token at(size_t i) const { return Token(types[i], lexeme(i), lines[i]); }
+};
+
+// 关键字识别: 使用编译期生成的完美哈希表 (见 token.cpp)，不需要启动时初始化。
+// 若 word 不是关键字则返回 TokenType::IDENTIFIER
+TokenType lookupKeyword(std::string_view word);
 
-// 外部声明Anchor语言的运算符/界符映射表 (词素 -> TokenType)
-extern std::unordered_map<std::string, TokenType> operatorMap;
-// 初始化Anchor语言运算符/界符映射表的函数声明
-void initializeOperatorMap();
+// 运算符/界符识别: 按首字符 switch，再看第二个字符是否构成双字符运算符。
+// first/second 为当前字符和下一个字符(没有则传 '\0')，length 返回匹配长度(1或2)；
+// 未识别时返回 TokenType::UNKNOWN
+TokenType lookupOperator(char first, char second, int& length);
 #endif // TOKEN_H
@@ -0,0 +1,378 @@
+#include "vm.h"
+
+#include <algorithm>
+#include <memory>
+
+using namespace std;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define VM_COMPUTED_GOTO 1
+#else
+#define VM_COMPUTED_GOTO 0
+#endif
+
+namespace {
+
+constexpr size_t MAX_CALL_DEPTH = 100000; // 超过这个深度视为无穷递归
+
+} // namespace
+
+VirtualMachine::VirtualMachine(const BytecodeProgram& prog, ostream& output)
+    : program(prog), out(output) {}
+
+const VirtualMachine::CallCache& VirtualMachine::resolveCall(int32_t site) {
+    NameId callee = program.callSites[site];
+    auto it = program.functionIndex.find(callee);
+    if (it == program.functionIndex.end()) runtimeError("调用了未定义的函数 '" + nameOf(callee) + "'");
+    const BcFunction& function = program.functions[it->second];
+    CallCache& cache = callCaches[site];
+    cache.entry = program.code.data() + function.entry;
+    cache.numParams = function.numParams;
+    cache.numCleared = function.numCleared;
+    cache.numRegisters = function.numRegisters;
+    return cache;
+}
+
+// 值栈扩容后 fp 和 top 仍指向原来的位置，保证 top 之上至少还有 count 个值
+void VirtualMachine::growStack(Value*& fp, Value*& top, size_t count) {
+    size_t fpOffset = fp - stack.data();
+    size_t topOffset = top - stack.data();
+    stack.resize(max(topOffset + count, stack.size() * 2));
+    fp = stack.data() + fpOffset;
+    top = stack.data() + topOffset;
+}
+
+uint64_t VirtualMachine::run() {
+    globals.assign(program.globals.size(), Value{});
+    callCaches.assign(program.callSites.size(), CallCache{});
+    // 调用栈按最大深度一次分配，页面用到时才真正占用内存
+    callStack.reset(new CallFrame[MAX_CALL_DEPTH]);
+    CallFrame* csp = callStack.get();
+    CallFrame* const callStackEnd = csp + MAX_CALL_DEPTH;
+
+    const BcFunction& main = program.functions[0];
+    stack.assign(max<size_t>(1024, main.numRegisters), Value{});
+
+    const BcInstr* const code = program.code.data();
+    const BcInstr* ip = code + main.entry;
+    const Value* const constants = program.constants.data();
+    Value* const gp = globals.data();
+    uint16_t numRegisters = main.numRegisters;
+    Value* fp = stack.data();
+    Value* sp = fp + numRegisters;  // 压入实参的位置，在当前寄存器段之上
+    Value* stackEnd = stack.data() + stack.size();
+    Value result;
+    uint64_t executed = 0;
+
+#define R(r) fp[(r)]
+#define K(k) constants[(k)]
+
+#if VM_COMPUTED_GOTO
+    // 顺序必须与 BcOp 一致
+    static const void* const dispatchTable[] = {
+        &&op_MOVE, &&op_LOADK, &&op_GETGLOBAL, &&op_SETGLOBAL,
+        &&op_ADD, &&op_SUB, &&op_MUL, &&op_DIV, &&op_MOD, &&op_ADDK, &&op_SUBK, &&op_MULK,
+        &&op_NEG, &&op_NOT, &&op_LT, &&op_GT, &&op_LE, &&op_GE, &&op_EQ, &&op_NE, &&op_AND, &&op_OR,
+        &&op_JMP, &&op_JMPF, &&op_JMPT,
+        &&op_JLT, &&op_JGT, &&op_JLE, &&op_JGE, &&op_JEQ, &&op_JNE,
+        &&op_JLTK, &&op_JGTK, &&op_JLEK, &&op_JGEK, &&op_JEQK, &&op_JNEK,
+        &&op_PARAM, &&op_CALL, &&op_RETURN, &&op_RETURN0, &&op_PRINT,
+        &&op_NEWARRAY, &&op_GETINDEX, &&op_SETINDEX, &&op_GETFIELD, &&op_SETFIELD, &&op_HALT
+    };
+    static_assert(sizeof(dispatchTable) / sizeof(dispatchTable[0]) == static_cast<size_t>(BcOp::HALT) + 1,
+                  "分派表与 BcOp 不一致");
+#define DISPATCH() do { ++executed; goto *dispatchTable[static_cast<uint8_t>(ip->op)]; } while (0)
+#define CASE(name) op_##name:
+    DISPATCH();
+#else
+#define DISPATCH() continue
+#define CASE(name) case BcOp::name:
+    for (;;) {
+    ++executed;
+    switch (ip->op) {
+#endif
+
+    CASE(MOVE) {
+        R(ip->a) = R(ip->b);
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(LOADK) {
+        R(ip->a) = K(ip->b);
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(GETGLOBAL) {
+        R(ip->a) = gp[ip->b];
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(SETGLOBAL) {
+        gp[ip->a] = R(ip->b);
+        ++ip;
+        DISPATCH();
+    }
+
+    // 两个操作数都是整数时直接算，其余交给慢速路径
+#define ARITHMETIC(name, opcode, rhs, expr)                                    \
+    CASE(name) {                                                               \
+        const Value& x = R(ip->b);                                             \
+        const Value& y = rhs(ip->c);                                           \
+        if (x.type == ValueType::INT && y.type == ValueType::INT) {            \
+            uint64_t a = static_cast<uint64_t>(x.i), b = static_cast<uint64_t>(y.i); \
+            result = makeInt(static_cast<int64_t>(expr));                      \
+        } else {                                                               \
+            result = performArithmetic(Opcode::opcode, x, y, heap);            \
+        }                                                                      \
+        R(ip->a) = result;                                                     \
+        ++ip;                                                                  \
+        DISPATCH();                                                            \
+    }
+
+    ARITHMETIC(ADD, ADD, R, a + b)
+    ARITHMETIC(SUB, SUB, R, a - b)
+    ARITHMETIC(MUL, MUL, R, a * b)
+    ARITHMETIC(ADDK, ADD, K, a + b)
+    ARITHMETIC(SUBK, SUB, K, a - b)
+    ARITHMETIC(MULK, MUL, K, a * b)
+#undef ARITHMETIC
+
+    CASE(DIV) {
+        R(ip->a) = performArithmetic(Opcode::DIV, R(ip->b), R(ip->c), heap);
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(MOD) {
+        R(ip->a) = performArithmetic(Opcode::MOD, R(ip->b), R(ip->c), heap);
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(NEG) {
+        R(ip->a) = performUnary(Opcode::NEG, R(ip->b));
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(NOT) {
+        R(ip->a) = performUnary(Opcode::NOT, R(ip->b));
+        ++ip;
+        DISPATCH();
+    }
+
+#define COMPARISON(name, cmp)                                                  \
+    CASE(name) {                                                               \
+        const Value& x = R(ip->b);                                             \
+        const Value& y = R(ip->c);                                             \
+        if (x.type == ValueType::INT && y.type == ValueType::INT) {            \
+            result = makeBool(x.i cmp y.i);                                    \
+        } else {                                                               \
+            result = performComparison(Opcode::name, x, y);                    \
+        }                                                                      \
+        R(ip->a) = result;                                                     \
+        ++ip;                                                                  \
+        DISPATCH();                                                            \
+    }
+
+    COMPARISON(LT, <)
+    COMPARISON(GT, >)
+    COMPARISON(LE, <=)
+    COMPARISON(GE, >=)
+    COMPARISON(EQ, ==)
+    COMPARISON(NE, !=)
+#undef COMPARISON
+
+    CASE(AND) {
+        R(ip->a) = makeBool(truth(R(ip->b)) && truth(R(ip->c)));
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(OR) {
+        R(ip->a) = makeBool(truth(R(ip->b)) || truth(R(ip->c)));
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(JMP) {
+        ip = code + ip->target;
+        DISPATCH();
+    }
+
+    CASE(JMPF) {
+        ip = truth(R(ip->a)) ? ip + 1 : code + ip->target;
+        DISPATCH();
+    }
+
+    CASE(JMPT) {
+        ip = truth(R(ip->a)) ? code + ip->target : ip + 1;
+        DISPATCH();
+    }
+
+    // 比较跳转: 比较结果等于 flag 时跳转
+#define COMPARE_JUMP(name, opcode, rhs, cmp)                                   \
+    CASE(name) {                                                               \
+        const Value& x = R(ip->a);                                             \
+        const Value& y = rhs(ip->b);                                           \
+        bool taken;                                                            \
+        if (x.type == ValueType::INT && y.type == ValueType::INT) {            \
+            taken = (x.i cmp y.i) == static_cast<bool>(ip->flag);              \
+        } else {                                                               \
+            taken = truth(performComparison(Opcode::opcode, x, y)) == static_cast<bool>(ip->flag); \
+        }                                                                      \
+        ip = taken ? code + ip->target : ip + 1;                               \
+        DISPATCH();                                                            \
+    }
+
+    COMPARE_JUMP(JLT, LT, R, <)
+    COMPARE_JUMP(JGT, GT, R, >)
+    COMPARE_JUMP(JLE, LE, R, <=)
+    COMPARE_JUMP(JGE, GE, R, >=)
+    COMPARE_JUMP(JEQ, EQ, R, ==)
+    COMPARE_JUMP(JNE, NE, R, !=)
+    COMPARE_JUMP(JLTK, LT, K, <)
+    COMPARE_JUMP(JGTK, GT, K, >)
+    COMPARE_JUMP(JLEK, LE, K, <=)
+    COMPARE_JUMP(JGEK, GE, K, >=)
+    COMPARE_JUMP(JEQK, EQ, K, ==)
+    COMPARE_JUMP(JNEK, NE, K, !=)
+#undef COMPARE_JUMP
+
+    CASE(PARAM) {
+        if (sp == stackEnd) {
+            growStack(fp, sp, 1);
+            stackEnd = stack.data() + stack.size();
+        }
+        *sp++ = R(ip->a);
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(CALL) {
+        const CallCache* cache = &callCaches[ip->target];
+        if (!cache->entry) cache = &resolveCall(ip->target); // 内联缓存未命中
+        if (csp == callStackEnd) runtimeError("调用栈溢出 (递归过深)");
+
+        // 实参已经压在调用者寄存器段之上，它们就是被调者的前几个寄存器
+        size_t argc = min(static_cast<size_t>(ip->b), static_cast<size_t>(sp - (fp + numRegisters)));
+        Value* calleeFp = sp - argc;
+        if (static_cast<size_t>(stackEnd - calleeFp) < cache->numRegisters) {
+            growStack(fp, calleeFp, cache->numRegisters);
+            stackEnd = stack.data() + stack.size();
+        }
+        if (argc == cache->numParams) {
+            fill(calleeFp + argc, calleeFp + argc + cache->numCleared, Value{});
+        } else {
+            // 实参个数与形参不符: 多余的丢掉，缺少的和其余寄存器一起清零
+            vector<Value> args(calleeFp, calleeFp + argc);
+            for (size_t r = 0; r < cache->numRegisters; ++r) {
+                size_t k = cache->numParams - 1 - r; // 寄存器 r 对应的形参序号
+                calleeFp[r] = r < cache->numParams && k < argc ? args[argc - 1 - k] : Value{};
+            }
+        }
+
+        *csp++ = CallFrame{ip + 1, static_cast<size_t>(fp - stack.data()), numRegisters, ip->a};
+        numRegisters = cache->numRegisters;
+        fp = calleeFp;
+        sp = fp + numRegisters;
+        ip = cache->entry;
+        DISPATCH();
+    }
+
+    CASE(RETURN) {
+        result = R(ip->a);
+        goto do_return;
+    }
+
+    CASE(RETURN0) {
+        result = Value{};
+    do_return:
+        if (csp == callStack.get()) goto halt; // 顶层代码里的 return 结束程序
+        {
+            // 被调者的寄存器段连同实参一起弹出
+            const CallFrame& caller = *--csp;
+            sp = fp;
+            fp = stack.data() + caller.base;
+            numRegisters = caller.numRegisters;
+            ip = caller.returnIp;
+            if (caller.resultReg != BC_NO_REG) R(caller.resultReg) = result;
+        }
+        DISPATCH();
+    }
+
+    CASE(PRINT) {
+        writeValue(out, R(ip->a));
+        out << '\n';
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(NEWARRAY) {
+        result.type = ValueType::OBJECT;
+        result.object = heap.newArray(R(ip->b));
+        R(ip->a) = result;
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(GETINDEX) {
+        vector<Value>& array = heap.objectOf(R(ip->b));
+        const Value& index = R(ip->c);
+        if (index.type == ValueType::FLOAT || index.i < 0 || static_cast<size_t>(index.i) >= array.size()) {
+            runtimeError("数组下标越界");
+        }
+        result = array[index.i];
+        R(ip->a) = result;
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(SETINDEX) {
+        vector<Value>& array = heap.objectOf(R(ip->a));
+        const Value& index = R(ip->b);
+        if (index.type == ValueType::FLOAT || index.i < 0 || static_cast<size_t>(index.i) >= array.size()) {
+            runtimeError("数组下标越界");
+        }
+        array[index.i] = R(ip->c);
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(GETFIELD) {
+        vector<Value>& object = heap.objectOf(R(ip->b));
+        if (ip->c >= object.size()) object.resize(ip->c + 1);
+        result = object[ip->c];
+        R(ip->a) = result;
+        ++ip;
+        DISPATCH();
+    }
+
+    CASE(SETFIELD) {
+        vector<Value>& object = heap.objectOf(R(ip->b));
+        if (ip->c >= object.size()) object.resize(ip->c + 1);
+        object[ip->c] = R(ip->a);
+        ++ip;
+        DISPATCH();
+    }
+
+#if VM_COMPUTED_GOTO
+    op_HALT:
+#else
+    case BcOp::HALT:
+        goto halt;
+    }
+    }
+#endif
+
+halt:
+#undef CASE
+#undef DISPATCH
+#undef K
+#undef R
+    out.flush();
+    return executed;
+}
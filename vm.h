@@ -0,0 +1,56 @@
+#ifndef VM_H
+#define VM_H
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "bytecode.h"
+#include "runtime_value.h"
+
+// 字节码虚拟机: 执行 lowerToBytecode 生成的寄存器式字节码。
+// 调用栈上每个函数占连续的一段寄存器。PARAM 把实参压在调用者寄存器段之上，
+// 形参寄存器按逆序编号，所以调用时这些实参原地成为被调者寄存器段的开头，不需要复制。
+// 每个调用点带一个内联缓存: 第一次执行时按函数名解析被调函数，
+// 把入口地址、形参个数和寄存器个数记在缓存里，之后的调用不再查表。
+// 在 GCC/Clang 下用 computed goto 分派，其他编译器退化为 switch。
+class VirtualMachine {
+public:
+    explicit VirtualMachine(const BytecodeProgram& program, std::ostream& out = std::cout);
+
+    // 从顶层代码开始执行，返回执行的指令条数
+    uint64_t run();
+
+private:
+    // 调用点的内联缓存，entry 为空表示还没有解析
+    struct CallCache {
+        const BcInstr* entry = nullptr;
+        uint16_t numParams = 0;
+        uint16_t numCleared = 0;
+        uint16_t numRegisters = 0;
+    };
+
+    // 调用栈上的一项，记录返回后要恢复的状态
+    struct CallFrame {
+        const BcInstr* returnIp;
+        size_t base;           // 调用者寄存器段在值栈中的起点 (扩容后指针会失效)
+        uint16_t numRegisters; // 调用者的寄存器个数
+        uint16_t resultReg;    // 返回值写到调用者的哪个寄存器
+    };
+
+    const BytecodeProgram& program;
+    std::ostream& out;
+
+    std::vector<Value> globals;
+    std::vector<CallCache> callCaches;  // 与 program.callSites 一一对应
+    std::vector<Value> stack;           // 所有寄存器段和待传的实参连续存放
+    std::unique_ptr<CallFrame[]> callStack;
+    RuntimeHeap heap;
+
+    // 内联缓存未命中时解析被调函数并填充缓存
+    const CallCache& resolveCall(int32_t site);
+    void growStack(Value*& fp, Value*& top, size_t count);
+};
+
+#endif // VM_H
@@ -0,0 +1,386 @@
+#include "x64_assembler.h"
+
+#include <climits>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+const char* const REG64[] = {"rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi",
+                             "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15"};
+const char* const REG32[] = {"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi",
+                             "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d"};
+const char* const REG8[] = {"al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil",
+                            "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b", "r15b"};
+
+const char* const OP_NAMES[] = {
+    "mov", "lea", "push", "pop", "add", "sub", "and", "or", "xor", "cmp", "test", "imul", "neg", "idiv", "cqo",
+    "btc", "movzx",
+    "jmp", "je", "jne", "jl", "jge", "jle", "jg", "jb", "jae", "jbe", "ja", "jp", "jnp",
+    "sete", "setne", "setl", "setge", "setle", "setg", "setb", "setae", "setbe", "seta",
+    "call", "ret",
+    "movq", "movsd", "cvtsi2sd", "cvttsd2si", "addsd", "subsd", "mulsd", "divsd", "ucomisd", "xorpd",
+    "fld", "fstp", "fstp st(0)", "fprem", "fnstsw ax",
+};
+
+// 条件码的名字和编码，按 X64Op::JE.. 与 X64Op::SETE.. 的顺序排列
+struct Condition {
+    const char* name;
+    uint8_t code;
+};
+const Condition CONDITIONS[] = {
+    {"e", 0x4}, {"ne", 0x5}, {"l", 0xC}, {"ge", 0xD}, {"le", 0xE}, {"g", 0xF},
+    {"b", 0x2}, {"ae", 0x3}, {"be", 0x6}, {"a", 0x7}, {"p", 0xA}, {"np", 0xB},
+};
+constexpr int NUM_JUMP_CONDITIONS = 12; // JE..JNP
+constexpr int NUM_SET_CONDITIONS = 10;  // SETE..SETA
+
+int regNumber(X64Reg r) {
+    int n = static_cast<int>(r);
+    return isXmm(r) ? n - static_cast<int>(X64Reg::XMM0) : n;
+}
+
+bool fitsInt8(int64_t v) { return v >= INT8_MIN && v <= INT8_MAX; }
+bool fitsInt32(int64_t v) { return v >= INT32_MIN && v <= INT32_MAX; }
+
+// 转义成 .string 指令的内容，非可打印字节写成八进制
+string escapeString(const string& s) {
+    string out;
+    for (unsigned char c : s) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20 || c >= 0x7F) {
+            char buf[8];
+            snprintf(buf, sizeof buf, "\\%03o", c);
+            out += buf;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+const char* x64OpName(X64Op op) { return OP_NAMES[static_cast<int>(op)]; }
+
+X64Op jumpFor(const string& cc) {
+    for (int k = 0; k < NUM_JUMP_CONDITIONS; ++k) {
+        if (cc == CONDITIONS[k].name) return static_cast<X64Op>(static_cast<int>(X64Op::JE) + k);
+    }
+    return X64Op::JMP;
+}
+
+X64Op setFor(const string& cc) {
+    for (int k = 0; k < NUM_SET_CONDITIONS; ++k) {
+        if (cc == CONDITIONS[k].name) return static_cast<X64Op>(static_cast<int>(X64Op::SETE) + k);
+    }
+    return X64Op::SETNE;
+}
+
+// ---- 文本 ----
+
+string X64TextEmitter::format(const X64Operand& operand) {
+    switch (operand.kind) {
+        case X64Operand::Kind::REG: {
+            if (isXmm(operand.reg)) return "xmm" + to_string(regNumber(operand.reg));
+            int n = regNumber(operand.reg);
+            return operand.size == 8 ? REG64[n] : operand.size == 4 ? REG32[n] : REG8[n];
+        }
+        case X64Operand::Kind::MEM: {
+            if (operand.reg == X64Reg::RIP) return "QWORD PTR " + operand.symbol + "[rip]";
+            string address = REG64[regNumber(operand.reg)];
+            if (operand.index != X64Reg::NONE) {
+                address += string("+") + REG64[regNumber(operand.index)] + "*" + to_string(operand.scale);
+            }
+            if (operand.value) address += (operand.value < 0 ? "-" : "+") + to_string(llabs(operand.value));
+            return "QWORD PTR [" + address + "]";
+        }
+        case X64Operand::Kind::IMM:    return to_string(operand.value);
+        case X64Operand::Kind::SYMBOL: return operand.symbol;
+        default:                       return "";
+    }
+}
+
+void X64TextEmitter::instruction(X64Op op, const X64Operand& a, const X64Operand& b, const string& comment) {
+    codeText << "    " << x64OpName(op);
+    if (!a.isNone()) codeText << " " << format(a);
+    if (!b.isNone()) {
+        string text = format(b);
+        // lea 取的是地址，不写操作数大小
+        if (op == X64Op::LEA && b.isMem()) text = text.substr(strlen("QWORD PTR "));
+        codeText << ", " << text;
+    }
+    if (!comment.empty()) codeText << "    # " << comment;
+    codeText << endl;
+}
+
+void X64TextEmitter::label(const string& name) { codeText << name << ":" << endl; }
+
+void X64TextEmitter::comment(const string& text) { codeText << "    # " << text << endl; }
+
+void X64TextEmitter::dataString(const string& label, const string& text) {
+    rodataText << label << ":\n    .string \"" << escapeString(text) << "\"" << endl;
+}
+
+void X64TextEmitter::dataZero(const string& label, size_t bytes) {
+    bssText << label << ":\n    .zero " << bytes << endl;
+}
+
+// ---- 机器码 ----
+
+void X64Encoder::imm32(int64_t v) {
+    uint32_t u = static_cast<uint32_t>(v);
+    for (int k = 0; k < 4; ++k) byte(static_cast<uint8_t>(u >> (8 * k)));
+}
+
+void X64Encoder::imm64(int64_t v) {
+    uint64_t u = static_cast<uint64_t>(v);
+    for (int k = 0; k < 8; ++k) byte(static_cast<uint8_t>(u >> (8 * k)));
+}
+
+void X64Encoder::rex(bool w, int reg, int index, int base, bool force) {
+    uint8_t r = static_cast<uint8_t>(0x40 | (w << 3) | ((reg >> 3) << 2) | ((index >> 3) << 1) | (base >> 3));
+    if (r != 0x40 || force) byte(r);
+}
+
+void X64Encoder::modrm(int regField, const X64Operand& rm) {
+    int reg = (regField & 7) << 3;
+    if (rm.isReg()) {
+        byte(static_cast<uint8_t>(0xC0 | reg | (regNumber(rm.reg) & 7)));
+        return;
+    }
+    if (rm.reg == X64Reg::RIP) {
+        // [rip + disp32]，偏移在指令结束后回填
+        byte(static_cast<uint8_t>(0x05 | reg));
+        pendingRip = code.size();
+        pendingSymbol = rm.symbol;
+        imm32(0);
+        return;
+    }
+    int base = regNumber(rm.reg) & 7;
+    int64_t disp = rm.value;
+    int mod = (disp == 0 && base != 5) ? 0 : fitsInt8(disp) ? 1 : 2; // rbp/r13 作基址时必须带偏移
+    if (rm.index != X64Reg::NONE || base == 4) {
+        // rsp/r12 作基址或者有变址寄存器时需要 SIB 字节
+        int scale = rm.scale == 8 ? 3 : rm.scale == 4 ? 2 : rm.scale == 2 ? 1 : 0;
+        int index = rm.index == X64Reg::NONE ? 4 : regNumber(rm.index) & 7;
+        byte(static_cast<uint8_t>((mod << 6) | reg | 4));
+        byte(static_cast<uint8_t>((scale << 6) | (index << 3) | base));
+    } else {
+        byte(static_cast<uint8_t>((mod << 6) | reg | base));
+    }
+    if (mod == 1) byte(static_cast<uint8_t>(disp));
+    else if (mod == 2) imm32(disp);
+}
+
+void X64Encoder::encode(int prefix, bool w, initializer_list<uint8_t> opcode, int regField, const X64Operand& rm,
+                        bool byteRegs) {
+    if (prefix) byte(static_cast<uint8_t>(prefix));
+    int index = rm.isMem() && rm.index != X64Reg::NONE ? regNumber(rm.index) : 0;
+    int base = rm.isReg() || (rm.isMem() && rm.reg != X64Reg::RIP) ? regNumber(rm.reg) : 0;
+    // spl/bpl/sil/dil 要有 REX 前缀才能与 ah/ch/dh/bh 区分
+    bool force = byteRegs && ((rm.isReg() && base >= 4) || (regField >= 4 && regField < 8));
+    rex(w, regField, index, base, force);
+    for (uint8_t b : opcode) byte(b);
+    modrm(regField, rm);
+}
+
+// add/or/and/sub/xor/cmp: base 是 "r/m, r" 形式的操作码，digit 是立即数形式的 /digit
+void X64Encoder::alu(int digit, uint8_t base, const X64Operand& a, const X64Operand& b) {
+    bool w = a.size == 8;
+    if (b.isReg()) {
+        if (a.size == 1) encode(0, false, {static_cast<uint8_t>(base - 1)}, regNumber(b.reg), a, true);
+        else encode(0, w, {base}, regNumber(b.reg), a);
+    } else if (b.isMem()) {
+        encode(0, w, {static_cast<uint8_t>(base + 2)}, regNumber(a.reg), b);
+    } else if (fitsInt8(b.value)) {
+        encode(0, w, {0x83}, digit, a);
+        byte(static_cast<uint8_t>(b.value));
+    } else {
+        encode(0, w, {0x81}, digit, a);
+        imm32(b.value);
+    }
+}
+
+void X64Encoder::branch(initializer_list<uint8_t> opcode, const X64Operand& target) {
+    for (uint8_t b : opcode) byte(b);
+    fixups.push_back({code.size(), code.size() + 4, target.symbol});
+    imm32(0);
+}
+
+void X64Encoder::instruction(X64Op op, const X64Operand& a, const X64Operand& b, const string&) {
+    bool w = a.size == 8;
+    switch (op) {
+        case X64Op::MOV:
+            if (b.isImm()) {
+                if (a.isMem()) {
+                    encode(0, true, {0xC7}, 0, a);
+                    imm32(b.value);
+                } else if (a.size == 4 || (b.value >= 0 && b.value <= UINT32_MAX)) {
+                    // 32 位寄存器的写入会清零高 32 位
+                    rex(false, 0, 0, regNumber(a.reg));
+                    byte(static_cast<uint8_t>(0xB8 + (regNumber(a.reg) & 7)));
+                    imm32(b.value);
+                } else if (fitsInt32(b.value)) {
+                    encode(0, true, {0xC7}, 0, a);
+                    imm32(b.value);
+                } else {
+                    rex(true, 0, 0, regNumber(a.reg));
+                    byte(static_cast<uint8_t>(0xB8 + (regNumber(a.reg) & 7)));
+                    imm64(b.value);
+                }
+            } else if (b.isMem()) {
+                encode(0, w, {0x8B}, regNumber(a.reg), b);
+            } else {
+                encode(0, a.isMem() || b.size == 8, {0x89}, regNumber(b.reg), a);
+            }
+            break;
+        case X64Op::LEA: encode(0, true, {0x8D}, regNumber(a.reg), b); break;
+        case X64Op::PUSH:
+            if (a.isReg()) {
+                rex(false, 0, 0, regNumber(a.reg));
+                byte(static_cast<uint8_t>(0x50 + (regNumber(a.reg) & 7)));
+            } else if (a.isMem()) {
+                encode(0, false, {0xFF}, 6, a);
+            } else if (fitsInt8(a.value)) {
+                byte(0x6A);
+                byte(static_cast<uint8_t>(a.value));
+            } else {
+                byte(0x68);
+                imm32(a.value);
+            }
+            break;
+        case X64Op::POP:
+            rex(false, 0, 0, regNumber(a.reg));
+            byte(static_cast<uint8_t>(0x58 + (regNumber(a.reg) & 7)));
+            break;
+        case X64Op::ADD: alu(0, 0x01, a, b); break;
+        case X64Op::OR:  alu(1, 0x09, a, b); break;
+        case X64Op::AND: alu(4, 0x21, a, b); break;
+        case X64Op::SUB: alu(5, 0x29, a, b); break;
+        case X64Op::XOR: alu(6, 0x31, a, b); break;
+        case X64Op::CMP: alu(7, 0x39, a, b); break;
+        case X64Op::TEST:
+            if (b.isImm()) {
+                encode(0, w, {0xF7}, 0, a);
+                imm32(b.value);
+            } else {
+                encode(0, w, {static_cast<uint8_t>(a.size == 1 ? 0x84 : 0x85)}, regNumber(b.reg), a, a.size == 1);
+            }
+            break;
+        case X64Op::IMUL: encode(0, true, {0x0F, 0xAF}, regNumber(a.reg), b); break;
+        case X64Op::NEG:  encode(0, true, {0xF7}, 3, a); break;
+        case X64Op::IDIV: encode(0, true, {0xF7}, 7, a); break;
+        case X64Op::CQO:  byte(0x48); byte(0x99); break;
+        case X64Op::BTC:
+            encode(0, true, {0x0F, 0xBA}, 7, a);
+            byte(static_cast<uint8_t>(b.value));
+            break;
+        case X64Op::MOVZX: encode(0, false, {0x0F, 0xB6}, regNumber(a.reg), b, true); break;
+        case X64Op::JMP:  branch({0xE9}, a); break;
+        case X64Op::CALL: branch({0xE8}, a); break;
+        case X64Op::RET:  byte(0xC3); break;
+        case X64Op::MOVQ:
+            if (isXmm(a.reg) && a.isReg() && b.isReg() && isXmm(b.reg)) {
+                encode(0xF3, false, {0x0F, 0x7E}, regNumber(a.reg), b);
+            } else if (a.isReg() && isXmm(a.reg)) {
+                encode(0x66, true, {0x0F, 0x6E}, regNumber(a.reg), b);
+            } else {
+                encode(0x66, true, {0x0F, 0x7E}, regNumber(b.reg), a);
+            }
+            break;
+        case X64Op::MOVSD:
+            if (a.isReg()) encode(0xF2, false, {0x0F, 0x10}, regNumber(a.reg), b);
+            else encode(0xF2, false, {0x0F, 0x11}, regNumber(b.reg), a);
+            break;
+        case X64Op::CVTSI2SD:  encode(0xF2, true, {0x0F, 0x2A}, regNumber(a.reg), b); break;
+        case X64Op::CVTTSD2SI: encode(0xF2, true, {0x0F, 0x2C}, regNumber(a.reg), b); break;
+        case X64Op::ADDSD:     encode(0xF2, false, {0x0F, 0x58}, regNumber(a.reg), b); break;
+        case X64Op::MULSD:     encode(0xF2, false, {0x0F, 0x59}, regNumber(a.reg), b); break;
+        case X64Op::SUBSD:     encode(0xF2, false, {0x0F, 0x5C}, regNumber(a.reg), b); break;
+        case X64Op::DIVSD:     encode(0xF2, false, {0x0F, 0x5E}, regNumber(a.reg), b); break;
+        case X64Op::UCOMISD:   encode(0x66, false, {0x0F, 0x2E}, regNumber(a.reg), b); break;
+        case X64Op::XORPD:     encode(0x66, false, {0x0F, 0x57}, regNumber(a.reg), b); break;
+        case X64Op::FLD:       encode(0, false, {0xDD}, 0, a); break;
+        case X64Op::FSTP:      encode(0, false, {0xDD}, 3, a); break;
+        case X64Op::FSTP_ST0:  byte(0xDD); byte(0xD8); break;
+        case X64Op::FPREM:     byte(0xD9); byte(0xF8); break;
+        case X64Op::FNSTSW_AX: byte(0xDF); byte(0xE0); break;
+        default:
+            if (op >= X64Op::JE && op <= X64Op::JNP) {
+                int k = static_cast<int>(op) - static_cast<int>(X64Op::JE);
+                branch({0x0F, static_cast<uint8_t>(0x80 + CONDITIONS[k].code)}, a);
+            } else {
+                int k = static_cast<int>(op) - static_cast<int>(X64Op::SETE);
+                encode(0, false, {0x0F, static_cast<uint8_t>(0x90 + CONDITIONS[k].code)}, 0, a, true);
+            }
+            break;
+    }
+    if (pendingRip != SIZE_MAX) {
+        fixups.push_back({pendingRip, code.size(), pendingSymbol});
+        pendingRip = SIZE_MAX;
+    }
+}
+
+void X64Encoder::label(const string& name) { labels[name] = code.size(); }
+
+void X64Encoder::dataString(const string& label, const string& text) {
+    dataLabels[label] = data.size();
+    data.insert(data.end(), text.begin(), text.end());
+    data.push_back(0);
+}
+
+void X64Encoder::dataZero(const string& label, size_t bytes) {
+    data.resize((data.size() + 7) & ~size_t{7});
+    dataLabels[label] = data.size();
+    data.resize(data.size() + bytes);
+}
+
+bool X64Encoder::link(size_t pageSize, vector<uint8_t>& image, size_t& dataOffset, string& error) {
+    image = code;
+    unordered_map<string, size_t> stubs;
+    for (const auto& fixup : fixups) {
+        if (labels.count(fixup.symbol) || dataLabels.count(fixup.symbol) || stubs.count(fixup.symbol)) continue;
+        auto ext = externals.find(fixup.symbol);
+        if (ext == externals.end()) {
+            error = "未定义的符号 " + fixup.symbol;
+            return false;
+        }
+        // 跳板: mov rax, 地址; jmp rax
+        stubs[fixup.symbol] = image.size();
+        uint64_t address = reinterpret_cast<uint64_t>(ext->second);
+        image.push_back(0x48);
+        image.push_back(0xB8);
+        for (int k = 0; k < 8; ++k) image.push_back(static_cast<uint8_t>(address >> (8 * k)));
+        image.push_back(0xFF);
+        image.push_back(0xE0);
+    }
+    dataOffset = (image.size() + pageSize - 1) / pageSize * pageSize;
+    image.resize(dataOffset);
+    image.insert(image.end(), data.begin(), data.end());
+
+    for (const auto& fixup : fixups) {
+        size_t target;
+        if (auto it = labels.find(fixup.symbol); it != labels.end()) target = it->second;
+        else if (auto d = dataLabels.find(fixup.symbol); d != dataLabels.end()) target = dataOffset + d->second;
+        else target = stubs[fixup.symbol];
+        int64_t rel = static_cast<int64_t>(target) - static_cast<int64_t>(fixup.end);
+        if (!fitsInt32(rel)) {
+            error = "跳转距离超出范围: " + fixup.symbol;
+            return false;
+        }
+        uint32_t u = static_cast<uint32_t>(rel);
+        for (int k = 0; k < 4; ++k) image[fixup.at + k] = static_cast<uint8_t>(u >> (8 * k));
+    }
+    return true;
+}
+
+bool X64Encoder::labelOffset(const string& name, size_t& offset) const {
+    auto it = labels.find(name);
+    if (it == labels.end()) return false;
+    offset = it->second;
+    return true;
+}
@@ -0,0 +1,167 @@
+#ifndef X64_ASSEMBLER_H
+#define X64_ASSEMBLER_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// x86-64 指令的结构化表示，X64Generator 通过 X64Emitter 接口输出指令:
+//   X64TextEmitter  打印成 GAS (Intel 语法) 汇编文本
+//   X64Encoder      直接编码成机器码，供 JIT (见 jit.h) 使用
+// 只覆盖代码生成器用到的指令和寻址方式。
+
+enum class X64Reg : uint8_t {
+    RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15,
+    XMM0, XMM1, XMM2, XMM3, XMM4, XMM5, XMM6, XMM7,
+    XMM8, XMM9, XMM10, XMM11, XMM12, XMM13, XMM14, XMM15,
+    RIP,  // 只作内存操作数的基址: 相对 symbol 寻址
+    NONE
+};
+
+inline bool isXmm(X64Reg r) { return r >= X64Reg::XMM0 && r <= X64Reg::XMM15; }
+inline X64Reg xmmReg(int n) { return static_cast<X64Reg>(static_cast<int>(X64Reg::XMM0) + n); }
+
+struct X64Operand {
+    enum class Kind : uint8_t { NONE, REG, MEM, IMM, SYMBOL };
+    Kind kind = Kind::NONE;
+    uint8_t size = 8;                  // 通用寄存器的宽度 (字节): 8, 4 或 1，内存操作数总是 8
+    X64Reg reg = X64Reg::NONE;         // REG 的寄存器，MEM 的基址
+    X64Reg index = X64Reg::NONE;       // MEM 的变址寄存器
+    uint8_t scale = 1;
+    int64_t value = 0;                 // IMM 的值，MEM 的偏移
+    std::string symbol;                // SYMBOL 的名字 (标签或函数)，基址为 RIP 的 MEM 引用的数据
+
+    bool isNone() const { return kind == Kind::NONE; }
+    bool isReg() const { return kind == Kind::REG; }
+    bool isMem() const { return kind == Kind::MEM; }
+    bool isImm() const { return kind == Kind::IMM; }
+    bool operator==(const X64Operand& o) const {
+        return kind == o.kind && size == o.size && reg == o.reg && index == o.index && scale == o.scale &&
+               value == o.value && symbol == o.symbol;
+    }
+    bool operator!=(const X64Operand& o) const { return !(*this == o); }
+};
+
+inline X64Operand reg64(X64Reg r) { X64Operand o; o.kind = X64Operand::Kind::REG; o.reg = r; return o; }
+inline X64Operand reg32(X64Reg r) { X64Operand o = reg64(r); o.size = 4; return o; }
+inline X64Operand reg8(X64Reg r) { X64Operand o = reg64(r); o.size = 1; return o; }
+inline X64Operand imm(int64_t v) { X64Operand o; o.kind = X64Operand::Kind::IMM; o.value = v; return o; }
+inline X64Operand symbolRef(std::string name) {
+    X64Operand o;
+    o.kind = X64Operand::Kind::SYMBOL;
+    o.symbol = std::move(name);
+    return o;
+}
+inline X64Operand mem(X64Reg base, int64_t disp = 0, X64Reg index = X64Reg::NONE, uint8_t scale = 1) {
+    X64Operand o;
+    o.kind = X64Operand::Kind::MEM;
+    o.reg = base;
+    o.value = disp;
+    o.index = index;
+    o.scale = scale;
+    return o;
+}
+inline X64Operand ripMem(std::string symbol) {
+    X64Operand o = mem(X64Reg::RIP);
+    o.symbol = std::move(symbol);
+    return o;
+}
+
+enum class X64Op : uint8_t {
+    MOV, LEA, PUSH, POP, ADD, SUB, AND, OR, XOR, CMP, TEST, IMUL, NEG, IDIV, CQO, BTC, MOVZX,
+    JMP, JE, JNE, JL, JGE, JLE, JG, JB, JAE, JBE, JA, JP, JNP,
+    SETE, SETNE, SETL, SETGE, SETLE, SETG, SETB, SETAE, SETBE, SETA,
+    CALL, RET,
+    MOVQ, MOVSD, CVTSI2SD, CVTTSD2SI, ADDSD, SUBSD, MULSD, DIVSD, UCOMISD, XORPD,
+    FLD, FSTP, FSTP_ST0, FPREM, FNSTSW_AX
+};
+
+const char* x64OpName(X64Op op);
+
+// 条件码 ("e", "l", "a", ...) 对应的条件跳转和 setcc
+X64Op jumpFor(const std::string& cc);
+X64Op setFor(const std::string& cc);
+
+// 指令的接收者。标签和数据符号都用名字引用，由实现负责解析
+class X64Emitter {
+public:
+    virtual ~X64Emitter() = default;
+    virtual void instruction(X64Op op, const X64Operand& a = {}, const X64Operand& b = {},
+                             const std::string& comment = "") = 0;
+    virtual void label(const std::string& name) = 0;
+    virtual void comment(const std::string&) {}
+    virtual void dataString(const std::string& label, const std::string& text) = 0; // 以 0 结尾的只读字符串
+    virtual void dataZero(const std::string& label, size_t bytes) = 0;               // 清零的可写数据
+};
+
+// 打印成 GAS 汇编文本，代码和数据分开收集
+class X64TextEmitter : public X64Emitter {
+public:
+    void instruction(X64Op op, const X64Operand& a = {}, const X64Operand& b = {},
+                     const std::string& comment = "") override;
+    void label(const std::string& name) override;
+    void comment(const std::string& text) override;
+    void dataString(const std::string& label, const std::string& text) override;
+    void dataZero(const std::string& label, size_t bytes) override;
+
+    std::string code() const { return codeText.str(); }
+    std::string rodata() const { return rodataText.str(); }
+    std::string bss() const { return bssText.str(); }
+
+    static std::string format(const X64Operand& operand);
+
+private:
+    std::stringstream codeText, rodataText, bssText;
+};
+
+// 编码成机器码。对标签、函数和数据的引用都是 32 位相对偏移，link 时统一回填;
+// 没有定义的符号视为外部函数，link 时为每个生成一段 "mov rax, 地址; jmp rax" 的跳板
+class X64Encoder : public X64Emitter {
+public:
+    void instruction(X64Op op, const X64Operand& a = {}, const X64Operand& b = {},
+                     const std::string& comment = "") override;
+    void label(const std::string& name) override;
+    void dataString(const std::string& label, const std::string& text) override;
+    void dataZero(const std::string& label, size_t bytes) override;
+
+    void defineExternal(const std::string& name, const void* address) { externals[name] = address; }
+
+    // 按 [代码 | 跳板 | 数据] 的布局生成映像，数据从 dataOffset 起按页对齐，
+    // 以便代码页和数据页分别设置权限。未解析的符号写入 error 并返回 false
+    bool link(size_t pageSize, std::vector<uint8_t>& image, size_t& dataOffset, std::string& error);
+    // 链接之后某个代码标签的偏移
+    bool labelOffset(const std::string& name, size_t& offset) const;
+    size_t codeSize() const { return code.size(); }
+
+private:
+    struct Fixup {
+        size_t at;          // 32 位偏移在代码中的位置
+        size_t end;         // 所在指令的结尾，偏移相对于它
+        std::string symbol;
+    };
+
+    std::vector<uint8_t> code;
+    std::vector<uint8_t> data;
+    std::unordered_map<std::string, size_t> labels;       // 代码标签 -> 偏移
+    std::unordered_map<std::string, size_t> dataLabels;   // 数据符号 -> 数据区内的偏移
+    std::unordered_map<std::string, const void*> externals;
+    std::vector<Fixup> fixups;
+    size_t pendingRip = SIZE_MAX; // 当前指令中 RIP 相对偏移的位置
+    std::string pendingSymbol;
+
+    void byte(uint8_t b) { code.push_back(b); }
+    void imm32(int64_t v);
+    void imm64(int64_t v);
+    void rex(bool w, int reg, int index, int base, bool force = false);
+    void modrm(int regField, const X64Operand& rm);
+    // 常见的 "前缀 + REX + 操作码 + ModRM" 形式，opcode 可以是 0F xx 两字节
+    void encode(int prefix, bool w, std::initializer_list<uint8_t> opcode, int regField, const X64Operand& rm,
+                bool byteRegs = false);
+    void alu(int digit, uint8_t base, const X64Operand& a, const X64Operand& b);
+    void branch(std::initializer_list<uint8_t> opcode, const X64Operand& target);
+};
+
+#endif // X64_ASSEMBLER_H
@@ -0,0 +1,1224 @@
+#include "x64_generator.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+#include "optimizer.h"
+
+using namespace std;
+
+namespace {
+
+// 可分配的寄存器: 前两个是调用者保存的，只分给不跨越调用的区间。
+// rax/rcx/rdx 和参数寄存器留作生成代码时的暂存
+const X64Reg ALLOCATABLE[] = {X64Reg::R10, X64Reg::R11, X64Reg::RBX, X64Reg::R12,
+                              X64Reg::R13, X64Reg::R14, X64Reg::R15};
+constexpr int NUM_ALLOCATABLE = 7;
+constexpr int NUM_CALLER_SAVED = 2;
+
+const X64Reg ARG_GPR[] = {X64Reg::RDI, X64Reg::RSI, X64Reg::RDX, X64Reg::RCX, X64Reg::R8, X64Reg::R9};
+constexpr size_t NUM_ARG_GPR = 6;
+constexpr size_t NUM_ARG_XMM = 8;
+
+constexpr int MAX_CALL_DEPTH = 100000; // 与解释器的调用深度上限一致
+
+// 运行时错误信息，与解释器的一致
+const pair<const char*, const char*> RUNTIME_MESSAGES[] = {
+    {"rt_err_div", "除以零"},
+    {"rt_err_index", "数组下标越界"},
+    {"rt_err_size", "数组大小无效"},
+    {"rt_err_overflow", "调用栈溢出 (递归过深)"},
+};
+
+bool fitsImm32(int64_t v) { return v >= INT32_MIN && v <= INT32_MAX; }
+
+const X64Operand RAX = reg64(X64Reg::RAX);
+const X64Operand RCX = reg64(X64Reg::RCX);
+const X64Operand RDX = reg64(X64Reg::RDX);
+const X64Operand RSP = reg64(X64Reg::RSP);
+const X64Operand RBP = reg64(X64Reg::RBP);
+const X64Operand XMM0 = reg64(X64Reg::XMM0);
+const X64Operand XMM1 = reg64(X64Reg::XMM1);
+const X64Operand XMM2 = reg64(X64Reg::XMM2);
+const X64Operand XMM15 = reg64(X64Reg::XMM15);
+
+int64_t doubleBits(double d) {
+    int64_t bits;
+    memcpy(&bits, &d, sizeof bits);
+    return bits;
+}
+
+const char* invertCondition(const string& cc) {
+    if (cc == "l") return "ge";
+    if (cc == "ge") return "l";
+    if (cc == "g") return "le";
+    if (cc == "le") return "g";
+    if (cc == "e") return "ne";
+    if (cc == "ne") return "e";
+    if (cc == "a") return "be";
+    return "a"; // be
+}
+
+bool isComparison(Opcode op) { return op >= Opcode::LT && op <= Opcode::NE; }
+
+// 汇编文本附带的运行时。进入每个例程时 rsp 按 System V 约定是 16n+8
+const char* const RUNTIME_ROUTINES = R"(
+# ---- 运行时 ----
+# rt_print(rdi = 值, esi = 类型编码): 输出一个值并换行
+rt_print:
+    sub rsp, 8
+    cmp esi, 1
+    je .Lrt_print_float
+    test esi, esi
+    je .Lrt_print_int
+    call rt_to_str
+    mov rdi, rax
+    call puts@PLT
+    add rsp, 8
+    ret
+.Lrt_print_int:
+    mov rsi, rdi
+    lea rdi, .Lrt_fmt_int_nl[rip]
+    xor eax, eax
+    call printf@PLT
+    add rsp, 8
+    ret
+.Lrt_print_float:
+    movq xmm0, rdi
+    lea rdi, .Lrt_fmt_float_nl[rip]
+    mov eax, 1
+    call printf@PLT
+    add rsp, 8
+    ret
+
+# rt_to_str(rdi = 值, esi = 类型编码) -> rax: 转成字符串，数组递归转换每个元素
+rt_to_str:
+    push rbx
+    push r12
+    push r13
+    push r14
+    sub rsp, 8
+    mov rbx, rdi
+    mov r12d, esi
+    cmp esi, 4
+    je .Lrt_to_str_string
+    cmp esi, 2
+    je .Lrt_to_str_bool
+    cmp esi, 5
+    jge .Lrt_to_str_array
+    mov edi, 32
+    call malloc@PLT
+    mov r13, rax
+    cmp r12d, 3
+    je .Lrt_to_str_char
+    mov rdi, r13
+    mov esi, 32
+    cmp r12d, 1
+    je .Lrt_to_str_float
+    lea rdx, .Lrt_fmt_int[rip]
+    mov rcx, rbx
+    xor eax, eax
+    call snprintf@PLT
+    jmp .Lrt_to_str_done
+.Lrt_to_str_float:
+    lea rdx, .Lrt_fmt_float[rip]
+    movq xmm0, rbx
+    mov eax, 1
+    call snprintf@PLT
+    jmp .Lrt_to_str_done
+.Lrt_to_str_char:
+    mov BYTE PTR [r13], bl
+    mov BYTE PTR [r13+1], 0
+.Lrt_to_str_done:
+    mov rax, r13
+    jmp .Lrt_to_str_ret
+.Lrt_to_str_string:
+    mov rax, rbx
+    test rax, rax
+    jnz .Lrt_to_str_ret
+    lea rax, .Lrt_empty[rip]
+    jmp .Lrt_to_str_ret
+.Lrt_to_str_bool:
+    lea rax, .Lrt_true[rip]
+    test rbx, rbx
+    jnz .Lrt_to_str_ret
+    lea rax, .Lrt_false[rip]
+    jmp .Lrt_to_str_ret
+.Lrt_to_str_array:
+    sub r12d, 5
+    lea r13, .Lrt_lbracket[rip]
+    xor r14d, r14d
+    test rbx, rbx
+    jz .Lrt_to_str_array_end
+.Lrt_to_str_array_loop:
+    cmp r14, QWORD PTR [rbx]
+    jae .Lrt_to_str_array_end
+    test r14, r14
+    jz .Lrt_to_str_array_elem
+    mov rdi, r13
+    lea rsi, .Lrt_comma[rip]
+    call rt_concat_str
+    mov r13, rax
+.Lrt_to_str_array_elem:
+    mov rdi, QWORD PTR [rbx+r14*8+8]
+    mov esi, r12d
+    call rt_to_str
+    mov rdi, r13
+    mov rsi, rax
+    call rt_concat_str
+    mov r13, rax
+    inc r14
+    jmp .Lrt_to_str_array_loop
+.Lrt_to_str_array_end:
+    mov rdi, r13
+    lea rsi, .Lrt_rbracket[rip]
+    call rt_concat_str
+.Lrt_to_str_ret:
+    add rsp, 8
+    pop r14
+    pop r13
+    pop r12
+    pop rbx
+    ret
+
+# rt_concat_str(rdi, rsi) -> rax: 拼接两个字符串到新分配的内存
+rt_concat_str:
+    push rbx
+    push r12
+    push r13
+    mov rbx, rdi
+    mov r12, rsi
+    call strlen@PLT
+    mov r13, rax
+    mov rdi, r12
+    call strlen@PLT
+    lea rdi, [r13+rax+1]
+    call malloc@PLT
+    mov r13, rax
+    mov rdi, rax
+    mov rsi, rbx
+    call strcpy@PLT
+    mov rdi, r13
+    mov rsi, r12
+    call strcat@PLT
+    mov rax, r13
+    pop r13
+    pop r12
+    pop rbx
+    ret
+
+# rt_concat(rdi = 左值, esi = 左类型编码, rdx = 右值, ecx = 右类型编码) -> rax: 字符串 + 任意值
+rt_concat:
+    push rbx
+    push r12
+    push r13
+    mov rbx, rdx
+    mov r12d, ecx
+    call rt_to_str
+    mov r13, rax
+    mov rdi, rbx
+    mov esi, r12d
+    call rt_to_str
+    mov rdi, r13
+    mov rsi, rax
+    call rt_concat_str
+    pop r13
+    pop r12
+    pop rbx
+    ret
+
+# rt_new_array(rdi = 元素个数) -> rax: 分配清零的 [元素个数, 元素...]
+rt_new_array:
+    push rbx
+    test rdi, rdi
+    js rt_err_size
+    mov rbx, rdi
+    lea rdi, [rdi+1]
+    mov esi, 8
+    call calloc@PLT
+    mov QWORD PTR [rax], rbx
+    pop rbx
+    ret
+
+# rt_strcmp(rdi, rsi) -> eax: 字符串比较
+rt_strcmp:
+    jmp strcmp@PLT
+
+# rt_fail(rdi = 信息): 刷新输出，报告运行时错误并退出，可以从任意栈位置跳来
+rt_fail:
+    and rsp, -16
+    mov rbx, rdi
+    xor edi, edi
+    call fflush@PLT
+    mov rax, QWORD PTR stderr@GOTPCREL[rip]
+    mov rdi, QWORD PTR [rax]
+    lea rsi, .Lrt_fmt_error[rip]
+    mov rdx, rbx
+    xor eax, eax
+    call fprintf@PLT
+    mov edi, 1
+    call exit@PLT
+)";
+
+} // namespace
+
+X64Generator::X64Generator(QuadrupleSpan quads, SymbolTable& st)
+    : quadruples(quads), symbolTable(st) {}
+
+string X64Generator::generate() {
+    X64TextEmitter text;
+    generate(text);
+    out = &text;
+    generateRuntime();
+    out = nullptr;
+
+    stringstream assembly;
+    assembly << "# Anchor 编译器生成的 x86-64 汇编 (System V, GAS Intel 语法)" << endl;
+    assembly << "# 汇编链接: gcc -o program output.s" << endl;
+    assembly << "    .intel_syntax noprefix" << endl;
+    assembly << "    .text" << endl;
+    assembly << "    .globl main" << endl;
+    assembly << text.code() << RUNTIME_ROUTINES;
+    assembly << endl << "    .section .rodata" << endl << text.rodata();
+    // 全局变量都占 8 字节，初值为 0，由顶层代码赋值
+    assembly << endl << "    .bss" << endl << "    .align 8" << endl << text.bss();
+    assembly << endl << "    .section .note.GNU-stack,\"\",@progbits" << endl;
+    return assembly.str();
+}
+
+void X64Generator::generate(X64Emitter& emitter) {
+    out = &emitter;
+    functions.clear();
+    functionIndex.clear();
+    useCounts.clear();
+    string_literals.clear();
+    globals.clear();
+    label_counter = 0;
+
+    // 活跃变量分析在传进来的 (优化后的) 四元式上重新做一遍，块按顺序首尾相接
+    Optimizer analyzer(quadruples, symbolTable);
+    const vector<BasicBlock>& blocks = analyzer.analyzeLiveness();
+    vector<size_t> blockStart;
+    size_t position = 0;
+    for (const auto& block : blocks) {
+        blockStart.push_back(position);
+        position += block.quads.size();
+    }
+
+    for (const auto& q : quadruples) {
+        Operand uses[3];
+        int count = quadUses(q, uses);
+        for (int k = 0; k < count; ++k) ++useCounts[uses[k].name];
+        for (const Operand* op : {&q.arg1, &q.arg2, &q.res}) {
+            if (op->kind == OperandKind::STRING && !string_literals.count(op->name)) {
+                string label = ".LS" + to_string(string_literals.size());
+                string_literals[op->name] = label;
+            }
+        }
+    }
+
+    collectFunctions(blocks, blockStart);
+    for (auto& f : functions) {
+        inferTypes(f);
+        allocateRegisters(f, blocks, blockStart);
+    }
+
+    for (auto& f : functions) generateFunction(f);
+    generateDataSection();
+    out = nullptr;
+}
+
+// 按 FUNC_BEGIN/FUNC_END 把四元式和基本块分给各个函数，其余的归顶层代码
+void X64Generator::collectFunctions(const vector<BasicBlock>& blocks, const vector<size_t>& blockStart) {
+    functions.emplace_back(); // functions[0] 是顶层代码
+    vector<size_t> owner(quadruples.size(), 0);
+    size_t currentFunction = 0;
+    for (size_t i = 0; i < quadruples.size(); ++i) {
+        const Quadruple& q = quadruples[i];
+        if (q.op == Opcode::FUNC_BEGIN) {
+            currentFunction = functions.size();
+            functionIndex[q.arg1.name] = currentFunction;
+            FunctionInfo f;
+            f.name = q.arg1.name;
+            Symbol* sym = symbolTable.lookup(q.arg1.name);
+            if (sym && sym->category == SymbolCategory::Function) f.signature = sym->type;
+            functions.push_back(std::move(f));
+        }
+        owner[i] = currentFunction;
+        functions[currentFunction].quads.push_back(i);
+        if (q.op == Opcode::GET_PARAM) functions[currentFunction].params.push_back(q.arg1.name);
+        if (q.op == Opcode::FUNC_END) currentFunction = 0;
+    }
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        functions[owner[blockStart[b]]].blocks.push_back(b);
+    }
+}
+
+bool X64Generator::isGlobal(const Operand& operand) {
+    if (operand.kind != OperandKind::SYMBOL) return false;
+    Symbol* sym = symbolTable.lookup(operand.name);
+    if (!sym || sym->scopeLevel != 0 || sym->category != SymbolCategory::Variable) return false;
+    globals.insert(operand.name);
+    return true;
+}
+
+X64Generator::NativeType X64Generator::fromTypeInfo(const shared_ptr<TypeInfo>& type) {
+    NativeType t;
+    t.info = type;
+    if (!type) return t;
+    switch (type->kind) {
+        case TypeKind::PRIMITIVE:
+            if (type->name == "int") t.kind = ValueKind::INT;
+            else if (type->name == "float") t.kind = ValueKind::FLOAT;
+            else if (type->name == "bool") t.kind = ValueKind::BOOL;
+            else if (type->name == "char") t.kind = ValueKind::CHAR;
+            else if (type->name == "string") t.kind = ValueKind::STRING;
+            break;
+        case TypeKind::ARRAY:  t.kind = ValueKind::ARRAY; break;
+        case TypeKind::STRUCT: t.kind = ValueKind::STRUCT; break;
+        default: break;
+    }
+    return t;
+}
+
+X64Generator::NativeType X64Generator::elementType(const NativeType& array) {
+    if (array.kind != ValueKind::ARRAY || !array.info) return {};
+    return fromTypeInfo(array.info->elementType);
+}
+
+X64Generator::NativeType X64Generator::memberType(const NativeType& object, int64_t offset) {
+    if (object.kind != ValueKind::STRUCT || !object.info) return {};
+    for (const auto& member : object.info->structMembers) {
+        if (member.offset == offset) return fromTypeInfo(member.type);
+    }
+    return {};
+}
+
+// 运行时 rt_print/rt_to_str 使用的类型编码: 0 整数, 1 浮点, 2 布尔, 3 字符, 4 字符串,
+// 5 + k 为元素编码是 k 的数组 (结构体按整数数组输出)
+int X64Generator::printCode(const NativeType& type) {
+    switch (type.kind) {
+        case ValueKind::FLOAT:  return 1;
+        case ValueKind::BOOL:   return 2;
+        case ValueKind::CHAR:   return 3;
+        case ValueKind::STRING: return 4;
+        case ValueKind::ARRAY:  return 5 + printCode(elementType(type));
+        case ValueKind::STRUCT: return 5;
+        default:                return 0;
+    }
+}
+
+// 形参取函数签名里的类型，其他有名字的变量取声明时的类型，临时变量没有声明类型
+X64Generator::NativeType X64Generator::declaredType(NameId name, const FunctionInfo& f) {
+    if (f.signature) {
+        for (const auto& param : f.signature->parameters) {
+            if (param.name == name) return fromTypeInfo(param.type);
+        }
+    }
+    const Symbol* sym = symbolTable.lookupEverDeclared(name);
+    if (sym && sym->category == SymbolCategory::Variable) return fromTypeInfo(sym->type);
+    return {};
+}
+
+X64Generator::NativeType X64Generator::typeOf(const Operand& operand) {
+    NativeType t;
+    switch (operand.kind) {
+        case OperandKind::INT:    t.kind = ValueKind::INT; return t;
+        case OperandKind::FLOAT:  t.kind = ValueKind::FLOAT; return t;
+        case OperandKind::BOOL:   t.kind = ValueKind::BOOL; return t;
+        case OperandKind::CHAR:   t.kind = ValueKind::CHAR; return t;
+        case OperandKind::STRING: t.kind = ValueKind::STRING; return t;
+        case OperandKind::TEMP: case OperandKind::SYMBOL: break;
+        default: return t;
+    }
+    if (isGlobal(operand)) return fromTypeInfo(symbolTable.lookup(operand.name)->type);
+    if (current) {
+        auto it = current->types.find(operand.name);
+        if (it != current->types.end()) return it->second;
+    }
+    return t;
+}
+
+// 局部变量用声明的类型，临时变量的类型从产生它的四元式推出。
+// 临时变量可能在循环里先用后定义，所以扫描两遍
+void X64Generator::inferTypes(FunctionInfo& f) {
+    current = &f;
+    for (int round = 0; round < 2; ++round) {
+        for (size_t index : f.quads) {
+            const Quadruple& q = quadruples[index];
+            for (const Operand* op : {&q.arg1, &q.arg2, &q.res}) {
+                if (op->kind == OperandKind::SYMBOL && !isGlobal(*op) && !f.types.count(op->name)) {
+                    NativeType t = declaredType(op->name, f);
+                    if (t.kind != ValueKind::UNKNOWN) f.types[op->name] = t;
+                }
+            }
+
+            const Operand def = quadDef(q);
+            if (def.kind != OperandKind::TEMP) continue;
+            NativeType t;
+            ValueKind a = kindOf(q.arg1), b = kindOf(q.arg2);
+            switch (q.op) {
+                case Opcode::ASSIGN: t = typeOf(q.arg1); break;
+                case Opcode::ADD:
+                    if (a == ValueKind::STRING || b == ValueKind::STRING) { t.kind = ValueKind::STRING; break; }
+                    // fallthrough
+                case Opcode::SUB: case Opcode::MUL: case Opcode::DIV: case Opcode::MOD:
+                    t.kind = (a == ValueKind::FLOAT || b == ValueKind::FLOAT) ? ValueKind::FLOAT : ValueKind::INT;
+                    break;
+                case Opcode::NEG: t.kind = a == ValueKind::FLOAT ? ValueKind::FLOAT : ValueKind::INT; break;
+                case Opcode::NOT: case Opcode::LT: case Opcode::GT: case Opcode::LE: case Opcode::GE:
+                case Opcode::EQ: case Opcode::NE: case Opcode::AND: case Opcode::OR:
+                    t.kind = ValueKind::BOOL;
+                    break;
+                case Opcode::CALL: {
+                    auto it = functionIndex.find(q.arg1.name);
+                    if (it != functionIndex.end() && functions[it->second].signature) {
+                        t = fromTypeInfo(functions[it->second].signature->returnType);
+                    }
+                    break;
+                }
+                case Opcode::LOAD_AT: t = elementType(typeOf(q.arg2)); break;
+                case Opcode::LOAD_MEMBER: t = memberType(typeOf(q.arg2), q.res.intValue); break;
+                case Opcode::DEC_ARRAY: case Opcode::DEC_DYN_ARRAY: t.kind = ValueKind::ARRAY; break;
+                default: break;
+            }
+            if (t.kind != ValueKind::UNKNOWN || !f.types.count(def.name)) f.types[def.name] = t;
+        }
+    }
+    current = nullptr;
+}
+
+bool X64Generator::callsOut(const Quadruple& q) {
+    switch (q.op) {
+        case Opcode::CALL: case Opcode::PRINT: case Opcode::DEC_ARRAY: case Opcode::DEC_DYN_ARRAY:
+        case Opcode::LOAD_MEMBER: case Opcode::STORE_MEMBER:
+            return true;
+        case Opcode::ADD:
+            return kindOf(q.arg1) == ValueKind::STRING || kindOf(q.arg2) == ValueKind::STRING;
+        default:
+            return isComparison(q.op) && kindOf(q.arg1) == ValueKind::STRING && kindOf(q.arg2) == ValueKind::STRING;
+    }
+}
+
+// 线性扫描寄存器分配。区间取变量所有活跃点的最小和最大下标:
+// 块内读写的位置，加上它在 live_in 中的块的起点和在 live_out 中的块的终点
+void X64Generator::allocateRegisters(FunctionInfo& f, const vector<BasicBlock>& blocks,
+                                     const vector<size_t>& blockStart) {
+    current = &f;
+    unordered_map<NameId, LiveInterval> ranges;
+    auto extend = [&](const Operand& o, int pos) {
+        if (!o.isVariable() || isGlobal(o)) return;
+        auto [it, inserted] = ranges.try_emplace(o.name);
+        if (inserted) {
+            it->second.name = o.name;
+            it->second.start = it->second.end = pos;
+        } else {
+            it->second.start = min(it->second.start, pos);
+            it->second.end = max(it->second.end, pos);
+        }
+    };
+
+    for (size_t b : f.blocks) {
+        int start = static_cast<int>(blockStart[b]);
+        int end = start + static_cast<int>(blocks[b].quads.size()) - 1;
+        for (const auto& v : blocks[b].live_in) extend(v, start);
+        for (const auto& v : blocks[b].live_out) extend(v, end);
+    }
+    vector<int> callPoints;
+    for (size_t index : f.quads) {
+        const Quadruple& q = quadruples[index];
+        int pos = static_cast<int>(index);
+        extend(quadDef(q), pos);
+        Operand uses[3];
+        int count = quadUses(q, uses);
+        for (int k = 0; k < count; ++k) extend(uses[k], pos);
+        if (callsOut(q)) callPoints.push_back(pos);
+    }
+    // 形参在序言里就写入，从函数入口开始活跃
+    if (!f.quads.empty()) {
+        for (NameId param : f.params) extend(Operand::symbol(param), static_cast<int>(f.quads.front()));
+    }
+
+    f.intervals.clear();
+    for (auto& [name, iv] : ranges) {
+        auto it = upper_bound(callPoints.begin(), callPoints.end(), iv.start);
+        iv.crossesCall = it != callPoints.end() && *it < iv.end;
+        f.intervals.push_back(iv);
+    }
+    sort(f.intervals.begin(), f.intervals.end(), [](const LiveInterval& x, const LiveInterval& y) {
+        return x.start != y.start ? x.start < y.start : x.name < y.name;
+    });
+
+    vector<LiveInterval*> active;
+    bool busy[NUM_ALLOCATABLE] = {};
+    bool used[NUM_ALLOCATABLE] = {};
+    for (auto& iv : f.intervals) {
+        // 结束得比当前区间开始早的区间释放寄存器。终点等于起点时不释放，
+        // 同一条四元式读的两个变量不能分到同一个寄存器
+        for (size_t k = 0; k < active.size();) {
+            if (active[k]->end < iv.start) {
+                busy[active[k]->reg] = false;
+                active.erase(active.begin() + k);
+            } else {
+                ++k;
+            }
+        }
+
+        int first = iv.crossesCall ? NUM_CALLER_SAVED : 0;
+        for (int r = first; r < NUM_ALLOCATABLE; ++r) {
+            if (!busy[r]) { iv.reg = r; break; }
+        }
+        if (iv.reg < 0) {
+            // 没有空闲的寄存器: 溢出结束得最晚的那个区间
+            LiveInterval* victim = nullptr;
+            for (LiveInterval* a : active) {
+                if (a->reg >= first && (!victim || a->end > victim->end)) victim = a;
+            }
+            if (victim && victim->end > iv.end) {
+                iv.reg = victim->reg;
+                victim->reg = -1;
+                victim->slot = f.spillSlots++;
+                replace(active.begin(), active.end(), victim, &iv);
+            } else {
+                iv.slot = f.spillSlots++;
+            }
+        } else {
+            busy[iv.reg] = true;
+            active.push_back(&iv);
+        }
+        if (iv.reg >= 0) used[iv.reg] = true;
+    }
+
+    f.savedRegisters.clear();
+    for (int r = NUM_CALLER_SAVED; r < NUM_ALLOCATABLE; ++r) {
+        if (used[r]) f.savedRegisters.push_back(r);
+    }
+    long saved = static_cast<long>(f.savedRegisters.size());
+    f.locations.clear();
+    for (const auto& iv : f.intervals) {
+        f.locations[iv.name] = iv.reg >= 0 ? reg64(ALLOCATABLE[iv.reg]) : mem(X64Reg::RBP, -8 * (saved + iv.slot + 1));
+    }
+
+    // 入口处就活跃的变量 (形参除外) 可能先读后写，与解释器一样从零开始
+    f.clearedOnEntry.clear();
+    if (!f.blocks.empty()) {
+        for (const auto& v : blocks[f.blocks.front()].live_in) {
+            if (!isGlobal(v) && f.locations.count(v.name) &&
+                find(f.params.begin(), f.params.end(), v.name) == f.params.end()) {
+                f.clearedOnEntry.push_back(v.name);
+            }
+        }
+    }
+    current = nullptr;
+}
+
+void X64Generator::generateFunction(FunctionInfo& f) {
+    bool isMain = f.name == NAME_NONE;
+    if (f.quads.empty() && !isMain) return;
+    current = &f;
+    pendingArgs.clear();
+    string symbol = isMain ? "main" : "fn_" + nameOf(f.name);
+
+    out->comment(isMain ? "顶层代码" : "函数 " + nameOf(f.name));
+    for (const auto& iv : f.intervals) {
+        out->comment("  " + nameOf(iv.name) + " [" + to_string(iv.start) + ", " + to_string(iv.end) + "] -> " +
+                     X64TextEmitter::format(f.locations[iv.name]));
+    }
+    out->label(symbol);
+
+    // 序言: 保存 rbp 和用到的被调者保存寄存器，为溢出的变量留出栈槽，保持 rsp 16 字节对齐
+    emit(X64Op::PUSH, RBP);
+    emit(X64Op::MOV, RBP, RSP);
+    for (int r : f.savedRegisters) emit(X64Op::PUSH, reg64(ALLOCATABLE[r]));
+    long frame = 8L * f.spillSlots;
+    if ((f.savedRegisters.size() + f.spillSlots) % 2) frame += 8;
+    if (frame) emit(X64Op::SUB, RSP, imm(frame));
+    if (!isMain) {
+        emit(X64Op::ADD, ripMem("rt_depth"), imm(1));
+        emit(X64Op::CMP, ripMem("rt_depth"), imm(MAX_CALL_DEPTH));
+        emit(X64Op::JA, symbolRef("rt_err_overflow"));
+    }
+
+    // 形参: 浮点数从 xmm0-7 取，其余从 rdi, rsi, rdx, rcx, r8, r9 取，再多的在调用者栈上
+    // 与全局变量同名的形参和解释器一样直接写入全局变量
+    size_t gpr = 0, xmm = 0, stackIndex = 0;
+    for (NameId param : f.params) {
+        bool isFloat = declaredType(param, f).kind == ValueKind::FLOAT;
+        Operand operand = Operand::symbol(param);
+        bool live = isGlobal(operand) || f.locations.count(param);
+        X64Operand loc = live ? location(operand) : X64Operand{};
+        if (isFloat && xmm < NUM_ARG_XMM) {
+            if (live) emit(X64Op::MOVQ, loc, reg64(xmmReg(static_cast<int>(xmm))), nameOf(param));
+            ++xmm;
+        } else if (!isFloat && gpr < NUM_ARG_GPR) {
+            if (live) emit(X64Op::MOV, loc, reg64(ARG_GPR[gpr]), nameOf(param));
+            ++gpr;
+        } else {
+            if (live) {
+                emit(X64Op::MOV, RAX, mem(X64Reg::RBP, 16 + 8L * stackIndex));
+                emit(X64Op::MOV, loc, RAX, nameOf(param));
+            }
+            ++stackIndex;
+        }
+    }
+    for (NameId name : f.clearedOnEntry) {
+        const X64Operand& loc = f.locations[name];
+        if (loc.isReg()) emit(X64Op::XOR, reg32(loc.reg), reg32(loc.reg), nameOf(name));
+        else emit(X64Op::MOV, loc, imm(0), nameOf(name));
+    }
+
+    for (size_t k = 0; k < f.quads.size(); ++k) {
+        const Quadruple& q = quadruples[f.quads[k]];
+        out->comment(q.toString());
+        // 比较的结果只被紧跟的条件跳转使用时，直接按标志位跳转
+        if (isComparison(q.op) && k + 1 < f.quads.size() && f.quads[k + 1] == f.quads[k] + 1) {
+            const Quadruple& next = quadruples[f.quads[k + 1]];
+            if ((next.op == Opcode::JUMPF || next.op == Opcode::JUMPNZ) && next.arg1 == q.res &&
+                q.res.kind == OperandKind::TEMP && useCounts[q.res.name] == 1) {
+                string cc = emitCompare(q);
+                emit(jumpFor(next.op == Opcode::JUMPF ? invertCondition(cc) : cc), symbolRef(labelName(next.res.name)),
+                     {}, next.toString());
+                ++k;
+                continue;
+            }
+        }
+        generateForQuad(q);
+    }
+
+    // 尾声: 执行到末尾时没有返回值
+    emit(X64Op::XOR, reg32(X64Reg::RAX), reg32(X64Reg::RAX));
+    out->label(".Lret_" + symbol);
+    if (!isMain) emit(X64Op::SUB, ripMem("rt_depth"), imm(1));
+    if (!f.savedRegisters.empty()) emit(X64Op::LEA, RSP, mem(X64Reg::RBP, -8L * f.savedRegisters.size()));
+    else emit(X64Op::MOV, RSP, RBP);
+    for (auto it = f.savedRegisters.rbegin(); it != f.savedRegisters.rend(); ++it) {
+        emit(X64Op::POP, reg64(ALLOCATABLE[*it]));
+    }
+    emit(X64Op::POP, RBP);
+    emit(X64Op::RET);
+    current = nullptr;
+}
+
+void X64Generator::generateForQuad(const Quadruple& q) {
+    switch (q.op) {
+        case Opcode::ASSIGN:
+            assign(q.res, q.arg1);
+            break;
+        case Opcode::ADD: case Opcode::SUB: case Opcode::MUL: case Opcode::DIV: case Opcode::MOD:
+            emitArithmetic(q);
+            break;
+        case Opcode::NEG:
+            load(X64Reg::RAX, q.arg1);
+            if (kindOf(q.arg1) == ValueKind::FLOAT) {
+                emit(X64Op::BTC, RAX, imm(63)); // 翻转符号位
+                store(X64Reg::RAX, ValueKind::FLOAT, q.res);
+            } else {
+                emit(X64Op::NEG, RAX);
+                store(X64Reg::RAX, ValueKind::INT, q.res);
+            }
+            break;
+        case Opcode::NOT:
+            emitTruth(q.arg1, X64Reg::RAX);
+            emit(X64Op::SETE, reg8(X64Reg::RAX));
+            emit(X64Op::MOVZX, reg32(X64Reg::RAX), reg8(X64Reg::RAX));
+            store(X64Reg::RAX, ValueKind::BOOL, q.res);
+            break;
+        case Opcode::LT: case Opcode::GT: case Opcode::LE: case Opcode::GE: case Opcode::EQ: case Opcode::NE: {
+            string cc = emitCompare(q);
+            emit(setFor(cc), reg8(X64Reg::RAX));
+            emit(X64Op::MOVZX, reg32(X64Reg::RAX), reg8(X64Reg::RAX));
+            store(X64Reg::RAX, ValueKind::BOOL, q.res);
+            break;
+        }
+        case Opcode::AND: case Opcode::OR:
+            emitTruth(q.arg1, X64Reg::RAX);
+            emit(X64Op::SETNE, reg8(X64Reg::RAX));
+            emitTruth(q.arg2, X64Reg::RCX);
+            emit(X64Op::SETNE, reg8(X64Reg::RCX));
+            emit(q.op == Opcode::AND ? X64Op::AND : X64Op::OR, reg8(X64Reg::RAX), reg8(X64Reg::RCX));
+            emit(X64Op::MOVZX, reg32(X64Reg::RAX), reg8(X64Reg::RAX));
+            store(X64Reg::RAX, ValueKind::BOOL, q.res);
+            break;
+        case Opcode::LABEL:
+            out->label(labelName(q.arg1.name));
+            break;
+        case Opcode::JUMP:
+            emit(X64Op::JMP, symbolRef(labelName(q.res.name)));
+            break;
+        case Opcode::JUMPF: case Opcode::JUMPNZ:
+            emitTruth(q.arg1, X64Reg::RAX);
+            emit(q.op == Opcode::JUMPF ? X64Op::JE : X64Op::JNE, symbolRef(labelName(q.res.name)));
+            break;
+        case Opcode::FUNC_BEGIN: case Opcode::FUNC_END: case Opcode::GET_PARAM:
+            break; // 序言和尾声里处理
+        case Opcode::PARAM:
+            // 实参从右往左压栈，CALL 时栈顶是第一个实参
+            emit(X64Op::PUSH, source(q.arg1, X64Reg::RAX));
+            pendingArgs.push_back(kindOf(q.arg1));
+            break;
+        case Opcode::CALL:
+            emitCall(q);
+            break;
+        case Opcode::RETURN: {
+            bool isMain = current->name == NAME_NONE;
+            if (isMain || q.arg1.isNone()) {
+                emit(X64Op::XOR, reg32(X64Reg::RAX), reg32(X64Reg::RAX));
+            } else {
+                NativeType ret = current->signature ? fromTypeInfo(current->signature->returnType) : NativeType{};
+                loadAs(X64Reg::RAX, q.arg1, ret.kind);
+                if (ret.kind == ValueKind::FLOAT) emit(X64Op::MOVQ, XMM0, RAX);
+            }
+            emit(X64Op::JMP, symbolRef(isMain ? ".Lret_main" : ".Lret_fn_" + nameOf(current->name)));
+            break;
+        }
+        case Opcode::PRINT:
+            load(X64Reg::RDI, q.arg1);
+            emit(X64Op::MOV, reg32(X64Reg::RSI), imm(printCode(typeOf(q.arg1))));
+            callRuntime("rt_print");
+            break;
+        case Opcode::DEC_ARRAY: case Opcode::DEC_DYN_ARRAY:
+            load(X64Reg::RDI, q.arg2);
+            callRuntime("rt_new_array");
+            store(X64Reg::RAX, ValueKind::ARRAY, q.arg1);
+            break;
+        case Opcode::LOAD_AT: case Opcode::STORE_AT: {
+            // 数组: [元素个数, 元素...]，未分配的数组 (空指针) 也按下标越界处理
+            X64Operand base = source(q.arg2, X64Reg::RAX);
+            if (!base.isReg()) { emit(X64Op::MOV, RAX, base); base = RAX; }
+            X64Operand index = source(q.res, X64Reg::RCX);
+            if (!index.isReg()) { emit(X64Op::MOV, RCX, index); index = RCX; }
+            emit(X64Op::TEST, base, base);
+            emit(X64Op::JE, symbolRef("rt_err_index"));
+            emit(X64Op::CMP, index, mem(base.reg));
+            emit(X64Op::JAE, symbolRef("rt_err_index"));
+            X64Operand element = mem(base.reg, 8, index.reg, 8);
+            NativeType elem = elementType(typeOf(q.arg2));
+            if (q.op == Opcode::LOAD_AT) {
+                emit(X64Op::MOV, RAX, element);
+                store(X64Reg::RAX, elem.kind, q.arg1);
+            } else {
+                loadAs(X64Reg::RDX, q.arg1, elem.kind);
+                emit(X64Op::MOV, element, RDX);
+            }
+            break;
+        }
+        case Opcode::LOAD_MEMBER: case Opcode::STORE_MEMBER: {
+            int64_t index = q.res.intValue / 2; // 成员按 2 字节一个排布
+            NativeType type = memberType(typeOf(q.arg2), q.res.intValue);
+            bool isStore = q.op == Opcode::STORE_MEMBER;
+            // 要写入的值在分配对象之前取出，分配时调用运行时可能破坏它所在的寄存器
+            if (isStore) loadAs(X64Reg::RDX, q.arg1, type.kind);
+            X64Operand member = mem(ensureObject(q.arg2, index, isStore), 8 + 8 * index);
+            if (isStore) {
+                emit(X64Op::MOV, member, RDX);
+            } else {
+                emit(X64Op::MOV, RAX, member);
+                store(X64Reg::RAX, type.kind, q.arg1);
+            }
+            break;
+        }
+    }
+}
+
+// 调用用户函数: 实参已经在栈上 ([rsp] 是第一个)，按 System V 约定装入参数寄存器，
+// 放不下的按顺序复制到栈顶，返回后一起弹出
+void X64Generator::emitCall(const Quadruple& q) {
+    size_t argc = min(static_cast<size_t>(max<int64_t>(q.arg2.intValue, 0)), pendingArgs.size());
+    vector<ValueKind> argKinds(argc), paramKinds(argc);
+    for (size_t k = 0; k < argc; ++k) argKinds[k] = pendingArgs[pendingArgs.size() - 1 - k];
+    paramKinds = argKinds;
+    NativeType ret;
+    auto fit = functionIndex.find(q.arg1.name);
+    if (fit != functionIndex.end() && functions[fit->second].signature) {
+        const auto& signature = functions[fit->second].signature;
+        if (signature->parameters.size() == argc) {
+            for (size_t k = 0; k < argc; ++k) paramKinds[k] = fromTypeInfo(signature->parameters[k].type).kind;
+        }
+        ret = fromTypeInfo(signature->returnType);
+    }
+
+    // 分类: 寄存器参数记下寄存器，其余按顺序放到栈上
+    vector<X64Reg> regs(argc, X64Reg::NONE);
+    vector<size_t> onStack;
+    size_t gpr = 0, xmm = 0;
+    for (size_t k = 0; k < argc; ++k) {
+        if (paramKinds[k] == ValueKind::FLOAT) {
+            if (xmm < NUM_ARG_XMM) regs[k] = xmmReg(static_cast<int>(xmm++));
+            else onStack.push_back(k);
+        } else {
+            if (gpr < NUM_ARG_GPR) regs[k] = ARG_GPR[gpr++];
+            else onStack.push_back(k);
+        }
+    }
+
+    // 调用时 rsp 要 16 字节对齐: 序言之后是对齐的，之后每压一个实参偏 8 字节
+    long extra = static_cast<long>(onStack.size() + (pendingArgs.size() + onStack.size()) % 2);
+    if (extra) emit(X64Op::SUB, RSP, imm(8 * extra));
+    auto argAt = [&](size_t k) { return mem(X64Reg::RSP, 8 * (extra + static_cast<long>(k))); };
+    auto convertInto = [&](X64Reg reg, size_t k) {
+        bool toFloat = paramKinds[k] == ValueKind::FLOAT;
+        bool fromFloat = argKinds[k] == ValueKind::FLOAT;
+        if (toFloat && !fromFloat && argKinds[k] != ValueKind::UNKNOWN) {
+            emit(X64Op::CVTSI2SD, isXmm(reg) ? reg64(reg) : XMM15, argAt(k));
+            if (!isXmm(reg)) emit(X64Op::MOVQ, reg64(reg), XMM15);
+        } else if (fromFloat && !toFloat && paramKinds[k] != ValueKind::UNKNOWN) {
+            emit(X64Op::CVTTSD2SI, reg64(reg), argAt(k));
+        } else {
+            emit(isXmm(reg) ? X64Op::MOVQ : X64Op::MOV, reg64(reg), argAt(k));
+        }
+    };
+    for (size_t j = 0; j < onStack.size(); ++j) {
+        convertInto(X64Reg::RAX, onStack[j]);
+        emit(X64Op::MOV, mem(X64Reg::RSP, 8 * static_cast<long>(j)), RAX);
+    }
+    for (size_t k = 0; k < argc; ++k) {
+        if (regs[k] != X64Reg::NONE) convertInto(regs[k], k);
+    }
+    emit(X64Op::CALL, symbolRef("fn_" + nameOf(q.arg1.name)));
+    long pop = 8 * (extra + static_cast<long>(argc));
+    if (pop) emit(X64Op::ADD, RSP, imm(pop));
+    pendingArgs.resize(pendingArgs.size() - argc);
+
+    if (q.res.isVariable()) {
+        if (ret.kind == ValueKind::FLOAT) emit(X64Op::MOVQ, RAX, XMM0);
+        store(X64Reg::RAX, ret.kind, q.res);
+    }
+}
+
+void X64Generator::emitArithmetic(const Quadruple& q) {
+    ValueKind a = kindOf(q.arg1), b = kindOf(q.arg2);
+    if (q.op == Opcode::ADD && (a == ValueKind::STRING || b == ValueKind::STRING)) {
+        load(X64Reg::RDI, q.arg1);
+        emit(X64Op::MOV, reg32(X64Reg::RSI), imm(printCode(typeOf(q.arg1))));
+        load(X64Reg::RDX, q.arg2);
+        emit(X64Op::MOV, reg32(X64Reg::RCX), imm(printCode(typeOf(q.arg2))));
+        callRuntime("rt_concat");
+        store(X64Reg::RAX, ValueKind::STRING, q.res);
+        return;
+    }
+
+    if (a == ValueKind::FLOAT || b == ValueKind::FLOAT) {
+        loadXmm(X64Reg::XMM0, q.arg1);
+        loadXmm(X64Reg::XMM1, q.arg2);
+        if (q.op == Opcode::DIV || q.op == Opcode::MOD) {
+            // 除数为 0 (不含 NaN) 时报错
+            string ok = newLabel();
+            emit(X64Op::XORPD, XMM2, XMM2);
+            emit(X64Op::UCOMISD, XMM1, XMM2);
+            emit(X64Op::JP, symbolRef(ok));
+            emit(X64Op::JE, symbolRef("rt_err_div"));
+            out->label(ok);
+        }
+        switch (q.op) {
+            case Opcode::ADD: emit(X64Op::ADDSD, XMM0, XMM1); break;
+            case Opcode::SUB: emit(X64Op::SUBSD, XMM0, XMM1); break;
+            case Opcode::MUL: emit(X64Op::MULSD, XMM0, XMM1); break;
+            case Opcode::DIV: emit(X64Op::DIVSD, XMM0, XMM1); break;
+            default: {
+                // fmod: 用 x87 的 fprem 求截断余数，不依赖 libm。C2 (状态字第 10 位) 置位表示还没算完
+                string again = newLabel();
+                emit(X64Op::SUB, RSP, imm(16));
+                emit(X64Op::MOVSD, mem(X64Reg::RSP), XMM1);
+                emit(X64Op::MOVSD, mem(X64Reg::RSP, 8), XMM0);
+                emit(X64Op::FLD, mem(X64Reg::RSP));
+                emit(X64Op::FLD, mem(X64Reg::RSP, 8));
+                out->label(again);
+                emit(X64Op::FPREM);
+                emit(X64Op::FNSTSW_AX);
+                emit(X64Op::TEST, reg32(X64Reg::RAX), imm(0x400));
+                emit(X64Op::JNE, symbolRef(again));
+                emit(X64Op::FSTP, mem(X64Reg::RSP, 8));
+                emit(X64Op::FSTP_ST0);
+                emit(X64Op::MOVSD, XMM0, mem(X64Reg::RSP, 8));
+                emit(X64Op::ADD, RSP, imm(16));
+                break;
+            }
+        }
+        emit(X64Op::MOVQ, RAX, XMM0);
+        store(X64Reg::RAX, ValueKind::FLOAT, q.res);
+        return;
+    }
+
+    load(X64Reg::RAX, q.arg1);
+    switch (q.op) {
+        case Opcode::ADD: emit(X64Op::ADD, RAX, source(q.arg2, X64Reg::RCX)); break;
+        case Opcode::SUB: emit(X64Op::SUB, RAX, source(q.arg2, X64Reg::RCX)); break;
+        case Opcode::MUL: {
+            X64Operand src = source(q.arg2, X64Reg::RCX);
+            if (src.isImm()) { load(X64Reg::RCX, q.arg2); src = RCX; }
+            emit(X64Op::IMUL, RAX, src);
+            break;
+        }
+        default: {
+            // 除以 -1 单独处理，避免 INT64_MIN / -1 触发异常 (结果按补码回绕，与解释器一致)
+            bool isMod = q.op == Opcode::MOD;
+            bool knownSafe = q.arg2.kind == OperandKind::INT && q.arg2.intValue != 0 && q.arg2.intValue != -1;
+            load(X64Reg::RCX, q.arg2);
+            if (knownSafe) {
+                emit(X64Op::CQO);
+                emit(X64Op::IDIV, RCX);
+                if (isMod) emit(X64Op::MOV, RAX, RDX);
+                break;
+            }
+            string byMinusOne = newLabel(), done = newLabel();
+            emit(X64Op::TEST, RCX, RCX);
+            emit(X64Op::JE, symbolRef("rt_err_div"));
+            emit(X64Op::CMP, RCX, imm(-1));
+            emit(X64Op::JE, symbolRef(byMinusOne));
+            emit(X64Op::CQO);
+            emit(X64Op::IDIV, RCX);
+            if (isMod) emit(X64Op::MOV, RAX, RDX);
+            emit(X64Op::JMP, symbolRef(done));
+            out->label(byMinusOne);
+            if (isMod) emit(X64Op::XOR, reg32(X64Reg::RAX), reg32(X64Reg::RAX));
+            else emit(X64Op::NEG, RAX);
+            out->label(done);
+            break;
+        }
+    }
+    store(X64Reg::RAX, ValueKind::INT, q.res);
+}
+
+// 浮点比较与解释器一致: 有 NaN 时既不小于也不大于，按相等处理
+string X64Generator::emitCompare(const Quadruple& q) {
+    ValueKind a = kindOf(q.arg1), b = kindOf(q.arg2);
+    if (a == ValueKind::STRING && b == ValueKind::STRING) {
+        load(X64Reg::RDI, q.arg1);
+        load(X64Reg::RSI, q.arg2);
+        callRuntime("rt_strcmp");
+        emit(X64Op::TEST, reg32(X64Reg::RAX), reg32(X64Reg::RAX));
+    } else if (a == ValueKind::FLOAT || b == ValueKind::FLOAT) {
+        loadXmm(X64Reg::XMM0, q.arg1);
+        loadXmm(X64Reg::XMM1, q.arg2);
+        switch (q.op) {
+            case Opcode::LT: emit(X64Op::UCOMISD, XMM1, XMM0); return "a";
+            case Opcode::GT: emit(X64Op::UCOMISD, XMM0, XMM1); return "a";
+            case Opcode::LE: emit(X64Op::UCOMISD, XMM0, XMM1); return "be";
+            case Opcode::GE: emit(X64Op::UCOMISD, XMM1, XMM0); return "be";
+            case Opcode::EQ: emit(X64Op::UCOMISD, XMM0, XMM1); return "e";
+            default:         emit(X64Op::UCOMISD, XMM0, XMM1); return "ne";
+        }
+    } else {
+        X64Operand left = source(q.arg1, X64Reg::RAX);
+        if (!left.isReg()) { load(X64Reg::RAX, q.arg1); left = RAX; }
+        emit(X64Op::CMP, left, source(q.arg2, X64Reg::RCX));
+    }
+    switch (q.op) {
+        case Opcode::LT: return "l";
+        case Opcode::GT: return "g";
+        case Opcode::LE: return "le";
+        case Opcode::GE: return "ge";
+        case Opcode::EQ: return "e";
+        default:         return "ne";
+    }
+}
+
+// 浮点数 ±0 为假 (NaN 为真)，把符号位移出去后看是否为 0
+void X64Generator::emitTruth(const Operand& operand, X64Reg scratch) {
+    if (kindOf(operand) == ValueKind::FLOAT) {
+        load(scratch, operand);
+        emit(X64Op::ADD, reg64(scratch), reg64(scratch));
+        return;
+    }
+    X64Operand src = source(operand, scratch);
+    if (src.isReg()) {
+        emit(X64Op::TEST, src, src);
+    } else if (src.isMem()) {
+        emit(X64Op::CMP, src, imm(0));
+    } else {
+        load(scratch, operand);
+        emit(X64Op::TEST, reg64(scratch), reg64(scratch));
+    }
+}
+
+// 结构体变量第一次使用时分配，返回存放对象指针的寄存器。keepRdx 为真时分配前后保存 rdx
+X64Reg X64Generator::ensureObject(const Operand& base, int64_t index, bool keepRdx) {
+    NativeType type = typeOf(base);
+    int64_t count = type.kind == ValueKind::STRUCT && type.info ? static_cast<int64_t>(type.info->structMembers.size()) : 16;
+    count = max(count, index + 1);
+
+    load(X64Reg::RAX, base);
+    string ready = newLabel();
+    emit(X64Op::TEST, RAX, RAX);
+    emit(X64Op::JNE, symbolRef(ready));
+    emit(X64Op::MOV, reg32(X64Reg::RDI), imm(count));
+    if (keepRdx) {
+        emit(X64Op::PUSH, RDX);
+        emit(X64Op::SUB, RSP, imm(8));
+    }
+    callRuntime("rt_new_array");
+    if (keepRdx) {
+        emit(X64Op::ADD, RSP, imm(8));
+        emit(X64Op::POP, RDX);
+    }
+    emit(X64Op::MOV, location(base), RAX);
+    out->label(ready);
+    return X64Reg::RAX;
+}
+
+// 调用运行时或 libc: 栈上还压着没用掉的实参时先补齐 16 字节对齐
+void X64Generator::callRuntime(const string& routine) {
+    bool pad = pendingArgs.size() % 2 != 0;
+    if (pad) emit(X64Op::SUB, RSP, imm(8));
+    emit(X64Op::CALL, symbolRef(routine));
+    if (pad) emit(X64Op::ADD, RSP, imm(8));
+}
+
+X64Operand X64Generator::location(const Operand& operand) {
+    if (isGlobal(operand)) return ripMem("gv_" + nameOf(operand.name));
+    auto it = current->locations.find(operand.name);
+    if (it != current->locations.end()) return it->second;
+    return ripMem("rt_discard"); // 没有活跃区间的变量 (不会被读取)
+}
+
+// 可以直接作为指令源操作数的形式: 寄存器、内存或 32 位立即数，否则先装入 scratch
+X64Operand X64Generator::source(const Operand& operand, X64Reg scratch) {
+    if (operand.isVariable()) return location(operand);
+    if ((operand.kind == OperandKind::INT || operand.kind == OperandKind::BOOL || operand.kind == OperandKind::CHAR) &&
+        fitsImm32(operand.intValue)) {
+        return imm(operand.intValue);
+    }
+    load(scratch, operand);
+    return reg64(scratch);
+}
+
+void X64Generator::load(X64Reg reg, const Operand& operand) {
+    switch (operand.kind) {
+        case OperandKind::INT: case OperandKind::BOOL: case OperandKind::CHAR:
+            if (operand.intValue == 0) emit(X64Op::XOR, reg32(reg), reg32(reg));
+            else emit(X64Op::MOV, reg64(reg), imm(operand.intValue));
+            break;
+        case OperandKind::FLOAT:
+            emit(X64Op::MOV, reg64(reg), imm(doubleBits(operand.floatValue)), operand.str());
+            break;
+        case OperandKind::STRING:
+            emit(X64Op::LEA, reg64(reg), ripMem(string_literals[operand.name]));
+            break;
+        case OperandKind::TEMP: case OperandKind::SYMBOL: {
+            X64Operand loc = location(operand);
+            if (loc != reg64(reg)) emit(X64Op::MOV, reg64(reg), loc);
+            break;
+        }
+        default:
+            emit(X64Op::XOR, reg32(reg), reg32(reg));
+            break;
+    }
+}
+
+// 装入并转换成 want 类型: 整数与浮点数之间按 C 的规则转换，其余按原样
+void X64Generator::loadAs(X64Reg reg, const Operand& operand, ValueKind want) {
+    ValueKind have = kindOf(operand);
+    bool haveInt = have == ValueKind::INT || have == ValueKind::BOOL || have == ValueKind::CHAR;
+    bool wantInt = want == ValueKind::INT || want == ValueKind::BOOL || want == ValueKind::CHAR;
+    if (want == ValueKind::FLOAT && haveInt) {
+        if (!operand.isVariable()) {
+            emit(X64Op::MOV, reg64(reg), imm(doubleBits(static_cast<double>(operand.intValue))));
+        } else {
+            emit(X64Op::CVTSI2SD, XMM15, location(operand));
+            emit(X64Op::MOVQ, reg64(reg), XMM15);
+        }
+    } else if (wantInt && have == ValueKind::FLOAT) {
+        if (!operand.isVariable()) {
+            emit(X64Op::MOV, reg64(reg), imm(static_cast<int64_t>(operand.floatValue)));
+        } else {
+            X64Operand loc = location(operand);
+            if (loc.isReg()) {
+                emit(X64Op::MOVQ, XMM15, loc);
+                loc = XMM15;
+            }
+            emit(X64Op::CVTTSD2SI, reg64(reg), loc);
+        }
+    } else {
+        load(reg, operand);
+    }
+}
+
+void X64Generator::loadXmm(X64Reg xmm, const Operand& operand) {
+    ValueKind kind = kindOf(operand);
+    if (!operand.isVariable()) {
+        double value = operand.kind == OperandKind::FLOAT ? operand.floatValue : static_cast<double>(operand.intValue);
+        if (value == 0 && !signbit(value)) {
+            emit(X64Op::XORPD, reg64(xmm), reg64(xmm));
+        } else {
+            emit(X64Op::MOV, RAX, imm(doubleBits(value)), operand.str());
+            emit(X64Op::MOVQ, reg64(xmm), RAX);
+        }
+    } else if (kind == ValueKind::FLOAT || kind == ValueKind::UNKNOWN) {
+        emit(X64Op::MOVQ, reg64(xmm), location(operand));
+    } else {
+        emit(X64Op::CVTSI2SD, reg64(xmm), location(operand));
+    }
+}
+
+// 把 reg 中 kind 类型的值写入 dest，按 dest 的类型转换
+void X64Generator::store(X64Reg reg, ValueKind kind, const Operand& dest) {
+    if (!dest.isVariable()) return;
+    ValueKind want = kindOf(dest);
+    bool haveInt = kind == ValueKind::INT || kind == ValueKind::BOOL || kind == ValueKind::CHAR;
+    bool wantInt = want == ValueKind::INT || want == ValueKind::BOOL || want == ValueKind::CHAR;
+    if (want == ValueKind::FLOAT && haveInt) {
+        emit(X64Op::CVTSI2SD, XMM15, reg64(reg));
+        emit(X64Op::MOVQ, reg64(reg), XMM15);
+    } else if (wantInt && kind == ValueKind::FLOAT) {
+        emit(X64Op::MOVQ, XMM15, reg64(reg));
+        emit(X64Op::CVTTSD2SI, reg64(reg), XMM15);
+    }
+    emit(X64Op::MOV, location(dest), reg64(reg));
+}
+
+void X64Generator::assign(const Operand& dest, const Operand& src) {
+    ValueKind have = kindOf(src), want = kindOf(dest);
+    bool haveInt = have == ValueKind::INT || have == ValueKind::BOOL || have == ValueKind::CHAR;
+    bool wantInt = want == ValueKind::INT || want == ValueKind::BOOL || want == ValueKind::CHAR;
+    X64Operand d = location(dest);
+    if ((want == ValueKind::FLOAT && haveInt) || (wantInt && have == ValueKind::FLOAT)) {
+        loadAs(X64Reg::RAX, src, want);
+        emit(X64Op::MOV, d, RAX);
+        return;
+    }
+    if (d.isReg()) {
+        load(d.reg, src);
+        return;
+    }
+    X64Operand s = source(src, X64Reg::RAX);
+    if (s.isMem()) {
+        emit(X64Op::MOV, RAX, s);
+        s = RAX;
+    }
+    emit(X64Op::MOV, d, s);
+}
+
+string X64Generator::newLabel() { return ".LX" + to_string(label_counter++); }
+
+string X64Generator::labelName(NameId label) { return ".L_" + nameOf(label); }
+
+// 汇编文本的运行时错误入口 (其余例程见 RUNTIME_ROUTINES) 和运行时用到的常量
+void X64Generator::generateRuntime() {
+    for (const auto& [routine, message] : RUNTIME_MESSAGES) {
+        out->label(routine);
+        emit(X64Op::LEA, reg64(X64Reg::RDI), ripMem(string(".L") + routine + "_msg"));
+        emit(X64Op::JMP, symbolRef("rt_fail"));
+        out->dataString(string(".L") + routine + "_msg", message);
+    }
+    const pair<const char*, string> constants[] = {
+        {".Lrt_fmt_int_nl", "%ld\n"}, {".Lrt_fmt_float_nl", "%g\n"},
+        {".Lrt_fmt_int", "%ld"}, {".Lrt_fmt_float", "%g"},
+        {".Lrt_fmt_error", "运行时错误: %s\n"},
+        {".Lrt_true", "true"}, {".Lrt_false", "false"}, {".Lrt_empty", ""},
+        {".Lrt_lbracket", "["}, {".Lrt_rbracket", "]"}, {".Lrt_comma", ", "},
+    };
+    for (const auto& [label, text] : constants) out->dataString(label, text);
+}
+
+// 字符串字面量，以及全局变量和运行时的两个计数/占位单元
+void X64Generator::generateDataSection() {
+    for (const auto& [name, label] : string_literals) out->dataString(label, nameOf(name));
+    vector<NameId> names(globals.begin(), globals.end());
+    sort(names.begin(), names.end());
+    for (NameId name : names) out->dataZero("gv_" + nameOf(name), 8);
+    out->dataZero("rt_depth", 8);
+    out->dataZero("rt_discard", 8);
+}
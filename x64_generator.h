@@ -0,0 +1,131 @@
+#ifndef X64_GENERATOR_H
+#define X64_GENERATOR_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "quadruple.h"
+#include "symbol_table.h"
+#include "x64_assembler.h"
+
+struct BasicBlock;
+
+// x86-64 后端: 按 System V 调用约定生成 Linux 下的 GAS 汇编 (Intel 语法)，
+// 可以直接用系统工具链汇编链接: gcc -o program output.s
+//
+// 与 CodeGenerator 每条四元式都经 ax 读写栈槽不同，这里按函数做线性扫描寄存器分配:
+// 活跃区间由 Optimizer::analyzeLiveness 给出的基本块 live_in/live_out 和块内的读写位置确定，
+// 局部变量和临时变量跨四元式留在寄存器里，分不到寄存器的才溢出到栈上。
+// 跨越调用的区间只分给被调者保存的寄存器。
+//
+// 所有值都占 64 位: 整数、布尔、字符按整数存放；浮点数按位存放在通用寄存器里，运算时移入 xmm；
+// 字符串是以 0 结尾的字符指针；数组和结构体是指向堆上 [元素个数, 元素...] 的指针。
+// 每个变量的静态类型取自符号表，临时变量的类型由产生它的四元式推出。
+// 输出、字符串拼接、数组分配和运行时错误由附在汇编末尾的小运行时完成，只依赖 libc。
+//
+// 指令通过 X64Emitter 输出: generate() 打印成汇编文本，
+// generate(emitter) 只输出各函数的代码和数据，运行时例程 (rt_*) 由调用者提供，JIT 用它直接编码机器码。
+class X64Generator {
+public:
+    X64Generator(QuadrupleSpan quads, SymbolTable& st);
+    std::string generate(); // 生成汇编代码的公共接口
+    void generate(X64Emitter& emitter);
+
+private:
+    // 值的静态类型，UNKNOWN 按整数处理且不做类型转换
+    enum class ValueKind : uint8_t { UNKNOWN, INT, FLOAT, BOOL, CHAR, STRING, ARRAY, STRUCT };
+
+    struct NativeType {
+        ValueKind kind = ValueKind::UNKNOWN;
+        std::shared_ptr<TypeInfo> info; // 数组的元素类型、结构体的成员从这里取
+    };
+
+    // 一个变量的活跃区间，端点是四元式下标
+    struct LiveInterval {
+        NameId name = NAME_NONE;
+        int start = 0;
+        int end = 0;
+        bool crossesCall = false; // 区间内部有调用，只能放在被调者保存的寄存器里
+        int reg = -1;             // 分到的寄存器，-1 表示溢出
+        int slot = -1;            // 溢出时的栈槽
+    };
+
+    // 一个函数 (函数定义之外的顶层代码也算一个，名为 NAME_NONE，生成为 C 的 main)
+    struct FunctionInfo {
+        NameId name = NAME_NONE;
+        std::shared_ptr<TypeInfo> signature;          // 函数类型，顶层代码为空
+        std::vector<size_t> quads;                    // 属于该函数的四元式下标
+        std::vector<size_t> blocks;                   // 属于该函数的基本块下标
+        std::vector<NameId> params;                   // 按 GET_PARAM 的顺序
+        std::unordered_map<NameId, NativeType> types; // 局部变量和临时变量的类型
+        std::unordered_map<NameId, X64Operand> locations; // 寄存器或栈槽
+        std::vector<LiveInterval> intervals;          // 按起点排序
+        std::vector<int> savedRegisters;              // 用到的被调者保存寄存器
+        std::vector<NameId> clearedOnEntry;           // 入口处活跃 (可能先读后写)，需要清零的变量
+        int spillSlots = 0;
+    };
+
+    QuadrupleSpan quadruples;
+    SymbolTable& symbolTable;
+    X64Emitter* out = nullptr;
+
+    std::vector<FunctionInfo> functions;
+    std::unordered_map<NameId, size_t> functionIndex;
+    std::unordered_map<NameId, int> useCounts;            // 每个变量被读取的次数，用于合并比较和跳转
+    std::map<NameId, std::string> string_literals;        // 字面量 id -> 只读数据段标签
+    std::unordered_set<NameId> globals;                   // 出现过的全局变量
+    FunctionInfo* current = nullptr;                      // 正在生成的函数
+    std::vector<ValueKind> pendingArgs;                   // 已经压栈、等待 CALL 的实参类型
+    int label_counter = 0;
+
+    // 准备阶段
+    void collectFunctions(const std::vector<BasicBlock>& blocks, const std::vector<size_t>& blockStart);
+    void inferTypes(FunctionInfo& f);
+    void allocateRegisters(FunctionInfo& f, const std::vector<BasicBlock>& blocks,
+                           const std::vector<size_t>& blockStart);
+
+    // 类型
+    bool isGlobal(const Operand& operand);
+    NativeType declaredType(NameId name, const FunctionInfo& f);
+    NativeType typeOf(const Operand& operand);
+    ValueKind kindOf(const Operand& operand) { return typeOf(operand).kind; }
+    static NativeType fromTypeInfo(const std::shared_ptr<TypeInfo>& type);
+    static NativeType elementType(const NativeType& array);
+    static NativeType memberType(const NativeType& object, int64_t offset);
+    static int printCode(const NativeType& type);
+    bool callsOut(const Quadruple& q); // 该四元式的代码中是否有 call (会破坏调用者保存的寄存器)
+
+    // 代码生成
+    void generateFunction(FunctionInfo& f);
+    void generateForQuad(const Quadruple& q);
+    void emitCall(const Quadruple& q);
+    void emitArithmetic(const Quadruple& q);
+    std::string emitCompare(const Quadruple& q); // 设置标志位，返回比较成立时的条件码
+    void emitTruth(const Operand& operand, X64Reg scratch); // 操作数为假时 ZF = 1
+    X64Reg ensureObject(const Operand& base, int64_t index, bool keepRdx); // 结构体第一次使用时才分配
+    void callRuntime(const std::string& routine);
+    void generateRuntime();
+    void generateDataSection();
+
+    // 操作数的存取
+    X64Operand location(const Operand& operand);
+    X64Operand source(const Operand& operand, X64Reg scratch);
+    void load(X64Reg reg, const Operand& operand);
+    void loadAs(X64Reg reg, const Operand& operand, ValueKind want);
+    void loadXmm(X64Reg xmm, const Operand& operand);
+    void store(X64Reg reg, ValueKind kind, const Operand& dest);
+    void assign(const Operand& dest, const Operand& src);
+
+    void emit(X64Op op, const X64Operand& a = {}, const X64Operand& b = {}, const std::string& comment = "") {
+        out->instruction(op, a, b, comment);
+    }
+    std::string newLabel();
+    static std::string labelName(NameId label);
+};
+
+#endif // X64_GENERATOR_H